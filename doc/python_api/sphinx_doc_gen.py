@@ -222,6 +222,7 @@ else:
     EXCLUDE_MODULES = [
         "aud",
         "bgl",
+        "bl_math",
         "blf",
         "imbuf",
         "bmesh",
@@ -1783,7 +1784,7 @@ def write_rst_contents(basepath):
 
     standalone_modules = (
         # submodules are added in parent page
-        "mathutils", "freestyle", "bgl", "blf", "imbuf", "gpu", "gpu_extras",
+        "mathutils", "freestyle", "bgl", "blf", "imbuf", "bl_math", "gpu", "gpu_extras",
         "aud", "bpy_extras", "idprop.types", "bmesh",
     )
 
@@ -1913,6 +1914,7 @@ def write_rst_importable_modules(basepath):
         # C_modules
         "aud": "Audio System",
         "blf": "Font Drawing",
+        "bl_math": "Additional Math Functions",
         "imbuf": "Image Buffer",
         "gpu": "GPU Shader Module",
         "gpu.types": "GPU Types",
@@ -37,6 +37,7 @@
 typedef Eigen::SparseMatrix<double, Eigen::ColMajor> EigenSparseMatrix;
 typedef Eigen::SparseLU<EigenSparseMatrix> EigenSparseLU;
 typedef Eigen::VectorXd EigenVectorX;
+typedef Eigen::MatrixXd EigenMatrixX;
 typedef Eigen::Triplet<double> EigenTriplet;
 
 /* Linear Solver data structure */
@@ -99,8 +100,9 @@ struct LinearSolver {
   std::vector<EigenTriplet> Mtriplets;
   EigenSparseMatrix M;
   EigenSparseMatrix MtM;
-  std::vector<EigenVectorX> b;
-  std::vector<EigenVectorX> x;
+  /* One column per right hand side, so all of them are solved in a single batch. */
+  EigenMatrixX b;
+  EigenMatrixX x;
 
   EigenSparseLU *sparseLU;
 
@@ -164,7 +166,7 @@ static void linear_solver_variables_to_vector(LinearSolver *solver)
     LinearSolver::Variable *v = &solver->variable[i];
     if (!v->locked) {
       for (int j = 0; j < num_rhs; j++)
-        solver->x[j][v->index] = v->value[j];
+        solver->x(v->index, j) = v->value[j];
     }
   }
 }
@@ -177,7 +179,7 @@ static void linear_solver_vector_to_variables(LinearSolver *solver)
     LinearSolver::Variable *v = &solver->variable[i];
     if (!v->locked) {
       for (int j = 0; j < num_rhs; j++)
-        v->value[j] = solver->x[j][v->index];
+        v->value[j] = solver->x(v->index, j);
     }
   }
 }
@@ -208,13 +210,8 @@ static void linear_solver_ensure_matrix_construct(LinearSolver *solver)
     solver->Mtriplets.clear();
     solver->Mtriplets.reserve(std::max(m, n) * 3);
 
-    solver->b.resize(solver->num_rhs);
-    solver->x.resize(solver->num_rhs);
-
-    for (int i = 0; i < solver->num_rhs; i++) {
-      solver->b[i].setZero(m);
-      solver->x[i].setZero(n);
-    }
+    solver->b.setZero(m, solver->num_rhs);
+    solver->x.setZero(n, solver->num_rhs);
 
     linear_solver_variables_to_vector(solver);
 
@@ -258,11 +255,11 @@ void EIG_linear_solver_right_hand_side_add(LinearSolver *solver, int rhs, int in
   linear_solver_ensure_matrix_construct(solver);
 
   if (solver->least_squares) {
-    solver->b[rhs][index] += value;
+    solver->b(index, rhs) += value;
   }
   else if (!solver->variable[index].locked) {
     index = solver->variable[index].index;
-    solver->b[rhs][index] += value;
+    solver->b(index, rhs) += value;
   }
 }
 
@@ -301,45 +298,46 @@ bool EIG_linear_solver_solve(LinearSolver *solver)
 
     solver->state = LinearSolver::STATE_MATRIX_SOLVED;
   }
+  else {
+    /* factorization of an earlier solve failed */
+    result = (solver->sparseLU->info() == Eigen::Success);
+  }
 
   if (result) {
-    /* solve for each right hand side */
-    for (int rhs = 0; rhs < solver->num_rhs; rhs++) {
-      /* modify for locked variables */
-      EigenVectorX &b = solver->b[rhs];
-
-      for (int i = 0; i < solver->num_variables; i++) {
-        LinearSolver::Variable *variable = &solver->variable[i];
+    EigenMatrixX &b = solver->b;
 
-        if (variable->locked) {
-          std::vector<LinearSolver::Coeff> &a = variable->a;
+    /* modify for locked variables */
+    for (int i = 0; i < solver->num_variables; i++) {
+      LinearSolver::Variable *variable = &solver->variable[i];
 
-          for (int j = 0; j < a.size(); j++)
-            b[a[j].index] -= a[j].value * variable->value[rhs];
-        }
-      }
+      if (variable->locked) {
+        std::vector<LinearSolver::Coeff> &a = variable->a;
 
-      /* solve */
-      if (solver->least_squares) {
-        EigenVectorX Mtb = solver->M.transpose() * b;
-        solver->x[rhs] = solver->sparseLU->solve(Mtb);
-      }
-      else {
-        EigenVectorX &b = solver->b[rhs];
-        solver->x[rhs] = solver->sparseLU->solve(b);
+        for (int j = 0; j < a.size(); j++)
+          for (int rhs = 0; rhs < solver->num_rhs; rhs++)
+            b(a[j].index, rhs) -= a[j].value * variable->value[rhs];
       }
+    }
 
-      if (solver->sparseLU->info() != Eigen::Success)
-        result = false;
+    /* solve all right hand sides at once, re-using the factorization, so repeated solves only
+     * cost the back-substitution */
+    if (solver->least_squares) {
+      EigenMatrixX Mtb = solver->M.transpose() * b;
+      solver->x = solver->sparseLU->solve(Mtb);
     }
+    else {
+      solver->x = solver->sparseLU->solve(b);
+    }
+
+    if (solver->sparseLU->info() != Eigen::Success)
+      result = false;
 
     if (result)
       linear_solver_vector_to_variables(solver);
   }
 
   /* clear for next solve */
-  for (int rhs = 0; rhs < solver->num_rhs; rhs++)
-    solver->b[rhs].setZero(solver->m);
+  solver->b.setZero();
 
   return result;
 }
@@ -351,7 +349,7 @@ void EIG_linear_solver_print_matrix(LinearSolver *solver)
   std::cout << "A:" << solver->M << std::endl;
 
   for (int rhs = 0; rhs < solver->num_rhs; rhs++)
-    std::cout << "b " << rhs << ":" << solver->b[rhs] << std::endl;
+    std::cout << "b " << rhs << ":" << solver->b.col(rhs) << std::endl;
 
   if (solver->MtM.rows() && solver->MtM.cols())
     std::cout << "AtA:" << solver->MtM << std::endl;
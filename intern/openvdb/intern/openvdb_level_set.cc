@@ -23,6 +23,11 @@
 #include "openvdb_capi.h"
 #include "openvdb_util.h"
 
+#include <memory>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 OpenVDBLevelSet::OpenVDBLevelSet()
 {
   openvdb::initialize();
@@ -32,26 +37,64 @@ OpenVDBLevelSet::~OpenVDBLevelSet()
 {
 }
 
+/**
+ * Feeds the triangles to #openvdb::tools::meshToVolume directly from the arrays passed in,
+ * instead of copying them into point and polygon vectors first.
+ */
+class OpenVDBTriangleMeshAdapter {
+ public:
+  OpenVDBTriangleMeshAdapter(const float *vertices,
+                             const unsigned int *faces,
+                             const unsigned int totvertices,
+                             const unsigned int totfaces,
+                             const openvdb::math::Transform &xform)
+      : vertices(vertices),
+        faces(faces),
+        totvertices(totvertices),
+        totfaces(totfaces),
+        xform(xform)
+  {
+  }
+
+  size_t polygonCount() const
+  {
+    return totfaces;
+  }
+
+  size_t pointCount() const
+  {
+    return totvertices;
+  }
+
+  size_t vertexCount(size_t /*n*/) const
+  {
+    return 3;
+  }
+
+  void getIndexSpacePoint(size_t n, size_t v, openvdb::Vec3d &pos) const
+  {
+    const float *co = &vertices[faces[n * 3 + v] * 3];
+    pos = xform.worldToIndex(openvdb::Vec3d(co[0], co[1], co[2]));
+  }
+
+ private:
+  const float *vertices;
+  const unsigned int *faces;
+  const unsigned int totvertices;
+  const unsigned int totfaces;
+  const openvdb::math::Transform &xform;
+};
+
 void OpenVDBLevelSet::mesh_to_level_set(const float *vertices,
                                         const unsigned int *faces,
                                         const unsigned int totvertices,
                                         const unsigned int totfaces,
                                         const openvdb::math::Transform::Ptr &xform)
 {
-  std::vector<openvdb::Vec3s> points(totvertices);
-  std::vector<openvdb::Vec3I> triangles(totfaces);
-  std::vector<openvdb::Vec4I> quads;
-
-  for (unsigned int i = 0; i < totvertices; i++) {
-    points[i] = openvdb::Vec3s(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
-  }
+  OpenVDBTriangleMeshAdapter mesh(vertices, faces, totvertices, totfaces, *xform);
 
-  for (unsigned int i = 0; i < totfaces; i++) {
-    triangles[i] = openvdb::Vec3I(faces[i * 3], faces[i * 3 + 1], faces[i * 3 + 2]);
-  }
-
-  this->grid = openvdb::tools::meshToLevelSet<openvdb::FloatGrid>(
-      *xform, points, triangles, quads, 1);
+  /* Same narrow band as #openvdb::tools::meshToLevelSet with a half width of one voxel. */
+  this->grid = openvdb::tools::meshToVolume<openvdb::FloatGrid>(mesh, *xform, 1.0f, 1.0f);
 }
 
 void OpenVDBLevelSet::volume_to_mesh(OpenVDBVolumeToMeshData *mesh,
@@ -59,48 +102,76 @@ void OpenVDBLevelSet::volume_to_mesh(OpenVDBVolumeToMeshData *mesh,
                                      const double adaptivity,
                                      const bool relax_disoriented_triangles)
 {
-  std::vector<openvdb::Vec3s> out_points;
-  std::vector<openvdb::Vec4I> out_quads;
-  std::vector<openvdb::Vec3I> out_tris;
-  openvdb::tools::volumeToMesh<openvdb::FloatGrid>(*this->grid,
-                                                   out_points,
-                                                   out_tris,
-                                                   out_quads,
-                                                   isovalue,
-                                                   adaptivity,
-                                                   relax_disoriented_triangles);
+  /* Use the mesher directly rather than #openvdb::tools::volumeToMesh,
+   * so its output is copied once, straight into the arrays passed back to Blender. */
+  openvdb::tools::VolumeToMesh mesher(isovalue, adaptivity, relax_disoriented_triangles);
+  mesher(*this->grid);
+
+  const size_t totpoints = mesher.pointListSize();
+  const size_t totpools = mesher.polygonPoolListSize();
+  openvdb::tools::PointList &points = mesher.pointList();
+  openvdb::tools::PolygonPoolList &pools = mesher.polygonPoolList();
+
+  /* Offsets of each polygon pool in the output arrays. */
+  std::unique_ptr<size_t[]> pool_quad_offset(new size_t[totpools]);
+  std::unique_ptr<size_t[]> pool_tri_offset(new size_t[totpools]);
+  size_t totquads = 0;
+  size_t tottris = 0;
+  for (size_t n = 0; n < totpools; n++) {
+    pool_quad_offset[n] = totquads;
+    pool_tri_offset[n] = tottris;
+    totquads += pools[n].numQuads();
+    tottris += pools[n].numTriangles();
+  }
+
   mesh->vertices = (float *)MEM_malloc_arrayN(
-      out_points.size(), 3 * sizeof(float), "openvdb remesher out verts");
+      totpoints, 3 * sizeof(float), "openvdb remesher out verts");
   mesh->quads = (unsigned int *)MEM_malloc_arrayN(
-      out_quads.size(), 4 * sizeof(unsigned int), "openvdb remesh out quads");
+      totquads, 4 * sizeof(unsigned int), "openvdb remesh out quads");
   mesh->triangles = NULL;
-  if (out_tris.size() > 0) {
+  if (tottris > 0) {
     mesh->triangles = (unsigned int *)MEM_malloc_arrayN(
-        out_tris.size(), 3 * sizeof(unsigned int), "openvdb remesh out tris");
+        tottris, 3 * sizeof(unsigned int), "openvdb remesh out tris");
   }
 
-  mesh->totvertices = out_points.size();
-  mesh->tottriangles = out_tris.size();
-  mesh->totquads = out_quads.size();
-
-  for (size_t i = 0; i < out_points.size(); i++) {
-    mesh->vertices[i * 3] = out_points[i].x();
-    mesh->vertices[i * 3 + 1] = out_points[i].y();
-    mesh->vertices[i * 3 + 2] = out_points[i].z();
-  }
-
-  for (size_t i = 0; i < out_quads.size(); i++) {
-    mesh->quads[i * 4] = out_quads[i].x();
-    mesh->quads[i * 4 + 1] = out_quads[i].y();
-    mesh->quads[i * 4 + 2] = out_quads[i].z();
-    mesh->quads[i * 4 + 3] = out_quads[i].w();
-  }
-
-  for (size_t i = 0; i < out_tris.size(); i++) {
-    mesh->triangles[i * 3] = out_tris[i].x();
-    mesh->triangles[i * 3 + 1] = out_tris[i].y();
-    mesh->triangles[i * 3 + 2] = out_tris[i].z();
-  }
+  mesh->totvertices = totpoints;
+  mesh->tottriangles = tottris;
+  mesh->totquads = totquads;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, totpoints),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t i = range.begin(); i < range.end(); i++) {
+                        mesh->vertices[i * 3] = points[i].x();
+                        mesh->vertices[i * 3 + 1] = points[i].y();
+                        mesh->vertices[i * 3 + 2] = points[i].z();
+                      }
+                    });
+  points.reset(nullptr);
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, totpools),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t n = range.begin(); n < range.end(); n++) {
+                        const openvdb::tools::PolygonPool &pool = pools[n];
+                        unsigned int *quads = &mesh->quads[pool_quad_offset[n] * 4];
+                        for (size_t i = 0; i < pool.numQuads(); i++, quads += 4) {
+                          const openvdb::Vec4I &quad = pool.quad(i);
+                          quads[0] = quad.x();
+                          quads[1] = quad.y();
+                          quads[2] = quad.z();
+                          quads[3] = quad.w();
+                        }
+                        if (pool.numTriangles() == 0) {
+                          continue;
+                        }
+                        unsigned int *tris = &mesh->triangles[pool_tri_offset[n] * 3];
+                        for (size_t i = 0; i < pool.numTriangles(); i++, tris += 3) {
+                          const openvdb::Vec3I &tri = pool.triangle(i);
+                          tris[0] = tri.x();
+                          tris[1] = tri.y();
+                          tris[2] = tri.z();
+                        }
+                      }
+                    });
 }
 
 void OpenVDBLevelSet::filter(OpenVDBLevelSet_FilterType filter_type,
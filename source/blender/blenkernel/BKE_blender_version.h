@@ -31,7 +31,7 @@ extern "C" {
  * \note Use #STRINGIFY() rather than defining with quotes.
  */
 #define BLENDER_VERSION 290
-#define BLENDER_SUBVERSION 0
+#define BLENDER_SUBVERSION 1
 /** Several breakages with 280, e.g. collections vs layers. */
 #define BLENDER_MINVERSION 280
 #define BLENDER_MINSUBVERSION 0
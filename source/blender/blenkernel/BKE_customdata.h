@@ -296,6 +296,13 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+void CustomData_interp_batch(const struct CustomData *source,
+                             struct CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             const int *src_offsets,
+                             int dest_len,
+                             int dest_index);
 void CustomData_bmesh_interp_n(struct CustomData *data,
                                const void **src_blocks,
                                const float *weights,
@@ -394,6 +401,7 @@ void CustomData_set_layer_stencil_index(struct CustomData *data, int type, int n
 void CustomData_set_layer_flag(struct CustomData *data, int type, int flag);
 void CustomData_clear_layer_flag(struct CustomData *data, int type, int flag);
 
+void CustomData_bmesh_alloc_block(struct CustomData *data, void **block);
 void CustomData_bmesh_set_default(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block_data(struct CustomData *data, void *block);
@@ -412,6 +420,17 @@ void CustomData_from_bmesh_block(const struct CustomData *source,
                                  struct CustomData *dest,
                                  void *src_block,
                                  int dest_index);
+void CustomData_to_bmesh_block_array(const struct CustomData *source,
+                                     struct CustomData *dest,
+                                     int src_index,
+                                     void **dest_blocks,
+                                     int count,
+                                     bool use_default_init);
+void CustomData_from_bmesh_block_array(const struct CustomData *source,
+                                       struct CustomData *dest,
+                                       void *const *src_blocks,
+                                       int dest_index,
+                                       int count);
 
 void CustomData_file_write_prepare(struct CustomData *data,
                                    struct CustomDataLayer **r_write_layers,
@@ -421,6 +440,7 @@ void CustomData_file_write_prepare(struct CustomData *data,
 /* query info over types */
 void CustomData_file_write_info(int type, const char **r_struct_name, int *r_struct_num);
 int CustomData_sizeof(int type);
+size_t CustomData_get_memory_size(const struct CustomData *data, const int totelem);
 
 /* get the name of a layer type */
 const char *CustomData_layertype_name(int type);
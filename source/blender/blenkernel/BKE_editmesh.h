@@ -33,6 +33,7 @@ extern "C" {
 #endif
 
 struct BMLoop;
+struct BMPartialUpdate;
 struct BMesh;
 struct BoundBox;
 struct Depsgraph;
@@ -88,6 +89,7 @@ typedef struct BMEditMesh {
 
 /* editmesh.c */
 void BKE_editmesh_looptri_calc(BMEditMesh *em);
+void BKE_editmesh_looptri_calc_with_partial(BMEditMesh *em, struct BMPartialUpdate *bmpinfo);
 BMEditMesh *BKE_editmesh_create(BMesh *bm, const bool do_tessellate);
 BMEditMesh *BKE_editmesh_copy(BMEditMesh *em);
 BMEditMesh *BKE_editmesh_from_object(struct Object *ob);
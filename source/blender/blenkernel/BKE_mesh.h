@@ -131,6 +131,7 @@ void BKE_mesh_eval_delete(struct Mesh *me_eval);
 /* Performs copy for use during evaluation,
  * optional referencing original arrays to reduce memory. */
 struct Mesh *BKE_mesh_copy_for_eval(struct Mesh *source, bool reference);
+size_t BKE_mesh_memory_size(const struct Mesh *me);
 
 /* These functions construct a new Mesh,
  * contrary to BKE_mesh_from_nurbs which modifies ob itself. */
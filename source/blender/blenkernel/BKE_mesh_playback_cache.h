@@ -0,0 +1,84 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __BKE_MESH_PLAYBACK_CACHE_H__
+#define __BKE_MESH_PLAYBACK_CACHE_H__
+
+/** \file
+ * \ingroup bke
+ *
+ * Memory bounded cache of evaluated meshes, stored per object and per frame.
+ *
+ * Used during timeline playback and scrubbing to avoid re-evaluating the modifier stack of
+ * objects which were not edited since the frame was last evaluated. Entries of an object are
+ * invalidated by the dependency graph whenever a user edit is flushed to its geometry.
+ *
+ * Cached meshes are shared by the evaluated objects using them, and are read-only.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct CustomData_MeshMasks;
+struct Depsgraph;
+struct Mesh;
+struct MeshPlaybackCacheEntry;
+struct Object;
+struct Scene;
+
+/* Whether evaluated meshes of the given (evaluated) object may be stored in or read from the
+ * playback cache. */
+bool BKE_mesh_playback_cache_is_enabled(struct Depsgraph *depsgraph,
+                                        struct Scene *scene,
+                                        struct Object *ob_eval);
+
+/* Returns the entry matching the current frame and scene state on a cache hit, NULL otherwise.
+ * On a hit the return arguments are set to the cached meshes, which stay valid until the entry
+ * is released with #BKE_mesh_playback_cache_release. The modifier errors of the evaluation which
+ * created the meshes are reported again. */
+struct MeshPlaybackCacheEntry *BKE_mesh_playback_cache_lookup(
+    struct Depsgraph *depsgraph,
+    const struct Scene *scene,
+    struct Object *ob_eval,
+    const struct CustomData_MeshMasks *mask,
+    const bool need_mapping,
+    struct Mesh **r_mesh_final,
+    struct Mesh **r_mesh_deform);
+/* Move the evaluated meshes into the cache. Returns the new entry, which is used by the caller
+ * until it's released, or NULL when the meshes were not stored and are still owned by the
+ * caller. */
+struct MeshPlaybackCacheEntry *BKE_mesh_playback_cache_store(
+    struct Depsgraph *depsgraph,
+    const struct Scene *scene,
+    const struct Object *ob_eval,
+    const struct CustomData_MeshMasks *mask,
+    const bool need_mapping,
+    struct Mesh *mesh_final,
+    struct Mesh *mesh_deform);
+void BKE_mesh_playback_cache_release(struct MeshPlaybackCacheEntry *entry);
+
+void BKE_mesh_playback_cache_invalidate_object(const struct Object *ob_orig);
+void BKE_mesh_playback_cache_clear(void);
+void BKE_mesh_playback_cache_limit_update(void);
+
+size_t BKE_mesh_playback_cache_memory_in_use(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BKE_MESH_PLAYBACK_CACHE_H__ */
@@ -35,13 +35,41 @@ struct CustomData;
 struct CustomData_MeshMasks;
 struct Depsgraph;
 struct KeyBlock;
+struct MDeformWeight;
 struct MLoop;
 struct MLoopTri;
 struct MVertTri;
 struct Mesh;
+struct MeshElemMap;
 struct Object;
 struct Scene;
 
+/* Vertex group weights of all vertices, stored in flat arrays. */
+typedef struct MeshDeformWeights {
+  /* Weights of vertex i are stored in the range [vert_offsets[i], vert_offsets[i + 1]). */
+  int *vert_offsets;
+  struct MDeformWeight *dw;
+  int verts_num;
+  /* One more than the largest vertex group index. */
+  int def_nr_len;
+} MeshDeformWeights;
+
+/* Adjacency maps cached in the mesh runtime data, see #BKE_mesh_runtime_vert_poly_map_ensure. */
+typedef enum eMeshTopologyMapType {
+  MESH_TOPOLOGY_MAP_VERT_EDGE = 0,
+  MESH_TOPOLOGY_MAP_VERT_POLY = 1,
+  MESH_TOPOLOGY_MAP_VERT_LOOP = 2,
+  MESH_TOPOLOGY_MAP_EDGE_POLY = 3,
+} eMeshTopologyMapType;
+#define MESH_TOPOLOGY_MAP_NUM 4
+
+typedef struct MeshTopologyMaps {
+  /* Indices of all elements are stored contiguously in #mem (CSR layout),
+   * each #MeshElemMap points to its range in there. NULL until first requested. */
+  struct MeshElemMap *maps[MESH_TOPOLOGY_MAP_NUM];
+  int *mem[MESH_TOPOLOGY_MAP_NUM];
+} MeshTopologyMaps;
+
 void BKE_mesh_runtime_reset(struct Mesh *mesh);
 void BKE_mesh_runtime_reset_on_copy(struct Mesh *mesh, const int flag);
 int BKE_mesh_runtime_looptri_len(const struct Mesh *mesh);
@@ -51,6 +79,11 @@ bool BKE_mesh_runtime_ensure_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_clear_edit_data(struct Mesh *mesh);
 void BKE_mesh_runtime_clear_geometry(struct Mesh *mesh);
 void BKE_mesh_runtime_clear_cache(struct Mesh *mesh);
+const struct MeshDeformWeights *BKE_mesh_runtime_deform_weights_ensure(struct Mesh *mesh);
+const struct MeshElemMap *BKE_mesh_runtime_vert_edge_map_ensure(struct Mesh *mesh);
+const struct MeshElemMap *BKE_mesh_runtime_vert_poly_map_ensure(struct Mesh *mesh);
+const struct MeshElemMap *BKE_mesh_runtime_vert_loop_map_ensure(struct Mesh *mesh);
+const struct MeshElemMap *BKE_mesh_runtime_edge_poly_map_ensure(struct Mesh *mesh);
 
 void BKE_mesh_runtime_verttri_from_looptri(struct MVertTri *r_verttri,
                                            const struct MLoop *mloop,
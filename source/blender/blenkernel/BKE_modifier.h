@@ -359,6 +359,7 @@ const ModifierTypeInfo *BKE_modifier_get_info(ModifierType type);
  * default values if pointer is optional.
  */
 struct ModifierData *BKE_modifier_new(int type);
+void BKE_modifier_settings_tag_changed(struct ModifierData *md);
 void BKE_modifier_free_ex(struct ModifierData *md, const int flag);
 void BKE_modifier_free(struct ModifierData *md);
 
@@ -443,6 +444,74 @@ typedef struct VirtualModifierData {
 struct ModifierData *BKE_modifiers_get_virtual_modifierlist(const struct Object *ob,
                                                             struct VirtualModifierData *data);
 
+/* Intermediate results of the modifier stack of an evaluated object, stored after constructive
+ * modifiers. When only a later modifier changed, evaluation resumes from the last valid result
+ * instead of starting over from the base mesh. */
+
+typedef struct ModifierStackCacheEntry {
+  /* Identification of the modifier at this stack position, using the same scheme as the runtime
+   * data backup of the dependency graph: original modifier pointer and modifier type. */
+  struct ModifierData *md_orig;
+  int type;
+  /* Settings of the modifier, see #ModifierData.settings_update_id. */
+  uint settings_update_id;
+  int mode;
+  bool is_enabled;
+  /* The result can not be reused, for example because the modifier is animated or depends on
+   * data which changed. */
+  bool is_volatile;
+
+  /* Error message reported during evaluation, restored when the modifier is skipped. */
+  char *error;
+
+  /* State of the stack right after this modifier, NULL when no result is stored. */
+  struct Mesh *mesh;
+  struct Mesh *mesh_orco;
+  struct Mesh *mesh_orco_cloth;
+  struct CustomData_MeshMasks append_mask;
+  size_t memory_size;
+} ModifierStackCacheEntry;
+
+typedef struct ModifierStackCache {
+  /* Parameters of the evaluation the results were created for. */
+  float ctime;
+  int required_mode;
+  struct CustomData_MeshMasks mask;
+  bool need_mapping;
+  /* Viewport simplify settings, read by modifiers from the scene. */
+  int simplify_mode;
+  short simplify_subsurf;
+  /* Results are only stored once the stack is evaluated twice for the same frame, avoiding the
+   * cost of copies during playback. */
+  bool use_store;
+
+  /* Result of the leading deform-only modifiers. */
+  struct Mesh *mesh_deform;
+
+  ModifierStackCacheEntry *entries;
+  int entries_num;
+  size_t memory_size;
+} ModifierStackCache;
+
+struct ModifierStackCache *BKE_modifier_stack_cache_begin(struct Depsgraph *depsgraph,
+                                                          struct Scene *scene,
+                                                          struct Object *ob,
+                                                          struct ModifierData *firstmd,
+                                                          const int required_mode,
+                                                          const struct CustomData_MeshMasks *mask,
+                                                          const bool need_mapping,
+                                                          int *r_resume_index);
+void BKE_modifier_stack_cache_store(struct ModifierStackCache *cache,
+                                    const int index,
+                                    struct Mesh *mesh,
+                                    struct Mesh *mesh_orco,
+                                    struct Mesh *mesh_orco_cloth,
+                                    const struct CustomData_MeshMasks *append_mask);
+void BKE_modifier_stack_cache_end(struct ModifierStackCache *cache,
+                                  struct ModifierData *firstmd,
+                                  struct Mesh *mesh_deform);
+void BKE_modifier_stack_cache_free(struct ModifierStackCache *cache);
+
 /* ensure modifier correctness when changing ob->data */
 void BKE_modifiers_test_object(struct Object *ob);
 
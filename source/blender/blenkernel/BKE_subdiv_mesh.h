@@ -32,6 +32,7 @@ extern "C" {
 
 struct Mesh;
 struct Subdiv;
+struct SubdivMeshCache;
 
 typedef struct SubdivToMeshSettings {
   /* Resolution at which regular ptex (created for quad polygon) are being
@@ -50,6 +51,20 @@ struct Mesh *BKE_subdiv_to_mesh(struct Subdiv *subdiv,
                                 const SubdivToMeshSettings *settings,
                                 const struct Mesh *coarse_mesh);
 
+/* Same as above, but re-uses topology and custom data of the previously subdivided mesh when
+ * only vertex coordinates of the coarse mesh changed. In this case only positions and normals
+ * are evaluated, from the limit surface coordinates stored in the cache.
+ *
+ * The cache is created, updated or freed as needed. It's only filled once the same topology is
+ * subdivided twice, and when it needs at most cache_memory_limit bytes, zero disables it. */
+struct Mesh *BKE_subdiv_to_mesh_cached(struct Subdiv *subdiv,
+                                       const SubdivToMeshSettings *settings,
+                                       const struct Mesh *coarse_mesh,
+                                       const size_t cache_memory_limit,
+                                       struct SubdivMeshCache **r_cache);
+
+void BKE_subdiv_mesh_cache_free(struct SubdivMeshCache *cache);
+
 #ifdef __cplusplus
 }
 #endif
@@ -55,6 +55,7 @@
 #include "BKE_mesh.h"
 #include "BKE_mesh_iterators.h"
 #include "BKE_mesh_mapping.h"
+#include "BKE_mesh_playback_cache.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_mesh_tangent.h"
 #include "BKE_modifier.h"
@@ -947,9 +948,41 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   /* Clear errors before evaluation. */
   BKE_modifiers_clear_errors(ob);
 
+  /* Position of the current modifier in the stack, including virtual modifiers. */
+  int stack_index = 0;
+  bool have_non_onlydeform_modifiers_appled = false;
+
+  /* When interactively tweaking modifiers, resume from the stored result of the last constructive
+   * modifier which did not change since the previous evaluation. */
+  ModifierStackCache *stack_cache = NULL;
+  int resume_index = -1;
+  if (use_cache && index == -1 && useDeform == 1 && r_deform != NULL) {
+    stack_cache = BKE_modifier_stack_cache_begin(
+        depsgraph, scene, ob, firstmd, required_mode, dataMask, need_mapping, &resume_index);
+  }
+  if (resume_index != -1) {
+    for (; stack_index <= resume_index;
+         md = md->next, md_datamask = md_datamask->next, stack_index++) {
+      const ModifierStackCacheEntry *entry = &stack_cache->entries[stack_index];
+      if (entry->error != NULL) {
+        BKE_modifier_set_error(md, "%s", entry->error);
+      }
+    }
+    const ModifierStackCacheEntry *entry = &stack_cache->entries[resume_index];
+    mesh_final = BKE_mesh_copy_for_eval(entry->mesh, false);
+    if (entry->mesh_orco != NULL) {
+      mesh_orco = BKE_mesh_copy_for_eval(entry->mesh_orco, false);
+    }
+    if (entry->mesh_orco_cloth != NULL) {
+      mesh_orco_cloth = BKE_mesh_copy_for_eval(entry->mesh_orco_cloth, false);
+    }
+    append_mask = entry->append_mask;
+    mesh_deform = BKE_mesh_copy_for_eval(stack_cache->mesh_deform, false);
+    have_non_onlydeform_modifiers_appled = true;
+  }
   /* Apply all leading deform modifiers. */
-  if (useDeform) {
-    for (; md; md = md->next, md_datamask = md_datamask->next) {
+  else if (useDeform) {
+    for (; md; md = md->next, md_datamask = md_datamask->next, stack_index++) {
       const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
 
       if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
@@ -1000,8 +1033,7 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   }
 
   /* Apply all remaining constructive and deforming modifiers. */
-  bool have_non_onlydeform_modifiers_appled = false;
-  for (; md; md = md->next, md_datamask = md_datamask->next) {
+  for (; md; md = md->next, md_datamask = md_datamask->next, stack_index++) {
     const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
 
     if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
@@ -1259,6 +1291,11 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       }
 
       mesh_final->runtime.deformed_only = false;
+
+      if (stack_cache != NULL && deformed_verts == NULL) {
+        BKE_modifier_stack_cache_store(
+            stack_cache, stack_index, mesh_final, mesh_orco, mesh_orco_cloth, &append_mask);
+      }
     }
 
     isPrevDeform = (mti->type == eModifierTypeType_OnlyDeform);
@@ -1275,6 +1312,10 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
 
   BLI_linklist_free((LinkNode *)datamasks, NULL);
 
+  if (stack_cache != NULL) {
+    BKE_modifier_stack_cache_end(stack_cache, firstmd, mesh_deform);
+  }
+
   for (md = firstmd; md; md = md->next) {
     BKE_modifier_free_temporary_data(md);
   }
@@ -1724,7 +1765,9 @@ static void mesh_build_extra_data(struct Depsgraph *depsgraph, Object *ob, Mesh
 {
   uint32_t eval_flags = DEG_get_eval_flags_for_id(depsgraph, &ob->id);
 
-  if (eval_flags & DAG_EVAL_NEED_SHRINKWRAP_BOUNDARY) {
+  /* Meshes read from the playback cache already have it, and must not be modified. */
+  if ((eval_flags & DAG_EVAL_NEED_SHRINKWRAP_BOUNDARY) &&
+      mesh_eval->runtime.shrinkwrap_data == NULL) {
     BKE_shrinkwrap_compute_boundary_data(mesh_eval);
   }
 }
@@ -1764,17 +1807,37 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
 #endif
 
   Mesh *mesh_eval = NULL, *mesh_deform_eval = NULL;
-  mesh_calc_modifiers(depsgraph,
-                      scene,
-                      ob,
-                      1,
-                      need_mapping,
-                      dataMask,
-                      -1,
-                      true,
-                      true,
-                      &mesh_deform_eval,
-                      &mesh_eval);
+
+  /* During playback, objects which were not edited since the current frame was last evaluated
+   * use the meshes stored in the playback cache instead of evaluating the modifier stack. */
+  const bool use_playback_cache = BKE_mesh_playback_cache_is_enabled(depsgraph, scene, ob);
+  struct MeshPlaybackCacheEntry *playback_cache_entry = NULL;
+  if (use_playback_cache) {
+    playback_cache_entry = BKE_mesh_playback_cache_lookup(
+        depsgraph, scene, ob, dataMask, need_mapping, &mesh_eval, &mesh_deform_eval);
+  }
+
+  if (playback_cache_entry == NULL) {
+    mesh_calc_modifiers(depsgraph,
+                        scene,
+                        ob,
+                        1,
+                        need_mapping,
+                        dataMask,
+                        -1,
+                        true,
+                        true,
+                        &mesh_deform_eval,
+                        &mesh_eval);
+
+    /* Meshes shared with the original data did not need any evaluation, no need to cache them.
+     * Otherwise the cache takes ownership of the evaluated meshes. */
+    Mesh *mesh = ob->data;
+    if (use_playback_cache && mesh_eval != mesh->runtime.mesh_eval) {
+      playback_cache_entry = BKE_mesh_playback_cache_store(
+          depsgraph, scene, ob, dataMask, need_mapping, mesh_eval, mesh_deform_eval);
+    }
+  }
 
   /* The modifier stack evaluation is storing result in mesh->runtime.mesh_eval, but this result
    * is not guaranteed to be owned by object.
@@ -1783,9 +1846,11 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * object's runtime: this could cause access freed data on depsgraph destruction (mesh who owns
    * the final result might be freed prior to object). */
   Mesh *mesh = ob->data;
-  const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
+  const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval) &&
+                                  (playback_cache_entry == NULL);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  ob->runtime.mesh_playback_cache_entry = playback_cache_entry;
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
   ob->runtime.last_need_mapping = need_mapping;
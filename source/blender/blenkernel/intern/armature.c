@@ -62,6 +62,7 @@
 #include "BKE_lattice.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_object.h"
 #include "BKE_scene.h"
 
@@ -73,6 +74,10 @@
 
 #include "CLG_log.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static CLG_LogRef LOG = {"bke.armature"};
 
 /*************************** Prototypes ***************************/
@@ -1473,6 +1478,55 @@ static void pchan_bone_deform(bPoseChannel *pchan,
   (*contrib) += weight;
 }
 
+/* Rigid bones (without B-Bone segments and envelope multiplication) only need the weight of the
+ * vertex group, so their contributions are blended with vector instructions. For the matrix
+ * method the weighted bone matrices are summed and the vertex is transformed once by the sum. */
+
+/* Add the weighted bone matrix to the sum of matrices. */
+BLI_INLINE void skin_madd_m4_m4fl(float mat_accum[4][4], const float mat[4][4], float weight)
+{
+#ifdef __SSE2__
+  const __m128 weight_v = _mm_set1_ps(weight);
+  for (int i = 0; i < 4; i++) {
+    const __m128 col = _mm_mul_ps(_mm_loadu_ps(mat[i]), weight_v);
+    _mm_storeu_ps(mat_accum[i], _mm_add_ps(_mm_loadu_ps(mat_accum[i]), col));
+  }
+#else
+  for (int i = 0; i < 4; i++) {
+    madd_v4_v4fl(mat_accum[i], mat[i], weight);
+  }
+#endif
+}
+
+/* Same as #add_weighted_dq_dq. */
+BLI_INLINE void skin_add_weighted_dq(DualQuat *dq_accum, const DualQuat *dq, float weight)
+{
+#ifdef __SSE2__
+  /* Make sure we interpolate quats in the right direction. */
+  const bool flipped = dot_qtqt(dq->quat, dq_accum->quat) < 0.0f;
+  const __m128 weight_v = _mm_set1_ps(flipped ? -weight : weight);
+
+  _mm_storeu_ps(dq_accum->quat,
+                _mm_add_ps(_mm_loadu_ps(dq_accum->quat),
+                           _mm_mul_ps(_mm_loadu_ps(dq->quat), weight_v)));
+  _mm_storeu_ps(dq_accum->trans,
+                _mm_add_ps(_mm_loadu_ps(dq_accum->trans),
+                           _mm_mul_ps(_mm_loadu_ps(dq->trans), weight_v)));
+
+  /* Scale is never interpolated with negative weights. */
+  if (dq->scale_weight) {
+    const __m128 scale_weight_v = _mm_set1_ps(weight);
+    for (int i = 0; i < 4; i++) {
+      const __m128 col = _mm_mul_ps(_mm_loadu_ps(dq->scale[i]), scale_weight_v);
+      _mm_storeu_ps(dq_accum->scale[i], _mm_add_ps(_mm_loadu_ps(dq_accum->scale[i]), col));
+    }
+    dq_accum->scale_weight += weight;
+  }
+#else
+  add_weighted_dq_dq(dq_accum, dq, weight);
+#endif
+}
+
 typedef struct ArmatureUserdata {
   Object *armOb;
   Object *target;
@@ -1493,6 +1547,11 @@ typedef struct ArmatureUserdata {
 
   int defbase_tot;
   bPoseChannel **defnrToPC;
+  /* Bones which are blended by the vectorized kernel, indexed like defnrToPC. */
+  const bool *defnr_is_rigid;
+
+  /* Flattened weights of the target mesh, used instead of dverts when set. */
+  const MeshDeformWeights *deform_weights;
 
   float premat[4][4];
   float postmat[4][4];
@@ -1581,7 +1640,78 @@ static void armature_vert_task(void *__restrict userdata,
   /* Apply the object's matrix */
   mul_m4_v3(data->premat, co);
 
-  if (use_dverts && dvert && dvert->totweight) { /* use weight groups ? */
+  if (use_dverts && data->deform_weights && i < data->deform_weights->verts_num) {
+    const MeshDeformWeights *deform_weights = data->deform_weights;
+    const MDeformWeight *dw = &deform_weights->dw[deform_weights->vert_offsets[i]];
+    const MDeformWeight *dw_end = &deform_weights->dw[deform_weights->vert_offsets[i + 1]];
+    bool deformed = false;
+
+    /* Sum of the weighted matrices of rigid bones, unused for the dual quaternion method. */
+    float mat_accum[4][4];
+    float weight_accum = 0.0f;
+    if (!use_quaternion) {
+      zero_m4(mat_accum);
+    }
+
+    for (; dw != dw_end; dw++) {
+      const uint index = dw->def_nr;
+      if (index >= data->defbase_tot || (pchan = data->defnrToPC[index]) == NULL) {
+        continue;
+      }
+
+      float weight = dw->weight;
+      deformed = true;
+
+      if (weight == 0.0f) {
+        continue;
+      }
+
+      if (data->defnr_is_rigid[index]) {
+        if (use_quaternion) {
+          skin_add_weighted_dq(dq, &pchan->runtime.deform_dual_quat, weight);
+        }
+        else {
+          skin_madd_m4_m4fl(mat_accum, pchan->chan_mat, weight);
+          weight_accum += weight;
+        }
+        contrib += weight;
+      }
+      else {
+        Bone *bone = pchan->bone;
+
+        if (bone->flag & BONE_MULT_VG_ENV) {
+          weight *= distfactor_to_bone(
+              co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
+        }
+
+        pchan_bone_deform(pchan, weight, vec, dq, smat, co, &contrib);
+      }
+    }
+
+    if (weight_accum != 0.0f) {
+      float tmp[3];
+      mul_v3_m4v3(tmp, mat_accum, co);
+      madd_v3_v3fl(tmp, co, -weight_accum);
+      add_v3_v3(vec, tmp);
+
+      if (smat) {
+        float tmpmat[3][3];
+        copy_m3_m4(tmpmat, mat_accum);
+        add_m3_m3m3(smat, smat, tmpmat);
+      }
+    }
+
+    /* if there are vertexgroups but not groups with bones
+     * (like for softbody groups) */
+    if (!deformed && use_envelope) {
+      for (pchan = data->armOb->pose->chanbase.first; pchan; pchan = pchan->next) {
+        if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
+          contrib += dist_bone_deform(pchan, vec, dq, smat, co);
+        }
+      }
+    }
+  }
+  else if (use_dverts && dvert && dvert->totweight) { /* use weight groups ? */
     MDeformWeight *dw = dvert->dw;
     int deformed = 0;
     unsigned int j;
@@ -1682,6 +1812,8 @@ void armature_deform_verts(Object *armOb,
 {
   bArmature *arm = armOb->data;
   bPoseChannel **defnrToPC = NULL;
+  bool *defnr_is_rigid = NULL;
+  const MeshDeformWeights *deform_weights = NULL;
   MDeformVert *dverts = NULL;
   bDeformGroup *dg;
   const bool use_envelope = (deformflag & ARM_DEF_ENVELOPE) != 0;
@@ -1758,6 +1890,27 @@ void armature_deform_verts(Object *armOb,
             }
           }
         }
+
+        /* The flattened weights are cached on the mesh, which is only valid for the
+         * copy-on-write mesh since it is re-created whenever the original is edited. */
+        Mesh *me_weights = mesh ? (Mesh *)mesh : (target->type == OB_MESH ? target->data : NULL);
+        if (me_weights && (me_weights->id.tag & LIB_TAG_COPIED_ON_WRITE)) {
+          deform_weights = BKE_mesh_runtime_deform_weights_ensure(me_weights);
+        }
+
+        if (deform_weights) {
+          defnr_is_rigid = MEM_callocN(sizeof(*defnr_is_rigid) * defbase_tot, __func__);
+          for (i = 0; i < defbase_tot; i++) {
+            const bPoseChannel *pchan = defnrToPC[i];
+            if (pchan == NULL) {
+              continue;
+            }
+            const Bone *bone = pchan->bone;
+            const bool use_bbone = bone->segments > 1 &&
+                                   pchan->runtime.bbone_segments == bone->segments;
+            defnr_is_rigid[i] = !use_bbone && !(bone->flag & BONE_MULT_VG_ENV);
+          }
+        }
       }
     }
   }
@@ -1776,7 +1929,9 @@ void armature_deform_verts(Object *armOb,
                            .target_totvert = target_totvert,
                            .dverts = dverts,
                            .defbase_tot = defbase_tot,
-                           .defnrToPC = defnrToPC};
+                           .defnrToPC = defnrToPC,
+                           .defnr_is_rigid = defnr_is_rigid,
+                           .deform_weights = deform_weights};
 
   float obinv[4][4];
   invert_m4_m4(obinv, target->obmat);
@@ -1792,6 +1947,7 @@ void armature_deform_verts(Object *armOb,
   if (defnrToPC) {
     MEM_freeN(defnrToPC);
   }
+  MEM_SAFE_FREE(defnr_is_rigid);
 }
 
 /* ************ END Armature Deform ******************* */
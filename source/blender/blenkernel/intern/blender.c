@@ -49,6 +49,7 @@
 #include "BKE_image.h"
 #include "BKE_layer.h"
 #include "BKE_main.h"
+#include "BKE_mesh_playback_cache.h"
 #include "BKE_node.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
@@ -90,6 +91,7 @@ void BKE_blender_free(void)
   IMB_exit();
   BKE_cachefiles_exit();
   BKE_images_exit();
+  BKE_mesh_playback_cache_clear();
   DEG_free_node_types();
 
   BKE_brush_system_exit();
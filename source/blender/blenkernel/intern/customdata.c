@@ -2903,6 +2903,225 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/* Batched interpolation
+ *
+ * Interpolates many destination elements per layer, element i is interpolated from the
+ * sources in the range [src_offsets[i], src_offsets[i + 1]).
+ * Common layer types have dedicated loops which match their #LayerTypeInfo.interp callback,
+ * and read the sources from the layer directly, avoiding a function call per element.
+ * Sub-weights aren't supported. */
+
+static void customdata_interp_batch_float(const float *src_data,
+                                          const int *src_indices,
+                                          const float *weights,
+                                          const int *src_offsets,
+                                          float *dest_data,
+                                          const int dest_len)
+{
+  for (int i = 0; i < dest_len; i++) {
+    if (src_offsets[i] == src_offsets[i + 1]) {
+      continue;
+    }
+    float f = 0.0f;
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      f += src_data[src_indices[j]] * (weights ? weights[j] : 1.0f);
+    }
+    dest_data[i] = f;
+  }
+}
+
+static void customdata_interp_batch_float3(const float (*src_data)[3],
+                                           const int *src_indices,
+                                           const float *weights,
+                                           const int *src_offsets,
+                                           float (*dest_data)[3],
+                                           const int dest_len)
+{
+  for (int i = 0; i < dest_len; i++) {
+    if (src_offsets[i] == src_offsets[i + 1]) {
+      continue;
+    }
+    float co[3] = {0.0f, 0.0f, 0.0f};
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      madd_v3_v3fl(co, src_data[src_indices[j]], weights ? weights[j] : 1.0f);
+    }
+    copy_v3_v3(dest_data[i], co);
+  }
+}
+
+static void customdata_interp_batch_mloopuv(const MLoopUV *src_data,
+                                            const int *src_indices,
+                                            const float *weights,
+                                            const int *src_offsets,
+                                            MLoopUV *dest_data,
+                                            const int dest_len)
+{
+  for (int i = 0; i < dest_len; i++) {
+    float uv[2] = {0.0f, 0.0f};
+    int flag = 0;
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      const float weight = weights ? weights[j] : 1.0f;
+      const MLoopUV *src = &src_data[src_indices[j]];
+      madd_v2_v2fl(uv, src->uv, weight);
+      if (weight > 0.0f) {
+        flag |= src->flag;
+      }
+    }
+    copy_v2_v2(dest_data[i].uv, uv);
+    dest_data[i].flag = flag;
+  }
+}
+
+static void customdata_interp_batch_mloopcol(const MLoopCol *src_data,
+                                             const int *src_indices,
+                                             const float *weights,
+                                             const int *src_offsets,
+                                             MLoopCol *dest_data,
+                                             const int dest_len)
+{
+  for (int i = 0; i < dest_len; i++) {
+    float col[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      const float weight = weights ? weights[j] : 1.0f;
+      const MLoopCol *src = &src_data[src_indices[j]];
+      col[0] += src->r * weight;
+      col[1] += src->g * weight;
+      col[2] += src->b * weight;
+      col[3] += src->a * weight;
+    }
+    MLoopCol *dst = &dest_data[i];
+    dst->r = round_fl_to_uchar_clamp(col[0]);
+    dst->g = round_fl_to_uchar_clamp(col[1]);
+    dst->b = round_fl_to_uchar_clamp(col[2]);
+    dst->a = round_fl_to_uchar_clamp(col[3]);
+  }
+}
+
+static void customdata_interp_batch_callback(const LayerTypeInfo *typeInfo,
+                                             const void *src_data,
+                                             const int *src_indices,
+                                             const float *weights,
+                                             const int *src_offsets,
+                                             void *dest_data,
+                                             const int dest_len)
+{
+  const size_t size = (size_t)typeInfo->size;
+  const void *source_buf[SOURCE_BUF_SIZE];
+  for (int i = 0; i < dest_len; i++) {
+    const int src_start = src_offsets[i];
+    const int count = src_offsets[i + 1] - src_start;
+    const void **sources = source_buf;
+    /* Slow fallback in case we're interpolating a ridiculous number of elements. */
+    if (count > SOURCE_BUF_SIZE) {
+      sources = MEM_malloc_arrayN(count, sizeof(*sources), __func__);
+    }
+    for (int j = 0; j < count; j++) {
+      sources[j] = POINTER_OFFSET(src_data, (size_t)src_indices[src_start + j] * size);
+    }
+    typeInfo->interp(sources,
+                     weights ? &weights[src_start] : NULL,
+                     NULL,
+                     count,
+                     POINTER_OFFSET(dest_data, (size_t)i * size));
+    if (count > SOURCE_BUF_SIZE) {
+      MEM_freeN((void *)sources);
+    }
+  }
+}
+
+static void customdata_interp_batch_layer(const LayerTypeInfo *typeInfo,
+                                          const void *src_data,
+                                          const int *src_indices,
+                                          const float *weights,
+                                          const int *src_offsets,
+                                          void *dest_data,
+                                          const int dest_len)
+{
+  if (typeInfo->interp == layerInterp_bweight) {
+    customdata_interp_batch_float(
+        src_data, src_indices, weights, src_offsets, dest_data, dest_len);
+  }
+  else if (typeInfo->interp == layerInterp_shapekey) {
+    customdata_interp_batch_float3(
+        src_data, src_indices, weights, src_offsets, dest_data, dest_len);
+  }
+  else if (typeInfo->interp == layerInterp_mloopuv) {
+    customdata_interp_batch_mloopuv(
+        src_data, src_indices, weights, src_offsets, dest_data, dest_len);
+  }
+  else if (typeInfo->interp == layerInterp_mloopcol) {
+    customdata_interp_batch_mloopcol(
+        src_data, src_indices, weights, src_offsets, dest_data, dest_len);
+  }
+  else {
+    customdata_interp_batch_callback(
+        typeInfo, src_data, src_indices, weights, src_offsets, dest_data, dest_len);
+  }
+}
+
+/**
+ * Interpolate \a dest_len consecutive destination elements starting at \a dest_index,
+ * the result matches calling #CustomData_interp for each of them (without sub-weights).
+ *
+ * \param src_offsets: Array of size \a dest_len + 1, destination element i is interpolated
+ * from \a src_indices and \a weights in the range [src_offsets[i], src_offsets[i + 1]).
+ * \param weights: May be NULL, in which case all weights are 1.
+ *
+ * \note The destination elements must not be used as sources.
+ */
+void CustomData_interp_batch(const CustomData *source,
+                             CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             const int *src_offsets,
+                             int dest_len,
+                             int dest_index)
+{
+  if (dest_len == 0) {
+    return;
+  }
+
+  /* interpolates a layer at a time */
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+    if (!typeInfo->interp) {
+      continue;
+    }
+
+    /* find the first dest layer with type >= the source type
+     * (this should work because layers are ordered by type)
+     */
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+
+    /* if there are no more dest layers, we're done */
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+
+    /* if we found a matching layer, copy the data */
+    if (dest->layers[dest_i].type == source->layers[src_i].type) {
+      customdata_interp_batch_layer(
+          typeInfo,
+          source->layers[src_i].data,
+          src_indices,
+          weights,
+          src_offsets,
+          POINTER_OFFSET(dest->layers[dest_i].data, (size_t)dest_index * typeInfo->size),
+          dest_len);
+
+      /* if there are multiple source & dest layers of the same type,
+       * we don't want to copy all source layers to the same dest, so
+       * increment dest_i
+       */
+      dest_i++;
+    }
+  }
+}
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data
@@ -3454,7 +3673,12 @@ void CustomData_bmesh_free_block_data(CustomData *data, void *block)
   }
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+/**
+ * Allocate a block without initializing it, so it can be filled afterwards,
+ * e.g. by #CustomData_to_bmesh_block from multiple threads
+ * (allocating from the pool isn't thread-safe).
+ */
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
 
   if (*block) {
@@ -4016,6 +4240,114 @@ void CustomData_from_bmesh_block(const CustomData *source,
   }
 }
 
+static void customdata_bmesh_set_default_array(CustomData *data, void **blocks, int count, int n)
+{
+  for (int i = 0; i < count; i++) {
+    CustomData_bmesh_set_default_n(data, &blocks[i], n);
+  }
+}
+
+/**
+ * Same as calling #CustomData_to_bmesh_block for \a count consecutive elements starting at
+ * \a src_index, but copies a layer at a time. The blocks must be allocated already.
+ */
+void CustomData_to_bmesh_block_array(const CustomData *source,
+                                     CustomData *dest,
+                                     int src_index,
+                                     void **dest_blocks,
+                                     int count,
+                                     bool use_default_init)
+{
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      if (use_default_init) {
+        customdata_bmesh_set_default_array(dest, dest_blocks, count, dest_i);
+      }
+      dest_i++;
+    }
+
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+
+    if (dest->layers[dest_i].type == source->layers[src_i].type) {
+      const LayerTypeInfo *typeInfo = layerType_getInfo(dest->layers[dest_i].type);
+      const int offset = dest->layers[dest_i].offset;
+      const size_t size = (size_t)typeInfo->size;
+      const void *src_data = POINTER_OFFSET(source->layers[src_i].data, (size_t)src_index * size);
+
+      if (typeInfo->copy) {
+        for (int i = 0; i < count; i++) {
+          typeInfo->copy(POINTER_OFFSET(src_data, (size_t)i * size),
+                         POINTER_OFFSET(dest_blocks[i], offset),
+                         1);
+        }
+      }
+      else {
+        for (int i = 0; i < count; i++) {
+          memcpy(POINTER_OFFSET(dest_blocks[i], offset),
+                 POINTER_OFFSET(src_data, (size_t)i * size),
+                 size);
+        }
+      }
+      dest_i++;
+    }
+  }
+
+  if (use_default_init) {
+    while (dest_i < dest->totlayer) {
+      customdata_bmesh_set_default_array(dest, dest_blocks, count, dest_i);
+      dest_i++;
+    }
+  }
+}
+
+/**
+ * Same as calling #CustomData_from_bmesh_block for \a count blocks, written to consecutive
+ * elements starting at \a dest_index, but copies a layer at a time.
+ */
+void CustomData_from_bmesh_block_array(const CustomData *source,
+                                       CustomData *dest,
+                                       void *const *src_blocks,
+                                       int dest_index,
+                                       int count)
+{
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+
+    if (dest_i >= dest->totlayer) {
+      return;
+    }
+
+    if (dest->layers[dest_i].type == source->layers[src_i].type) {
+      const LayerTypeInfo *typeInfo = layerType_getInfo(dest->layers[dest_i].type);
+      const int offset = source->layers[src_i].offset;
+      const size_t size = (size_t)typeInfo->size;
+      void *dst_data = POINTER_OFFSET(dest->layers[dest_i].data, (size_t)dest_index * size);
+
+      if (typeInfo->copy) {
+        for (int i = 0; i < count; i++) {
+          typeInfo->copy(POINTER_OFFSET(src_blocks[i], offset),
+                         POINTER_OFFSET(dst_data, (size_t)i * size),
+                         1);
+        }
+      }
+      else {
+        for (int i = 0; i < count; i++) {
+          memcpy(POINTER_OFFSET(dst_data, (size_t)i * size),
+                 POINTER_OFFSET(src_blocks[i], offset),
+                 size);
+        }
+      }
+      dest_i++;
+    }
+  }
+}
+
 void CustomData_file_write_info(int type, const char **r_struct_name, int *r_struct_num)
 {
   const LayerTypeInfo *typeInfo = layerType_getInfo(type);
@@ -4090,6 +4422,21 @@ int CustomData_sizeof(int type)
   return typeInfo->size;
 }
 
+/**
+ * Amount of memory used by the layer arrays, not including data owned by individual elements.
+ */
+size_t CustomData_get_memory_size(const CustomData *data, const int totelem)
+{
+  size_t size = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    if (layer->data != NULL) {
+      size += (size_t)CustomData_sizeof(layer->type) * (size_t)totelem;
+    }
+  }
+  return size;
+}
+
 const char *CustomData_layertype_name(int type)
 {
   return layerType_getName(type);
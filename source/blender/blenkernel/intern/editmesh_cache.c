@@ -24,9 +24,30 @@
 
 #include "DNA_mesh_types.h"
 
+#include "BLI_task.h"
+
 #include "BKE_editmesh.h"
 #include "BKE_editmesh_cache.h" /* own include */
 
+/* -------------------------------------------------------------------- */
+/** \name Calculate Poly Normals
+ * \{ */
+
+typedef struct EditMeshCacheFaceData {
+  BMesh *bm;
+  BMFace **ftable;
+  const float (*vertexCos)[3];
+  float (*r_fdata)[3];
+} EditMeshCacheFaceData;
+
+static void editmesh_cache_poly_normals_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EditMeshCacheFaceData *data = userdata;
+  BM_face_calc_normal_vcos(data->bm, data->ftable[i], data->r_fdata[i], data->vertexCos);
+}
+
 void BKE_editmesh_cache_ensure_poly_normals(BMEditMesh *em, EditMeshData *emd)
 {
   if (!(emd->vertexCos && (emd->polyNos == NULL))) {
@@ -34,28 +55,34 @@ void BKE_editmesh_cache_ensure_poly_normals(BMEditMesh *em, EditMeshData *emd)
   }
 
   BMesh *bm = em->bm;
-  const float(*vertexCos)[3];
   float(*polyNos)[3];
 
-  BMFace *efa;
-  BMIter fiter;
-  int i;
-
-  BM_mesh_elem_index_ensure(bm, BM_VERT);
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_FACE);
+  BM_mesh_elem_table_ensure(bm, BM_FACE);
 
   polyNos = MEM_mallocN(sizeof(*polyNos) * bm->totface, __func__);
 
-  vertexCos = emd->vertexCos;
+  EditMeshCacheFaceData data = {
+      .bm = bm,
+      .ftable = bm->ftable,
+      .vertexCos = emd->vertexCos,
+      .r_fdata = polyNos,
+  };
 
-  BM_ITER_MESH_INDEX (efa, &fiter, bm, BM_FACES_OF_MESH, i) {
-    BM_elem_index_set(efa, i); /* set_inline */
-    BM_face_calc_normal_vcos(bm, efa, polyNos[i], vertexCos);
-  }
-  bm->elem_index_dirty &= ~BM_FACE;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = bm->totface >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0, bm->totface, &data, editmesh_cache_poly_normals_cb, &settings);
 
   emd->polyNos = (const float(*)[3])polyNos;
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Calculate Vertex Normals
+ * \{ */
+
 void BKE_editmesh_cache_ensure_vert_normals(BMEditMesh *em, EditMeshData *emd)
 {
   if (!(emd->vertexCos && (emd->vertexNos == NULL))) {
@@ -80,6 +107,28 @@ void BKE_editmesh_cache_ensure_vert_normals(BMEditMesh *em, EditMeshData *emd)
   emd->vertexNos = (const float(*)[3])vertexNos;
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Calculate Poly Centers
+ * \{ */
+
+static void editmesh_cache_poly_centers_vcos_cb(void *__restrict userdata,
+                                                const int i,
+                                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EditMeshCacheFaceData *data = userdata;
+  BM_face_calc_center_median_vcos(data->bm, data->ftable[i], data->r_fdata[i], data->vertexCos);
+}
+
+static void editmesh_cache_poly_centers_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  EditMeshCacheFaceData *data = userdata;
+  BM_face_calc_center_median(data->ftable[i], data->r_fdata[i]);
+}
+
 void BKE_editmesh_cache_ensure_poly_centers(BMEditMesh *em, EditMeshData *emd)
 {
   if (emd->polyCos != NULL) {
@@ -88,27 +137,31 @@ void BKE_editmesh_cache_ensure_poly_centers(BMEditMesh *em, EditMeshData *emd)
   BMesh *bm = em->bm;
   float(*polyCos)[3];
 
-  BMFace *efa;
-  BMIter fiter;
-  int i;
-
   polyCos = MEM_mallocN(sizeof(*polyCos) * bm->totface, __func__);
 
   if (emd->vertexCos) {
-    const float(*vertexCos)[3];
-    vertexCos = emd->vertexCos;
-
     BM_mesh_elem_index_ensure(bm, BM_VERT);
-
-    BM_ITER_MESH_INDEX (efa, &fiter, bm, BM_FACES_OF_MESH, i) {
-      BM_face_calc_center_median_vcos(bm, efa, polyCos[i], vertexCos);
-    }
-  }
-  else {
-    BM_ITER_MESH_INDEX (efa, &fiter, bm, BM_FACES_OF_MESH, i) {
-      BM_face_calc_center_median(efa, polyCos[i]);
-    }
   }
+  BM_mesh_elem_table_ensure(bm, BM_FACE);
+
+  EditMeshCacheFaceData data = {
+      .bm = bm,
+      .ftable = bm->ftable,
+      .vertexCos = emd->vertexCos,
+      .r_fdata = polyCos,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = bm->totface >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0,
+                          bm->totface,
+                          &data,
+                          emd->vertexCos ? editmesh_cache_poly_centers_vcos_cb :
+                                           editmesh_cache_poly_centers_cb,
+                          &settings);
 
   emd->polyCos = (const float(*)[3])polyCos;
 }
+
+/** \} */
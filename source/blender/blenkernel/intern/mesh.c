@@ -810,6 +810,18 @@ Mesh *BKE_mesh_copy_for_eval(struct Mesh *source, bool reference)
   return result;
 }
 
+/**
+ * Approximate amount of memory used by the mesh, used to enforce limits of evaluated mesh caches.
+ */
+size_t BKE_mesh_memory_size(const Mesh *me)
+{
+  return sizeof(Mesh) + CustomData_get_memory_size(&me->vdata, me->totvert) +
+         CustomData_get_memory_size(&me->edata, me->totedge) +
+         CustomData_get_memory_size(&me->fdata, me->totface) +
+         CustomData_get_memory_size(&me->ldata, me->totloop) +
+         CustomData_get_memory_size(&me->pdata, me->totpoly);
+}
+
 Mesh *BKE_mesh_copy(Main *bmain, const Mesh *me)
 {
   Mesh *me_copy;
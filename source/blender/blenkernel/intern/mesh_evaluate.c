@@ -798,6 +798,10 @@ typedef struct LoopSplitTaskDataCommon {
   int *loop_to_poly;
   const float (*polynors)[3];
 
+  /* Set by #loop_split_generator_parallel when a fan can't be walked, see
+   * #loop_split_generator_is_cyclic_smooth_fan_start. */
+  uint8_t is_fan_walk_invalid;
+
   int numEdges;
   int numLoops;
   int numPolys;
@@ -1585,6 +1589,192 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
 #endif
 }
 
+/**
+ * Check whether given smooth loop is the entry point of a cyclic smooth fan, i.e. whether its fan
+ * is cyclic and it is the first loop of that fan in (poly, loop) order.
+ *
+ * This gives the same entry points as #loop_split_generator_check_cyclic_smooth_fan when polys
+ * are processed in order, but without needing the shared skip_loops bitmap,
+ * so that it can be called for all loops in parallel.
+ *
+ * Without that bitmap the walk only ends by coming back to the initial loop or reaching a sharp
+ * edge, which invalid geometry doesn't guarantee. A fan can't have more loops than the mesh, so
+ * \a r_is_invalid is set and the walk stops once it took more steps than that.
+ */
+static bool loop_split_generator_is_cyclic_smooth_fan_start(const MLoop *mloops,
+                                                            const MPoly *mpolys,
+                                                            const int (*edge_to_loops)[2],
+                                                            const int *loop_to_poly,
+                                                            const int *e2l_prev,
+                                                            const MLoop *ml_curr,
+                                                            const MLoop *ml_prev,
+                                                            const int ml_curr_index,
+                                                            const int ml_prev_index,
+                                                            const int mp_curr_index,
+                                                            const int numLoops,
+                                                            bool *r_is_invalid)
+{
+  const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
+  const int *e2lfan_curr;
+  const MLoop *mlfan_curr;
+  /* mlfan_vert_index: the loop of our current edge might not be the loop of our current vertex! */
+  int mlfan_curr_index, mlfan_vert_index, mpfan_curr_index;
+
+  e2lfan_curr = e2l_prev;
+  if (IS_EDGE_SHARP(e2lfan_curr)) {
+    /* Sharp loop, so not a cyclic smooth fan... */
+    return false;
+  }
+
+  mlfan_curr = ml_prev;
+  mlfan_curr_index = ml_prev_index;
+  mlfan_vert_index = ml_curr_index;
+  mpfan_curr_index = mp_curr_index;
+
+  for (int steps = 0;; steps++) {
+    if (steps == numLoops) {
+      /* The walk entered a cycle which doesn't contain the initial loop. */
+      *r_is_invalid = true;
+      return false;
+    }
+    /* Find next loop of the smooth fan. */
+    BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
+                                                mpolys,
+                                                loop_to_poly,
+                                                e2lfan_curr,
+                                                mv_pivot_index,
+                                                &mlfan_curr,
+                                                &mlfan_curr_index,
+                                                &mlfan_vert_index,
+                                                &mpfan_curr_index);
+
+    e2lfan_curr = edge_to_loops[mlfan_curr->e];
+
+    if (IS_EDGE_SHARP(e2lfan_curr)) {
+      /* Sharp loop/edge, so not a cyclic smooth fan... */
+      return false;
+    }
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan without finding any loop coming before the
+       * initial one, it is the entry point of this smooth fan. */
+      return true;
+    }
+    if ((mpfan_curr_index < mp_curr_index) ||
+        (mpfan_curr_index == mp_curr_index && mlfan_vert_index < ml_curr_index)) {
+      /* Some other loop of this fan comes first, it will handle it. */
+      return false;
+    }
+  }
+}
+
+static void loop_split_generator_parallel_cb(void *__restrict userdata,
+                                             const int mp_index,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  float(*loopnors)[3] = common_data->loopnors;
+
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  bool is_fan_walk_invalid = false;
+
+  if (common_data->is_fan_walk_invalid) {
+    /* All normals are computed again by #loop_split_generator. */
+    return;
+  }
+
+  const MPoly *mp = &mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_curr_index = mp->loopstart;
+  int ml_prev_index = ml_last_index;
+
+  const MLoop *ml_curr = &mloops[ml_curr_index];
+  const MLoop *ml_prev = &mloops[ml_prev_index];
+
+  for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
+    const int *e2l_curr = edge_to_loops[ml_curr->e];
+    const int *e2l_prev = edge_to_loops[ml_prev->e];
+
+    if (IS_EDGE_SHARP(e2l_curr) ||
+        loop_split_generator_is_cyclic_smooth_fan_start(mloops,
+                                                        mpolys,
+                                                        edge_to_loops,
+                                                        loop_to_poly,
+                                                        e2l_prev,
+                                                        ml_curr,
+                                                        ml_prev,
+                                                        ml_curr_index,
+                                                        ml_prev_index,
+                                                        mp_index,
+                                                        common_data->numLoops,
+                                                        &is_fan_walk_invalid)) {
+      /* Same data as generated by #loop_split_generator, but kept on the stack
+       * since there is no lnor space to define. */
+      LoopSplitTaskData data = {
+          .lnor = &loopnors[ml_curr_index],
+          .ml_curr = ml_curr,
+          .ml_prev = ml_prev,
+          .ml_curr_index = ml_curr_index,
+          .ml_prev_index = ml_prev_index,
+          .mp_index = mp_index,
+      };
+      if (!(IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev))) {
+        /* Tag as 'fan' task. */
+        data.e2l_prev = e2l_prev;
+      }
+      loop_split_worker_do(common_data, &data, NULL);
+    }
+
+    ml_prev = ml_curr;
+    ml_prev_index = ml_curr_index;
+  }
+
+  if (is_fan_walk_invalid) {
+    atomic_fetch_and_or_uint8(&common_data->is_fan_walk_invalid, (uint8_t)true);
+  }
+}
+
+/**
+ * Variant of #loop_split_generator used when no lnor spaces are needed (i.e. without custom
+ * normals), which computes split normals directly from each fan's accumulated poly normals.
+ *
+ * Each fan is entered from the same loop as in #loop_split_generator, so face normals are
+ * accumulated in the same order and results are identical, but fans are found independently
+ * for each poly, which lets the whole process run in parallel. Meshes with fans which can't be
+ * walked that way are handled by #loop_split_generator instead.
+ */
+static void loop_split_generator_parallel(LoopSplitTaskDataCommon *common_data,
+                                          const bool use_threading)
+{
+  BLI_assert(common_data->lnors_spacearr == NULL);
+  BLI_assert(common_data->clnors_data == NULL);
+
+#ifdef DEBUG_TIME
+  TIMEIT_START_AVERAGED(loop_split_generator_parallel);
+#endif
+
+  common_data->is_fan_walk_invalid = false;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = use_threading;
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE / 4;
+
+  BLI_task_parallel_range(
+      0, common_data->numPolys, common_data, loop_split_generator_parallel_cb, &settings);
+
+  if (common_data->is_fan_walk_invalid) {
+    /* Computes all normals again, tracking the walked loops. */
+    loop_split_generator(NULL, common_data);
+  }
+
+#ifdef DEBUG_TIME
+  TIMEIT_END_AVERAGED(loop_split_generator_parallel);
+#endif
+}
+
 /**
  * Compute split normals, i.e. vertex normals associated with each poly (hence 'loop normals').
  * Useful to materialize sharp edges (or non-smooth faces) without actually modifying the geometry
@@ -1699,7 +1889,11 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
   /* This first loop check which edges are actually smooth, and compute edge vectors. */
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
+  if (r_lnors_spacearr == NULL) {
+    /* No lnor spaces to define, fans can be processed directly for each poly in parallel. */
+    loop_split_generator_parallel(&common_data, numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  }
+  else if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
     /* Not enough loops to be worth the whole threading overhead... */
     loop_split_generator(NULL, &common_data);
   }
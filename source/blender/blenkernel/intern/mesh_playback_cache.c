@@ -0,0 +1,484 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+/** \file
+ * \ingroup bke
+ *
+ * Playback Cache Design Notes
+ * ===========================
+ *
+ * The cache keeps the final (and, when requested, the deformed) mesh of an object for every
+ * evaluated frame, so that a second playback loop of an unchanged scene reads the result of the
+ * modifier stack instead of evaluating it again.
+ *
+ * Entries are looked up by the original object, its session UUID, the scene time and the scene
+ * state which modifiers read besides their own settings: the evaluation mode and the simplify
+ * settings. Evaluated meshes are moved into the cache instead of being copied, and evaluated
+ * objects reference the meshes of an entry without owning them. Cached meshes are shared between
+ * all users and must not be modified. Entries count their users: an entry removed from the cache
+ * while it is used is only freed once the last evaluated object releases it.
+ *
+ * A cache hit skips the modifier stack, so the errors reported by the modifiers are stored with
+ * the meshes and reported again on a hit. Stacks containing modifiers which have an effect
+ * besides their result (collision and surface data used by other objects, simulations) are
+ * never cached.
+ *
+ * Entries are linked in least recently used order. Once the memory used by all entries exceeds
+ * the limit from the user preferences, entries are removed starting from the least recently used
+ * one. A limit of zero disables the cache entirely.
+ *
+ * Invalidation is done by the dependency graph: whenever an update which originates from a user
+ * edit is flushed to the geometry component of an object, all entries of that object are removed.
+ * Entries are also indexed per object for this, so invalidating doesn't depend on the number of
+ * entries of other objects. Updates caused by time changes do not invalidate anything, this is
+ * what makes the cache useful.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_playback_cache.h"
+#include "BKE_modifier.h"
+#include "BKE_pointcache.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+typedef struct PlaybackCacheKey {
+  const Object *ob_orig;
+  uint session_uuid;
+  float ctime;
+
+  /* Scene state which modifiers read besides their own settings. */
+  const Scene *scene_orig;
+  int eval_mode;
+  int simplify_mode;
+  short simplify_subsurf;
+} PlaybackCacheKey;
+
+typedef struct MeshPlaybackCacheEntry {
+  /* Least recently used order. */
+  struct MeshPlaybackCacheEntry *next, *prev;
+  /* Link in #PlaybackCacheObject.entries, with the entry as data. */
+  LinkData object_link;
+
+  PlaybackCacheKey key;
+
+  /* Evaluation request the meshes were created for. */
+  CustomData_MeshMasks mask;
+  bool need_mapping;
+
+  /* Shared with the evaluated objects using the entry, read-only. */
+  Mesh *mesh_final;
+  Mesh *mesh_deform;
+
+  /* Errors reported by the modifiers in stack order, NULL when there were none. */
+  char **modifier_errors;
+  int modifier_errors_num;
+
+  size_t memory_size;
+
+  /* Number of evaluated objects using the meshes. */
+  int users;
+  /* No longer in the cache, freed when the last user releases it. */
+  bool is_removed;
+} MeshPlaybackCacheEntry;
+
+/* Entries of one object, to invalidate them without going over all entries. */
+typedef struct PlaybackCacheObject {
+  ListBase entries;
+} PlaybackCacheObject;
+
+typedef struct PlaybackCache {
+  GHash *hash;
+  /* Original object to #PlaybackCacheObject. */
+  GHash *objects;
+  /* Least recently used entries first. */
+  ListBase lru;
+  size_t memory_in_use;
+} PlaybackCache;
+
+static PlaybackCache playback_cache = {NULL};
+static ThreadMutex playback_cache_mutex = BLI_MUTEX_INITIALIZER;
+
+static size_t playback_cache_limit(void)
+{
+  return ((size_t)U.geometry_cachelimit) * 1024 * 1024;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Keys
+ * \{ */
+
+static uint playback_cache_key_hash(const void *key_v)
+{
+  const PlaybackCacheKey *key = key_v;
+  uint hash = BLI_ghashutil_ptrhash(key->ob_orig);
+  hash ^= BLI_ghashutil_uinthash(key->session_uuid);
+  hash ^= BLI_ghashutil_uinthash(*(const uint *)&key->ctime);
+  hash ^= BLI_ghashutil_ptrhash(key->scene_orig);
+  hash ^= BLI_ghashutil_uinthash((uint)key->simplify_mode ^ ((uint)key->simplify_subsurf << 8) ^
+                                 ((uint)key->eval_mode << 16));
+  return hash;
+}
+
+static bool playback_cache_key_cmp(const void *a_v, const void *b_v)
+{
+  const PlaybackCacheKey *a = a_v;
+  const PlaybackCacheKey *b = b_v;
+  /* Mirror #BLI_ghashutil_ptrcmp, false means the keys are equal. */
+  return (a->ob_orig != b->ob_orig) || (a->session_uuid != b->session_uuid) ||
+         (a->ctime != b->ctime) || (a->scene_orig != b->scene_orig) ||
+         (a->eval_mode != b->eval_mode) || (a->simplify_mode != b->simplify_mode) ||
+         (a->simplify_subsurf != b->simplify_subsurf);
+}
+
+static void playback_cache_key_init(PlaybackCacheKey *key,
+                                    Depsgraph *depsgraph,
+                                    const Scene *scene,
+                                    const Object *ob_eval)
+{
+  const Object *ob_orig = DEG_get_original_object((Object *)ob_eval);
+  key->ob_orig = ob_orig;
+  key->session_uuid = ob_orig->id.session_uuid;
+  key->ctime = DEG_get_ctime(depsgraph);
+  key->scene_orig = (const Scene *)DEG_get_original_id((ID *)&scene->id);
+  key->eval_mode = (int)DEG_get_mode(depsgraph);
+  key->simplify_mode = scene->r.mode & R_SIMPLIFY;
+  key->simplify_subsurf = scene->r.simplify_subsurf;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Entries
+ * \{ */
+
+static void playback_cache_entry_free(MeshPlaybackCacheEntry *entry)
+{
+  BLI_assert(entry->users == 0);
+  if (entry->mesh_final != NULL) {
+    BKE_mesh_eval_delete(entry->mesh_final);
+  }
+  if (entry->mesh_deform != NULL) {
+    BKE_mesh_eval_delete(entry->mesh_deform);
+  }
+  for (int i = 0; i < entry->modifier_errors_num; i++) {
+    MEM_SAFE_FREE(entry->modifier_errors[i]);
+  }
+  MEM_SAFE_FREE(entry->modifier_errors);
+  MEM_freeN(entry);
+}
+
+static void playback_cache_object_free(void *object_v)
+{
+  PlaybackCacheObject *object = object_v;
+  BLI_assert(BLI_listbase_is_empty(&object->entries));
+  MEM_freeN(object);
+}
+
+static void playback_cache_entry_add(MeshPlaybackCacheEntry *entry)
+{
+  if (playback_cache.hash == NULL) {
+    playback_cache.hash = BLI_ghash_new(
+        playback_cache_key_hash, playback_cache_key_cmp, "mesh playback cache");
+    playback_cache.objects = BLI_ghash_ptr_new("mesh playback cache objects");
+  }
+
+  PlaybackCacheObject **object_p;
+  if (!BLI_ghash_ensure_p(
+          playback_cache.objects, (void *)entry->key.ob_orig, (void ***)&object_p)) {
+    *object_p = MEM_callocN(sizeof(PlaybackCacheObject), __func__);
+  }
+  entry->object_link.data = entry;
+  BLI_addtail(&(*object_p)->entries, &entry->object_link);
+
+  BLI_ghash_insert(playback_cache.hash, &entry->key, entry);
+  BLI_addtail(&playback_cache.lru, entry);
+  playback_cache.memory_in_use += entry->memory_size;
+}
+
+/* Remove the entry from the cache, it's freed once it has no users. */
+static void playback_cache_entry_remove(MeshPlaybackCacheEntry *entry)
+{
+  BLI_ghash_remove(playback_cache.hash, &entry->key, NULL, NULL);
+  BLI_remlink(&playback_cache.lru, entry);
+
+  PlaybackCacheObject *object = BLI_ghash_lookup(playback_cache.objects, entry->key.ob_orig);
+  BLI_remlink(&object->entries, &entry->object_link);
+  if (BLI_listbase_is_empty(&object->entries)) {
+    BLI_ghash_remove(playback_cache.objects, entry->key.ob_orig, NULL, playback_cache_object_free);
+  }
+
+  BLI_assert(playback_cache.memory_in_use >= entry->memory_size);
+  playback_cache.memory_in_use -= entry->memory_size;
+
+  entry->is_removed = true;
+  if (entry->users == 0) {
+    playback_cache_entry_free(entry);
+  }
+}
+
+/* Free least recently used entries until the given amount of memory fits into the limit. */
+static void playback_cache_evict(const size_t memory_needed)
+{
+  const size_t limit = playback_cache_limit();
+  while (playback_cache.lru.first != NULL &&
+         playback_cache.memory_in_use + memory_needed > limit) {
+    playback_cache_entry_remove(playback_cache.lru.first);
+  }
+}
+
+static bool playback_cache_modifier_has_side_effects(const ModifierData *md)
+{
+  /* Collision and surface modifiers store their input for other objects, fluid and dynamic
+   * paint step their simulation. */
+  return ELEM(md->type,
+              eModifierType_Collision,
+              eModifierType_Surface,
+              eModifierType_Fluid,
+              eModifierType_DynamicPaint);
+}
+
+static void playback_cache_entry_errors_store(MeshPlaybackCacheEntry *entry, const Object *ob_eval)
+{
+  int index = 0;
+  LISTBASE_FOREACH (ModifierData *, md, &ob_eval->modifiers) {
+    if (md->error != NULL) {
+      if (entry->modifier_errors == NULL) {
+        entry->modifier_errors_num = BLI_listbase_count(&ob_eval->modifiers);
+        entry->modifier_errors = MEM_callocN(sizeof(char *) * entry->modifier_errors_num,
+                                             __func__);
+      }
+      entry->modifier_errors[index] = BLI_strdup(md->error);
+    }
+    index++;
+  }
+}
+
+static void playback_cache_entry_errors_restore(const MeshPlaybackCacheEntry *entry,
+                                                Object *ob_eval)
+{
+  BKE_modifiers_clear_errors(ob_eval);
+  int index = 0;
+  LISTBASE_FOREACH (ModifierData *, md, &ob_eval->modifiers) {
+    if (index == entry->modifier_errors_num) {
+      break;
+    }
+    if (entry->modifier_errors[index] != NULL) {
+      BKE_modifier_set_error(md, "%s", entry->modifier_errors[index]);
+    }
+    index++;
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+bool BKE_mesh_playback_cache_is_enabled(Depsgraph *depsgraph, Scene *scene, Object *ob_eval)
+{
+  if (U.geometry_cachelimit <= 0) {
+    return false;
+  }
+  /* Only interactive playback is accelerated, render and temporary graphs evaluate normally. */
+  if (!DEG_is_active(depsgraph) || DEG_get_mode(depsgraph) != DAG_EVAL_VIEWPORT) {
+    return false;
+  }
+  /* Paint and edit modes modify data in ways which are not reported as geometry edits. */
+  if (ob_eval->mode != OB_MODE_OBJECT) {
+    return false;
+  }
+  /* Simulations need to be stepped every frame to keep their internal state valid, they have
+   * their own caching through point caches. */
+  if (BKE_ptcache_object_has(scene, ob_eval, 0)) {
+    return false;
+  }
+  LISTBASE_FOREACH (ModifierData *, md, &ob_eval->modifiers) {
+    if (playback_cache_modifier_has_side_effects(md)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+MeshPlaybackCacheEntry *BKE_mesh_playback_cache_lookup(Depsgraph *depsgraph,
+                                                       const Scene *scene,
+                                                       Object *ob_eval,
+                                                       const CustomData_MeshMasks *mask,
+                                                       const bool need_mapping,
+                                                       Mesh **r_mesh_final,
+                                                       Mesh **r_mesh_deform)
+{
+  PlaybackCacheKey key;
+  playback_cache_key_init(&key, depsgraph, scene, ob_eval);
+
+  MeshPlaybackCacheEntry *entry = NULL;
+
+  BLI_mutex_lock(&playback_cache_mutex);
+  if (playback_cache.hash != NULL) {
+    entry = BLI_ghash_lookup(playback_cache.hash, &key);
+    if (entry != NULL && CustomData_MeshMasks_are_matching(&entry->mask, mask) &&
+        (entry->need_mapping || !need_mapping) &&
+        (entry->mesh_deform != NULL || r_mesh_deform == NULL)) {
+      entry->users++;
+      /* Mark as most recently used. */
+      BLI_remlink(&playback_cache.lru, entry);
+      BLI_addtail(&playback_cache.lru, entry);
+    }
+    else {
+      entry = NULL;
+    }
+  }
+  BLI_mutex_unlock(&playback_cache_mutex);
+
+  if (entry == NULL) {
+    return NULL;
+  }
+
+  /* The entry can't be freed while it has users, its data doesn't change. */
+  *r_mesh_final = entry->mesh_final;
+  if (r_mesh_deform != NULL) {
+    *r_mesh_deform = entry->mesh_deform;
+  }
+  playback_cache_entry_errors_restore(entry, ob_eval);
+  return entry;
+}
+
+MeshPlaybackCacheEntry *BKE_mesh_playback_cache_store(Depsgraph *depsgraph,
+                                                      const Scene *scene,
+                                                      const Object *ob_eval,
+                                                      const CustomData_MeshMasks *mask,
+                                                      const bool need_mapping,
+                                                      Mesh *mesh_final,
+                                                      Mesh *mesh_deform)
+{
+  BLI_assert(mesh_final != NULL);
+
+  const size_t memory_size = BKE_mesh_memory_size(mesh_final) +
+                             (mesh_deform ? BKE_mesh_memory_size(mesh_deform) : 0);
+  /* Don't let a single huge object flush everything else out of the cache. */
+  if (memory_size > playback_cache_limit() / 2) {
+    return NULL;
+  }
+
+  MeshPlaybackCacheEntry *entry = MEM_callocN(sizeof(*entry), __func__);
+  playback_cache_key_init(&entry->key, depsgraph, scene, ob_eval);
+  entry->mask = *mask;
+  entry->need_mapping = need_mapping;
+  entry->mesh_final = mesh_final;
+  entry->mesh_deform = mesh_deform;
+  entry->memory_size = memory_size;
+  entry->users = 1;
+  playback_cache_entry_errors_store(entry, ob_eval);
+
+  BLI_mutex_lock(&playback_cache_mutex);
+  if (playback_cache.hash != NULL) {
+    MeshPlaybackCacheEntry *entry_old = BLI_ghash_lookup(playback_cache.hash, &entry->key);
+    if (entry_old != NULL) {
+      playback_cache_entry_remove(entry_old);
+    }
+  }
+  playback_cache_evict(memory_size);
+  playback_cache_entry_add(entry);
+  BLI_mutex_unlock(&playback_cache_mutex);
+
+  return entry;
+}
+
+void BKE_mesh_playback_cache_release(MeshPlaybackCacheEntry *entry)
+{
+  BLI_mutex_lock(&playback_cache_mutex);
+  BLI_assert(entry->users > 0);
+  entry->users--;
+  const bool do_free = (entry->users == 0 && entry->is_removed);
+  BLI_mutex_unlock(&playback_cache_mutex);
+
+  if (do_free) {
+    playback_cache_entry_free(entry);
+  }
+}
+
+void BKE_mesh_playback_cache_invalidate_object(const Object *ob_orig)
+{
+  BLI_mutex_lock(&playback_cache_mutex);
+  if (playback_cache.objects != NULL) {
+    PlaybackCacheObject *object = BLI_ghash_lookup(playback_cache.objects, ob_orig);
+    if (object != NULL) {
+      /* The object is freed with its last entry. */
+      LinkData *link = object->entries.first;
+      while (link != NULL) {
+        LinkData *link_next = link->next;
+        playback_cache_entry_remove(link->data);
+        link = link_next;
+      }
+    }
+  }
+  BLI_mutex_unlock(&playback_cache_mutex);
+}
+
+void BKE_mesh_playback_cache_clear(void)
+{
+  BLI_mutex_lock(&playback_cache_mutex);
+  while (playback_cache.lru.first != NULL) {
+    playback_cache_entry_remove(playback_cache.lru.first);
+  }
+  if (playback_cache.hash != NULL) {
+    BLI_ghash_free(playback_cache.hash, NULL, NULL);
+    BLI_ghash_free(playback_cache.objects, NULL, NULL);
+    playback_cache.hash = NULL;
+    playback_cache.objects = NULL;
+  }
+  BLI_assert(playback_cache.memory_in_use == 0);
+  BLI_mutex_unlock(&playback_cache_mutex);
+}
+
+/* Apply a changed memory limit from the user preferences. */
+void BKE_mesh_playback_cache_limit_update(void)
+{
+  if (U.geometry_cachelimit <= 0) {
+    BKE_mesh_playback_cache_clear();
+    return;
+  }
+  BLI_mutex_lock(&playback_cache_mutex);
+  playback_cache_evict(0);
+  BLI_mutex_unlock(&playback_cache_mutex);
+}
+
+size_t BKE_mesh_playback_cache_memory_in_use(void)
+{
+  BLI_mutex_lock(&playback_cache_mutex);
+  const size_t memory_in_use = playback_cache.memory_in_use;
+  BLI_mutex_unlock(&playback_cache_mutex);
+  return memory_in_use;
+}
+
+/** \} */
@@ -32,6 +32,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_mesh_types.h"
@@ -70,8 +71,8 @@ struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
   unsigned int totfaces = BKE_mesh_runtime_looptri_len(mesh);
   unsigned int totverts = mesh->totvert;
   float *verts = (float *)MEM_malloc_arrayN(totverts * 3, sizeof(float), "remesh_input_verts");
-  unsigned int *faces = (unsigned int *)MEM_malloc_arrayN(
-      totfaces * 3, sizeof(unsigned int), "remesh_intput_faces");
+  /* #MVertTri is laid out as three vertex indices, pass it as the face array directly. */
+  const unsigned int *faces = (const unsigned int *)verttri;
 
   for (unsigned int i = 0; i < totverts; i++) {
     MVert *mvert = &mesh->mvert[i];
@@ -80,33 +81,69 @@ struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
     verts[i * 3 + 2] = mvert->co[2];
   }
 
-  for (unsigned int i = 0; i < totfaces; i++) {
-    MVertTri *vt = &verttri[i];
-    faces[i * 3] = vt->tri[0];
-    faces[i * 3 + 1] = vt->tri[1];
-    faces[i * 3 + 2] = vt->tri[2];
-  }
-
   struct OpenVDBLevelSet *level_set = OpenVDBLevelSet_create(false, NULL);
   OpenVDBLevelSet_mesh_to_level_set(level_set, verts, faces, totverts, totfaces, transform);
 
   MEM_freeN(verts);
-  MEM_freeN(faces);
   MEM_freeN(verttri);
 
   return level_set;
 }
 
+typedef struct VolumeToMeshData {
+  const struct OpenVDBVolumeToMeshData *output_mesh;
+  Mesh *mesh;
+} VolumeToMeshData;
+
+static void volume_to_mesh_verts_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  VolumeToMeshData *data = userdata;
+  copy_v3_v3(data->mesh->mvert[i].co, &data->output_mesh->vertices[i * 3]);
+}
+
+static void volume_to_mesh_polys_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  VolumeToMeshData *data = userdata;
+  const struct OpenVDBVolumeToMeshData *output_mesh = data->output_mesh;
+  MPoly *mp = &data->mesh->mpoly[i];
+
+  /* Quads come first, followed by the triangles, flip both to match Blender's winding. */
+  if (i < output_mesh->totquads) {
+    const unsigned int *quad = &output_mesh->quads[i * 4];
+    mp->loopstart = i * 4;
+    mp->totloop = 4;
+
+    MLoop *ml = &data->mesh->mloop[mp->loopstart];
+    ml[0].v = quad[3];
+    ml[1].v = quad[2];
+    ml[2].v = quad[1];
+    ml[3].v = quad[0];
+  }
+  else {
+    const int tri_index = i - output_mesh->totquads;
+    const unsigned int *tri = &output_mesh->triangles[tri_index * 3];
+    mp->loopstart = (output_mesh->totquads * 4) + (tri_index * 3);
+    mp->totloop = 3;
+
+    MLoop *ml = &data->mesh->mloop[mp->loopstart];
+    ml[0].v = tri[2];
+    ml[1].v = tri[1];
+    ml[2].v = tri[0];
+  }
+}
+
 Mesh *BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(struct OpenVDBLevelSet *level_set,
                                                        double isovalue,
                                                        double adaptivity,
                                                        bool relax_disoriented_triangles)
 {
-#  ifdef WITH_OPENVDB
   struct OpenVDBVolumeToMeshData output_mesh;
   OpenVDBLevelSet_volume_to_mesh(
       level_set, &output_mesh, isovalue, adaptivity, relax_disoriented_triangles);
-#  endif
 
   Mesh *mesh = BKE_mesh_new_nomain(output_mesh.totvertices,
                                    0,
@@ -114,30 +151,17 @@ Mesh *BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(struct OpenVDBLevelSet *l
                                    (output_mesh.totquads * 4) + (output_mesh.tottriangles * 3),
                                    output_mesh.totquads + output_mesh.tottriangles);
 
-  for (int i = 0; i < output_mesh.totvertices; i++) {
-    copy_v3_v3(mesh->mvert[i].co, &output_mesh.vertices[i * 3]);
-  }
-
-  MPoly *mp = mesh->mpoly;
-  MLoop *ml = mesh->mloop;
-  for (int i = 0; i < output_mesh.totquads; i++, mp++, ml += 4) {
-    mp->loopstart = (int)(ml - mesh->mloop);
-    mp->totloop = 4;
-
-    ml[0].v = output_mesh.quads[i * 4 + 3];
-    ml[1].v = output_mesh.quads[i * 4 + 2];
-    ml[2].v = output_mesh.quads[i * 4 + 1];
-    ml[3].v = output_mesh.quads[i * 4];
-  }
-
-  for (int i = 0; i < output_mesh.tottriangles; i++, mp++, ml += 3) {
-    mp->loopstart = (int)(ml - mesh->mloop);
-    mp->totloop = 3;
+  VolumeToMeshData data = {
+      .output_mesh = &output_mesh,
+      .mesh = mesh,
+  };
 
-    ml[0].v = output_mesh.triangles[i * 3 + 2];
-    ml[1].v = output_mesh.triangles[i * 3 + 1];
-    ml[2].v = output_mesh.triangles[i * 3];
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (mesh->totvert > 10000);
+  BLI_task_parallel_range(0, mesh->totvert, &data, volume_to_mesh_verts_cb, &settings);
+  settings.use_threading = (mesh->totpoly > 10000);
+  BLI_task_parallel_range(0, mesh->totpoly, &data, volume_to_mesh_polys_cb, &settings);
 
   BKE_mesh_calc_edges(mesh, false, false);
   BKE_mesh_calc_normals(mesh);
@@ -316,6 +340,63 @@ Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain(Mesh *mesh,
   return new_mesh;
 }
 
+/* The nearest source element lookups are read-only, so the targets are processed in parallel. */
+
+typedef struct ReprojectPaintMaskData {
+  BVHTreeFromMesh *bvhtree;
+  const MVert *target_verts;
+  float *target_mask;
+  const float *source_mask;
+} ReprojectPaintMaskData;
+
+static void reproject_paint_mask_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReprojectPaintMaskData *data = userdata;
+  BVHTreeFromMesh *bvhtree = data->bvhtree;
+  BVHTreeNearest nearest;
+  nearest.index = -1;
+  nearest.dist_sq = FLT_MAX;
+  BLI_bvhtree_find_nearest(
+      bvhtree->tree, data->target_verts[i].co, &nearest, bvhtree->nearest_callback, bvhtree);
+  if (nearest.index != -1) {
+    data->target_mask[i] = data->source_mask[nearest.index];
+  }
+}
+
+typedef struct ReprojectFaceSetsData {
+  BVHTreeFromMesh *bvhtree;
+  const MPoly *target_polys;
+  const MVert *target_verts;
+  const MLoop *target_loops;
+  int *target_face_sets;
+  const int *source_face_sets;
+  const MLoopTri *source_looptri;
+} ReprojectFaceSetsData;
+
+static void reproject_face_sets_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReprojectFaceSetsData *data = userdata;
+  BVHTreeFromMesh *bvhtree = data->bvhtree;
+  float from_co[3];
+  BVHTreeNearest nearest;
+  nearest.index = -1;
+  nearest.dist_sq = FLT_MAX;
+  const MPoly *mpoly = &data->target_polys[i];
+  BKE_mesh_calc_poly_center(
+      mpoly, &data->target_loops[mpoly->loopstart], data->target_verts, from_co);
+  BLI_bvhtree_find_nearest(bvhtree->tree, from_co, &nearest, bvhtree->nearest_callback, bvhtree);
+  if (nearest.index != -1) {
+    data->target_face_sets[i] = data->source_face_sets[data->source_looptri[nearest.index].poly];
+  }
+  else {
+    data->target_face_sets[i] = 1;
+  }
+}
+
 void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
 {
   BVHTreeFromMesh bvhtree = {
@@ -342,17 +423,18 @@ void BKE_mesh_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
         &source->vdata, CD_PAINT_MASK, CD_CALLOC, NULL, source->totvert);
   }
 
-  for (int i = 0; i < target->totvert; i++) {
-    float from_co[3];
-    BVHTreeNearest nearest;
-    nearest.index = -1;
-    nearest.dist_sq = FLT_MAX;
-    copy_v3_v3(from_co, target_verts[i].co);
-    BLI_bvhtree_find_nearest(bvhtree.tree, from_co, &nearest, bvhtree.nearest_callback, &bvhtree);
-    if (nearest.index != -1) {
-      target_mask[i] = source_mask[nearest.index];
-    }
-  }
+  ReprojectPaintMaskData data = {
+      .bvhtree = &bvhtree,
+      .target_verts = target_verts,
+      .target_mask = target_mask,
+      .source_mask = source_mask,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (target->totvert > 10000);
+  BLI_task_parallel_range(0, target->totvert, &data, reproject_paint_mask_cb, &settings);
+
   free_bvhtree_from_mesh(&bvhtree);
 }
 
@@ -387,21 +469,21 @@ void BKE_remesh_reproject_sculpt_face_sets(Mesh *target, Mesh *source)
   const MLoopTri *looptri = BKE_mesh_runtime_looptri_ensure(source);
   BKE_bvhtree_from_mesh_get(&bvhtree, source, BVHTREE_FROM_LOOPTRI, 2);
 
-  for (int i = 0; i < target->totpoly; i++) {
-    float from_co[3];
-    BVHTreeNearest nearest;
-    nearest.index = -1;
-    nearest.dist_sq = FLT_MAX;
-    const MPoly *mpoly = &target_polys[i];
-    BKE_mesh_calc_poly_center(mpoly, &target_loops[mpoly->loopstart], target_verts, from_co);
-    BLI_bvhtree_find_nearest(bvhtree.tree, from_co, &nearest, bvhtree.nearest_callback, &bvhtree);
-    if (nearest.index != -1) {
-      target_face_sets[i] = source_face_sets[looptri[nearest.index].poly];
-    }
-    else {
-      target_face_sets[i] = 1;
-    }
-  }
+  ReprojectFaceSetsData data = {
+      .bvhtree = &bvhtree,
+      .target_polys = target_polys,
+      .target_verts = target_verts,
+      .target_loops = target_loops,
+      .target_face_sets = target_face_sets,
+      .source_face_sets = source_face_sets,
+      .source_looptri = looptri,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (target->totpoly > 10000);
+  BLI_task_parallel_range(0, target->totpoly, &data, reproject_face_sets_cb, &settings);
+
   free_bvhtree_from_mesh(&bvhtree);
 }
 
@@ -29,12 +29,14 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_math_base.h"
 #include "BLI_math_geom.h"
 #include "BLI_threads.h"
 
 #include "BKE_bvhutils.h"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_shrinkwrap.h"
 #include "BKE_subdiv_ccg.h"
@@ -53,6 +55,7 @@ void BKE_mesh_runtime_reset(Mesh *mesh)
   memset(&mesh->runtime, 0, sizeof(mesh->runtime));
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
+  mesh->runtime.topology_maps_lock = BLI_rw_mutex_alloc();
 }
 
 /* Clear all pointers which we don't want to be shared on copying the datablock.
@@ -69,9 +72,12 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
   runtime->bvh_cache = NULL;
   runtime->shrinkwrap_data = NULL;
+  runtime->deform_weights = NULL;
+  runtime->topology_maps = NULL;
 
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
+  mesh->runtime.topology_maps_lock = BLI_rw_mutex_alloc();
 }
 
 void BKE_mesh_runtime_clear_cache(Mesh *mesh)
@@ -81,6 +87,10 @@ void BKE_mesh_runtime_clear_cache(Mesh *mesh)
     MEM_freeN(mesh->runtime.eval_mutex);
     mesh->runtime.eval_mutex = NULL;
   }
+  if (mesh->runtime.topology_maps_lock != NULL) {
+    BLI_rw_mutex_free(mesh->runtime.topology_maps_lock);
+    mesh->runtime.topology_maps_lock = NULL;
+  }
   if (mesh->runtime.mesh_eval != NULL) {
     mesh->runtime.mesh_eval->edit_mesh = NULL;
     BKE_id_free(NULL, mesh->runtime.mesh_eval);
@@ -178,6 +188,179 @@ const MLoopTri *BKE_mesh_runtime_looptri_ensure(Mesh *mesh)
   return looptri;
 }
 
+static void mesh_deform_weights_free(Mesh *mesh)
+{
+  MeshDeformWeights *deform_weights = mesh->runtime.deform_weights;
+  if (deform_weights != NULL) {
+    MEM_freeN(deform_weights->vert_offsets);
+    MEM_SAFE_FREE(deform_weights->dw);
+    MEM_freeN(deform_weights);
+    mesh->runtime.deform_weights = NULL;
+  }
+}
+
+static MeshDeformWeights *mesh_deform_weights_create(const Mesh *mesh)
+{
+  MeshDeformWeights *deform_weights = MEM_callocN(sizeof(*deform_weights), __func__);
+  deform_weights->verts_num = mesh->totvert;
+  deform_weights->vert_offsets = MEM_mallocN(sizeof(int) * (mesh->totvert + 1), __func__);
+
+  int dw_num = 0;
+  for (int i = 0; i < mesh->totvert; i++) {
+    deform_weights->vert_offsets[i] = dw_num;
+    dw_num += mesh->dvert[i].totweight;
+  }
+  deform_weights->vert_offsets[mesh->totvert] = dw_num;
+
+  if (dw_num != 0) {
+    MDeformWeight *dw = MEM_mallocN(sizeof(MDeformWeight) * dw_num, __func__);
+    deform_weights->dw = dw;
+
+    for (int i = 0; i < mesh->totvert; i++) {
+      const MDeformVert *dvert = &mesh->dvert[i];
+      for (int j = 0; j < dvert->totweight; j++, dw++) {
+        *dw = dvert->dw[j];
+        deform_weights->def_nr_len = max_ii(deform_weights->def_nr_len, (int)dw->def_nr + 1);
+      }
+    }
+  }
+
+  return deform_weights;
+}
+
+/**
+ * Get the vertex group weights of all vertices in flat arrays, which are faster to traverse than
+ * the per vertex allocations of #MDeformVert. The arrays are freed together with the other
+ * geometry caches, so this must only be used for meshes which are never modified in place, like
+ * the copy-on-write meshes of the dependency graph.
+ *
+ * Returns NULL when the mesh has no vertex groups.
+ */
+const MeshDeformWeights *BKE_mesh_runtime_deform_weights_ensure(Mesh *mesh)
+{
+  if (mesh->dvert == NULL) {
+    return NULL;
+  }
+
+  BLI_mutex_lock(mesh->runtime.eval_mutex);
+  if (mesh->runtime.deform_weights == NULL) {
+    mesh->runtime.deform_weights = mesh_deform_weights_create(mesh);
+  }
+  const MeshDeformWeights *deform_weights = mesh->runtime.deform_weights;
+  BLI_mutex_unlock(mesh->runtime.eval_mutex);
+
+  BLI_assert(deform_weights->verts_num == mesh->totvert);
+  return deform_weights;
+}
+
+static void mesh_topology_maps_free(Mesh *mesh)
+{
+  MeshTopologyMaps *topology_maps = mesh->runtime.topology_maps;
+  if (topology_maps != NULL) {
+    for (int i = 0; i < MESH_TOPOLOGY_MAP_NUM; i++) {
+      MEM_SAFE_FREE(topology_maps->maps[i]);
+      MEM_SAFE_FREE(topology_maps->mem[i]);
+    }
+    MEM_freeN(topology_maps);
+    mesh->runtime.topology_maps = NULL;
+  }
+}
+
+static void mesh_topology_map_create(const Mesh *mesh,
+                                     const eMeshTopologyMapType type,
+                                     MeshElemMap **r_map,
+                                     int **r_mem)
+{
+  switch (type) {
+    case MESH_TOPOLOGY_MAP_VERT_EDGE:
+      BKE_mesh_vert_edge_map_create(r_map, r_mem, mesh->medge, mesh->totvert, mesh->totedge);
+      break;
+    case MESH_TOPOLOGY_MAP_VERT_POLY:
+      BKE_mesh_vert_poly_map_create(r_map,
+                                    r_mem,
+                                    mesh->mpoly,
+                                    mesh->mloop,
+                                    mesh->totvert,
+                                    mesh->totpoly,
+                                    mesh->totloop);
+      break;
+    case MESH_TOPOLOGY_MAP_VERT_LOOP:
+      BKE_mesh_vert_loop_map_create(r_map,
+                                    r_mem,
+                                    mesh->mpoly,
+                                    mesh->mloop,
+                                    mesh->totvert,
+                                    mesh->totpoly,
+                                    mesh->totloop);
+      break;
+    case MESH_TOPOLOGY_MAP_EDGE_POLY:
+      BKE_mesh_edge_poly_map_create(r_map,
+                                    r_mem,
+                                    mesh->medge,
+                                    mesh->totedge,
+                                    mesh->mpoly,
+                                    mesh->totpoly,
+                                    mesh->mloop,
+                                    mesh->totloop);
+      break;
+  }
+}
+
+static const MeshElemMap *mesh_topology_map_ensure(Mesh *mesh, const eMeshTopologyMapType type)
+{
+  ThreadRWMutex *topology_maps_lock = mesh->runtime.topology_maps_lock;
+  const MeshElemMap *map = NULL;
+
+  BLI_rw_mutex_lock(topology_maps_lock, THREAD_LOCK_READ);
+  if (mesh->runtime.topology_maps != NULL) {
+    map = mesh->runtime.topology_maps->maps[type];
+  }
+  BLI_rw_mutex_unlock(topology_maps_lock);
+
+  if (map == NULL) {
+    BLI_rw_mutex_lock(topology_maps_lock, THREAD_LOCK_WRITE);
+    /* Another thread may have created the map in the meantime. */
+    if (mesh->runtime.topology_maps == NULL) {
+      mesh->runtime.topology_maps = MEM_callocN(sizeof(MeshTopologyMaps), __func__);
+    }
+    MeshTopologyMaps *topology_maps = mesh->runtime.topology_maps;
+    if (topology_maps->maps[type] == NULL) {
+      mesh_topology_map_create(mesh, type, &topology_maps->maps[type], &topology_maps->mem[type]);
+    }
+    map = topology_maps->maps[type];
+    BLI_rw_mutex_unlock(topology_maps_lock);
+  }
+
+  return map;
+}
+
+/**
+ * Get an adjacency map of the mesh, built on first use and shared by all callers afterwards.
+ * The maps are freed together with the other geometry caches (see
+ * #BKE_mesh_runtime_clear_geometry), which must be called whenever the topology changes.
+ * So unless that's ensured, only use these for meshes which are never modified in place,
+ * like the copy-on-write meshes of the dependency graph.
+ */
+const MeshElemMap *BKE_mesh_runtime_vert_edge_map_ensure(Mesh *mesh)
+{
+  return mesh_topology_map_ensure(mesh, MESH_TOPOLOGY_MAP_VERT_EDGE);
+}
+
+const MeshElemMap *BKE_mesh_runtime_vert_poly_map_ensure(Mesh *mesh)
+{
+  return mesh_topology_map_ensure(mesh, MESH_TOPOLOGY_MAP_VERT_POLY);
+}
+
+const MeshElemMap *BKE_mesh_runtime_vert_loop_map_ensure(Mesh *mesh)
+{
+  return mesh_topology_map_ensure(mesh, MESH_TOPOLOGY_MAP_VERT_LOOP);
+}
+
+const MeshElemMap *BKE_mesh_runtime_edge_poly_map_ensure(Mesh *mesh)
+{
+  return mesh_topology_map_ensure(mesh, MESH_TOPOLOGY_MAP_EDGE_POLY);
+}
+
 /* This is a copy of DM_verttri_from_looptri(). */
 void BKE_mesh_runtime_verttri_from_looptri(MVertTri *r_verttri,
                                            const MLoop *mloop,
@@ -235,6 +418,8 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     mesh->runtime.subdiv_ccg = NULL;
   }
   BKE_shrinkwrap_discard_boundary_data(mesh);
+  mesh_deform_weights_free(mesh);
+  mesh_topology_maps_free(mesh);
 }
 
 /** \} */
@@ -37,6 +37,7 @@
 #include "BLI_edgehash.h"
 #include "BLI_math_base.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.h"
@@ -47,6 +48,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 /* loop v/e are unsigned, so using max uint_32 value as invalid marker... */
 #define INVALID_LOOP_EDGE_MARKER 4294967295u
 
@@ -191,6 +194,495 @@ static int search_polyloop_cmp(const void *v1, const void *v2)
   /* Else, sort on loopstart. */
   return sp1->loopstart > sp2->loopstart ? 1 : sp1->loopstart < sp2->loopstart ? -1 : 0;
 }
+
+static int uint64_cmp(const void *v1, const void *v2)
+{
+  const uint64_t x1 = *(const uint64_t *)v1;
+  const uint64_t x2 = *(const uint64_t *)v2;
+
+  return x1 > x2 ? 1 : x1 < x2 ? -1 : 0;
+}
+
+/**
+ * Items (edges, polys or face corners) grouped by one of their vertices,
+ * built in parallel so that each vertex's items can then be processed independently.
+ */
+typedef struct VertBuckets {
+  /** Start of the items of each vertex in \a items, of size totvert + 1. */
+  int *offsets;
+  /** Item indices, in no particular order within each vertex. */
+  int *items;
+} VertBuckets;
+
+typedef struct VertBucketsData {
+  /** Vertex of each item, UINT_MAX for items to skip. */
+  const uint *item_verts;
+  int *counts;
+  const int *offsets;
+  int *items;
+} VertBucketsData;
+
+static void vert_buckets_count_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  VertBucketsData *data = userdata;
+  const uint v = data->item_verts[i];
+
+  if (v != UINT_MAX) {
+    atomic_add_and_fetch_int32(&data->counts[v], 1);
+  }
+}
+
+static void vert_buckets_fill_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  VertBucketsData *data = userdata;
+  const uint v = data->item_verts[i];
+
+  if (v != UINT_MAX) {
+    const int slot = atomic_fetch_and_add_int32(&data->counts[v], 1);
+    data->items[data->offsets[v] + slot] = i;
+  }
+}
+
+/**
+ * \param item_verts: Vertex of each item, all lower than \a totvert, or UINT_MAX to skip the item.
+ */
+static void vert_buckets_build(VertBuckets *buckets,
+                               const uint *item_verts,
+                               const int totitem,
+                               const uint totvert)
+{
+  int *counts = MEM_calloc_arrayN(MAX2(totvert, 1), sizeof(*counts), __func__);
+  int *offsets = MEM_malloc_arrayN(totvert + 1, sizeof(*offsets), __func__);
+
+  VertBucketsData data = {
+      .item_verts = item_verts,
+      .counts = counts,
+      .offsets = offsets,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 4096;
+
+  BLI_task_parallel_range(0, totitem, &data, vert_buckets_count_cb, &settings);
+
+  offsets[0] = 0;
+  for (uint v = 0; v < totvert; v++) {
+    offsets[v + 1] = offsets[v] + counts[v];
+    counts[v] = 0;
+  }
+
+  data.items = MEM_malloc_arrayN(max_ii(offsets[totvert], 1), sizeof(*data.items), __func__);
+  BLI_task_parallel_range(0, totitem, &data, vert_buckets_fill_cb, &settings);
+
+  MEM_freeN(counts);
+
+  buckets->offsets = offsets;
+  buckets->items = data.items;
+}
+
+static void vert_buckets_free(VertBuckets *buckets)
+{
+  MEM_SAFE_FREE(buckets->offsets);
+  MEM_SAFE_FREE(buckets->items);
+}
+
+/**
+ * Get the items of vertex \a v sorted on their key, then on their index,
+ * packed as (key << 32 | item) in \a r_sorted, which must be large enough for all of them.
+ */
+static void vert_bucket_sort(const VertBuckets *buckets,
+                             const uint v,
+                             const uint *item_keys,
+                             uint64_t *r_sorted)
+{
+  const int *items = &buckets->items[buckets->offsets[v]];
+  const int items_num = buckets->offsets[v + 1] - buckets->offsets[v];
+
+  for (int i = 0; i < items_num; i++) {
+    r_sorted[i] = ((uint64_t)item_keys[items[i]] << 32) | (uint64_t)(uint)items[i];
+  }
+  if (items_num > 1) {
+    qsort(r_sorted, (size_t)items_num, sizeof(*r_sorted), uint64_cmp);
+  }
+}
+
+#define VERT_BUCKET_SORT_KEY(_sorted) ((uint)((_sorted) >> 32))
+#define VERT_BUCKET_SORT_ITEM(_sorted) ((int)((_sorted)&0xffffffff))
+
+/** Size of the stack buffers given to #vert_bucket_sort, larger buckets are allocated. */
+#define VERT_BUCKET_STACK_SIZE 64
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Parallel Mesh Validation
+ *
+ * Most meshes given to #BKE_mesh_validate_arrays are valid. This read-only check finds out
+ * whether a mesh is free of any issue the serial validation would report, in parallel,
+ * so that the serial validation (and its sorting and hashing of all elements) only runs on
+ * meshes which actually need reporting or fixing.
+ * \{ */
+
+typedef struct MeshValidateParallelData {
+  const MVert *mverts;
+  uint totvert;
+  const MEdge *medges;
+  uint totedge;
+  const MLoop *mloops;
+  uint totloop;
+  const MPoly *mpolys;
+  uint totpoly;
+  const MDeformVert *dverts;
+
+  /** Lowest vertex of each edge, used to group edges and detect duplicates. */
+  uint *edge_vert_low;
+  /** Highest vertex of each edge. */
+  uint *edge_vert_high;
+  VertBuckets edge_buckets;
+
+  /** Lowest vertex of each poly, used to group polys and detect duplicates. */
+  uint *poly_vert_low;
+  /** Hash of the vertices of each poly, independent of their order. */
+  uint *poly_vert_hash;
+  VertBuckets poly_buckets;
+
+  /** Number of polys using each loop. */
+  int *loop_users;
+} MeshValidateParallelData;
+
+typedef struct MeshValidateParallelTLS {
+  bool is_valid;
+  /** Sum of totloop of all polys. */
+  int64_t poly_loops_num;
+} MeshValidateParallelTLS;
+
+static void mesh_validate_parallel_reduce(const void *__restrict UNUSED(userdata),
+                                          void *__restrict chunk_join,
+                                          void *__restrict chunk)
+{
+  MeshValidateParallelTLS *join = chunk_join;
+  const MeshValidateParallelTLS *tls = chunk;
+
+  join->is_valid &= tls->is_valid;
+  join->poly_loops_num += tls->poly_loops_num;
+}
+
+static void mesh_validate_parallel_verts_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict tls)
+{
+  const MeshValidateParallelData *data = userdata;
+  MeshValidateParallelTLS *tls_data = tls->userdata_chunk;
+  const MVert *mv = &data->mverts[i];
+
+  if (!(isfinite(mv->co[0]) && isfinite(mv->co[1]) && isfinite(mv->co[2]))) {
+    tls_data->is_valid = false;
+  }
+  if (mv->no[0] == 0 && mv->no[1] == 0 && mv->no[2] == 0) {
+    tls_data->is_valid = false;
+  }
+
+  if (data->dverts) {
+    const MDeformVert *dv = &data->dverts[i];
+    const MDeformWeight *dw = dv->dw;
+    for (int j = 0; j < dv->totweight; j++, dw++) {
+      if (!isfinite(dw->weight) || dw->weight < 0.0f || dw->weight > 1.0f ||
+          dw->def_nr >= INT_MAX) {
+        tls_data->is_valid = false;
+      }
+    }
+  }
+}
+
+static void mesh_validate_parallel_edges_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict tls)
+{
+  MeshValidateParallelData *data = userdata;
+  MeshValidateParallelTLS *tls_data = tls->userdata_chunk;
+  const MEdge *me = &data->medges[i];
+
+  if (me->v1 == me->v2 || me->v1 >= data->totvert || me->v2 >= data->totvert) {
+    tls_data->is_valid = false;
+    data->edge_vert_low[i] = UINT_MAX;
+    return;
+  }
+  data->edge_vert_low[i] = MIN2(me->v1, me->v2);
+  data->edge_vert_high[i] = MAX2(me->v1, me->v2);
+}
+
+static void mesh_validate_parallel_edges_duplicate_cb(void *__restrict userdata,
+                                                      const int v,
+                                                      const TaskParallelTLS *__restrict tls)
+{
+  const MeshValidateParallelData *data = userdata;
+  MeshValidateParallelTLS *tls_data = tls->userdata_chunk;
+  const VertBuckets *buckets = &data->edge_buckets;
+  const int items_num = buckets->offsets[v + 1] - buckets->offsets[v];
+
+  if (items_num < 2) {
+    return;
+  }
+
+  uint64_t sorted_stack[VERT_BUCKET_STACK_SIZE];
+  uint64_t *sorted = (items_num <= VERT_BUCKET_STACK_SIZE) ?
+                         sorted_stack :
+                         MEM_malloc_arrayN((size_t)items_num, sizeof(*sorted), __func__);
+
+  vert_bucket_sort(buckets, (uint)v, data->edge_vert_high, sorted);
+  for (int i = 1; i < items_num; i++) {
+    if (VERT_BUCKET_SORT_KEY(sorted[i]) == VERT_BUCKET_SORT_KEY(sorted[i - 1])) {
+      tls_data->is_valid = false;
+      break;
+    }
+  }
+
+  if (sorted != sorted_stack) {
+    MEM_freeN(sorted);
+  }
+}
+
+static void mesh_validate_parallel_polys_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict tls)
+{
+  MeshValidateParallelData *data = userdata;
+  MeshValidateParallelTLS *tls_data = tls->userdata_chunk;
+  const MPoly *mp = &data->mpolys[i];
+
+  data->poly_vert_low[i] = UINT_MAX;
+
+  if (mp->loopstart < 0 || mp->totloop < 3 ||
+      (int64_t)mp->loopstart + mp->totloop > (int64_t)data->totloop) {
+    tls_data->is_valid = false;
+    return;
+  }
+  tls_data->poly_loops_num += mp->totloop;
+
+  const MLoop *mloops = &data->mloops[mp->loopstart];
+  uint vert_low = UINT_MAX;
+  uint vert_hash = (uint)mp->totloop;
+
+  for (int j = 0; j < mp->totloop; j++) {
+    const MLoop *ml = &mloops[j];
+    const uint v1 = ml->v;
+    const uint v2 = mloops[(j + 1) % mp->totloop].v;
+
+    if (atomic_add_and_fetch_int32(&data->loop_users[mp->loopstart + j], 1) != 1) {
+      /* Loop used by more than one poly. */
+      tls_data->is_valid = false;
+    }
+    if (v1 >= data->totvert) {
+      tls_data->is_valid = false;
+      continue;
+    }
+    /* Duplicated vertex in this poly. */
+    for (int k = 0; k < j; k++) {
+      if (mloops[k].v == v1) {
+        tls_data->is_valid = false;
+        break;
+      }
+    }
+    /* The loop's edge must exist and use the same vertices, which also means the edge needed
+     * by this corner exists. */
+    if (ml->e >= data->totedge) {
+      tls_data->is_valid = false;
+    }
+    else {
+      const MEdge *me = &data->medges[ml->e];
+      if (!((me->v1 == v1 && me->v2 == v2) || (me->v1 == v2 && me->v2 == v1))) {
+        tls_data->is_valid = false;
+      }
+    }
+
+    vert_low = MIN2(vert_low, v1);
+    vert_hash += v1 * 2654435761u;
+  }
+
+  data->poly_vert_low[i] = vert_low;
+  data->poly_vert_hash[i] = vert_hash;
+}
+
+/** Whether both polys use the same vertices, knowing none of them uses a vertex twice. */
+static bool mesh_validate_polys_same_verts(const MLoop *mloops,
+                                           const MPoly *mp_a,
+                                           const MPoly *mp_b)
+{
+  if (mp_a->totloop != mp_b->totloop) {
+    return false;
+  }
+  for (int j = 0; j < mp_a->totloop; j++) {
+    const uint v = mloops[mp_a->loopstart + j].v;
+    int k;
+    for (k = 0; k < mp_b->totloop; k++) {
+      if (mloops[mp_b->loopstart + k].v == v) {
+        break;
+      }
+    }
+    if (k == mp_b->totloop) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void mesh_validate_parallel_polys_duplicate_cb(void *__restrict userdata,
+                                                      const int v,
+                                                      const TaskParallelTLS *__restrict tls)
+{
+  const MeshValidateParallelData *data = userdata;
+  MeshValidateParallelTLS *tls_data = tls->userdata_chunk;
+  const VertBuckets *buckets = &data->poly_buckets;
+  const int items_num = buckets->offsets[v + 1] - buckets->offsets[v];
+
+  if (items_num < 2) {
+    return;
+  }
+
+  uint64_t sorted_stack[VERT_BUCKET_STACK_SIZE];
+  uint64_t *sorted = (items_num <= VERT_BUCKET_STACK_SIZE) ?
+                         sorted_stack :
+                         MEM_malloc_arrayN((size_t)items_num, sizeof(*sorted), __func__);
+
+  /* Only polys with the same lowest vertex and the same hash may use the same vertices. */
+  vert_bucket_sort(buckets, (uint)v, data->poly_vert_hash, sorted);
+  for (int i = 0; i < items_num && tls_data->is_valid; i++) {
+    for (int k = i + 1; k < items_num; k++) {
+      if (VERT_BUCKET_SORT_KEY(sorted[k]) != VERT_BUCKET_SORT_KEY(sorted[i])) {
+        break;
+      }
+      if (mesh_validate_polys_same_verts(data->mloops,
+                                         &data->mpolys[VERT_BUCKET_SORT_ITEM(sorted[i])],
+                                         &data->mpolys[VERT_BUCKET_SORT_ITEM(sorted[k])])) {
+        tls_data->is_valid = false;
+        break;
+      }
+    }
+  }
+
+  if (sorted != sorted_stack) {
+    MEM_freeN(sorted);
+  }
+}
+
+/**
+ * \return true when #BKE_mesh_validate_arrays would neither report nor fix anything.
+ * Meshes using legacy faces only are not handled, false is returned for them.
+ */
+static bool mesh_validate_arrays_parallel(Mesh *mesh,
+                                          const MVert *mverts,
+                                          const uint totvert,
+                                          const MEdge *medges,
+                                          const uint totedge,
+                                          const MFace *mfaces,
+                                          const MLoop *mloops,
+                                          const uint totloop,
+                                          const MPoly *mpolys,
+                                          const uint totpoly,
+                                          const MDeformVert *dverts)
+{
+  if ((totedge == 0 && totpoly != 0) || (mfaces && !mpolys)) {
+    return false;
+  }
+  if (totvert > INT_MAX || totedge > INT_MAX || totloop > INT_MAX || totpoly > INT_MAX) {
+    return false;
+  }
+
+  MeshValidateParallelData data = {
+      .mverts = mverts,
+      .totvert = totvert,
+      .medges = medges,
+      .totedge = totedge,
+      .mloops = mloops,
+      .totloop = totloop,
+      .mpolys = mpolys,
+      .totpoly = totpoly,
+      .dverts = dverts,
+  };
+  MeshValidateParallelTLS tls_data = {
+      .is_valid = true,
+      .poly_loops_num = 0,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_reduce = mesh_validate_parallel_reduce;
+
+  BLI_task_parallel_range(0, (int)totvert, &data, mesh_validate_parallel_verts_cb, &settings);
+  if (!tls_data.is_valid) {
+    return false;
+  }
+
+  /* Edges. */
+  data.edge_vert_low = MEM_malloc_arrayN(totedge, sizeof(*data.edge_vert_low), __func__);
+  data.edge_vert_high = MEM_malloc_arrayN(totedge, sizeof(*data.edge_vert_high), __func__);
+  BLI_task_parallel_range(0, (int)totedge, &data, mesh_validate_parallel_edges_cb, &settings);
+  if (tls_data.is_valid) {
+    vert_buckets_build(&data.edge_buckets, data.edge_vert_low, (int)totedge, totvert);
+    BLI_task_parallel_range(
+        0, (int)totvert, &data, mesh_validate_parallel_edges_duplicate_cb, &settings);
+    vert_buckets_free(&data.edge_buckets);
+  }
+  MEM_freeN(data.edge_vert_low);
+  MEM_freeN(data.edge_vert_high);
+  if (!tls_data.is_valid) {
+    return false;
+  }
+
+  /* Polys and loops. */
+  data.poly_vert_low = MEM_malloc_arrayN(totpoly, sizeof(*data.poly_vert_low), __func__);
+  data.poly_vert_hash = MEM_malloc_arrayN(totpoly, sizeof(*data.poly_vert_hash), __func__);
+  data.loop_users = MEM_calloc_arrayN(totloop, sizeof(*data.loop_users), __func__);
+  BLI_task_parallel_range(0, (int)totpoly, &data, mesh_validate_parallel_polys_cb, &settings);
+  /* No loop is used twice, so all of them are used if the polys' sizes add up to totloop. */
+  if (tls_data.is_valid && tls_data.poly_loops_num == (int64_t)totloop) {
+    vert_buckets_build(&data.poly_buckets, data.poly_vert_low, (int)totpoly, totvert);
+    BLI_task_parallel_range(
+        0, (int)totvert, &data, mesh_validate_parallel_polys_duplicate_cb, &settings);
+    vert_buckets_free(&data.poly_buckets);
+  }
+  else {
+    tls_data.is_valid = false;
+  }
+  MEM_freeN(data.poly_vert_low);
+  MEM_freeN(data.poly_vert_hash);
+  MEM_freeN(data.loop_users);
+  if (!tls_data.is_valid) {
+    return false;
+  }
+
+  /* Selection history, cheap enough to stay serial. */
+  if (mesh && mesh->mselect) {
+    for (int i = 0; i < mesh->totselect; i++) {
+      const MSelect *msel = &mesh->mselect[i];
+      int tot_elem = 0;
+      switch (msel->type) {
+        case ME_VSEL:
+          tot_elem = mesh->totvert;
+          break;
+        case ME_ESEL:
+          tot_elem = mesh->totedge;
+          break;
+        case ME_FSEL:
+          tot_elem = mesh->totpoly;
+          break;
+      }
+      if (msel->index < 0 || msel->index > tot_elem) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -287,7 +779,7 @@ bool BKE_mesh_validate_arrays(Mesh *mesh,
     int as_flag;
   } recalc_flag;
 
-  EdgeHash *edge_hash = BLI_edgehash_new_ex(__func__, totedge);
+  EdgeHash *edge_hash;
 
   BLI_assert(!(do_fixes && mesh == NULL));
 
@@ -297,6 +789,25 @@ bool BKE_mesh_validate_arrays(Mesh *mesh,
 
   PRINT_MSG("verts(%u), edges(%u), loops(%u), polygons(%u)", totvert, totedge, totloop, totpoly);
 
+  if (mesh_validate_arrays_parallel(mesh,
+                                    mverts,
+                                    totvert,
+                                    medges,
+                                    totedge,
+                                    mfaces,
+                                    mloops,
+                                    totloop,
+                                    mpolys,
+                                    totpoly,
+                                    dverts)) {
+    /* Nothing to report nor to fix. */
+    PRINT_MSG("%s: finished\n\n", __func__);
+    *r_changed = false;
+    return is_valid;
+  }
+
+  edge_hash = BLI_edgehash_new_ex(__func__, totedge);
+
   if (totedge == 0 && totpoly != 0) {
     PRINT_ERR("\tLogical error, %u polygons and 0 edges", totpoly);
     recalc_flag.edges = do_fixes;
@@ -1513,6 +2024,217 @@ void BKE_mesh_calc_edges_legacy(Mesh *me, const bool use_old)
   BKE_mesh_strip_loose_faces(me);
 }
 
+typedef struct MeshCalcEdgesData {
+  const MPoly *mpoly;
+  MLoop *mloop;
+  MEdge *medge;
+  uint totvert;
+  short ed_flag;
+
+  /** Index of the first corner of each poly, counting corners in poly order. */
+  const int *poly_corner_start;
+  /** Sorted vertices of the edge ending at each corner, low is UINT_MAX for degenerate edges. */
+  uint *corner_vert_low;
+  uint *corner_vert_high;
+  /** First corner using the same edge as each corner, -1 for degenerate edges. */
+  int *corner_first;
+  /** Index of the edge created by each first corner. */
+  int *corner_edge;
+  VertBuckets buckets;
+} MeshCalcEdgesData;
+
+static void mesh_calc_edges_corners_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict tls)
+{
+  MeshCalcEdgesData *data = userdata;
+  bool *is_valid = tls->userdata_chunk;
+  const MPoly *mp = &data->mpoly[i];
+  const MLoop *l = &data->mloop[mp->loopstart];
+  int corner = data->poly_corner_start[i];
+
+  for (int j = 0; j < mp->totloop; j++, corner++) {
+    const uint v_prev = l[(j + mp->totloop - 1) % mp->totloop].v;
+    const uint v = l[j].v;
+    if (v_prev == v) {
+      data->corner_vert_low[corner] = UINT_MAX;
+      data->corner_first[corner] = -1;
+    }
+    else {
+      data->corner_vert_low[corner] = MIN2(v_prev, v);
+      data->corner_vert_high[corner] = MAX2(v_prev, v);
+      if (data->corner_vert_high[corner] >= data->totvert) {
+        *is_valid = false;
+      }
+    }
+  }
+}
+
+static void mesh_calc_edges_valid_reduce(const void *__restrict UNUSED(userdata),
+                                         void *__restrict chunk_join,
+                                         void *__restrict chunk)
+{
+  bool *join = chunk_join;
+  const bool *is_valid = chunk;
+
+  *join &= *is_valid;
+}
+
+static void mesh_calc_edges_first_cb(void *__restrict userdata,
+                                     const int v,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshCalcEdgesData *data = userdata;
+  const VertBuckets *buckets = &data->buckets;
+  const int items_num = buckets->offsets[v + 1] - buckets->offsets[v];
+
+  if (items_num == 0) {
+    return;
+  }
+
+  uint64_t sorted_stack[VERT_BUCKET_STACK_SIZE];
+  uint64_t *sorted = (items_num <= VERT_BUCKET_STACK_SIZE) ?
+                         sorted_stack :
+                         MEM_malloc_arrayN((size_t)items_num, sizeof(*sorted), __func__);
+
+  /* Corners using the same edge end up next to each other, the first of them first. */
+  vert_bucket_sort(buckets, (uint)v, data->corner_vert_high, sorted);
+  int corner_first = VERT_BUCKET_SORT_ITEM(sorted[0]);
+  for (int i = 0; i < items_num; i++) {
+    const int corner = VERT_BUCKET_SORT_ITEM(sorted[i]);
+    if (i != 0 && VERT_BUCKET_SORT_KEY(sorted[i]) != VERT_BUCKET_SORT_KEY(sorted[i - 1])) {
+      corner_first = corner;
+    }
+    data->corner_first[corner] = corner_first;
+  }
+
+  if (sorted != sorted_stack) {
+    MEM_freeN(sorted);
+  }
+}
+
+static void mesh_calc_edges_assign_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshCalcEdgesData *data = userdata;
+  const MPoly *mp = &data->mpoly[i];
+  MLoop *l = &data->mloop[mp->loopstart];
+  int corner = data->poly_corner_start[i];
+
+  for (int j = 0; j < mp->totloop; j++, corner++) {
+    MLoop *l_prev = &l[(j + mp->totloop - 1) % mp->totloop];
+    const int corner_first = data->corner_first[corner];
+
+    if (corner_first == -1) {
+      /* Same as looking up a degenerate edge, which is never hashed. */
+      l_prev->e = 0;
+      continue;
+    }
+
+    const int med_index = data->corner_edge[corner_first];
+    l_prev->e = (uint)med_index;
+    if (corner_first == corner) {
+      MEdge *med = &data->medge[med_index];
+      med->v1 = data->corner_vert_low[corner];
+      med->v2 = data->corner_vert_high[corner];
+      med->flag = data->ed_flag;
+    }
+  }
+}
+
+/**
+ * Parallel version of #BKE_mesh_calc_edges when not updating existing edges.
+ *
+ * Corners are grouped by the lowest vertex of their edge to find the first corner using each
+ * edge, edges are then numbered in the order of their first corner. This gives the same edges
+ * in the same order as inserting them in an #EdgeHash.
+ *
+ * \return false when some loops use out of range vertices, in which case nothing is done.
+ */
+static bool mesh_calc_edges_parallel(Mesh *mesh, const short ed_flag)
+{
+  const int totpoly = mesh->totpoly;
+  int *poly_corner_start = MEM_malloc_arrayN(
+      (size_t)max_ii(totpoly, 1), sizeof(*poly_corner_start), __func__);
+  int totcorner = 0;
+
+  for (int i = 0; i < totpoly; i++) {
+    poly_corner_start[i] = totcorner;
+    totcorner += max_ii(mesh->mpoly[i].totloop, 0);
+  }
+
+  MeshCalcEdgesData data = {
+      .mpoly = mesh->mpoly,
+      .mloop = mesh->mloop,
+      .totvert = (uint)mesh->totvert,
+      .ed_flag = ed_flag,
+      .poly_corner_start = poly_corner_start,
+  };
+  const size_t corners_len = (size_t)max_ii(totcorner, 1);
+  data.corner_vert_low = MEM_malloc_arrayN(corners_len, sizeof(*data.corner_vert_low), __func__);
+  data.corner_vert_high = MEM_malloc_arrayN(corners_len, sizeof(*data.corner_vert_high), __func__);
+  data.corner_first = MEM_malloc_arrayN(corners_len, sizeof(*data.corner_first), __func__);
+
+  bool is_valid = true;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = &is_valid;
+  settings.userdata_chunk_size = sizeof(is_valid);
+  settings.func_reduce = mesh_calc_edges_valid_reduce;
+
+  BLI_task_parallel_range(0, totpoly, &data, mesh_calc_edges_corners_cb, &settings);
+
+  if (!is_valid) {
+    MEM_freeN(data.corner_vert_low);
+    MEM_freeN(data.corner_vert_high);
+    MEM_freeN(data.corner_first);
+    MEM_freeN(poly_corner_start);
+    return false;
+  }
+
+  settings.userdata_chunk = NULL;
+  settings.userdata_chunk_size = 0;
+  settings.func_reduce = NULL;
+
+  vert_buckets_build(&data.buckets, data.corner_vert_low, totcorner, data.totvert);
+  BLI_task_parallel_range(0, mesh->totvert, &data, mesh_calc_edges_first_cb, &settings);
+  vert_buckets_free(&data.buckets);
+
+  /* Number edges in the order of their first corner. */
+  data.corner_edge = MEM_malloc_arrayN(corners_len, sizeof(*data.corner_edge), __func__);
+  int totedge = 0;
+  for (int corner = 0; corner < totcorner; corner++) {
+    if (data.corner_first[corner] == corner) {
+      data.corner_edge[corner] = totedge++;
+    }
+  }
+
+  /* Write new edges into a temporary CustomData. */
+  CustomData edata;
+  CustomData_reset(&edata);
+  data.medge = CustomData_add_layer(&edata, CD_MEDGE, CD_CALLOC, NULL, totedge);
+
+  BLI_task_parallel_range(0, totpoly, &data, mesh_calc_edges_assign_cb, &settings);
+
+  MEM_freeN(data.corner_vert_low);
+  MEM_freeN(data.corner_vert_high);
+  MEM_freeN(data.corner_first);
+  MEM_freeN(data.corner_edge);
+  MEM_freeN(poly_corner_start);
+
+  /* Free old CustomData and assign new one. */
+  CustomData_free(&mesh->edata, mesh->totedge);
+  mesh->edata = edata;
+  mesh->totedge = totedge;
+
+  mesh->medge = CustomData_get_layer(&mesh->edata, CD_MEDGE);
+
+  return true;
+}
+
 /**
  * Calculate edges from polygons
  *
@@ -1536,6 +2258,10 @@ void BKE_mesh_calc_edges(Mesh *mesh, bool update, const bool select)
     update = false;
   }
 
+  if (!update && mesh_calc_edges_parallel(mesh, ed_flag)) {
+    return;
+  }
+
   eh_reserve = max_ii(update ? mesh->totedge : 0, BLI_EDGEHASH_SIZE_GUESS_FROM_POLYS(totpoly));
   eh = BLI_edgehash_new_ex(__func__, eh_reserve);
 
@@ -68,6 +68,8 @@
 
 #include "MOD_modifiertypes.h"
 
+#include "atomic_ops.h"
+
 #include "CLG_log.h"
 
 static CLG_LogRef LOG = {"bke.modifier"};
@@ -137,9 +139,25 @@ ModifierData *BKE_modifier_new(int type)
     mti->initData(md);
   }
 
+  BKE_modifier_settings_tag_changed(md);
+
   return md;
 }
 
+static uint global_settings_update_id = 0;
+
+/**
+ * Tag settings of an original modifier as changed, which invalidates the intermediate results
+ * stored after it by the modifier stack cache.
+ *
+ * \note The value is never reused during a session, so undo restoring older settings is not
+ * mistaken for the settings the cache stored results for.
+ */
+void BKE_modifier_settings_tag_changed(ModifierData *md)
+{
+  md->settings_update_id = atomic_add_and_fetch_uint32(&global_settings_update_id, 1);
+}
+
 static void modifier_free_data_id_us_cb(void *UNUSED(userData),
                                         Object *UNUSED(ob),
                                         ID **idpoin,
@@ -0,0 +1,495 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ *
+ * Modifier Stack Cache Design Notes
+ * =================================
+ *
+ * The cache lives in the runtime of the evaluated object, which is preserved by the dependency
+ * graph when the object is copied-on-write again after a user edit. Every position of the stack
+ * has an entry, identified by the original modifier pointer and type.
+ *
+ * Before evaluation, each modifier is compared against its entry. Settings are compared by the
+ * update identifier of the original modifier, which is renewed by every RNA update of the
+ * modifier (see #BKE_modifier_settings_tag_changed), together with the mode and enabled state.
+ * The first modifier which changed, or which can not be trusted to produce the same result
+ * (animated, depending on another changed data-block, or having side effects like simulations),
+ * invalidates all entries from that position on. Evaluation then resumes from the last result
+ * stored before it.
+ *
+ * Everything else which changes the result invalidates the whole cache: the scene simplify
+ * settings, and update tags of the object, its mesh or shape keys which are not explained by a
+ * change of the stack itself. The latter covers mesh edits, vertex group edits and operators
+ * changing modifier data directly, like binding. Since modifier edits tag the mesh as well, a
+ * mesh edit in the same update as a modifier edit is not detected.
+ *
+ * Results are only stored after constructive modifiers, where the stack state is a single mesh
+ * and not pending deformed coordinates. To keep playback fast, results are only stored when the
+ * stack is evaluated again for the same frame, which is what happens when tweaking settings.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_key_types.h"
+#include "DNA_layer_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+static size_t modifier_stack_cache_limit(void)
+{
+  return ((size_t)U.modifier_cachelimit) * 1024 * 1024;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Change Detection
+ * \{ */
+
+static bool modifier_is_animated(Object *ob, ModifierData *md)
+{
+  AnimData *adt = ob->adt;
+  if (adt == NULL) {
+    return false;
+  }
+
+  ListBase *fcurve_lists[2] = {(adt->action != NULL) ? &adt->action->curves : NULL,
+                               &adt->drivers};
+  for (int i = 0; i < ARRAY_SIZE(fcurve_lists); i++) {
+    if (fcurve_lists[i] == NULL) {
+      continue;
+    }
+    LISTBASE_FOREACH (FCurve *, fcu, fcurve_lists[i]) {
+      if (fcu->rna_path == NULL) {
+        continue;
+      }
+      char *name = BLI_str_quoted_substrN(fcu->rna_path, "modifiers[");
+      if (name == NULL) {
+        continue;
+      }
+      const bool is_match = STREQ(name, md->name);
+      MEM_freeN(name);
+      if (is_match) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+typedef struct ModifierIDChangedData {
+  bool has_id;
+  bool is_changed;
+} ModifierIDChangedData;
+
+static void modifier_id_changed_walk(void *user_data,
+                                     Object *UNUSED(ob),
+                                     ID **idpoin,
+                                     int UNUSED(cb_flag))
+{
+  ModifierIDChangedData *data = user_data;
+  if (*idpoin == NULL) {
+    return;
+  }
+  data->has_id = true;
+  /* Recalc flags of the evaluated data-blocks are accumulated during the flush of updates,
+   * and cleared only once the whole graph is evaluated. */
+  if ((*idpoin)->recalc & ID_RECALC_ALL) {
+    data->is_changed = true;
+  }
+}
+
+/* Whether the modifier result may differ even when its settings did not change. */
+static bool modifier_is_volatile(Object *ob, ModifierData *md)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+
+  /* Simulations and modifiers storing data for other modifiers or physics must run. */
+  if ((mti->flags & eModifierTypeFlag_UsesPointCache) ||
+      ELEM(md->type,
+           eModifierType_ParticleSystem,
+           eModifierType_Collision,
+           eModifierType_Surface,
+           eModifierType_DynamicPaint,
+           eModifierType_Fluid)) {
+    return true;
+  }
+
+  /* Animated values are written to the evaluated modifier, they don't renew the update
+   * identifier. */
+  if (modifier_is_animated(ob, md)) {
+    return true;
+  }
+
+  ModifierIDChangedData data = {false, false};
+  if (mti->foreachIDLink) {
+    mti->foreachIDLink(md, ob, modifier_id_changed_walk, &data);
+  }
+  else if (mti->foreachObjectLink) {
+    mti->foreachObjectLink(md, ob, (ObjectWalkFunc)modifier_id_changed_walk, &data);
+  }
+  /* Modifiers using other data-blocks usually depend on the relative transform as well. */
+  if (data.has_id && (ob->id.recalc & ID_RECALC_TRANSFORM)) {
+    return true;
+  }
+  return data.is_changed;
+}
+
+static void modifier_stack_cache_entry_init(ModifierStackCacheEntry *entry,
+                                            Scene *scene,
+                                            Object *ob,
+                                            ModifierData *md,
+                                            const int required_mode)
+{
+  /* Virtual modifiers have no original, they are created from scratch for every evaluation. */
+  const ModifierData *md_settings = (md->orig_modifier_data != NULL) ? md->orig_modifier_data :
+                                                                       md;
+  entry->md_orig = md->orig_modifier_data;
+  entry->type = md->type;
+  entry->settings_update_id = md_settings->settings_update_id;
+  entry->mode = md->mode;
+  entry->is_enabled = BKE_modifier_is_enabled(scene, md, required_mode);
+  entry->is_volatile = modifier_is_volatile(ob, md);
+}
+
+static bool modifier_stack_cache_entry_is_matching(const ModifierStackCacheEntry *entry_a,
+                                                   const ModifierStackCacheEntry *entry_b)
+{
+  return entry_a->md_orig == entry_b->md_orig && entry_a->type == entry_b->type &&
+         entry_a->settings_update_id == entry_b->settings_update_id &&
+         entry_a->mode == entry_b->mode && entry_a->is_enabled == entry_b->is_enabled;
+}
+
+/* Whether the settings of any modifier differ from the cached stack. */
+static bool modifier_stack_cache_settings_changed(const ModifierStackCache *cache,
+                                                  const ModifierStackCacheEntry *entries,
+                                                  const int entries_num)
+{
+  if (entries_num != cache->entries_num) {
+    return true;
+  }
+  for (int i = 0; i < entries_num; i++) {
+    if (!modifier_stack_cache_entry_is_matching(&entries[i], &cache->entries[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool modifier_stack_cache_has_volatile(const ModifierStackCacheEntry *entries,
+                                              const int entries_num)
+{
+  for (int i = 0; i < entries_num; i++) {
+    if (entries[i].is_volatile) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool modifier_stack_cache_input_changed(const ModifierStackCache *cache,
+                                               Scene *scene,
+                                               Object *ob,
+                                               const ModifierStackCacheEntry *entries,
+                                               const int entries_num)
+{
+  if (cache->simplify_mode != (scene->r.mode & R_SIMPLIFY) ||
+      cache->simplify_subsurf != scene->r.simplify_subsurf) {
+    return true;
+  }
+
+  /* Modifier edits tag the object for a geometry update, which the dependency graph passes on
+   * to the mesh and its shape keys. Such tags are explained by the changed settings, which are
+   * handled per entry. Any other reason for the tags is unknown to the cache. */
+  const bool settings_changed = modifier_stack_cache_settings_changed(
+      cache, entries, entries_num);
+  Mesh *mesh = ob->data;
+  if (((mesh->id.recalc & ID_RECALC_ALL) ||
+       (mesh->key != NULL && (mesh->key->id.recalc & ID_RECALC_ALL))) &&
+      !settings_changed) {
+    return true;
+  }
+  /* Changes of other data-blocks are flushed to the object as geometry updates as well. */
+  if ((ob->id.recalc & ID_RECALC_GEOMETRY) && !settings_changed &&
+      !modifier_stack_cache_has_volatile(entries, entries_num)) {
+    return true;
+  }
+  return false;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Entries
+ * \{ */
+
+static void modifier_stack_cache_entry_clear_result(ModifierStackCache *cache,
+                                                    ModifierStackCacheEntry *entry)
+{
+  if (entry->mesh != NULL) {
+    BKE_id_free(NULL, entry->mesh);
+    entry->mesh = NULL;
+  }
+  if (entry->mesh_orco != NULL) {
+    BKE_id_free(NULL, entry->mesh_orco);
+    entry->mesh_orco = NULL;
+  }
+  if (entry->mesh_orco_cloth != NULL) {
+    BKE_id_free(NULL, entry->mesh_orco_cloth);
+    entry->mesh_orco_cloth = NULL;
+  }
+  BLI_assert(cache->memory_size >= entry->memory_size);
+  cache->memory_size -= entry->memory_size;
+  entry->memory_size = 0;
+}
+
+static void modifier_stack_cache_entry_free(ModifierStackCache *cache,
+                                            ModifierStackCacheEntry *entry)
+{
+  modifier_stack_cache_entry_clear_result(cache, entry);
+  MEM_SAFE_FREE(entry->error);
+}
+
+static void modifier_stack_cache_clear(ModifierStackCache *cache)
+{
+  for (int i = 0; i < cache->entries_num; i++) {
+    modifier_stack_cache_entry_free(cache, &cache->entries[i]);
+  }
+  MEM_SAFE_FREE(cache->entries);
+  cache->entries_num = 0;
+  if (cache->mesh_deform != NULL) {
+    BKE_id_free(NULL, cache->mesh_deform);
+    cache->mesh_deform = NULL;
+  }
+  BLI_assert(cache->memory_size == 0);
+}
+
+static Mesh *mesh_copy_for_cache(Mesh *mesh)
+{
+  if (mesh == NULL) {
+    return NULL;
+  }
+  Mesh *mesh_copy = BKE_mesh_copy_for_eval(mesh, false);
+  mesh_copy->edit_mesh = NULL;
+  return mesh_copy;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+static bool modifier_stack_cache_is_enabled(Depsgraph *depsgraph, Object *ob)
+{
+  if (U.modifier_cachelimit <= 0) {
+    return false;
+  }
+  if (!DEG_is_active(depsgraph) || DEG_get_mode(depsgraph) != DAG_EVAL_VIEWPORT) {
+    return false;
+  }
+  /* Sculpt mode has its own rules about which modifiers are evaluated. */
+  if (ob->mode != OB_MODE_OBJECT) {
+    return false;
+  }
+  /* Only the active object is tweaked interactively, don't keep memory for all others. */
+  ViewLayer *view_layer = DEG_get_evaluated_view_layer(depsgraph);
+  Object *ob_active = (view_layer->basact != NULL) ?
+                          DEG_get_original_object(view_layer->basact->object) :
+                          NULL;
+  return DEG_get_original_object(ob) == ob_active;
+}
+
+/**
+ * Compare the stack against the cached entries, and find the stack position after which the
+ * evaluation can resume using the stored result. \a r_resume_index is -1 when evaluation has to
+ * start from the base mesh.
+ *
+ * Returns NULL when caching is not used for this evaluation.
+ */
+ModifierStackCache *BKE_modifier_stack_cache_begin(Depsgraph *depsgraph,
+                                                   Scene *scene,
+                                                   Object *ob,
+                                                   ModifierData *firstmd,
+                                                   const int required_mode,
+                                                   const CustomData_MeshMasks *mask,
+                                                   const bool need_mapping,
+                                                   int *r_resume_index)
+{
+  *r_resume_index = -1;
+
+  ModifierStackCache *cache = ob->runtime.modifier_stack_cache;
+  if (!modifier_stack_cache_is_enabled(depsgraph, ob)) {
+    if (cache != NULL) {
+      BKE_modifier_stack_cache_free(cache);
+      ob->runtime.modifier_stack_cache = NULL;
+    }
+    return NULL;
+  }
+
+  if (cache == NULL) {
+    cache = MEM_callocN(sizeof(*cache), __func__);
+    ob->runtime.modifier_stack_cache = cache;
+  }
+
+  /* Build entries for the current stack, keeping results of the unchanged leading part. */
+  int entries_num = 0;
+  for (ModifierData *md = firstmd; md; md = md->next) {
+    entries_num++;
+  }
+  ModifierStackCacheEntry *entries = MEM_calloc_arrayN(entries_num, sizeof(*entries), __func__);
+  int i = 0;
+  for (ModifierData *md = firstmd; md; md = md->next, i++) {
+    modifier_stack_cache_entry_init(&entries[i], scene, ob, md, required_mode);
+  }
+
+  const float ctime = DEG_get_ctime(depsgraph);
+  const bool is_same_evaluation = cache->entries != NULL && cache->ctime == ctime &&
+                                  cache->required_mode == required_mode &&
+                                  cache->need_mapping == need_mapping &&
+                                  CustomData_MeshMasks_are_matching(&cache->mask, mask) &&
+                                  CustomData_MeshMasks_are_matching(mask, &cache->mask) &&
+                                  !modifier_stack_cache_input_changed(
+                                      cache, scene, ob, entries, entries_num);
+
+  bool is_valid = is_same_evaluation;
+  for (i = 0; i < entries_num && i < cache->entries_num && is_valid; i++) {
+    ModifierStackCacheEntry *entry = &entries[i];
+    ModifierStackCacheEntry *entry_old = &cache->entries[i];
+    is_valid = !entry->is_volatile && !entry_old->is_volatile &&
+               modifier_stack_cache_entry_is_matching(entry, entry_old);
+    if (is_valid) {
+      /* Move the stored result over to the new entry. */
+      SWAP(char *, entry->error, entry_old->error);
+      SWAP(Mesh *, entry->mesh, entry_old->mesh);
+      SWAP(Mesh *, entry->mesh_orco, entry_old->mesh_orco);
+      SWAP(Mesh *, entry->mesh_orco_cloth, entry_old->mesh_orco_cloth);
+      SWAP(size_t, entry->memory_size, entry_old->memory_size);
+      entry->append_mask = entry_old->append_mask;
+      if (entry->mesh != NULL) {
+        *r_resume_index = i;
+      }
+    }
+  }
+
+  if (cache->mesh_deform == NULL) {
+    *r_resume_index = -1;
+  }
+
+  /* Free results of everything which changed. */
+  for (i = 0; i < cache->entries_num; i++) {
+    modifier_stack_cache_entry_free(cache, &cache->entries[i]);
+  }
+  MEM_SAFE_FREE(cache->entries);
+  /* Leading deform modifiers are always before the first stored result. */
+  if (*r_resume_index == -1 && cache->mesh_deform != NULL) {
+    BKE_id_free(NULL, cache->mesh_deform);
+    cache->mesh_deform = NULL;
+  }
+
+  cache->entries = entries;
+  cache->entries_num = entries_num;
+  cache->use_store = is_same_evaluation;
+  cache->ctime = ctime;
+  cache->required_mode = required_mode;
+  cache->need_mapping = need_mapping;
+  cache->mask = *mask;
+  cache->simplify_mode = scene->r.mode & R_SIMPLIFY;
+  cache->simplify_subsurf = scene->r.simplify_subsurf;
+
+  return cache;
+}
+
+/* Store the state of the stack after the constructive modifier at the given position. */
+void BKE_modifier_stack_cache_store(ModifierStackCache *cache,
+                                    const int index,
+                                    Mesh *mesh,
+                                    Mesh *mesh_orco,
+                                    Mesh *mesh_orco_cloth,
+                                    const CustomData_MeshMasks *append_mask)
+{
+  BLI_assert(index >= 0 && index < cache->entries_num);
+  if (!cache->use_store) {
+    return;
+  }
+  ModifierStackCacheEntry *entry = &cache->entries[index];
+  if (entry->mesh != NULL || entry->is_volatile) {
+    return;
+  }
+
+  const size_t memory_size = BKE_mesh_memory_size(mesh) +
+                             (mesh_orco ? BKE_mesh_memory_size(mesh_orco) : 0) +
+                             (mesh_orco_cloth ? BKE_mesh_memory_size(mesh_orco_cloth) : 0);
+  /* Later results skip more work, so they replace earlier ones when running out of memory. */
+  const size_t limit = modifier_stack_cache_limit();
+  for (int i = 0; i < index && cache->memory_size + memory_size > limit; i++) {
+    modifier_stack_cache_entry_clear_result(cache, &cache->entries[i]);
+  }
+  if (cache->memory_size + memory_size > limit) {
+    return;
+  }
+
+  entry->mesh = mesh_copy_for_cache(mesh);
+  entry->mesh_orco = mesh_copy_for_cache(mesh_orco);
+  entry->mesh_orco_cloth = mesh_copy_for_cache(mesh_orco_cloth);
+  entry->append_mask = *append_mask;
+  entry->memory_size = memory_size;
+  cache->memory_size += memory_size;
+}
+
+/* Store data which is only known once the whole stack was evaluated. */
+void BKE_modifier_stack_cache_end(ModifierStackCache *cache,
+                                  ModifierData *firstmd,
+                                  Mesh *mesh_deform)
+{
+  int i = 0;
+  for (ModifierData *md = firstmd; md && i < cache->entries_num; md = md->next, i++) {
+    ModifierStackCacheEntry *entry = &cache->entries[i];
+    MEM_SAFE_FREE(entry->error);
+    if (md->error != NULL) {
+      entry->error = BLI_strdup(md->error);
+    }
+  }
+
+  if (cache->use_store && cache->mesh_deform == NULL && mesh_deform != NULL) {
+    cache->mesh_deform = mesh_copy_for_cache(mesh_deform);
+  }
+}
+
+void BKE_modifier_stack_cache_free(ModifierStackCache *cache)
+{
+  modifier_stack_cache_clear(cache);
+  MEM_freeN(cache);
+}
+
+/** \} */
@@ -107,6 +107,7 @@
 #include "BKE_material.h"
 #include "BKE_mball.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_playback_cache.h"
 #include "BKE_modifier.h"
 #include "BKE_multires.h"
 #include "BKE_node.h"
@@ -280,6 +281,10 @@ static void object_free_data(ID *id)
 
   DRW_drawdata_free((ID *)ob);
 
+  if ((ob->id.tag & LIB_TAG_COPIED_ON_WRITE) == 0) {
+    BKE_mesh_playback_cache_invalidate_object(ob);
+  }
+
   /* BKE_<id>_free shall never touch to ID->us. Never ever. */
   BKE_object_free_modifiers(ob, LIB_ID_CREATE_NO_USER_REFCOUNT);
   BKE_object_free_shaderfx(ob, LIB_ID_CREATE_NO_USER_REFCOUNT);
@@ -324,6 +329,11 @@ static void object_free_data(ID *id)
     ob->runtime.curve_cache = NULL;
   }
 
+  if (ob->runtime.modifier_stack_cache) {
+    BKE_modifier_stack_cache_free(ob->runtime.modifier_stack_cache);
+    ob->runtime.modifier_stack_cache = NULL;
+  }
+
   BKE_previewimg_free(&ob->preview);
 }
 
@@ -747,10 +757,16 @@ void BKE_object_free_derived_caches(Object *ob)
     ob->runtime.data_eval = NULL;
   }
   if (ob->runtime.mesh_deform_eval != NULL) {
-    Mesh *mesh_deform_eval = ob->runtime.mesh_deform_eval;
-    BKE_mesh_eval_delete(mesh_deform_eval);
+    if (ob->runtime.mesh_playback_cache_entry == NULL) {
+      Mesh *mesh_deform_eval = ob->runtime.mesh_deform_eval;
+      BKE_mesh_eval_delete(mesh_deform_eval);
+    }
     ob->runtime.mesh_deform_eval = NULL;
   }
+  if (ob->runtime.mesh_playback_cache_entry != NULL) {
+    BKE_mesh_playback_cache_release(ob->runtime.mesh_playback_cache_entry);
+    ob->runtime.mesh_playback_cache_entry = NULL;
+  }
 
   /* Restore initial pointer for copy-on-write datablocks, object->data
    * might be pointing to an evaluated datablock data was just freed above. */
@@ -805,6 +821,10 @@ void BKE_object_free_caches(Object *object)
    */
   if ((object->base_flag & BASE_FROM_DUPLI) == 0) {
     BKE_object_free_derived_caches(object);
+    if (object->runtime.modifier_stack_cache != NULL) {
+      BKE_modifier_stack_cache_free(object->runtime.modifier_stack_cache);
+      object->runtime.modifier_stack_cache = NULL;
+    }
     update_flag |= ID_RECALC_GEOMETRY;
   }
 
@@ -4112,6 +4132,8 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
   runtime->data_eval = NULL;
   runtime->mesh_deform_eval = NULL;
   runtime->curve_cache = NULL;
+  runtime->modifier_stack_cache = NULL;
+  runtime->mesh_playback_cache_entry = NULL;
 }
 
 /*
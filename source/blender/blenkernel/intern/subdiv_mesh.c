@@ -28,12 +28,16 @@
 #include "DNA_key_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
 
 #include "BLI_alloca.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_key.h"
+#include "BKE_lib_id.h"
 #include "BKE_mesh.h"
 #include "BKE_subdiv.h"
 #include "BKE_subdiv_eval.h"
@@ -45,6 +49,18 @@
 /** \name Subdivision Context
  * \{ */
 
+/* Coordinate on the limit surface at which a subdivided vertex is evaluated. */
+typedef struct SubdivVertexSample {
+  int ptex_face_index;
+  float u, v;
+} SubdivVertexSample;
+
+/* Sample of a vertex on a coarse edge or corner, used for normals averaging. */
+typedef struct SubdivBoundarySample {
+  int subdiv_vertex_index;
+  SubdivVertexSample sample;
+} SubdivBoundarySample;
+
 typedef struct SubdivMeshContext {
   const SubdivToMeshSettings *settings;
   const Mesh *coarse_mesh;
@@ -76,6 +92,17 @@ typedef struct SubdivMeshContext {
    * when it's not possible is when displacement is used. */
   bool can_evaluate_normals;
   bool have_displacement;
+  /* Recording of the limit surface coordinates of every subdivided vertex, and of the coarse
+   * elements which flags are copied from, which is needed to create a #SubdivMeshCache. */
+  bool need_vertex_samples;
+  SubdivVertexSample *vertex_samples;
+  int *vert_coarse_index;
+  int *edge_coarse_index;
+  int *poly_coarse_index;
+  /* Boundary samples are only recorded from the single threaded part of the traversal. */
+  SubdivBoundarySample *boundary_samples;
+  int num_boundary_samples;
+  int boundary_samples_alloc;
 } SubdivMeshContext;
 
 static void subdiv_mesh_ctx_cache_uv_layers(SubdivMeshContext *ctx)
@@ -113,10 +140,77 @@ static void subdiv_mesh_prepare_accumulator(SubdivMeshContext *ctx, int num_vert
       sizeof(*ctx->accumulated_counters), num_vertices, "subdiv accumulated counters");
 }
 
+static int *subdiv_mesh_coarse_index_alloc(const int num_elements, const char *name)
+{
+  int *coarse_index = MEM_malloc_arrayN(num_elements, sizeof(int), name);
+  copy_vn_i(coarse_index, num_elements, -1);
+  return coarse_index;
+}
+
+static void subdiv_mesh_prepare_vertex_samples(SubdivMeshContext *ctx,
+                                               int num_vertices,
+                                               int num_edges,
+                                               int num_polygons)
+{
+  if (!ctx->need_vertex_samples) {
+    return;
+  }
+  ctx->vertex_samples = MEM_malloc_arrayN(
+      num_vertices, sizeof(*ctx->vertex_samples), "subdiv vertex samples");
+  /* Loose geometry is not evaluated from the limit surface, and keeps the invalid index. */
+  for (int i = 0; i < num_vertices; i++) {
+    ctx->vertex_samples[i].ptex_face_index = -1;
+  }
+  ctx->vert_coarse_index = subdiv_mesh_coarse_index_alloc(num_vertices, "subdiv vert index");
+  ctx->edge_coarse_index = subdiv_mesh_coarse_index_alloc(num_edges, "subdiv edge index");
+  ctx->poly_coarse_index = subdiv_mesh_coarse_index_alloc(num_polygons, "subdiv poly index");
+}
+
 static void subdiv_mesh_context_free(SubdivMeshContext *ctx)
 {
   MEM_SAFE_FREE(ctx->accumulated_normals);
   MEM_SAFE_FREE(ctx->accumulated_counters);
+  MEM_SAFE_FREE(ctx->vertex_samples);
+  MEM_SAFE_FREE(ctx->vert_coarse_index);
+  MEM_SAFE_FREE(ctx->edge_coarse_index);
+  MEM_SAFE_FREE(ctx->poly_coarse_index);
+  MEM_SAFE_FREE(ctx->boundary_samples);
+}
+
+static void subdiv_mesh_record_vertex_sample(const SubdivMeshContext *ctx,
+                                             const int subdiv_vertex_index,
+                                             const int ptex_face_index,
+                                             const float u,
+                                             const float v)
+{
+  if (ctx->vertex_samples == NULL) {
+    return;
+  }
+  SubdivVertexSample *sample = &ctx->vertex_samples[subdiv_vertex_index];
+  sample->ptex_face_index = ptex_face_index;
+  sample->u = u;
+  sample->v = v;
+}
+
+static void subdiv_mesh_record_boundary_sample(SubdivMeshContext *ctx,
+                                               const int subdiv_vertex_index,
+                                               const int ptex_face_index,
+                                               const float u,
+                                               const float v)
+{
+  if (ctx->vertex_samples == NULL) {
+    return;
+  }
+  if (ctx->num_boundary_samples == ctx->boundary_samples_alloc) {
+    ctx->boundary_samples_alloc = max_ii(1024, ctx->boundary_samples_alloc * 2);
+    ctx->boundary_samples = MEM_reallocN(
+        ctx->boundary_samples, sizeof(*ctx->boundary_samples) * ctx->boundary_samples_alloc);
+  }
+  SubdivBoundarySample *boundary_sample = &ctx->boundary_samples[ctx->num_boundary_samples++];
+  boundary_sample->subdiv_vertex_index = subdiv_vertex_index;
+  boundary_sample->sample.ptex_face_index = ptex_face_index;
+  boundary_sample->sample.u = u;
+  boundary_sample->sample.v = v;
 }
 
 /** \} */
@@ -524,6 +618,7 @@ static bool subdiv_mesh_topology_info(const SubdivForeachContext *foreach_contex
       subdiv_context->coarse_mesh, num_vertices, num_edges, 0, num_loops, num_polygons, mask);
   subdiv_mesh_ctx_cache_custom_data_layers(subdiv_context);
   subdiv_mesh_prepare_accumulator(subdiv_context, num_vertices);
+  subdiv_mesh_prepare_vertex_samples(subdiv_context, num_vertices, num_edges, num_polygons);
   return true;
 }
 
@@ -543,6 +638,9 @@ static void subdiv_vertex_data_copy(const SubdivMeshContext *ctx,
   const int subdiv_vertex_index = subdiv_vertex - subdiv_mesh->mvert;
   CustomData_copy_data(
       &coarse_mesh->vdata, &ctx->subdiv_mesh->vdata, coarse_vertex_index, subdiv_vertex_index, 1);
+  if (ctx->vert_coarse_index != NULL) {
+    ctx->vert_coarse_index[subdiv_vertex_index] = coarse_vertex_index;
+  }
 }
 
 static void subdiv_vertex_data_interpolate(const SubdivMeshContext *ctx,
@@ -641,6 +739,7 @@ static void subdiv_mesh_vertex_every_corner_or_edge(const SubdivForeachContext *
   MVert *subdiv_mvert = subdiv_mesh->mvert;
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_accumulate_vertex_normal_and_displacement(ctx, ptex_face_index, u, v, subdiv_vert);
+  subdiv_mesh_record_boundary_sample(ctx, subdiv_vertex_index, ptex_face_index, u, v);
 }
 
 static void subdiv_mesh_vertex_every_corner(const SubdivForeachContext *foreach_context,
@@ -691,6 +790,7 @@ static void subdiv_mesh_vertex_corner(const SubdivForeachContext *foreach_contex
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   evaluate_vertex_and_apply_displacement_copy(
       ctx, ptex_face_index, u, v, coarse_vert, subdiv_vert);
+  subdiv_mesh_record_vertex_sample(ctx, subdiv_vertex_index, ptex_face_index, u, v);
 }
 
 static void subdiv_mesh_ensure_vertex_interpolation(SubdivMeshContext *ctx,
@@ -742,6 +842,7 @@ static void subdiv_mesh_vertex_edge(const SubdivForeachContext *foreach_context,
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
   evaluate_vertex_and_apply_displacement_interpolate(
       ctx, ptex_face_index, u, v, &tls->vertex_interpolation, subdiv_vert);
+  subdiv_mesh_record_vertex_sample(ctx, subdiv_vertex_index, ptex_face_index, u, v);
 }
 
 static bool subdiv_mesh_is_center_vertex(const MPoly *coarse_poly, const float u, const float v)
@@ -792,6 +893,7 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   eval_final_point_and_vertex_normal(
       subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
+  subdiv_mesh_record_vertex_sample(ctx, subdiv_vertex_index, ptex_face_index, u, v);
 }
 
 /** \} */
@@ -821,6 +923,9 @@ static void subdiv_copy_edge_data(SubdivMeshContext *ctx,
   CustomData_copy_data(
       &ctx->coarse_mesh->edata, &ctx->subdiv_mesh->edata, coarse_edge_index, subdiv_edge_index, 1);
   subdiv_edge->flag |= ME_EDGERENDER;
+  if (ctx->edge_coarse_index != NULL) {
+    ctx->edge_coarse_index[subdiv_edge_index] = coarse_edge_index;
+  }
 }
 
 static void subdiv_mesh_edge(const SubdivForeachContext *foreach_context,
@@ -955,6 +1060,9 @@ static void subdiv_copy_poly_data(const SubdivMeshContext *ctx,
   const int subdiv_poly_index = subdiv_poly - ctx->subdiv_mesh->mpoly;
   CustomData_copy_data(
       &ctx->coarse_mesh->pdata, &ctx->subdiv_mesh->pdata, coarse_poly_index, subdiv_poly_index, 1);
+  if (ctx->poly_coarse_index != NULL) {
+    ctx->poly_coarse_index[subdiv_poly_index] = coarse_poly_index;
+  }
 }
 
 static void subdiv_mesh_poly(const SubdivForeachContext *foreach_context,
@@ -1185,13 +1293,355 @@ static void setup_foreach_callbacks(const SubdivMeshContext *subdiv_context,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Evaluation cache
+ *
+ * For meshes which only change their coordinates, the topology and the custom data of the
+ * subdivided mesh stay the same. The cache stores the subdivided mesh together with the limit
+ * surface coordinates of all its vertices, so that only positions and normals need to be
+ * evaluated, in one multi-threaded loop over vertices.
+ *
+ * The cache costs memory and makes the first subdivision slower, so it's only filled when the
+ * same coarse topology is subdivided a second time, as deforming meshes are, and when it fits
+ * the memory limit. Until then only the fingerprint of the coarse mesh is stored.
+ * \{ */
+
+/* Selection and visibility only change flags of elements copied from the coarse mesh, they are
+ * copied again on every evaluation of the cache instead of being part of the fingerprint. */
+#define SUBDIV_CACHE_VERT_FLAG (SELECT | ME_HIDE)
+#define SUBDIV_CACHE_EDGE_FLAG (SELECT | ME_HIDE)
+#define SUBDIV_CACHE_POLY_FLAG (ME_FACE_SEL | ME_HIDE)
+
+typedef struct SubdivMeshCache {
+  /* Settings and fingerprint of the coarse mesh the cache was created for. The subdivision
+   * settings affect face-varying data (UV smoothing) and topology refinement, and are not
+   * reflected by the coarse mesh. */
+  SubdivSettings subdiv_settings;
+  SubdivToMeshSettings settings;
+  int coarse_totvert;
+  int coarse_totedge;
+  int coarse_totloop;
+  int coarse_totpoly;
+  uint coarse_hash;
+  /* Memory needed by the filled cache, zero while it's not known yet. SIZE_MAX when the mesh
+   * can't be evaluated from the cache. */
+  size_t memory_size;
+  /* Subdivided mesh, NULL while the cache is not filled. Vertex coordinates and normals, and
+   * selection and visibility flags are overwritten on evaluation. */
+  Mesh *mesh;
+  /* Limit surface coordinate at which position of every subdivided vertex is evaluated. */
+  SubdivVertexSample *vertex_samples;
+  /* Vertices on coarse edges and corners average normals of all adjacent ptex faces. Samples of
+   * vertex i are stored in [normal_samples_offset[i], normal_samples_offset[i + 1]), inner
+   * vertices have no samples and use normal of their vertex sample. */
+  int *normal_samples_offset;
+  SubdivVertexSample *normal_samples;
+  /* Coarse elements which flags are copied, -1 for elements created by subdivision. */
+  int *vert_coarse_index;
+  int *edge_coarse_index;
+  int *poly_coarse_index;
+} SubdivMeshCache;
+
+static uint subdiv_mesh_custom_data_hash(const CustomData *data, const int totelem, uint seed)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, seed);
+  for (int layer_index = 0; layer_index < data->totlayer; layer_index++) {
+    const CustomDataLayer *layer = &data->layers[layer_index];
+    BLI_hash_mm2a_add_int(&mm2, layer->type);
+    if (layer->data == NULL) {
+      continue;
+    }
+    switch (layer->type) {
+      case CD_MVERT: {
+        /* Coordinates are evaluated, only flags are copied to the subdivided mesh. */
+        const MVert *mvert = layer->data;
+        for (int i = 0; i < totelem; i++) {
+          BLI_hash_mm2a_add_int(&mm2,
+                                ((mvert[i].flag & ~SUBDIV_CACHE_VERT_FLAG) << 8) |
+                                    mvert[i].bweight);
+        }
+        break;
+      }
+      case CD_MEDGE: {
+        const MEdge *medge = layer->data;
+        for (int i = 0; i < totelem; i++) {
+          BLI_hash_mm2a_add_int(&mm2, (int)medge[i].v1);
+          BLI_hash_mm2a_add_int(&mm2, (int)medge[i].v2);
+          BLI_hash_mm2a_add_int(&mm2,
+                                ((medge[i].flag & ~SUBDIV_CACHE_EDGE_FLAG) << 16) |
+                                    (medge[i].crease << 8) | medge[i].bweight);
+        }
+        break;
+      }
+      case CD_MPOLY: {
+        const MPoly *mpoly = layer->data;
+        for (int i = 0; i < totelem; i++) {
+          BLI_hash_mm2a_add_int(&mm2, mpoly[i].loopstart);
+          BLI_hash_mm2a_add_int(&mm2, mpoly[i].totloop);
+          BLI_hash_mm2a_add_int(
+              &mm2, ((mpoly[i].flag & ~SUBDIV_CACHE_POLY_FLAG) << 16) | mpoly[i].mat_nr);
+        }
+        break;
+      }
+      case CD_MDEFORMVERT: {
+        /* Weights are stored in a separate allocation, which changes with every copy. */
+        const MDeformVert *dvert = layer->data;
+        for (int i = 0; i < totelem; i++) {
+          BLI_hash_mm2a_add_int(&mm2, dvert[i].totweight);
+          BLI_hash_mm2a_add(&mm2,
+                            (const unsigned char *)dvert[i].dw,
+                            sizeof(*dvert[i].dw) * dvert[i].totweight);
+        }
+        break;
+      }
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+        /* Multires grids are not preserved by subdivision. */
+        break;
+      default:
+        BLI_hash_mm2a_add(&mm2,
+                          (const unsigned char *)layer->data,
+                          (size_t)CustomData_sizeof(layer->type) * (size_t)totelem);
+        break;
+    }
+  }
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+/* Hash of everything in the coarse mesh which affects the subdivided mesh, except for vertex
+ * coordinates and the flags which are copied on evaluation. */
+static uint subdiv_mesh_coarse_hash(const Mesh *coarse_mesh)
+{
+  uint hash = 0;
+  hash = subdiv_mesh_custom_data_hash(&coarse_mesh->vdata, coarse_mesh->totvert, hash);
+  hash = subdiv_mesh_custom_data_hash(&coarse_mesh->edata, coarse_mesh->totedge, hash);
+  hash = subdiv_mesh_custom_data_hash(&coarse_mesh->ldata, coarse_mesh->totloop, hash);
+  hash = subdiv_mesh_custom_data_hash(&coarse_mesh->pdata, coarse_mesh->totpoly, hash);
+  return hash;
+}
+
+static bool subdiv_mesh_cache_is_valid(const SubdivMeshCache *cache,
+                                       const Subdiv *subdiv,
+                                       const SubdivToMeshSettings *settings,
+                                       const Mesh *coarse_mesh,
+                                       const uint coarse_hash)
+{
+  /* Creases are not compared by #BKE_subdiv_settings_equal. */
+  return BKE_subdiv_settings_equal(&cache->subdiv_settings, &subdiv->settings) &&
+         cache->subdiv_settings.use_creases == subdiv->settings.use_creases &&
+         cache->settings.resolution == settings->resolution &&
+         cache->settings.use_optimal_display == settings->use_optimal_display &&
+         cache->coarse_totvert == coarse_mesh->totvert &&
+         cache->coarse_totedge == coarse_mesh->totedge &&
+         cache->coarse_totloop == coarse_mesh->totloop &&
+         cache->coarse_totpoly == coarse_mesh->totpoly && cache->coarse_hash == coarse_hash;
+}
+
+/* Create a cache which only stores the fingerprint of the coarse mesh. */
+static SubdivMeshCache *subdiv_mesh_cache_new(const Subdiv *subdiv,
+                                              const SubdivToMeshSettings *settings,
+                                              const Mesh *coarse_mesh,
+                                              const uint coarse_hash)
+{
+  SubdivMeshCache *cache = MEM_callocN(sizeof(*cache), "subdiv mesh cache");
+  cache->subdiv_settings = subdiv->settings;
+  cache->settings = *settings;
+  cache->coarse_totvert = coarse_mesh->totvert;
+  cache->coarse_totedge = coarse_mesh->totedge;
+  cache->coarse_totloop = coarse_mesh->totloop;
+  cache->coarse_totpoly = coarse_mesh->totpoly;
+  cache->coarse_hash = coarse_hash;
+  return cache;
+}
+
+static void subdiv_mesh_cache_clear(SubdivMeshCache *cache)
+{
+  if (cache->mesh != NULL) {
+    BKE_id_free(NULL, cache->mesh);
+    cache->mesh = NULL;
+  }
+  MEM_SAFE_FREE(cache->vertex_samples);
+  MEM_SAFE_FREE(cache->normal_samples_offset);
+  MEM_SAFE_FREE(cache->normal_samples);
+  MEM_SAFE_FREE(cache->vert_coarse_index);
+  MEM_SAFE_FREE(cache->edge_coarse_index);
+  MEM_SAFE_FREE(cache->poly_coarse_index);
+}
+
+/* Fill the cache from the samples recorded during traversal, unless some of the vertices can not
+ * be evaluated from the limit surface or the cache needs more memory than \a memory_limit. */
+static void subdiv_mesh_cache_fill(SubdivMeshCache *cache,
+                                   SubdivMeshContext *ctx,
+                                   const size_t memory_limit)
+{
+  Mesh *subdiv_mesh = ctx->subdiv_mesh;
+  const int num_vertices = subdiv_mesh->totvert;
+  /* Loose vertices and edges are interpolated from the coarse mesh. */
+  for (int i = 0; i < num_vertices; i++) {
+    if (ctx->vertex_samples[i].ptex_face_index == -1) {
+      cache->memory_size = SIZE_MAX;
+      return;
+    }
+  }
+  if (num_vertices == 0) {
+    cache->memory_size = SIZE_MAX;
+    return;
+  }
+  cache->memory_size = BKE_mesh_memory_size(subdiv_mesh) +
+                       sizeof(*cache->vertex_samples) * (size_t)num_vertices +
+                       sizeof(*cache->normal_samples_offset) * (size_t)(num_vertices + 1) +
+                       sizeof(*cache->normal_samples) * (size_t)ctx->num_boundary_samples +
+                       sizeof(int) * (size_t)(num_vertices + subdiv_mesh->totedge +
+                                              subdiv_mesh->totpoly);
+  if (cache->memory_size > memory_limit) {
+    return;
+  }
+  cache->mesh = BKE_mesh_copy_for_eval(subdiv_mesh, false);
+  /* Take ownership of the recorded vertex samples and coarse indices. */
+  SWAP(SubdivVertexSample *, cache->vertex_samples, ctx->vertex_samples);
+  SWAP(int *, cache->vert_coarse_index, ctx->vert_coarse_index);
+  SWAP(int *, cache->edge_coarse_index, ctx->edge_coarse_index);
+  SWAP(int *, cache->poly_coarse_index, ctx->poly_coarse_index);
+  /* Group boundary samples by vertex. */
+  int *offset = MEM_calloc_arrayN(num_vertices + 1, sizeof(int), "subdiv normal samples offset");
+  for (int i = 0; i < ctx->num_boundary_samples; i++) {
+    offset[ctx->boundary_samples[i].subdiv_vertex_index + 1]++;
+  }
+  for (int i = 0; i < num_vertices; i++) {
+    offset[i + 1] += offset[i];
+  }
+  cache->normal_samples_offset = offset;
+  cache->normal_samples = MEM_malloc_arrayN(max_ii(ctx->num_boundary_samples, 1),
+                                            sizeof(*cache->normal_samples),
+                                            "subdiv normal samples");
+  int *fill = MEM_dupallocN(offset);
+  for (int i = 0; i < ctx->num_boundary_samples; i++) {
+    const SubdivBoundarySample *boundary_sample = &ctx->boundary_samples[i];
+    cache->normal_samples[fill[boundary_sample->subdiv_vertex_index]++] = boundary_sample->sample;
+  }
+  MEM_freeN(fill);
+}
+
+typedef struct SubdivMeshCacheEvalData {
+  Subdiv *subdiv;
+  const SubdivMeshCache *cache;
+  MVert *mvert;
+} SubdivMeshCacheEvalData;
+
+static void subdiv_mesh_cache_eval_vertex(void *__restrict userdata,
+                                          const int subdiv_vertex_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SubdivMeshCacheEvalData *data = userdata;
+  const SubdivMeshCache *cache = data->cache;
+  Subdiv *subdiv = data->subdiv;
+  MVert *subdiv_vert = &data->mvert[subdiv_vertex_index];
+  const SubdivVertexSample *sample = &cache->vertex_samples[subdiv_vertex_index];
+  const int normal_samples_start = cache->normal_samples_offset[subdiv_vertex_index];
+  const int normal_samples_end = cache->normal_samples_offset[subdiv_vertex_index + 1];
+  if (normal_samples_start == normal_samples_end) {
+    BKE_subdiv_eval_limit_point_and_short_normal(
+        subdiv, sample->ptex_face_index, sample->u, sample->v, subdiv_vert->co, subdiv_vert->no);
+    return;
+  }
+  /* Same averaging as subdiv_accumulate_vertex_normal_and_displacement(). */
+  BKE_subdiv_eval_limit_point(
+      subdiv, sample->ptex_face_index, sample->u, sample->v, subdiv_vert->co);
+  float N_accumulated[3] = {0.0f, 0.0f, 0.0f};
+  for (int i = normal_samples_start; i < normal_samples_end; i++) {
+    const SubdivVertexSample *normal_sample = &cache->normal_samples[i];
+    float dummy_P[3], dPdu[3], dPdv[3], N[3];
+    BKE_subdiv_eval_limit_point_and_derivatives(subdiv,
+                                                normal_sample->ptex_face_index,
+                                                normal_sample->u,
+                                                normal_sample->v,
+                                                dummy_P,
+                                                dPdu,
+                                                dPdv);
+    cross_v3_v3v3(N, dPdu, dPdv);
+    normalize_v3(N);
+    add_v3_v3(N_accumulated, N);
+  }
+  normalize_v3(N_accumulated);
+  normal_float_to_short_v3(subdiv_vert->no, N_accumulated);
+}
+
+static void subdiv_mesh_cache_copy_flags(const SubdivMeshCache *cache,
+                                         const Mesh *coarse_mesh,
+                                         Mesh *result)
+{
+  for (int i = 0; i < result->totvert; i++) {
+    const int coarse_index = cache->vert_coarse_index[i];
+    if (coarse_index != -1) {
+      MVert *mv = &result->mvert[i];
+      mv->flag = (mv->flag & ~SUBDIV_CACHE_VERT_FLAG) |
+                 (coarse_mesh->mvert[coarse_index].flag & SUBDIV_CACHE_VERT_FLAG);
+    }
+  }
+  for (int i = 0; i < result->totedge; i++) {
+    const int coarse_index = cache->edge_coarse_index[i];
+    if (coarse_index != -1) {
+      MEdge *me = &result->medge[i];
+      me->flag = (me->flag & ~SUBDIV_CACHE_EDGE_FLAG) |
+                 (coarse_mesh->medge[coarse_index].flag & SUBDIV_CACHE_EDGE_FLAG);
+    }
+  }
+  for (int i = 0; i < result->totpoly; i++) {
+    const int coarse_index = cache->poly_coarse_index[i];
+    if (coarse_index != -1) {
+      MPoly *mp = &result->mpoly[i];
+      mp->flag = (mp->flag & ~SUBDIV_CACHE_POLY_FLAG) |
+                 (coarse_mesh->mpoly[coarse_index].flag & SUBDIV_CACHE_POLY_FLAG);
+    }
+  }
+}
+
+static Mesh *subdiv_mesh_cache_evaluate(Subdiv *subdiv,
+                                        const SubdivMeshCache *cache,
+                                        const Mesh *coarse_mesh)
+{
+  if (!BKE_subdiv_eval_begin_from_mesh(subdiv, coarse_mesh, NULL)) {
+    return NULL;
+  }
+  BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
+  Mesh *result = BKE_mesh_copy_for_eval(cache->mesh, false);
+  result->cd_flag = coarse_mesh->cd_flag;
+  BKE_mesh_copy_settings(result, coarse_mesh);
+  SubdivMeshCacheEvalData data = {
+      .subdiv = subdiv,
+      .cache = cache,
+      .mvert = result->mvert,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, result->totvert, &data, subdiv_mesh_cache_eval_vertex, &settings);
+  subdiv_mesh_cache_copy_flags(cache, coarse_mesh, result);
+  BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
+  return result;
+}
+
+void BKE_subdiv_mesh_cache_free(SubdivMeshCache *cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+  subdiv_mesh_cache_clear(cache);
+  MEM_freeN(cache);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Public entry point
  * \{ */
 
-Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
-                         const SubdivToMeshSettings *settings,
-                         const Mesh *coarse_mesh)
+static Mesh *subdiv_to_mesh(Subdiv *subdiv,
+                            const SubdivToMeshSettings *settings,
+                            const Mesh *coarse_mesh,
+                            SubdivMeshCache *cache,
+                            const size_t cache_memory_limit)
 {
   BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
   /* Make sure evaluator is up to date with possible new topology, and that
@@ -1214,6 +1664,7 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   subdiv_context.subdiv = subdiv;
   subdiv_context.have_displacement = (subdiv->displacement_evaluator != NULL);
   subdiv_context.can_evaluate_normals = !subdiv_context.have_displacement;
+  subdiv_context.need_vertex_samples = (cache != NULL && !subdiv_context.have_displacement);
   /* Multi-threaded traversal/evaluation. */
   BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   SubdivForeachContext foreach_context;
@@ -1230,9 +1681,56 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   if (!subdiv_context.can_evaluate_normals) {
     result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
   }
+  if (subdiv_context.vertex_samples != NULL) {
+    subdiv_mesh_cache_fill(cache, &subdiv_context, cache_memory_limit);
+  }
   /* Free used memory. */
   subdiv_mesh_context_free(&subdiv_context);
   return result;
 }
 
+Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
+                         const SubdivToMeshSettings *settings,
+                         const Mesh *coarse_mesh)
+{
+  return subdiv_to_mesh(subdiv, settings, coarse_mesh, NULL, 0);
+}
+
+Mesh *BKE_subdiv_to_mesh_cached(Subdiv *subdiv,
+                                const SubdivToMeshSettings *settings,
+                                const Mesh *coarse_mesh,
+                                const size_t cache_memory_limit,
+                                SubdivMeshCache **r_cache)
+{
+  /* Displacement can not be evaluated in a batch. */
+  if (subdiv->displacement_evaluator != NULL || cache_memory_limit == 0) {
+    BKE_subdiv_mesh_cache_free(*r_cache);
+    *r_cache = NULL;
+    return BKE_subdiv_to_mesh(subdiv, settings, coarse_mesh);
+  }
+  const uint coarse_hash = subdiv_mesh_coarse_hash(coarse_mesh);
+  SubdivMeshCache *cache = *r_cache;
+  if (cache != NULL &&
+      !subdiv_mesh_cache_is_valid(cache, subdiv, settings, coarse_mesh, coarse_hash)) {
+    BKE_subdiv_mesh_cache_free(cache);
+    cache = NULL;
+  }
+  if (cache != NULL && cache->mesh != NULL) {
+    Mesh *result = subdiv_mesh_cache_evaluate(subdiv, cache, coarse_mesh);
+    if (result != NULL) {
+      return result;
+    }
+  }
+  if (cache == NULL) {
+    /* Fill the cache when the same topology is subdivided again. */
+    *r_cache = subdiv_mesh_cache_new(subdiv, settings, coarse_mesh, coarse_hash);
+    return subdiv_to_mesh(subdiv, settings, coarse_mesh, NULL, 0);
+  }
+  *r_cache = cache;
+  subdiv_mesh_cache_clear(cache);
+  const bool use_cache = (cache->memory_size <= cache_memory_limit);
+  return subdiv_to_mesh(
+      subdiv, settings, coarse_mesh, use_cache ? cache : NULL, cache_memory_limit);
+}
+
 /** \} */
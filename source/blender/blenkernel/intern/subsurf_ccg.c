@@ -662,6 +662,61 @@ static void free_ss_weights(WeightTable *wtable)
   }
 }
 
+/* Interpolation weights of many elements, for #CustomData_interp_batch. */
+typedef struct InterpBatch {
+  int *src_indices;
+  float *weights;
+  int *src_offsets;
+  int len, len_alloc;
+  int src_len_alloc;
+} InterpBatch;
+
+static void interp_batch_add(InterpBatch *batch,
+                             const int *src_indices,
+                             const float *weights,
+                             const int count)
+{
+  const int src_len = batch->len ? batch->src_offsets[batch->len] : 0;
+
+  if (batch->len + 1 >= batch->len_alloc) {
+    batch->len_alloc = max_ii(batch->len_alloc * 2, 256);
+    batch->src_offsets = MEM_reallocN(batch->src_offsets, sizeof(int) * batch->len_alloc);
+  }
+  if (src_len + count > batch->src_len_alloc) {
+    batch->src_len_alloc = max_ii(batch->src_len_alloc * 2, src_len + count);
+    batch->src_indices = MEM_reallocN(batch->src_indices, sizeof(int) * batch->src_len_alloc);
+    batch->weights = MEM_reallocN(batch->weights, sizeof(float) * batch->src_len_alloc);
+  }
+
+  memcpy(&batch->src_indices[src_len], src_indices, sizeof(int) * count);
+  memcpy(&batch->weights[src_len], weights, sizeof(float) * count);
+  batch->src_offsets[batch->len] = src_len;
+  batch->src_offsets[++batch->len] = src_len + count;
+}
+
+/* Interpolate all added elements to \a dest, starting at \a dest_index. */
+static void interp_batch_flush(InterpBatch *batch,
+                               const CustomData *source,
+                               CustomData *dest,
+                               const int dest_index)
+{
+  CustomData_interp_batch(source,
+                          dest,
+                          batch->src_indices,
+                          batch->weights,
+                          batch->src_offsets,
+                          batch->len,
+                          dest_index);
+  batch->len = 0;
+}
+
+static void interp_batch_free(InterpBatch *batch)
+{
+  MEM_SAFE_FREE(batch->src_indices);
+  MEM_SAFE_FREE(batch->weights);
+  MEM_SAFE_FREE(batch->src_offsets);
+}
+
 static void ss_sync_ccg_from_derivedmesh(CCGSubSurf *ss,
                                          DerivedMesh *dm,
                                          float (*vertexCos)[3],
@@ -2151,6 +2206,7 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
   int gridSideEdges;
   int gridInternalEdges;
   WeightTable wtable = {NULL};
+  InterpBatch batch = {NULL};
   MEdge *medge = NULL;
   MPoly *mpoly = NULL;
   bool has_edge_cd;
@@ -2234,14 +2290,7 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
     for (s = 0; s < numVerts; s++) {
       for (x = 1; x < gridFaces; x++) {
         w2 = w + s * numVerts * g2_wid * g2_wid + x * numVerts;
-        DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2, numVerts, vertNum);
-
-        if (vertOrigIndex) {
-          *vertOrigIndex = ORIGINDEX_NONE;
-          vertOrigIndex++;
-        }
-
-        vertNum++;
+        interp_batch_add(&batch, vertidx, w2, numVerts);
       }
     }
 
@@ -2250,18 +2299,18 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
       for (y = 1; y < gridFaces; y++) {
         for (x = 1; x < gridFaces; x++) {
           w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-          DM_interp_vert_data(dm, &ccgdm->dm, vertidx, w2, numVerts, vertNum);
-
-          if (vertOrigIndex) {
-            *vertOrigIndex = ORIGINDEX_NONE;
-            vertOrigIndex++;
-          }
-
-          vertNum++;
+          interp_batch_add(&batch, vertidx, w2, numVerts);
         }
       }
     }
 
+    if (vertOrigIndex) {
+      copy_vn_i(vertOrigIndex, batch.len, ORIGINDEX_NONE);
+      vertOrigIndex += batch.len;
+    }
+    vertNum += batch.len;
+    interp_batch_flush(&batch, &dm->vertData, &ccgdm->dm.vertData, vertNum - batch.len);
+
     if (edgeOrigIndex) {
       for (i = 0; i < numFinalEdges; i++) {
         edgeOrigIndex[edgeNum + i] = ORIGINDEX_NONE;
@@ -2273,24 +2322,16 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
       for (y = 0; y < gridFaces; y++) {
         for (x = 0; x < gridFaces; x++) {
           w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
+          interp_batch_add(&batch, loopidx, w2, numVerts);
 
           w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
+          interp_batch_add(&batch, loopidx, w2, numVerts);
 
           w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x + 1)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
+          interp_batch_add(&batch, loopidx, w2, numVerts);
 
           w2 = w + s * numVerts * g2_wid * g2_wid + ((y)*g2_wid + (x + 1)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
+          interp_batch_add(&batch, loopidx, w2, numVerts);
 
           /*copy over poly data, e.g. mtexpoly*/
           CustomData_copy_data(&dm->polyData, &ccgdm->dm.polyData, origIndex, faceNum, 1);
@@ -2316,11 +2357,16 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
           faceNum++;
         }
       }
+
+      loopindex2 += batch.len;
+      interp_batch_flush(&batch, &dm->loopData, &ccgdm->dm.loopData, loopindex2 - batch.len);
     }
 
     edgeNum += numFinalEdges;
   }
 
+  const int edge_vert_start = vertNum;
+
   for (index = 0; index < totedge; index++) {
     CCGEdge *e = ccgdm->edgeMap[index].edge;
     int numFinalEdges = edgeSize - 1;
@@ -2349,7 +2395,7 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
       float w[2];
       w[1] = (float)x / (edgeSize - 1);
       w[0] = 1 - w[1];
-      DM_interp_vert_data(dm, &ccgdm->dm, vertIdx, w, 2, vertNum);
+      interp_batch_add(&batch, vertIdx, w, 2);
       if (vertOrigIndex) {
         *vertOrigIndex = ORIGINDEX_NONE;
         vertOrigIndex++;
@@ -2373,6 +2419,9 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
     edgeNum += numFinalEdges;
   }
 
+  /* Vertices of all edges are consecutive. */
+  interp_batch_flush(&batch, &dm->vertData, &ccgdm->dm.vertData, edge_vert_start);
+
   if (useSubsurfUv) {
     CustomData *ldata = &ccgdm->dm.loopData;
     CustomData *dmldata = &dm->loopData;
@@ -2410,6 +2459,7 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
   BLI_array_free(loopidx);
 #endif
   free_ss_weights(&wtable);
+  interp_batch_free(&batch);
 
   BLI_assert(vertNum == ccgSubSurf_getNumFinalVerts(ss));
   BLI_assert(edgeNum == ccgSubSurf_getNumFinalEdges(ss));
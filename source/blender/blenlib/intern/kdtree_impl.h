@@ -22,9 +22,11 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
-#include "BLI_strict_flags.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
+#include "BLI_strict_flags.h"
+
 #define _CONCAT_AUX(MACRO_ARG1, MACRO_ARG2) MACRO_ARG1##MACRO_ARG2
 #define _CONCAT(MACRO_ARG1, MACRO_ARG2) _CONCAT_AUX(MACRO_ARG1, MACRO_ARG2)
 #define BLI_kdtree_nd_(id) _CONCAT(KDTREE_PREFIX_ID, _##id)
@@ -58,6 +60,14 @@ struct KDTree {
 
 #define KD_NODE_UNSET ((uint)-1)
 
+/* Subtrees with fewer nodes than this are balanced by a single task. */
+#define KD_BALANCE_PARALLEL_LIMIT 4096
+/* Trees with fewer nodes than this search for duplicates with the serial loop. */
+#define KD_DUPLICATES_PARALLEL_LIMIT 10000
+/* Searches finding more candidates than this are deferred to the serial pass,
+ * prevents dense clusters from collecting (and storing) a quadratic number of candidates. */
+#define KD_DUPLICATES_NEIGHBORS_MAX 16
+
 /**
  * When set we know all values are unbalanced,
  * otherwise clear them when re-balancing: see T62210.
@@ -145,20 +155,14 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Quicksort style sorting around the median, which is returned.
+ */
+static uint kdtree_balance_median(KDTreeNode *nodes, uint nodes_len, uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
-  /* quicksort style sorting around median */
   left = 0;
   right = nodes_len - 1;
   median = nodes_len / 2;
@@ -190,6 +194,23 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_balance_median(nodes, nodes_len, axis);
+
   /* set node and sort subnodes */
   node = &nodes[median];
   node->d = axis;
@@ -201,6 +222,54 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+struct KDTreeBalanceTask {
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+};
+
+static void kdtree_balance_task_cb(TaskPool *__restrict pool, void *taskdata)
+{
+  KDTreeNode *nodes = BLI_task_pool_user_data(pool);
+  const struct KDTreeBalanceTask *task = taskdata;
+  kdtree_balance(nodes + task->ofs, task->nodes_len, task->axis, task->ofs);
+}
+
+/**
+ * Balance the nodes like #kdtree_balance, pushing subtrees with fewer nodes than
+ * #KD_BALANCE_PARALLEL_LIMIT to \a task_pool. Subtrees don't overlap and the root of a subtree
+ * only depends on its length, so the result is the same as balancing on a single thread.
+ */
+static uint kdtree_balance_parallel(
+    TaskPool *task_pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len < KD_BALANCE_PARALLEL_LIMIT) {
+    if (nodes_len <= 1) {
+      return kdtree_balance(nodes, nodes_len, axis, ofs);
+    }
+    struct KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+    task->nodes_len = nodes_len;
+    task->axis = axis;
+    task->ofs = ofs;
+    BLI_task_pool_push(task_pool, kdtree_balance_task_cb, task, true, NULL);
+    return (nodes_len / 2) + ofs;
+  }
+
+  median = kdtree_balance_median(nodes, nodes_len, axis);
+
+  node = &nodes[median];
+  node->d = axis;
+  axis = (axis + 1) % KD_DIMS;
+  node->left = kdtree_balance_parallel(task_pool, nodes, median, axis, ofs);
+  node->right = kdtree_balance_parallel(
+      task_pool, nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+
+  return median + ofs;
+}
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -210,7 +279,15 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if ((tree->nodes_len >= KD_BALANCE_PARALLEL_LIMIT) && (BLI_task_scheduler_num_threads() > 1)) {
+    TaskPool *task_pool = BLI_task_pool_create(tree->nodes, TASK_PRIORITY_HIGH);
+    tree->root = kdtree_balance_parallel(task_pool, tree->nodes, tree->nodes_len, 0, 0);
+    BLI_task_pool_work_and_wait(task_pool);
+    BLI_task_pool_free(task_pool);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -866,6 +943,207 @@ static void deduplicate_recursive(const struct DeDuplicateParams *p, uint i)
   }
 }
 
+/**
+ * Parallel search for duplicate candidates.
+ *
+ * Since the result depends on the order nodes are searched in,
+ * the range searches run in parallel against the initial \a duplicates array
+ * (values only change from -1 to another index, so this gives a superset of candidates),
+ * then candidates are applied in order on a single thread, giving the same result as
+ * the serial loop.
+ */
+struct DeDuplicateCollectParams {
+  /* Static */
+  const KDTreeNode *nodes;
+  float range;
+  float range_sq;
+  const int *duplicates;
+
+  /* Per Search */
+  float search_co[KD_DIMS];
+  int search;
+  /* When NULL only count the candidates. */
+  int *neighbors;
+  uint neighbors_len;
+};
+
+struct DeDuplicateParallelData {
+  const KDTree *tree;
+  /* Maps the iteration order to node indices, NULL to loop over nodes in order. */
+  const uint *order;
+  float range;
+  const int *duplicates;
+
+  /* Candidates found for each search, in iteration order,
+   * values over #KD_DUPLICATES_NEIGHBORS_MAX are searched again on a single thread. */
+  uint *neighbors_len;
+  /* Offset of each search in `neighbors`, #KDTree.nodes_len + 1 in length. */
+  uint *neighbors_offset;
+  int *neighbors;
+};
+
+static void deduplicate_collect_recursive(struct DeDuplicateCollectParams *p, uint i)
+{
+  if (p->neighbors_len > KD_DUPLICATES_NEIGHBORS_MAX) {
+    return;
+  }
+  const KDTreeNode *node = &p->nodes[i];
+  if (p->search_co[node->d] + p->range <= node->co[node->d]) {
+    if (node->left != KD_NODE_UNSET) {
+      deduplicate_collect_recursive(p, node->left);
+    }
+  }
+  else if (p->search_co[node->d] - p->range >= node->co[node->d]) {
+    if (node->right != KD_NODE_UNSET) {
+      deduplicate_collect_recursive(p, node->right);
+    }
+  }
+  else {
+    if ((p->search != node->index) && (p->duplicates[node->index] == -1)) {
+      if (len_squared_vnvn(node->co, p->search_co) <= p->range_sq) {
+        if (p->neighbors) {
+          p->neighbors[p->neighbors_len] = node->index;
+        }
+        p->neighbors_len += 1;
+      }
+    }
+    if (node->left != KD_NODE_UNSET) {
+      deduplicate_collect_recursive(p, node->left);
+    }
+    if (node->right != KD_NODE_UNSET) {
+      deduplicate_collect_recursive(p, node->right);
+    }
+  }
+}
+
+static void deduplicate_collect(const struct DeDuplicateParallelData *data,
+                                const uint i,
+                                int *neighbors,
+                                uint *r_neighbors_len)
+{
+  const KDTreeNode *nodes = data->tree->nodes;
+  const uint node_index = data->order ? data->order[i] : i;
+  const int index = data->order ? (int)i : nodes[node_index].index;
+
+  *r_neighbors_len = 0;
+  if (!ELEM(data->duplicates[index], -1, index)) {
+    return;
+  }
+
+  struct DeDuplicateCollectParams p = {
+      .nodes = nodes,
+      .range = data->range,
+      .range_sq = square_f(data->range),
+      .duplicates = data->duplicates,
+      .search = index,
+      .neighbors = neighbors,
+  };
+  copy_vn_vn(p.search_co, nodes[node_index].co);
+  deduplicate_collect_recursive(&p, data->tree->root);
+  *r_neighbors_len = p.neighbors_len;
+}
+
+static void deduplicate_count_cb(void *__restrict userdata,
+                                 const int iter,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct DeDuplicateParallelData *data = userdata;
+  deduplicate_collect(data, (uint)iter, NULL, &data->neighbors_len[iter]);
+}
+
+static void deduplicate_fill_cb(void *__restrict userdata,
+                                const int iter,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct DeDuplicateParallelData *data = userdata;
+  const uint len = data->neighbors_len[iter];
+  if ((len == 0) || (len > KD_DUPLICATES_NEIGHBORS_MAX)) {
+    return;
+  }
+  uint len_test;
+  deduplicate_collect(data, (uint)iter, &data->neighbors[data->neighbors_offset[iter]], &len_test);
+  BLI_assert(len_test == len);
+}
+
+static int kdtree_calc_duplicates_fast_parallel(const KDTree *tree,
+                                                const float range,
+                                                const uint *order,
+                                                int *duplicates)
+{
+  const uint nodes_len = tree->nodes_len;
+  struct DeDuplicateParallelData data = {
+      .tree = tree,
+      .order = order,
+      .range = range,
+      .duplicates = duplicates,
+  };
+  data.neighbors_len = MEM_mallocN(sizeof(uint) * nodes_len, __func__);
+  data.neighbors_offset = MEM_mallocN(sizeof(uint) * (nodes_len + 1), __func__);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  BLI_task_parallel_range(0, (int)nodes_len, &data, deduplicate_count_cb, &settings);
+
+  uint neighbors_total = 0;
+  for (uint i = 0; i < nodes_len; i++) {
+    data.neighbors_offset[i] = neighbors_total;
+    if (data.neighbors_len[i] <= KD_DUPLICATES_NEIGHBORS_MAX) {
+      neighbors_total += data.neighbors_len[i];
+    }
+  }
+  data.neighbors_offset[nodes_len] = neighbors_total;
+
+  if (neighbors_total != 0) {
+    data.neighbors = MEM_mallocN(sizeof(int) * neighbors_total, __func__);
+    BLI_task_parallel_range(0, (int)nodes_len, &data, deduplicate_fill_cb, &settings);
+  }
+
+  /* Apply the candidates in order, matching the serial loop. */
+  int found = 0;
+  struct DeDuplicateParams p = {
+      .nodes = tree->nodes,
+      .range = range,
+      .range_sq = square_f(range),
+      .duplicates = duplicates,
+      .duplicates_found = &found,
+  };
+  for (uint i = 0; i < nodes_len; i++) {
+    if (data.neighbors_len[i] == 0) {
+      continue;
+    }
+    const uint node_index = order ? order[i] : i;
+    const int index = order ? (int)i : tree->nodes[node_index].index;
+    if (ELEM(duplicates[index], -1, index)) {
+      int found_prev = found;
+      if (data.neighbors_len[i] > KD_DUPLICATES_NEIGHBORS_MAX) {
+        p.search = index;
+        copy_vn_vn(p.search_co, tree->nodes[node_index].co);
+        deduplicate_recursive(&p, tree->root);
+      }
+      else {
+        for (uint j = data.neighbors_offset[i]; j < data.neighbors_offset[i + 1]; j++) {
+          const int index_other = data.neighbors[j];
+          if (duplicates[index_other] == -1) {
+            duplicates[index_other] = index;
+            found += 1;
+          }
+        }
+      }
+      if (found != found_prev) {
+        /* Prevent chains of doubles. */
+        duplicates[index] = index;
+      }
+    }
+  }
+
+  MEM_freeN(data.neighbors_len);
+  MEM_freeN(data.neighbors_offset);
+  MEM_SAFE_FREE(data.neighbors);
+  return found;
+}
+
 /**
  * Find duplicate points in \a range.
  * Favors speed over quality since it doesn't find the best target vertex for merging.
@@ -883,12 +1161,24 @@ static void deduplicate_recursive(const struct DeDuplicateParams *p, uint i)
  * \returns The number of merges found (includes any merges already in the \a duplicates array).
  *
  * \note Merging is always a single step (target indices wont be marked for merging).
+ * \note Large trees are searched in parallel, the result is the same as the serial loop.
+ * With a single thread the serial loop is used, the parallel search only adds work then.
  */
 int BLI_kdtree_nd_(calc_duplicates_fast)(const KDTree *tree,
                                          const float range,
                                          bool use_index_order,
                                          int *duplicates)
 {
+  if ((tree->nodes_len >= KD_DUPLICATES_PARALLEL_LIMIT) &&
+      (BLI_task_scheduler_num_threads() > 1)) {
+    uint *order = use_index_order ? kdtree_order(tree) : NULL;
+    const int found = kdtree_calc_duplicates_fast_parallel(tree, range, order, duplicates);
+    if (order) {
+      MEM_freeN(order);
+    }
+    return found;
+  }
+
   int found = 0;
   struct DeDuplicateParams p = {
       .nodes = tree->nodes,
@@ -753,6 +753,11 @@ void BLO_version_defaults_userpref_blend(Main *bmain, UserDef *userdef)
     userdef->transopts &= ~USER_DOTRANSLATE_DEPRECATED;
   }
 
+  if (!USER_VERSION_ATLEAST(290, 1)) {
+    /* Zero disables the cache, only initialize preferences saved before it existed. */
+    userdef->modifier_cachelimit = U_default.modifier_cachelimit;
+  }
+
   /**
    * Versioning code until next subversion bump goes here.
    *
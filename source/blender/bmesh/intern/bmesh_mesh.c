@@ -528,6 +528,89 @@ void BM_mesh_normals_update(BMesh *bm)
   MEM_freeN(edgevec);
 }
 
+static void mesh_faces_parallel_range_calc_normals_cb(
+    void *userdata, const int iter, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMFace *f = ((BMFace **)userdata)[iter];
+  BM_face_normal_update(f);
+}
+
+/**
+ * Calculate a single vertex normal from the (already up to date) normals of its faces,
+ * using the same angle weighting & degenerate handling as #BM_mesh_normals_update.
+ */
+static void mesh_verts_parallel_range_calc_normals_cb(
+    void *userdata, const int iter, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMVert *v = ((BMVert **)userdata)[iter];
+  float *v_no = v->no;
+
+  zero_v3(v_no);
+
+  if (v->e) {
+    BMEdge *e_iter, *e_first;
+    e_iter = e_first = v->e;
+    do {
+      if (e_iter->l == NULL) {
+        continue;
+      }
+      BMLoop *l_iter, *l_first;
+      l_iter = l_first = e_iter->l;
+      do {
+        if (l_iter->v != v) {
+          continue;
+        }
+        float e1diff[3], e2diff[3];
+        sub_v3_v3v3(e1diff, l_iter->v->co, l_iter->prev->v->co);
+        sub_v3_v3v3(e2diff, l_iter->next->v->co, l_iter->v->co);
+        normalize_v3(e1diff);
+        normalize_v3(e2diff);
+
+        const float fac = saacos(-dot_v3v3(e1diff, e2diff));
+        if (fac != fac) { /* NAN detection. */
+          /* Degenerated case, nothing to do here, just ignore that vertex. */
+          continue;
+        }
+        madd_v3_v3fl(v_no, l_iter->f->no, fac);
+      } while ((l_iter = l_iter->radial_next) != l_first);
+    } while ((e_iter = BM_DISK_EDGE_NEXT(e_iter, v)) != e_first);
+  }
+
+  if (UNLIKELY(normalize_v3(v_no) == 0.0f)) {
+    normalize_v3_v3(v_no, v->co);
+  }
+}
+
+/**
+ * A version of #BM_mesh_normals_update that only updates
+ * the face & vertex normals referenced by \a bmpinfo.
+ *
+ * Vertex normals are calculated per vertex (instead of accumulating from faces),
+ * so each vertex can be handled in parallel without any locking.
+ */
+void BM_mesh_normals_update_with_partial(BMesh *UNUSED(bm), const BMPartialUpdate *bmpinfo)
+{
+  BLI_assert(bmpinfo->params.do_normals);
+
+  BMVert **verts = bmpinfo->verts;
+  BMFace **faces = bmpinfo->faces;
+  const int verts_len = bmpinfo->verts_len;
+  const int faces_len = bmpinfo->faces_len;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+
+  /* Faces. */
+  settings.use_threading = faces_len >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(
+      0, faces_len, faces, mesh_faces_parallel_range_calc_normals_cb, &settings);
+
+  /* Verts. */
+  settings.use_threading = verts_len >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(
+      0, verts_len, verts, mesh_verts_parallel_range_calc_normals_cb, &settings);
+}
+
 /**
  * \brief BMesh Compute Normals from/to external data.
  *
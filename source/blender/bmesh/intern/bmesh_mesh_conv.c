@@ -81,6 +81,8 @@
 #include "BLI_alloca.h"
 #include "BLI_listbase.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -174,6 +176,216 @@ static BMFace *bm_face_create_from_mpoly(
   return BM_face_create(bm, verts, edges, mp->totloop, NULL, BM_CREATE_SKIP_CD);
 }
 
+/* Custom-data is copied a layer at a time for chunks of elements, instead of all layers of one
+ * element at a time. Chunks are also the unit of work of the parallel conversion. */
+#define BM_CD_CHUNK_SIZE 1024
+
+static int bm_cd_chunks_num(const int len)
+{
+  return (len + BM_CD_CHUNK_SIZE - 1) / BM_CD_CHUNK_SIZE;
+}
+
+/* Consecutive mesh elements, whose custom-data is copied to or from their BMesh blocks together.
+ * Used for faces and loops, where skipped faces and mesh loop order can break a chunk. */
+typedef struct BMCustomDataRun {
+  const CustomData *source;
+  CustomData *dest;
+  /* Index of the first element in the mesh. */
+  int index;
+  int len;
+  void *blocks[BM_CD_CHUNK_SIZE];
+} BMCustomDataRun;
+
+static void bm_cd_run_init(BMCustomDataRun *run, const CustomData *source, CustomData *dest)
+{
+  run->source = source;
+  run->dest = dest;
+  run->index = 0;
+  run->len = 0;
+}
+
+static void bm_cd_run_flush_to_bmesh(BMCustomDataRun *run)
+{
+  if (run->len != 0) {
+    CustomData_to_bmesh_block_array(
+        run->source, run->dest, run->index, run->blocks, run->len, true);
+    run->len = 0;
+  }
+}
+
+static void bm_cd_run_add_to_bmesh(BMCustomDataRun *run, const int index, void *block)
+{
+  if (run->len == BM_CD_CHUNK_SIZE || (run->len != 0 && run->index + run->len != index)) {
+    bm_cd_run_flush_to_bmesh(run);
+  }
+  if (run->len == 0) {
+    run->index = index;
+  }
+  run->blocks[run->len++] = block;
+}
+
+static void bm_cd_run_flush_from_bmesh(BMCustomDataRun *run)
+{
+  if (run->len != 0) {
+    CustomData_from_bmesh_block_array(run->source, run->dest, run->blocks, run->index, run->len);
+    run->len = 0;
+  }
+}
+
+static void bm_cd_run_add_from_bmesh(BMCustomDataRun *run, const int index, void *block)
+{
+  if (run->len == BM_CD_CHUNK_SIZE || (run->len != 0 && run->index + run->len != index)) {
+    bm_cd_run_flush_from_bmesh(run);
+  }
+  if (run->len == 0) {
+    run->index = index;
+  }
+  run->blocks[run->len++] = block;
+}
+
+/* Creating elements uses the BMesh memory pools, which isn't thread-safe, so elements are
+ * created in order first, then their custom-data blocks are filled in parallel. */
+
+typedef struct BMFromMeshData {
+  const Mesh *me;
+  BMesh *bm;
+  BMVert **vtable;
+  BMEdge **etable;
+  /* may contain NULL for skipped faces */
+  BMFace **ftable;
+
+  const float (**shape_key_table)[3];
+  int tot_shape_keys;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+  int cd_shape_key_offset;
+  int cd_shape_keyindex_offset;
+
+  bool calc_face_normal;
+} BMFromMeshData;
+
+/* Fill the custom-data of vertices in [start, end). */
+static void bm_from_me_verts_copy(BMFromMeshData *data, const int start, const int end)
+{
+  const Mesh *me = data->me;
+  void *blocks[BM_CD_CHUNK_SIZE];
+
+  /* Copy Custom Data */
+  for (int i = start; i < end; i++) {
+    blocks[i - start] = data->vtable[i]->head.data;
+  }
+  CustomData_to_bmesh_block_array(&me->vdata, &data->bm->vdata, start, blocks, end - start, true);
+
+  for (int i = start; i < end; i++) {
+    BMVert *v = data->vtable[i];
+
+    if (data->cd_vert_bweight_offset != -1) {
+      BM_ELEM_CD_SET_FLOAT(v, data->cd_vert_bweight_offset, (float)me->mvert[i].bweight / 255.0f);
+    }
+
+    /* Set shape key original index. */
+    if (data->cd_shape_keyindex_offset != -1) {
+      BM_ELEM_CD_SET_INT(v, data->cd_shape_keyindex_offset, i);
+    }
+
+    /* Set shape-key data. */
+    if (data->tot_shape_keys) {
+      float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, data->cd_shape_key_offset);
+      for (int j = 0; j < data->tot_shape_keys; j++, co_dst++) {
+        copy_v3_v3(*co_dst, data->shape_key_table[j][i]);
+      }
+    }
+  }
+}
+
+/* Fill the custom-data of edges in [start, end). */
+static void bm_from_me_edges_copy(BMFromMeshData *data, const int start, const int end)
+{
+  const Mesh *me = data->me;
+  void *blocks[BM_CD_CHUNK_SIZE];
+
+  /* Copy Custom Data */
+  for (int i = start; i < end; i++) {
+    blocks[i - start] = data->etable[i]->head.data;
+  }
+  CustomData_to_bmesh_block_array(&me->edata, &data->bm->edata, start, blocks, end - start, true);
+
+  for (int i = start; i < end; i++) {
+    const MEdge *medge = &me->medge[i];
+    BMEdge *e = data->etable[i];
+
+    if (data->cd_edge_bweight_offset != -1) {
+      BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+    }
+    if (data->cd_edge_crease_offset != -1) {
+      BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_crease_offset, (float)medge->crease / 255.0f);
+    }
+  }
+}
+
+/* Fill the custom-data of faces in [start, end) and their loops. */
+static void bm_from_me_faces_copy(BMFromMeshData *data, const int start, const int end)
+{
+  const Mesh *me = data->me;
+  BMCustomDataRun loop_run, face_run;
+  bm_cd_run_init(&loop_run, &me->ldata, &data->bm->ldata);
+  bm_cd_run_init(&face_run, &me->pdata, &data->bm->pdata);
+
+  for (int i = start; i < end; i++) {
+    BMFace *f = data->ftable[i];
+    BMLoop *l_iter, *l_first;
+
+    if (f == NULL) {
+      continue;
+    }
+
+    int j = me->mpoly[i].loopstart;
+    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+    do {
+      bm_cd_run_add_to_bmesh(&loop_run, j++, l_iter->head.data);
+    } while ((l_iter = l_iter->next) != l_first);
+
+    /* Copy Custom Data */
+    bm_cd_run_add_to_bmesh(&face_run, i, f->head.data);
+
+    if (data->calc_face_normal) {
+      BM_face_normal_update(f);
+    }
+  }
+
+  bm_cd_run_flush_to_bmesh(&loop_run);
+  bm_cd_run_flush_to_bmesh(&face_run);
+}
+
+static void bm_from_me_verts_cb(void *__restrict userdata,
+                                const int chunk,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMFromMeshData *data = userdata;
+  const int start = chunk * BM_CD_CHUNK_SIZE;
+  bm_from_me_verts_copy(data, start, min_ii(start + BM_CD_CHUNK_SIZE, data->me->totvert));
+}
+
+static void bm_from_me_edges_cb(void *__restrict userdata,
+                                const int chunk,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMFromMeshData *data = userdata;
+  const int start = chunk * BM_CD_CHUNK_SIZE;
+  bm_from_me_edges_copy(data, start, min_ii(start + BM_CD_CHUNK_SIZE, data->me->totedge));
+}
+
+static void bm_from_me_faces_cb(void *__restrict userdata,
+                                const int chunk,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMFromMeshData *data = userdata;
+  const int start = chunk * BM_CD_CHUNK_SIZE;
+  bm_from_me_faces_copy(data, start, min_ii(start + BM_CD_CHUNK_SIZE, data->me->totpoly));
+}
+
 /**
  * \brief Mesh -> BMesh
  * \param bm: The mesh to write into, while this is typically a newly created BMesh,
@@ -304,8 +516,41 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
                                            -1;
 
   vtable = MEM_mallocN(sizeof(BMVert **) * me->totvert, __func__);
+  etable = MEM_mallocN(sizeof(BMEdge **) * me->totedge, __func__);
+  /* Needed for the parallel custom-data copy and selection. */
+  ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
+
+  BMFromMeshData data = {
+      .me = me,
+      .bm = bm,
+      .vtable = vtable,
+      .etable = etable,
+      .ftable = ftable,
+      .shape_key_table = shape_key_table,
+      .tot_shape_keys = tot_shape_keys,
+      .cd_vert_bweight_offset = cd_vert_bweight_offset,
+      .cd_edge_bweight_offset = cd_edge_bweight_offset,
+      .cd_edge_crease_offset = cd_edge_crease_offset,
+      .cd_shape_key_offset = cd_shape_key_offset,
+      .cd_shape_keyindex_offset = cd_shape_keyindex_offset,
+      .calc_face_normal = params->calc_face_normal,
+  };
+
+  /* Elements are created serially, their custom-data is copied in parallel afterwards.
+   * Without threads it's copied while creating the elements, a chunk behind, avoiding a second
+   * pass over all elements. */
+  const bool use_threading = BLI_system_thread_count() > 1;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  int chunk_start;
+
+  settings.use_threading = use_threading && (me->totvert >= BM_OMP_LIMIT);
+  for (i = 0, chunk_start = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
+    if (!settings.use_threading && (i - chunk_start == BM_CD_CHUNK_SIZE)) {
+      bm_from_me_verts_copy(&data, chunk_start, i);
+      chunk_start = i;
+    }
 
-  for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
     v = vtable[i] = BM_vert_create(bm, keyco ? keyco[i] : mvert->co, NULL, BM_CREATE_SKIP_CD);
     BM_elem_index_set(v, i); /* set_ok */
 
@@ -319,34 +564,28 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
     normal_short_to_float_v3(v->no, mvert->no);
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
-
-    if (cd_vert_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
-    }
-
-    /* Set shape key original index. */
-    if (cd_shape_keyindex_offset != -1) {
-      BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
-    }
-
-    /* Set shape-key data. */
-    if (tot_shape_keys) {
-      float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
-      for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
-        copy_v3_v3(*co_dst, shape_key_table[j][i]);
-      }
-    }
+    CustomData_bmesh_alloc_block(&bm->vdata, &v->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
   }
 
-  etable = MEM_mallocN(sizeof(BMEdge **) * me->totedge, __func__);
+  if (settings.use_threading) {
+    BLI_task_parallel_range(
+        0, bm_cd_chunks_num(me->totvert), &data, bm_from_me_verts_cb, &settings);
+  }
+  else {
+    bm_from_me_verts_copy(&data, chunk_start, me->totvert);
+  }
 
+  settings.use_threading = use_threading && (me->totedge >= BM_OMP_LIMIT);
   medge = me->medge;
-  for (i = 0; i < me->totedge; i++, medge++) {
+  for (i = 0, chunk_start = 0; i < me->totedge; i++, medge++) {
+    if (!settings.use_threading && (i - chunk_start == BM_CD_CHUNK_SIZE)) {
+      bm_from_me_edges_copy(&data, chunk_start, i);
+      chunk_start = i;
+    }
+
     e = etable[i] = BM_edge_create(
         bm, vtable[medge->v1], vtable[medge->v2], NULL, BM_CREATE_SKIP_CD);
     BM_elem_index_set(e, i); /* set_ok */
@@ -359,36 +598,34 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
       BM_edge_select_set(bm, e, true);
     }
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
-
-    if (cd_edge_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
-    }
-    if (cd_edge_crease_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge->crease / 255.0f);
-    }
+    CustomData_bmesh_alloc_block(&bm->edata, &e->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_EDGE; /* Added in order, clear dirty flag. */
   }
 
-  /* Only needed for selection. */
-  if (me->mselect && me->totselect != 0) {
-    ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
+  if (settings.use_threading) {
+    BLI_task_parallel_range(
+        0, bm_cd_chunks_num(me->totedge), &data, bm_from_me_edges_cb, &settings);
+  }
+  else {
+    bm_from_me_edges_copy(&data, chunk_start, me->totedge);
   }
 
+  settings.use_threading = use_threading && (me->totpoly >= BM_OMP_LIMIT);
   mloop = me->mloop;
   mp = me->mpoly;
-  for (i = 0, totloops = 0; i < me->totpoly; i++, mp++) {
+  for (i = 0, chunk_start = 0, totloops = 0; i < me->totpoly; i++, mp++) {
     BMLoop *l_iter;
     BMLoop *l_first;
 
-    f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
-    if (ftable != NULL) {
-      ftable[i] = f;
+    if (!settings.use_threading && (i - chunk_start == BM_CD_CHUNK_SIZE)) {
+      bm_from_me_faces_copy(&data, chunk_start, i);
+      chunk_start = i;
     }
 
+    f = ftable[i] = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
+
     if (UNLIKELY(f == NULL)) {
       printf(
           "%s: Warning! Bad face in mesh"
@@ -415,27 +652,28 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
       bm->act_face = f;
     }
 
-    int j = mp->loopstart;
     l_iter = l_first = BM_FACE_FIRST_LOOP(f);
     do {
       /* Don't use 'j' since we may have skipped some faces, hence some loops. */
       BM_elem_index_set(l_iter, totloops++); /* set_ok */
 
-      /* Save index of corresponding #MLoop. */
-      CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+      CustomData_bmesh_alloc_block(&bm->ldata, &l_iter->head.data);
     } while ((l_iter = l_iter->next) != l_first);
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
-
-    if (params->calc_face_normal) {
-      BM_face_normal_update(f);
-    }
+    CustomData_bmesh_alloc_block(&bm->pdata, &f->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
   }
 
+  if (settings.use_threading) {
+    BLI_task_parallel_range(
+        0, bm_cd_chunks_num(me->totpoly), &data, bm_from_me_faces_cb, &settings);
+  }
+  else {
+    bm_from_me_faces_copy(&data, chunk_start, me->totpoly);
+  }
+
   /* -------------------------------------------------------------------- */
   /* MSelect clears the array elements (avoid adding multiple times).
    *
@@ -472,9 +710,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
   MEM_freeN(vtable);
   MEM_freeN(etable);
-  if (ftable) {
-    MEM_freeN(ftable);
-  }
+  MEM_freeN(ftable);
 }
 
 /**
@@ -555,15 +791,143 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
   }
 }
 
+typedef struct BMToMeshData {
+  BMesh *bm;
+  Mesh *me;
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+} BMToMeshData;
+
+static void bm_to_me_verts_cb(void *__restrict userdata,
+                              const int chunk,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  const int start = chunk * BM_CD_CHUNK_SIZE;
+  const int end = min_ii(start + BM_CD_CHUNK_SIZE, bm->totvert);
+  void *blocks[BM_CD_CHUNK_SIZE];
+
+  for (int i = start; i < end; i++) {
+    BMVert *v = bm->vtable[i];
+    MVert *mvert = &me->mvert[i];
+
+    copy_v3_v3(mvert->co, v->co);
+    normal_float_to_short_v3(mvert->no, v->no);
+
+    mvert->flag = BM_vert_flag_to_mflag(v);
+
+    if (data->cd_vert_bweight_offset != -1) {
+      mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+    }
+
+    blocks[i - start] = v->head.data;
+
+    BM_CHECK_ELEMENT(v);
+  }
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block_array(&bm->vdata, &me->vdata, blocks, start, end - start);
+}
+
+static void bm_to_me_edges_cb(void *__restrict userdata,
+                              const int chunk,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  const int start = chunk * BM_CD_CHUNK_SIZE;
+  const int end = min_ii(start + BM_CD_CHUNK_SIZE, bm->totedge);
+  void *blocks[BM_CD_CHUNK_SIZE];
+
+  for (int i = start; i < end; i++) {
+    BMEdge *e = bm->etable[i];
+    MEdge *med = &me->medge[i];
+
+    med->v1 = BM_elem_index_get(e->v1);
+    med->v2 = BM_elem_index_get(e->v2);
+
+    med->flag = BM_edge_flag_to_mflag(e);
+
+    bmesh_quick_edgedraw_flag(med, e);
+
+    if (data->cd_edge_crease_offset != -1) {
+      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+    }
+    if (data->cd_edge_bweight_offset != -1) {
+      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+    }
+
+    blocks[i - start] = e->head.data;
+
+    BM_CHECK_ELEMENT(e);
+  }
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block_array(&bm->edata, &me->edata, blocks, start, end - start);
+}
+
+/**
+ * \note Expects #MPoly.loopstart and #MPoly.totloop to be set already.
+ */
+static void bm_to_me_faces_cb(void *__restrict userdata,
+                              const int chunk,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  const int start = chunk * BM_CD_CHUNK_SIZE;
+  const int end = min_ii(start + BM_CD_CHUNK_SIZE, bm->totface);
+  BMCustomDataRun loop_run, face_run;
+  bm_cd_run_init(&loop_run, &bm->ldata, &me->ldata);
+  bm_cd_run_init(&face_run, &bm->pdata, &me->pdata);
+
+  for (int i = start; i < end; i++) {
+    BMFace *f = bm->ftable[i];
+    MPoly *mpoly = &me->mpoly[i];
+    BMLoop *l_iter, *l_first;
+    int j = mpoly->loopstart;
+    MLoop *mloop = &me->mloop[j];
+
+    mpoly->mat_nr = f->mat_nr;
+    mpoly->flag = BM_face_flag_to_mflag(f);
+
+    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+    do {
+      mloop->e = BM_elem_index_get(l_iter->e);
+      mloop->v = BM_elem_index_get(l_iter->v);
+
+      /* Copy over custom-data. */
+      bm_cd_run_add_from_bmesh(&loop_run, j, l_iter->head.data);
+
+      j++;
+      mloop++;
+      BM_CHECK_ELEMENT(l_iter);
+      BM_CHECK_ELEMENT(l_iter->e);
+      BM_CHECK_ELEMENT(l_iter->v);
+    } while ((l_iter = l_iter->next) != l_first);
+
+    /* Copy over custom-data. */
+    bm_cd_run_add_from_bmesh(&face_run, i, f->head.data);
+
+    BM_CHECK_ELEMENT(f);
+  }
+
+  bm_cd_run_flush_from_bmesh(&loop_run);
+  bm_cd_run_flush_from_bmesh(&face_run);
+}
+
 /**
  *
  * \param bmain: May be NULL in case \a calc_object_remap parameter option is not set.
  */
 void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMeshParams *params)
 {
-  MEdge *med;
-  BMVert *v, *eve;
-  BMEdge *e;
+  BMVert *eve;
   BMFace *f;
   BMIter iter;
   int i, j;
@@ -631,91 +995,40 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
   /* This is called again, 'dotess' arg is used there. */
   BKE_mesh_update_customdata_pointers(me, 0);
 
-  i = 0;
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    copy_v3_v3(mvert->co, v->co);
-    normal_float_to_short_v3(mvert->no, v->no);
-
-    mvert->flag = BM_vert_flag_to_mflag(v);
-
-    BM_elem_index_set(v, i); /* set_inline */
+  /* Index values and tables are in iteration order,
+   * this allows elements to be converted in parallel. */
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-    if (cd_vert_bweight_offset != -1) {
-      mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-    }
-
-    i++;
-    mvert++;
-
-    BM_CHECK_ELEMENT(v);
-  }
-  bm->elem_index_dirty &= ~BM_VERT;
-
-  med = medge;
-  i = 0;
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    med->v1 = BM_elem_index_get(e->v1);
-    med->v2 = BM_elem_index_get(e->v2);
-
-    med->flag = BM_edge_flag_to_mflag(e);
-
-    BM_elem_index_set(e, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-    bmesh_quick_edgedraw_flag(med, e);
-
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
-    }
-
-    i++;
-    med++;
-    BM_CHECK_ELEMENT(e);
-  }
-  bm->elem_index_dirty &= ~BM_EDGE;
-
-  i = 0;
   j = 0;
-  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_iter, *l_first;
-    mpoly->loopstart = j;
-    mpoly->totloop = f->len;
-    mpoly->mat_nr = f->mat_nr;
-    mpoly->flag = BM_face_flag_to_mflag(f);
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      mloop->e = BM_elem_index_get(l_iter->e);
-      mloop->v = BM_elem_index_get(l_iter->v);
-
-      /* Copy over custom-data. */
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      j++;
-      mloop++;
-      BM_CHECK_ELEMENT(l_iter);
-      BM_CHECK_ELEMENT(l_iter->e);
-      BM_CHECK_ELEMENT(l_iter->v);
-    } while ((l_iter = l_iter->next) != l_first);
-
+  for (i = 0; i < bm->totface; i++) {
+    f = bm->ftable[i];
+    mpoly[i].loopstart = j;
+    mpoly[i].totloop = f->len;
     if (f == bm->act_face) {
       me->act_face = i;
     }
+    j += f->len;
+  }
 
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
-    i++;
-    mpoly++;
-    BM_CHECK_ELEMENT(f);
+  {
+    BMToMeshData data = {
+        .bm = bm,
+        .me = me,
+        .cd_vert_bweight_offset = cd_vert_bweight_offset,
+        .cd_edge_bweight_offset = cd_edge_bweight_offset,
+        .cd_edge_crease_offset = cd_edge_crease_offset,
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+
+    settings.use_threading = (bm->totvert >= BM_OMP_LIMIT);
+    BLI_task_parallel_range(0, bm_cd_chunks_num(bm->totvert), &data, bm_to_me_verts_cb, &settings);
+    settings.use_threading = (bm->totedge >= BM_OMP_LIMIT);
+    BLI_task_parallel_range(0, bm_cd_chunks_num(bm->totedge), &data, bm_to_me_edges_cb, &settings);
+    settings.use_threading = (bm->totface >= BM_OMP_LIMIT);
+    BLI_task_parallel_range(0, bm_cd_chunks_num(bm->totface), &data, bm_to_me_faces_cb, &settings);
   }
 
   /* Patch hook indices and vertex parents. */
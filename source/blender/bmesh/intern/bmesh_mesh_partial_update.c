@@ -0,0 +1,185 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bmesh
+ *
+ * Generate data needed for partially updating mesh information.
+ * Currently this is used for normals and tessellation.
+ *
+ * Transform is the main user of this,
+ * where only a small part of the mesh is being transformed.
+ *
+ * Elements are looked up using their indices,
+ * the caller must ensure vertex indices are valid when creating the lookup
+ * and that no geometry is added or removed while it's in use.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_math_base.h"
+#include "BLI_utildefines.h"
+
+#include "bmesh.h"
+
+/**
+ * Grow by 1.5x (rounding up).
+ *
+ * \note Use conservative reallocation since the initial sizes reserved
+ * may be close to (or exactly) the number of elements needed.
+ */
+#define GROW(len_alloc) ((len_alloc) + ((len_alloc) - ((len_alloc) / 2)))
+#define GROW_ARRAY(mem, len_alloc) \
+  { \
+    mem = MEM_reallocN(mem, (sizeof(*mem)) * ((len_alloc) = GROW(len_alloc))); \
+  } \
+  ((void)0)
+
+#define GROW_ARRAY_AS_NEEDED(mem, len_alloc, index) \
+  if (UNLIKELY(len_alloc == index)) { \
+    GROW_ARRAY(mem, len_alloc); \
+  }
+
+BLI_INLINE bool partial_elem_vert_ensure(BMPartialUpdate *bmpinfo,
+                                         BLI_bitmap *verts_tag,
+                                         BMVert *v)
+{
+  const int i = BM_elem_index_get(v);
+  if (!BLI_BITMAP_TEST(verts_tag, i)) {
+    BLI_BITMAP_ENABLE(verts_tag, i);
+    GROW_ARRAY_AS_NEEDED(bmpinfo->verts, bmpinfo->verts_len_alloc, bmpinfo->verts_len);
+    bmpinfo->verts[bmpinfo->verts_len++] = v;
+    return true;
+  }
+  return false;
+}
+
+BLI_INLINE bool partial_elem_face_ensure(BMPartialUpdate *bmpinfo,
+                                         BLI_bitmap *faces_tag,
+                                         BMFace *f)
+{
+  const int i = BM_elem_index_get(f);
+  if (!BLI_BITMAP_TEST(faces_tag, i)) {
+    BLI_BITMAP_ENABLE(faces_tag, i);
+    GROW_ARRAY_AS_NEEDED(bmpinfo->faces, bmpinfo->faces_len_alloc, bmpinfo->faces_len);
+    bmpinfo->faces[bmpinfo->faces_len++] = f;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Create a lookup of the faces (and vertices when normals are needed)
+ * affected by moving the vertices enabled in \a verts_mask.
+ *
+ * \param verts_mask: Bitmap indexed by vertex index.
+ * \param verts_mask_count: The number of enabled bits in \a verts_mask,
+ * used to reserve memory (it's not a problem if this is an estimate).
+ */
+BMPartialUpdate *BM_mesh_partial_create_from_verts(BMesh *bm,
+                                                   const BMPartialUpdate_Params *params,
+                                                   const BLI_bitmap *verts_mask,
+                                                   const int verts_mask_count)
+{
+  /* The caller is doing something wrong if this isn't the case. */
+  BLI_assert(verts_mask_count <= bm->totvert);
+
+  BMPartialUpdate *bmpinfo = MEM_callocN(sizeof(*bmpinfo), __func__);
+
+  /* Reserve for the masked vertices, the arrays grow when more are needed. */
+  const int default_verts_len_alloc = verts_mask_count;
+  const int default_faces_len_alloc = min_ii(bm->totface, verts_mask_count);
+
+  /* Only assign verts if normals are being recalculated. */
+  BLI_bitmap *verts_tag = NULL;
+  if (params->do_normals) {
+    bmpinfo->verts_len_alloc = max_ii(default_verts_len_alloc, 1);
+    bmpinfo->verts = MEM_mallocN((sizeof(BMVert *) * bmpinfo->verts_len_alloc), __func__);
+    verts_tag = BLI_BITMAP_NEW((size_t)bm->totvert, __func__);
+  }
+
+  /* Faces are always needed, both normals & tessellation depend on them. */
+  bmpinfo->faces_len_alloc = max_ii(default_faces_len_alloc, 1);
+  bmpinfo->faces = MEM_mallocN((sizeof(BMFace *) * bmpinfo->faces_len_alloc), __func__);
+  BLI_bitmap *faces_tag = BLI_BITMAP_NEW((size_t)bm->totface, __func__);
+
+  /* The vertex mask uses vertex indices, faces are tagged using their indices too. */
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_FACE);
+
+  BMVert *v;
+  BMIter iter;
+  int i;
+  BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+    if (!BLI_BITMAP_TEST(verts_mask, i)) {
+      continue;
+    }
+    if (params->do_normals) {
+      /* Needed for loose vertices, which don't have any faces. */
+      partial_elem_vert_ensure(bmpinfo, verts_tag, v);
+    }
+    if (v->e == NULL) {
+      continue;
+    }
+
+    /* Moving a vertex changes the normal & tessellation of all faces using it. */
+    BMEdge *e_iter, *e_first;
+    e_iter = e_first = v->e;
+    do {
+      if (e_iter->l == NULL) {
+        continue;
+      }
+      BMLoop *l_iter, *l_first;
+      l_iter = l_first = e_iter->l;
+      do {
+        if (l_iter->v == v) {
+          partial_elem_face_ensure(bmpinfo, faces_tag, l_iter->f);
+        }
+      } while ((l_iter = l_iter->radial_next) != l_first);
+    } while ((e_iter = BM_DISK_EDGE_NEXT(e_iter, v)) != e_first);
+  }
+
+  if (params->do_normals) {
+    /* Every vertex of a changed face needs its normal recalculated,
+     * as the face normal (and the angle at the vertex) may have changed. */
+    for (i = 0; i < bmpinfo->faces_len; i++) {
+      BMFace *f = bmpinfo->faces[i];
+      BMLoop *l_iter, *l_first;
+      l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+      do {
+        partial_elem_vert_ensure(bmpinfo, verts_tag, l_iter->v);
+      } while ((l_iter = l_iter->next) != l_first);
+    }
+    MEM_freeN(verts_tag);
+  }
+
+  MEM_freeN(faces_tag);
+
+  bmpinfo->params = *params;
+
+  return bmpinfo;
+}
+
+void BM_mesh_partial_destroy(BMPartialUpdate *bmpinfo)
+{
+  if (bmpinfo->verts) {
+    MEM_freeN(bmpinfo->verts);
+  }
+  if (bmpinfo->faces) {
+    MEM_freeN(bmpinfo->faces);
+  }
+  MEM_freeN(bmpinfo);
+}
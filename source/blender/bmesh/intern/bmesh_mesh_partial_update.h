@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __BMESH_MESH_PARTIAL_UPDATE_H__
+#define __BMESH_MESH_PARTIAL_UPDATE_H__
+
+/** \file
+ * \ingroup bmesh
+ */
+
+#include "BLI_bitmap.h"
+#include "BLI_compiler_attrs.h"
+
+/**
+ * Parameters used to determine which kinds of data needs to be generated.
+ */
+typedef struct BMPartialUpdate_Params {
+  bool do_normals;
+  bool do_tessellate;
+} BMPartialUpdate_Params;
+
+/**
+ * Cached data to speed up partial updates.
+ *
+ * Hints:
+ *
+ * - Avoid creating this data for small updates,
+ *   as there is an overhead in creating the lookup.
+ *
+ * - Geometry must be unchanged between creating/using this data,
+ *   (element indices are used to look up the affected geometry).
+ */
+typedef struct BMPartialUpdate {
+  /** Vertices which need their normals recalculated. */
+  BMVert **verts;
+  int verts_len, verts_len_alloc;
+
+  /** Faces which need their normals (and tessellation) recalculated. */
+  BMFace **faces;
+  int faces_len, faces_len_alloc;
+
+  /** Store the parameters used in creation so invalid use can be asserted. */
+  BMPartialUpdate_Params params;
+} BMPartialUpdate;
+
+BMPartialUpdate *BM_mesh_partial_create_from_verts(BMesh *bm,
+                                                   const BMPartialUpdate_Params *params,
+                                                   const BLI_bitmap *verts_mask,
+                                                   const int verts_mask_count)
+    ATTR_NONNULL(1, 2, 3) ATTR_WARN_UNUSED_RESULT;
+
+void BM_mesh_partial_destroy(BMPartialUpdate *bmpinfo) ATTR_NONNULL(1);
+
+#endif /* __BMESH_MESH_PARTIAL_UPDATE_H__ */
@@ -35,6 +35,7 @@
 #include "BLI_memarena.h"
 #include "BLI_polyfill_2d.h"
 #include "BLI_polyfill_2d_beautify.h"
+#include "BLI_task.h"
 
 #include "bmesh.h"
 #include "bmesh_tools.h"
@@ -1528,139 +1529,133 @@ void BM_face_as_array_loop_quad(BMFace *f, BMLoop *r_loops[4])
   r_loops[3] = l;
 }
 
+/* use this to avoid locking pthread for _every_ polygon
+ * and calling the fill function */
+#define USE_TESSFACE_SPEEDUP
+
 /**
- * \brief BM_mesh_calc_tessellation get the looptris and its number from a certain bmesh
- * \param looptris:
+ * Tessellate a single face into \a looptris.
  *
- * \note \a looptris Must be pre-allocated to at least the size of given by: poly_to_tri_count
+ * \param pf_arena_p: Lazily allocated arena used for ngons,
+ * cleared (not freed) after each use.
+ * \return The number of triangles written (always `efa->len - 2` for valid faces).
  */
-void BM_mesh_calc_tessellation(BMesh *bm, BMLoop *(*looptris)[3], int *r_looptris_tot)
+BLI_INLINE int bm_face_calc_tessellation_looptris(BMFace *efa,
+                                                  BMLoop *(*looptris)[3],
+                                                  MemArena **pf_arena_p)
 {
-  /* use this to avoid locking pthread for _every_ polygon
-   * and calling the fill function */
-#define USE_TESSFACE_SPEEDUP
+  int i = 0;
 
-  /* this assumes all faces can be scan-filled, which isn't always true,
-   * worst case we over alloc a little which is acceptable */
-#ifndef NDEBUG
-  const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
-#endif
+  /* don't consider two-edged faces */
+  if (UNLIKELY(efa->len < 3)) {
+    /* do nothing */
+  }
 
-  BMIter iter;
-  BMFace *efa;
-  int i = 0;
+#ifdef USE_TESSFACE_SPEEDUP
 
-  MemArena *arena = NULL;
+  /* no need to ensure the loop order, we know its ok */
 
-  BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
-    /* don't consider two-edged faces */
-    if (UNLIKELY(efa->len < 3)) {
-      /* do nothing */
+  else if (efa->len == 3) {
+    /* more cryptic but faster */
+    BMLoop *l;
+    BMLoop **l_ptr = looptris[i++];
+    l_ptr[0] = l = BM_FACE_FIRST_LOOP(efa);
+    l_ptr[1] = l = l->next;
+    l_ptr[2] = l->next;
+  }
+  else if (efa->len == 4) {
+    /* more cryptic but faster */
+    BMLoop *l;
+    BMLoop **l_ptr_a = looptris[i++];
+    BMLoop **l_ptr_b = looptris[i++];
+    (l_ptr_a[0] = l_ptr_b[0] = l = BM_FACE_FIRST_LOOP(efa));
+    (l_ptr_a[1] = l = l->next);
+    (l_ptr_a[2] = l_ptr_b[1] = l = l->next);
+    (l_ptr_b[2] = l->next);
+
+    if (UNLIKELY(is_quad_flip_v3_first_third_fast(
+            l_ptr_a[0]->v->co, l_ptr_a[1]->v->co, l_ptr_a[2]->v->co, l_ptr_b[2]->v->co))) {
+      /* flip out of degenerate 0-2 state. */
+      l_ptr_a[2] = l_ptr_b[2];
+      l_ptr_b[0] = l_ptr_a[1];
     }
+  }
 
-#ifdef USE_TESSFACE_SPEEDUP
+#endif /* USE_TESSFACE_SPEEDUP */
 
-    /* no need to ensure the loop order, we know its ok */
+  else {
+    int j;
 
-    else if (efa->len == 3) {
-#  if 0
-      int j;
-      BM_ITER_ELEM_INDEX(l, &liter, efa, BM_LOOPS_OF_FACE, j) {
-        looptris[i][j] = l;
-      }
-      i += 1;
-#  else
-      /* more cryptic but faster */
-      BMLoop *l;
-      BMLoop **l_ptr = looptris[i++];
-      l_ptr[0] = l = BM_FACE_FIRST_LOOP(efa);
-      l_ptr[1] = l = l->next;
-      l_ptr[2] = l->next;
-#  endif
-    }
-    else if (efa->len == 4) {
-#  if 0
-      BMLoop *ltmp[4];
-      int j;
-      BLI_array_grow_items(looptris, 2);
-      BM_ITER_ELEM_INDEX(l, &liter, efa, BM_LOOPS_OF_FACE, j) {
-        ltmp[j] = l;
-      }
+    BMLoop *l_iter;
+    BMLoop *l_first;
+    BMLoop **l_arr;
 
-      looptris[i][0] = ltmp[0];
-      looptris[i][1] = ltmp[1];
-      looptris[i][2] = ltmp[2];
-      i += 1;
-
-      looptris[i][0] = ltmp[0];
-      looptris[i][1] = ltmp[2];
-      looptris[i][2] = ltmp[3];
-      i += 1;
-#  else
-      /* more cryptic but faster */
-      BMLoop *l;
-      BMLoop **l_ptr_a = looptris[i++];
-      BMLoop **l_ptr_b = looptris[i++];
-      (l_ptr_a[0] = l_ptr_b[0] = l = BM_FACE_FIRST_LOOP(efa));
-      (l_ptr_a[1] = l = l->next);
-      (l_ptr_a[2] = l_ptr_b[1] = l = l->next);
-      (l_ptr_b[2] = l->next);
-#  endif
-
-      if (UNLIKELY(is_quad_flip_v3_first_third_fast(
-              l_ptr_a[0]->v->co, l_ptr_a[1]->v->co, l_ptr_a[2]->v->co, l_ptr_b[2]->v->co))) {
-        /* flip out of degenerate 0-2 state. */
-        l_ptr_a[2] = l_ptr_b[2];
-        l_ptr_b[0] = l_ptr_a[1];
-      }
+    float axis_mat[3][3];
+    float(*projverts)[2];
+    uint(*tris)[3];
+
+    const int totfilltri = efa->len - 2;
+
+    MemArena *arena = *pf_arena_p;
+    if (UNLIKELY(arena == NULL)) {
+      arena = *pf_arena_p = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
     }
 
-#endif /* USE_TESSFACE_SPEEDUP */
+    tris = BLI_memarena_alloc(arena, sizeof(*tris) * totfilltri);
+    l_arr = BLI_memarena_alloc(arena, sizeof(*l_arr) * efa->len);
+    projverts = BLI_memarena_alloc(arena, sizeof(*projverts) * efa->len);
 
-    else {
-      int j;
+    axis_dominant_v3_to_m3_negate(axis_mat, efa->no);
 
-      BMLoop *l_iter;
-      BMLoop *l_first;
-      BMLoop **l_arr;
+    j = 0;
+    l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
+    do {
+      l_arr[j] = l_iter;
+      mul_v2_m3v3(projverts[j], axis_mat, l_iter->v->co);
+      j++;
+    } while ((l_iter = l_iter->next) != l_first);
 
-      float axis_mat[3][3];
-      float(*projverts)[2];
-      uint(*tris)[3];
+    BLI_polyfill_calc_arena(projverts, efa->len, 1, tris, arena);
 
-      const int totfilltri = efa->len - 2;
+    for (j = 0; j < totfilltri; j++) {
+      BMLoop **l_ptr = looptris[i++];
+      uint *tri = tris[j];
 
-      if (UNLIKELY(arena == NULL)) {
-        arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
-      }
+      l_ptr[0] = l_arr[tri[0]];
+      l_ptr[1] = l_arr[tri[1]];
+      l_ptr[2] = l_arr[tri[2]];
+    }
 
-      tris = BLI_memarena_alloc(arena, sizeof(*tris) * totfilltri);
-      l_arr = BLI_memarena_alloc(arena, sizeof(*l_arr) * efa->len);
-      projverts = BLI_memarena_alloc(arena, sizeof(*projverts) * efa->len);
+    BLI_memarena_clear(arena);
+  }
 
-      axis_dominant_v3_to_m3_negate(axis_mat, efa->no);
+  return i;
+}
 
-      j = 0;
-      l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
-      do {
-        l_arr[j] = l_iter;
-        mul_v2_m3v3(projverts[j], axis_mat, l_iter->v->co);
-        j++;
-      } while ((l_iter = l_iter->next) != l_first);
+#undef USE_TESSFACE_SPEEDUP
 
-      BLI_polyfill_calc_arena(projverts, efa->len, 1, tris, arena);
+/**
+ * \brief BM_mesh_calc_tessellation get the looptris and its number from a certain bmesh
+ * \param looptris:
+ *
+ * \note \a looptris Must be pre-allocated to at least the size of given by: poly_to_tri_count
+ */
+void BM_mesh_calc_tessellation(BMesh *bm, BMLoop *(*looptris)[3], int *r_looptris_tot)
+{
+  /* this assumes all faces can be scan-filled, which isn't always true,
+   * worst case we over alloc a little which is acceptable */
+#ifndef NDEBUG
+  const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
+#endif
 
-      for (j = 0; j < totfilltri; j++) {
-        BMLoop **l_ptr = looptris[i++];
-        uint *tri = tris[j];
+  BMIter iter;
+  BMFace *efa;
+  int i = 0;
 
-        l_ptr[0] = l_arr[tri[0]];
-        l_ptr[1] = l_arr[tri[1]];
-        l_ptr[2] = l_arr[tri[2]];
-      }
+  MemArena *arena = NULL;
 
-      BLI_memarena_clear(arena);
-    }
+  BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
+    i += bm_face_calc_tessellation_looptris(efa, looptris + i, &arena);
   }
 
   if (arena) {
@@ -1671,8 +1666,71 @@ void BM_mesh_calc_tessellation(BMesh *bm, BMLoop *(*looptris)[3], int *r_looptri
   *r_looptris_tot = i;
 
   BLI_assert(i <= looptris_tot);
+}
 
-#undef USE_TESSFACE_SPEEDUP
+typedef struct PartialTessellationUserData {
+  BMFace **faces;
+  BMLoop *(*looptris)[3];
+} PartialTessellationUserData;
+
+typedef struct PartialTessellationUserTLS {
+  MemArena *pf_arena;
+} PartialTessellationUserTLS;
+
+static void bm_mesh_calc_tessellation_with_partial__func(
+    void *__restrict userdata, const int index, const TaskParallelTLS *__restrict tls)
+{
+  PartialTessellationUserTLS *tls_data = tls->userdata_chunk;
+  PartialTessellationUserData *data = userdata;
+  BMFace *f = data->faces[index];
+  BMLoop *l = BM_FACE_FIRST_LOOP(f);
+  /* Faces are stored contiguously, with all faces having at least three sides,
+   * so the offset of the first triangle can be derived from the loop & face indices. */
+  const int offset = BM_elem_index_get(l) - (BM_elem_index_get(f) * 2);
+  bm_face_calc_tessellation_looptris(f, data->looptris + offset, &tls_data->pf_arena);
+}
+
+static void bm_mesh_calc_tessellation_with_partial__free_fn(
+    const void *__restrict UNUSED(userdata), void *__restrict tls_v)
+{
+  PartialTessellationUserTLS *tls_data = tls_v;
+  if (tls_data->pf_arena) {
+    BLI_memarena_free(tls_data->pf_arena);
+  }
+}
+
+/**
+ * Re-calculate the triangles of faces in \a bmpinfo,
+ * leaving the triangles of all other faces untouched.
+ *
+ * \note \a looptris must already contain a valid tessellation of \a bm
+ * (its size can't change as the topology is unchanged).
+ */
+void BM_mesh_calc_tessellation_with_partial(BMesh *bm,
+                                            BMLoop *(*looptris)[3],
+                                            const BMPartialUpdate *bmpinfo)
+{
+  BLI_assert(bmpinfo->params.do_tessellate);
+
+  /* Needed for calculating the triangle offset of each face. */
+  BM_mesh_elem_index_ensure(bm, BM_LOOP | BM_FACE);
+
+  PartialTessellationUserTLS tls_dummy = {NULL};
+
+  PartialTessellationUserData data = {
+      .faces = bmpinfo->faces,
+      .looptris = looptris,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = bmpinfo->faces_len >= BM_OMP_LIMIT;
+  settings.userdata_chunk = &tls_dummy;
+  settings.userdata_chunk_size = sizeof(tls_dummy);
+  settings.func_free = bm_mesh_calc_tessellation_with_partial__free_fn;
+
+  BLI_task_parallel_range(
+      0, bmpinfo->faces_len, &data, bm_mesh_calc_tessellation_with_partial__func, &settings);
 }
 
 /**
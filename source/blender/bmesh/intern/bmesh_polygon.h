@@ -21,11 +21,15 @@
  * \ingroup bmesh
  */
 
+struct BMPartialUpdate;
 struct Heap;
 
 #include "BLI_compiler_attrs.h"
 
 void BM_mesh_calc_tessellation(BMesh *bm, BMLoop *(*looptris)[3], int *r_looptris_tot);
+void BM_mesh_calc_tessellation_with_partial(BMesh *bm,
+                                            BMLoop *(*looptris)[3],
+                                            const struct BMPartialUpdate *bmpinfo);
 void BM_mesh_calc_tessellation_beauty(BMesh *bm, BMLoop *(*looptris)[3], int *r_looptris_tot);
 
 void BM_face_calc_tessellation(const BMFace *f,
@@ -27,6 +27,7 @@
 #include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BLI_stack.h"
+#include "BLI_task.h"
 #include "BLI_utildefines_stack.h"
 
 #include "BKE_customdata.h"
@@ -34,14 +35,27 @@
 #include "bmesh.h"
 #include "intern/bmesh_operators_private.h"
 
-static void remdoubles_splitface(BMFace *f, BMesh *bm, BMOperator *op, BMOpSlot *slot_targetmap)
+#define ELE_DEL 1
+#define EDGE_COL 2
+#define VERT_IN_FACE 4
+/* Faces using merged verts. Each element type has its own tool flags,
+ * so this can use the same bit as #EDGE_COL. */
+#define FACE_VERT_DEL 2
+
+/**
+ * Lookup the target of a merged vertex, see #bmo_weld_verts_exec.
+ * Unlike the slot-map (a hash), \a vert_map is indexed by the vertex index.
+ */
+#define VERT_MAP_GET(vert_map, v) ((vert_map)[BM_elem_index_get(v)])
+
+static void remdoubles_splitface(BMFace *f, BMesh *bm, BMVert **vert_map)
 {
   BMIter liter;
   BMLoop *l, *l_tar, *l_double;
   bool split = false;
 
   BM_ITER_ELEM (l, &liter, f, BM_LOOPS_OF_FACE) {
-    BMVert *v_tar = BMO_slot_map_elem_get(slot_targetmap, l->v);
+    BMVert *v_tar = VERT_MAP_GET(vert_map, l->v);
     /* ok: if v_tar is NULL (e.g. not in the map) then it's
      *     a target vert, otherwise it's a double */
     if (v_tar) {
@@ -60,23 +74,18 @@ static void remdoubles_splitface(BMFace *f, BMesh *bm, BMOperator *op, BMOpSlot
     BMFace *f_new;
 
     f_new = BM_face_split(bm, f, l_double, l_tar, &l_new, NULL, false);
+    /* Both sides of the split use the merged vertex. */
+    BMO_face_flag_enable(bm, f_new, FACE_VERT_DEL);
 
-    remdoubles_splitface(f, bm, op, slot_targetmap);
-    remdoubles_splitface(f_new, bm, op, slot_targetmap);
+    remdoubles_splitface(f, bm, vert_map);
+    remdoubles_splitface(f_new, bm, vert_map);
   }
 }
 
-#define ELE_DEL 1
-#define EDGE_COL 2
-#define VERT_IN_FACE 4
-
 /**
  * helper function for bmo_weld_verts_exec so we can use stack memory
  */
-static BMFace *remdoubles_createface(BMesh *bm,
-                                     BMFace *f,
-                                     BMOpSlot *slot_targetmap,
-                                     bool *r_created)
+static BMFace *remdoubles_createface(BMesh *bm, BMFace *f, BMVert **vert_map, bool *r_created)
 {
   BMEdge *e_new;
 
@@ -102,7 +111,7 @@ static BMFace *remdoubles_createface(BMesh *bm,
   v_map = l_init->v; \
   is_del = BMO_vert_flag_test_bool(bm, v_map, ELE_DEL); \
   if (is_del) { \
-    v_map = BMO_slot_map_elem_get(slot_targetmap, v_map); \
+    v_map = VERT_MAP_GET(vert_map, v_map); \
   } \
   ((void)0)
 
@@ -183,6 +192,20 @@ finally : {
   return NULL;
 }
 
+static void remdoubles_face_tag_cb(void *userdata, MempoolIterData *mp_f)
+{
+  BMesh *bm = userdata;
+  BMFace *f = (BMFace *)mp_f;
+  BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    if (BMO_vert_flag_test(bm, l_iter->v, ELE_DEL)) {
+      BMO_face_flag_enable(bm, f, FACE_VERT_DEL);
+      break;
+    }
+  } while ((l_iter = l_iter->next) != l_first);
+}
+
 /**
  * \note with 'targetmap', multiple 'keys' are currently supported,
  * though no callers should be using.
@@ -191,11 +214,11 @@ finally : {
 void bmo_weld_verts_exec(BMesh *bm, BMOperator *op)
 {
   BMIter iter, liter;
+  BMOIter oiter;
   BMVert *v;
   BMEdge *e;
   BMLoop *l;
   BMFace *f;
-  BMOpSlot *slot_targetmap = BMO_slot_get(op->slots_in, "targetmap");
 
   /* Maintain selection history. */
   const bool has_selected = !BLI_listbase_is_empty(&bm->selected);
@@ -206,11 +229,17 @@ void bmo_weld_verts_exec(BMesh *bm, BMOperator *op)
     targetmap_all = BLI_ghash_ptr_new(__func__);
   }
 
+  /* Resolve the target-map once, vertices are neither added or removed until the end,
+   * so their indices can be used to lookup targets instead of the slot-map. */
+  BM_mesh_elem_index_ensure(bm, BM_VERT);
+  BMVert **vert_map = MEM_callocN(sizeof(*vert_map) * (size_t)bm->totvert, __func__);
+
   /* mark merge verts for deletion */
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    BMVert *v_dst = BMO_slot_map_elem_get(slot_targetmap, v);
+  BMO_ITER (v, &oiter, op->slots_in, "targetmap", 0) {
+    BMVert *v_dst = BMO_iter_map_value_ptr(&oiter);
     if (v_dst != NULL) {
       BMO_vert_flag_enable(bm, v, ELE_DEL);
+      VERT_MAP_GET(vert_map, v) = v_dst;
 
       /* merge the vertex flags, else we get randomly selected/unselected verts */
       BM_elem_flag_merge_ex(v, v_dst, BM_ELEM_HIDDEN);
@@ -222,10 +251,15 @@ void bmo_weld_verts_exec(BMesh *bm, BMOperator *op)
     }
   }
 
+  /* Tag faces using merged verts, only these need to be split or rebuilt. */
+  BM_iter_parallel(bm, BM_FACES_OF_MESH, remdoubles_face_tag_cb, bm, bm->totface >= BM_OMP_LIMIT);
+
   /* check if any faces are getting their own corners merged
    * together, split face if so */
   BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    remdoubles_splitface(f, bm, op, slot_targetmap);
+    if (BMO_face_flag_test(bm, f, FACE_VERT_DEL)) {
+      remdoubles_splitface(f, bm, vert_map);
+    }
   }
 
   BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
@@ -235,10 +269,10 @@ void bmo_weld_verts_exec(BMesh *bm, BMOperator *op)
 
     if (is_del_v1 || is_del_v2) {
       if (is_del_v1) {
-        v1 = BMO_slot_map_elem_get(slot_targetmap, v1);
+        v1 = VERT_MAP_GET(vert_map, v1);
       }
       if (is_del_v2) {
-        v2 = BMO_slot_map_elem_get(slot_targetmap, v2);
+        v2 = VERT_MAP_GET(vert_map, v2);
       }
 
       if (v1 == v2) {
@@ -264,55 +298,53 @@ void bmo_weld_verts_exec(BMesh *bm, BMOperator *op)
   /* faces get "modified" by creating new faces here, then at the
    * end the old faces are deleted */
   BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    bool vert_delete = false;
+    bool use_in_place = false;
+    BMFace *f_new = NULL;
     int edge_collapse = 0;
 
+    if (!BMO_face_flag_test(bm, f, FACE_VERT_DEL)) {
+      continue;
+    }
+
     BM_ITER_ELEM (l, &liter, f, BM_LOOPS_OF_FACE) {
-      if (BMO_vert_flag_test(bm, l->v, ELE_DEL)) {
-        vert_delete = true;
-      }
       if (BMO_edge_flag_test(bm, l->e, EDGE_COL)) {
         edge_collapse++;
       }
     }
 
-    if (vert_delete) {
-      bool use_in_place = false;
-      BMFace *f_new = NULL;
-      BMO_face_flag_enable(bm, f, ELE_DEL);
-
-      if (f->len - edge_collapse >= 3) {
-        bool created;
-        f_new = remdoubles_createface(bm, f, slot_targetmap, &created);
-        /* do this so we don't need to return a list of created faces */
-        if (f_new) {
-          if (created) {
-            bmesh_face_swap_data(f_new, f);
-
-            if (bm->use_toolflags) {
-              SWAP(BMFlagLayer *, ((BMFace_OFlag *)f)->oflags, ((BMFace_OFlag *)f_new)->oflags);
-            }
-
-            BMO_face_flag_disable(bm, f, ELE_DEL);
-            BM_face_kill(bm, f_new);
-            use_in_place = true;
-          }
-          else {
-            BM_elem_flag_merge_ex(f_new, f, BM_ELEM_HIDDEN);
+    BMO_face_flag_enable(bm, f, ELE_DEL);
+
+    if (f->len - edge_collapse >= 3) {
+      bool created;
+      f_new = remdoubles_createface(bm, f, vert_map, &created);
+      /* do this so we don't need to return a list of created faces */
+      if (f_new) {
+        if (created) {
+          bmesh_face_swap_data(f_new, f);
+
+          if (bm->use_toolflags) {
+            SWAP(BMFlagLayer *, ((BMFace_OFlag *)f)->oflags, ((BMFace_OFlag *)f_new)->oflags);
           }
-        }
-      }
 
-      if ((use_in_place == false) && (f_new != NULL)) {
-        BLI_assert(f != f_new);
-        if (use_targetmap_all) {
-          BLI_ghash_insert(targetmap_all, f, f_new);
+          BMO_face_flag_disable(bm, f, ELE_DEL);
+          BM_face_kill(bm, f_new);
+          use_in_place = true;
         }
-        if (bm->act_face && (f == bm->act_face)) {
-          bm->act_face = f_new;
+        else {
+          BM_elem_flag_merge_ex(f_new, f, BM_ELEM_HIDDEN);
         }
       }
     }
+
+    if ((use_in_place == false) && (f_new != NULL)) {
+      BLI_assert(f != f_new);
+      if (use_targetmap_all) {
+        BLI_ghash_insert(targetmap_all, f, f_new);
+      }
+      if (bm->act_face && (f == bm->act_face)) {
+        bm->act_face = f_new;
+      }
+    }
   }
 
   if (has_selected) {
@@ -323,6 +355,8 @@ void bmo_weld_verts_exec(BMesh *bm, BMOperator *op)
     BLI_ghash_free(targetmap_all, NULL, NULL);
   }
 
+  MEM_freeN(vert_map);
+
   BMO_mesh_delete_oflag_context(bm, ELE_DEL, DEL_ONLYTAGGED);
 }
 
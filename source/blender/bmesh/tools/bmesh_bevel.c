@@ -28,8 +28,11 @@
 
 #include "BLI_alloca.h"
 #include "BLI_array.h"
+#include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.h"
@@ -253,13 +256,19 @@ typedef struct BevVert {
   bool any_seam;
   /** Used in graph traversal for adjusting offsets. */
   bool visited;
+  /** The #vmesh_adj is built with #build_square_in_vmesh. */
+  bool vmesh_adj_square_in;
   /** Array of size edgecount; CCW order from vertex normal side. */
-  char _pad[6];
+  char _pad[5];
   EdgeHalf *edges;
   /** Array of size wirecount of wire edges. */
   BMEdge **wire_edges;
   /** Mesh structure for replacing vertex. */
   VMesh *vmesh;
+  /** Result of #pipe_test, set by #build_vmesh_calc. */
+  BoundVert *vpipe;
+  /** Subdivided mesh used by #bevel_build_rings, set by #build_vmesh_calc. */
+  VMesh *vmesh_adj;
 } BevVert;
 
 /* Face classification. Note: depends on F_RECON > F_EDGE > F_VERT .*/
@@ -294,6 +303,8 @@ typedef struct BevelParams {
   GHash *face_hash;
   /** Use for all allocs while bevel runs. Note: If we need to free we can switch to mempool. */
   MemArena *mem_arena;
+  /** Arenas used by threads for parallel calculations, freed along with #mem_arena. */
+  LinkNode *mem_arena_threads;
   /** Profile vertex location and spacings. */
   ProfileSpacing pro_spacing;
   /** Parameter values for evenly spaced profile points for the miter profiles. */
@@ -4805,23 +4816,21 @@ static VMesh *square_out_adj_vmesh(BevelParams *bp, BevVert *bv)
  * calculate the positions of the interior mesh points for the M_ADJ pattern,
  * using cubic subdivision, then make the BMVerts and the new faces.
  */
-static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv, BoundVert *vpipe)
+/**
+ * Calculate the subdivided vertex mesh used by #bevel_build_rings.
+ * Only positions are calculated, no #BMesh data is created.
+ *
+ * \param r_square_in: Set when the mesh must be built with #build_square_in_vmesh.
+ */
+static VMesh *bevel_build_rings_adj_vmesh(BevelParams *bp,
+                                          BevVert *bv,
+                                          BoundVert *vpipe,
+                                          bool *r_square_in)
 {
-  int n_bndv, ns, ns2, odd, i, j, k, ring;
-  VMesh *vm1, *vm;
-  BoundVert *bndv;
-  BMVert *bmv1, *bmv2, *bmv3, *bmv4;
-  BMFace *f, *f2, *r_f;
-  BMEdge *bme, *bme1, *bme2, *bme3;
-  EdgeHalf *e;
-  int mat_nr = bp->mat_nr;
-
-  n_bndv = bv->vmesh->count;
-  ns = bv->vmesh->seg;
-  ns2 = ns / 2;
-  odd = ns % 2;
-  BLI_assert(n_bndv >= 3 && ns > 1);
+  VMesh *vm1;
+  const bool odd = (bv->vmesh->seg % 2) != 0;
 
+  *r_square_in = false;
   if (bp->pro_super_r == PRO_SQUARE_R && bv->selcount >= 3 && !odd && !bp->use_custom_profile) {
     vm1 = square_out_adj_vmesh(bp, bv);
   }
@@ -4833,13 +4842,39 @@ static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv, BoundVert
     /* The PRO_SQUARE_IN_R profile has boundary edges that merge
      * and no internal ring polys except possibly center ngon. */
     if (bp->pro_super_r == PRO_SQUARE_IN_R && !bp->use_custom_profile) {
-      build_square_in_vmesh(bp, bm, bv, vm1);
-      return;
+      *r_square_in = true;
     }
   }
   else {
     vm1 = adj_vmesh(bp, bv);
   }
+  return vm1;
+}
+
+static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv)
+{
+  int n_bndv, ns, ns2, odd, i, j, k, ring;
+  VMesh *vm1, *vm;
+  BoundVert *bndv;
+  BMVert *bmv1, *bmv2, *bmv3, *bmv4;
+  BMFace *f, *f2, *r_f;
+  BMEdge *bme, *bme1, *bme2, *bme3;
+  EdgeHalf *e;
+  int mat_nr = bp->mat_nr;
+
+  n_bndv = bv->vmesh->count;
+  ns = bv->vmesh->seg;
+  ns2 = ns / 2;
+  odd = ns % 2;
+  BLI_assert(n_bndv >= 3 && ns > 1);
+
+  /* Calculated ahead of time by #build_vmesh_calc. */
+  vm1 = bv->vmesh_adj;
+  BLI_assert(vm1 != NULL);
+  if (bv->vmesh_adj_square_in) {
+    build_square_in_vmesh(bp, bm, bv, vm1);
+    return;
+  }
 
   /* Copy final vmesh into bv->vmesh, make BMVerts and BMFaces. */
   vm = bv->vmesh;
@@ -5357,12 +5392,61 @@ static void bevel_vert_two_edges(BevelParams *bp, BMesh *bm, BevVert *bv)
   }
 }
 
+/**
+ * Given that the boundary is built, calculate the profiles and (for the #M_ADJ pattern)
+ * the subdivided vertex mesh, in preparation for #build_vmesh.
+ *
+ * This doesn't create any #BMesh data and only writes to \a bv,
+ * so it can run for many #BevVert's in parallel (see #bevel_parallel_calc).
+ */
+static void build_vmesh_calc(BevelParams *bp, BevVert *bv)
+{
+  VMesh *vm = bv->vmesh;
+  BoundVert *bndv, *weld1, *weld2;
+
+  /* Special case: just two beveled edges welded together. */
+  const bool weld = (bv->selcount == 2) && (vm->count == 2);
+
+  /* Move profile planes if this is a weld case. */
+  if (weld) {
+    weld1 = weld2 = NULL;
+    bndv = vm->boundstart;
+    do {
+      if (bndv->ebev) {
+        if (!weld1) {
+          weld1 = bndv;
+        }
+        else { /* Get the last of the two BoundVerts. */
+          weld2 = bndv;
+          set_profile_params(bp, bv, weld1);
+          set_profile_params(bp, bv, weld2);
+          move_weld_profile_planes(bv, weld1, weld2);
+        }
+      }
+    } while ((bndv = bndv->next) != vm->boundstart);
+  }
+
+  /* It's simpler to calculate all profiles only once at a single moment, so keep just a single
+   * profile calculation here, the last point before actual mesh verts are created. */
+  calculate_vm_profiles(bp, bv, vm);
+
+  bv->vpipe = NULL;
+  if ((vm->count == 3 || vm->count == 4) && bp->seg > 1) {
+    /* Result is used by bevel_build_rings to avoid overhead. */
+    bv->vpipe = pipe_test(bv);
+  }
+
+  if (bv->vpipe || (vm->mesh_kind == M_ADJ && !weld)) {
+    bv->vmesh_adj = bevel_build_rings_adj_vmesh(bp, bv, bv->vpipe, &bv->vmesh_adj_square_in);
+  }
+}
+
 /* Given that the boundary is built, now make the actual BMVerts
  * for the boundary and the interior of the vertex mesh. */
 static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
 {
   VMesh *vm = bv->vmesh;
-  BoundVert *bndv, *weld1, *weld2, *vpipe;
+  BoundVert *bndv, *weld1, *weld2;
   int n, ns, ns2, i, k, weld;
   float *v_weld1, *v_weld2, co[3];
 
@@ -5385,24 +5469,17 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
     create_mesh_bmvert(bm, vm, i, 0, 0, bv->v);          /* Create BMVert for that NewVert. */
     bndv->nv.v = mesh_vert(vm, i, 0, 0)->v; /* Use the BMVert for the BoundVert's NewVert. */
 
-    /* Find boundverts and move profile planes if this is a weld case. */
+    /* Find boundverts if this is a weld case (profile planes are moved by #build_vmesh_calc). */
     if (weld && bndv->ebev) {
       if (!weld1) {
         weld1 = bndv;
       }
       else { /* Get the last of the two BoundVerts. */
         weld2 = bndv;
-        set_profile_params(bp, bv, weld1);
-        set_profile_params(bp, bv, weld2);
-        move_weld_profile_planes(bv, weld1, weld2);
       }
     }
   } while ((bndv = bndv->next) != vm->boundstart);
 
-  /* It's simpler to calculate all profiles only once at a single moment, so keep just a single
-   * profile calculation here, the last point before actual mesh verts are created. */
-  calculate_vm_profiles(bp, bv, vm);
-
   /* Create new vertices and place them based on the profiles. */
   /* Copy other ends to (i, 0, ns) for all i, and fill in profiles for edges. */
   bndv = vm->boundstart;
@@ -5462,13 +5539,8 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
   }
 
   /* Make sure the pipe case ADJ mesh is used for both the "Grid Fill" (ADJ) and cutoff options. */
-  vpipe = NULL;
-  if ((vm->count == 3 || vm->count == 4) && bp->seg > 1) {
-    /* Result is passed to bevel_build_rings to avoid overhead. */
-    vpipe = pipe_test(bv);
-    if (vpipe) {
-      vm->mesh_kind = M_ADJ;
-    }
+  if (bv->vpipe) {
+    vm->mesh_kind = M_ADJ;
   }
 
   switch (vm->mesh_kind) {
@@ -5481,7 +5553,7 @@ static void build_vmesh(BevelParams *bp, BMesh *bm, BevVert *bv)
       bevel_build_poly(bp, bm, bv);
       break;
     case M_ADJ:
-      bevel_build_rings(bp, bm, bv, vpipe);
+      bevel_build_rings(bp, bm, bv);
       break;
     case M_TRI_FAN:
       bevel_build_trifan(bp, bm, bv);
@@ -7131,6 +7203,108 @@ static void bevel_limit_offset(BevelParams *bp, BMesh *bm)
   }
 }
 
+/* Parallel calculation of per-BevVert data.
+ *
+ * Calculations which only read the input mesh and only write to a single BevVert
+ * can run in parallel. BevelParams.mem_arena isn't thread safe, so each thread uses
+ * a copy of the BevelParams with its own arena, kept until the bevel is finished. */
+
+/** Minimum number of #BevVert's to use threading. */
+#define BEVEL_PARALLEL_LIMIT 256
+
+typedef struct BevelParallelData {
+  BevelParams *bp;
+  BevVert **bv_arr;
+  /** Lock for adding thread arenas to #BevelParams.mem_arena_threads. */
+  ThreadMutex *mutex;
+} BevelParallelData;
+
+typedef struct BevelParallelTLS {
+  /** Copy of #BevelParallelData.bp using a thread local arena (lazily allocated). */
+  BevelParams bp;
+} BevelParallelTLS;
+
+static BevelParams *bevel_parallel_tls_params(const TaskParallelTLS *__restrict tls)
+{
+  BevelParallelTLS *tls_data = tls->userdata_chunk;
+  if (tls_data->bp.mem_arena == NULL) {
+    tls_data->bp.mem_arena = BLI_memarena_new(MEM_SIZE_OPTIMAL(1 << 16), __func__);
+    BLI_memarena_use_calloc(tls_data->bp.mem_arena);
+  }
+  return &tls_data->bp;
+}
+
+static void bevel_parallel_free_fn(const void *__restrict userdata, void *__restrict chunk)
+{
+  const BevelParallelData *data = userdata;
+  BevelParallelTLS *tls_data = chunk;
+  MemArena *mem_arena = tls_data->bp.mem_arena;
+  if (mem_arena != NULL) {
+    /* Allocated memory is still in use, keep the arena until the bevel is done. */
+    BLI_mutex_lock(data->mutex);
+    BLI_linklist_prepend_arena(&data->bp->mem_arena_threads, mem_arena, mem_arena);
+    BLI_mutex_unlock(data->mutex);
+  }
+}
+
+static void build_boundary_parallel_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict tls)
+{
+  BevelParallelData *data = userdata;
+  build_boundary(bevel_parallel_tls_params(tls), data->bv_arr[i], true);
+}
+
+static void build_vmesh_calc_parallel_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict tls)
+{
+  BevelParallelData *data = userdata;
+  build_vmesh_calc(bevel_parallel_tls_params(tls), data->bv_arr[i]);
+}
+
+static void bevel_parallel_calc(BevelParams *bp,
+                                BevVert **bv_arr,
+                                const int bv_len,
+                                TaskParallelRangeFunc func)
+{
+  ThreadMutex mutex;
+  BLI_mutex_init(&mutex);
+
+  BevelParallelData data = {
+      .bp = bp,
+      .bv_arr = bv_arr,
+      .mutex = &mutex,
+  };
+
+  BevelParallelTLS tls_data;
+  tls_data.bp = *bp;
+  tls_data.bp.mem_arena = NULL;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (bv_len >= BEVEL_PARALLEL_LIMIT);
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = bevel_parallel_free_fn;
+
+  BLI_task_parallel_range(0, bv_len, &data, func, &settings);
+
+  BLI_mutex_end(&mutex);
+}
+
+static void bevel_mem_arena_threads_free(BevelParams *bp)
+{
+  LinkNode *node = bp->mem_arena_threads;
+  while (node != NULL) {
+    /* The link is allocated in the arena being freed. */
+    LinkNode *node_next = node->next;
+    BLI_memarena_free(node->link);
+    node = node_next;
+  }
+  bp->mem_arena_threads = NULL;
+}
+
 /**
  * - Currently only bevels BM_ELEM_TAG'd verts and edges.
  *
@@ -7173,6 +7347,8 @@ void BM_mesh_bevel(BMesh *bm,
   BMFace *f;
   BMLoop *l;
   BevVert *bv;
+  BevVert **bv_arr;
+  int bv_len, i;
   BevelParams bp = {NULL};
 
   bp.offset = offset;
@@ -7246,12 +7422,14 @@ void BM_mesh_bevel(BMesh *bm,
     bp.face_hash = BLI_ghash_ptr_new(__func__);
     BLI_ghash_flag_set(bp.face_hash, GHASH_FLAG_ALLOW_DUPES);
 
-    /* Analyze input vertices, sorting edges and assigning initial new vertex positions. */
+    /* Analyze input vertices, sorting edges. */
+    bv_arr = MEM_mallocN(sizeof(*bv_arr) * (size_t)bm->totvert, __func__);
+    bv_len = 0;
     BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
       if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
         bv = bevel_vert_construct(bm, &bp, v);
-        if (!limit_offset && bv) {
-          build_boundary(&bp, bv, true);
+        if (bv) {
+          bv_arr[bv_len++] = bv;
         }
       }
     }
@@ -7259,18 +7437,11 @@ void BM_mesh_bevel(BMesh *bm,
     /* Perhaps clamp offset to avoid geometry colliisions. */
     if (limit_offset) {
       bevel_limit_offset(&bp, bm);
-
-      /* Assign initial new vertex positions. */
-      BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-        if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
-          bv = find_bevvert(&bp, v);
-          if (bv) {
-            build_boundary(&bp, bv, true);
-          }
-        }
-      }
     }
 
+    /* Assign initial new vertex positions. */
+    bevel_parallel_calc(&bp, bv_arr, bv_len, build_boundary_parallel_cb);
+
     /* Perhaps do a pass to try to even out widths. */
     if (!bp.vertex_only && bp.offset_adjust && bp.offset_type != BEVEL_AMT_PERCENT) {
       adjust_offsets(&bp, bm);
@@ -7285,15 +7456,14 @@ void BM_mesh_bevel(BMesh *bm,
       }
     }
 
-    /* Build the meshes around vertices, now that positions are final. */
-    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-      if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
-        bv = find_bevvert(&bp, v);
-        if (bv) {
-          build_vmesh(&bp, bm, bv);
-        }
-      }
+    /* Calculate the meshes around vertices, now that positions are final. */
+    bevel_parallel_calc(&bp, bv_arr, bv_len, build_vmesh_calc_parallel_cb);
+
+    /* Build the meshes around vertices, creating the geometry. */
+    for (i = 0; i < bv_len; i++) {
+      build_vmesh(&bp, bm, bv_arr[i]);
     }
+    MEM_freeN(bv_arr);
 
     /* Build polygons for edges. */
     if (!bp.vertex_only) {
@@ -7365,5 +7535,6 @@ void BM_mesh_bevel(BMesh *bm,
     BLI_ghash_free(bp.vert_hash, NULL, NULL);
     BLI_ghash_free(bp.face_hash, NULL, NULL);
     BLI_memarena_free(bp.mem_arena);
+    bevel_mem_arena_threads_free(&bp);
   }
 }
@@ -844,6 +844,55 @@ finally:
 
 #ifdef USE_BVH
 
+struct OverlapFilterData {
+  struct BMLoop *(*looptris)[3];
+  const struct ISectEpsilon *epsilon;
+};
+
+/**
+ * Check if all vertices of \a t_b are on one side of the plane of \a t_a,
+ * far enough that #bm_isect_tri_tri can't find any touching or intersecting elements.
+ */
+static bool bm_isect_tri_tri_plane_separated(const float *t_a[3],
+                                             const float *t_b[3],
+                                             const struct ISectEpsilon *e)
+{
+  float nor[3];
+  if (normal_tri_v3(nor, UNPACK3(t_a)) == 0.0f) {
+    return false;
+  }
+
+  float d_min = FLT_MAX, d_max = -FLT_MAX;
+  for (uint i = 0; i < 3; i++) {
+    float dir[3];
+    sub_v3_v3v3(dir, t_b[i], t_a[0]);
+    const float d = dot_v3v3(nor, dir);
+    d_min = min_ff(d_min, d);
+    d_max = max_ff(d_max, d);
+  }
+
+  /* Points on edges are tested with a tolerance relative to the edge length,
+   * so they may be slightly outside of the triangle. */
+  const float margin = e->eps_margin + e->eps2x + (d_max - d_min) * e->eps;
+  return (d_min > margin) || (d_max < -margin);
+}
+
+/**
+ * Reject overlapping bounds of triangles which can't intersect,
+ * this runs in parallel as part of the BVH overlap query, before the serial intersection.
+ */
+static bool bm_isect_overlap_cb(void *userdata, int index_a, int index_b, int UNUSED(thread))
+{
+  const struct OverlapFilterData *data = userdata;
+  BMLoop **a = data->looptris[index_a];
+  BMLoop **b = data->looptris[index_b];
+  const float *f_a_cos[3] = {UNPACK3_EX(, a, ->v->co)};
+  const float *f_b_cos[3] = {UNPACK3_EX(, b, ->v->co)};
+
+  return !(bm_isect_tri_tri_plane_separated(f_a_cos, f_b_cos, data->epsilon) ||
+           bm_isect_tri_tri_plane_separated(f_b_cos, f_a_cos, data->epsilon));
+}
+
 struct RaycastData {
   const float **looptris;
   BLI_Buffer *z_buffer;
@@ -1103,7 +1152,19 @@ bool BM_mesh_intersect(BMesh *bm,
     flag &= ~BVH_OVERLAP_USE_THREADING;
   }
 #  endif
-  overlap = BLI_bvhtree_overlap_ex(tree_b, tree_a, &tree_overlap_tot, NULL, NULL, 0, flag);
+  /* Triangles are filtered in parallel into per-thread buffers, which are joined in order,
+   * only the remaining pairs are intersected (editing the mesh) in the loop below. */
+  struct OverlapFilterData overlap_filter_data = {
+      .looptris = looptris,
+      .epsilon = &s.epsilon,
+  };
+  overlap = BLI_bvhtree_overlap_ex(tree_b,
+                                   tree_a,
+                                   &tree_overlap_tot,
+                                   bm_isect_overlap_cb,
+                                   &overlap_filter_data,
+                                   0,
+                                   flag);
 
   if (overlap) {
     uint i;
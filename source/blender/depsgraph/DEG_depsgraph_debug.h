@@ -53,6 +53,16 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+typedef void (*DEG_StatsComponentTimeFn)(void *user_data,
+                                         const char *component_name,
+                                         double time);
+
+/* Time spent in every type of component during the last evaluation. Only measured when evaluation
+ * is timed (G_DEBUG_DEPSGRAPH_TIME). */
+void DEG_stats_component_times(const struct Depsgraph *graph,
+                               DEG_StatsComponentTimeFn callback,
+                               void *user_data);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
@@ -243,6 +243,29 @@ void DEG_stats_simple(const Depsgraph *graph,
   }
 }
 
+/**
+ * Obtain time spent in every type of component during the last evaluation.
+ * Component times are aggregated from operations by #deg_eval_stats_aggregate().
+ * \param callback: Called once for every component type which took any time to evaluate.
+ */
+void DEG_stats_component_times(const Depsgraph *graph,
+                               DEG_StatsComponentTimeFn callback,
+                               void *user_data)
+{
+  const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+  double times[int(DEG::NodeType::NUM_TYPES)] = {0.0};
+  for (DEG::IDNode *id_node : deg_graph->id_nodes) {
+    for (DEG::ComponentNode *comp_node : id_node->components.values()) {
+      times[int(comp_node->type)] += comp_node->stats.current_time;
+    }
+  }
+  for (int type = 0; type < int(DEG::NodeType::NUM_TYPES); type++) {
+    if (times[type] != 0.0) {
+      callback(user_data, DEG::nodeTypeAsString(DEG::NodeType(type)), times[type]);
+    }
+  }
+}
+
 static DEG::string depsgraph_name_for_logging(struct Depsgraph *depsgraph)
 {
   const char *name = DEG_debug_name_get(depsgraph);
@@ -32,6 +32,7 @@
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
 
+#include "BKE_mesh_playback_cache.h"
 #include "BKE_object.h"
 #include "BKE_scene.h"
 
@@ -241,6 +242,14 @@ void flush_editors_id_update(Depsgraph *graph, const DEGEditorUpdateContext *upd
                      id_orig->name,
                      (unsigned int)id_cow->recalc);
 
+    /* Cached playback results of the object are no longer valid once a user
+     * edit reached its geometry. Time updates keep the cache intact. */
+    if (id_node->is_user_modified && GS(id_orig->name) == ID_OB) {
+      ComponentNode *geom_comp = id_node->find_component(NodeType::GEOMETRY);
+      if (geom_comp != nullptr && geom_comp->custom_flags == COMPONENT_STATE_DONE) {
+        BKE_mesh_playback_cache_invalidate_object((Object *)id_orig);
+      }
+    }
     /* Inform editors. Only if the data-block is being evaluated a second
      * time, to distinguish between user edits and initial evaluation when
      * the data-block becomes visible.
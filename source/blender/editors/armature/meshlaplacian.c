@@ -31,6 +31,8 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BLT_translation.h"
 
@@ -216,7 +218,10 @@ static void laplacian_triangle_weights(LaplacianSystem *sys, int f, int i1, int
   }
 }
 
-static LaplacianSystem *laplacian_system_construct_begin(int totvert, int totface, int lsq)
+static LaplacianSystem *laplacian_system_construct_begin(int totvert,
+                                                         int totface,
+                                                         int lsq,
+                                                         int num_rhs)
 {
   LaplacianSystem *sys;
 
@@ -234,10 +239,10 @@ static LaplacianSystem *laplacian_system_construct_begin(int totvert, int totfac
 
   /* create linear solver */
   if (lsq) {
-    sys->context = EIG_linear_least_squares_solver_new(0, totvert, 1);
+    sys->context = EIG_linear_least_squares_solver_new(0, totvert, num_rhs);
   }
   else {
-    sys->context = EIG_linear_solver_new(0, totvert, 1);
+    sys->context = EIG_linear_solver_new(0, totvert, num_rhs);
   }
 
   return sys;
@@ -383,6 +388,8 @@ float laplacian_system_get_solution(LaplacianSystem *sys, int v)
 #define WEIGHT_LIMIT_START 0.05f
 #define WEIGHT_LIMIT_END 0.025f
 #define DISTANCE_EPSILON 1e-4f
+/** number of bones solved for at once, one right hand side of the solver each */
+#define HEAT_SOLVE_BATCH 4
 
 typedef struct BVHCallbackUserData {
   float start[3];
@@ -564,6 +571,13 @@ static void heat_set_H(LaplacianSystem *sys, int vertex)
   sys->heat.H[vertex] = h;
 }
 
+static void heat_set_H_cb(void *__restrict userdata,
+                          const int vertex,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  heat_set_H(userdata, vertex);
+}
+
 static void heat_calc_vnormals(LaplacianSystem *sys)
 {
   float fnor[3];
@@ -617,9 +631,11 @@ static void heat_laplacian_create(LaplacianSystem *sys)
   /* for distance computation in set_H */
   heat_calc_vnormals(sys);
 
-  for (a = 0; a < totvert; a++) {
-    heat_set_H(sys, a);
-  }
+  /* each vertex ray-casts to all of the closest bones, thread even for small meshes */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (totvert > 1000);
+  BLI_task_parallel_range(0, totvert, sys, heat_set_H_cb, &settings);
 }
 
 static void heat_system_free(LaplacianSystem *sys)
@@ -650,6 +666,28 @@ static float heat_limit_weight(float weight)
   }
 }
 
+typedef struct HeatRHSData {
+  LaplacianSystem *sys;
+  /* bones (sources) of the current batch */
+  const int *bones;
+  int bones_len;
+  float (*rhs)[HEAT_SOLVE_BATCH];
+} HeatRHSData;
+
+static void heat_fill_rhs_cb(void *__restrict userdata,
+                             const int a,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  HeatRHSData *data = userdata;
+  LaplacianSystem *sys = data->sys;
+
+  for (int i = 0; i < data->bones_len; i++) {
+    data->rhs[a][i] = heat_source_closest(sys, a, data->bones[i]) ?
+                          sys->heat.H[a] * sys->heat.p[a] :
+                          0.0f;
+  }
+}
+
 void heat_bone_weighting(Object *ob,
                          Mesh *me,
                          float (*verts)[3],
@@ -703,7 +741,7 @@ void heat_bone_weighting(Object *ob,
   }
 
   /* create laplacian */
-  sys = laplacian_system_construct_begin(me->totvert, tottri, 1);
+  sys = laplacian_system_construct_begin(me->totvert, tottri, 1, HEAT_SOLVE_BATCH);
 
   sys->heat.tottri = poly_to_tri_count(me->totpoly, me->totloop);
   mlooptri = MEM_mallocN(sizeof(*sys->heat.mlooptri) * sys->heat.tottri, __func__);
@@ -730,48 +768,76 @@ void heat_bone_weighting(Object *ob,
     }
   }
 
-  /* compute weights per bone */
+  /* The selected bones are solved in batches, sharing the factorization of the system.
+   * Loading the solutions into the vertex groups is done one bone at a time, in order. */
+  int *bones = MEM_mallocN(sizeof(*bones) * numsource, __func__);
+  int bones_len = 0;
   for (j = 0; j < numsource; j++) {
-    if (!selected[j]) {
-      continue;
+    if (selected[j]) {
+      bones[bones_len++] = j;
     }
+  }
 
-    firstsegment = (j == 0 || dgrouplist[j - 1] != dgrouplist[j]);
-    lastsegment = (j == numsource - 1 || dgrouplist[j] != dgrouplist[j + 1]);
-    bbone = !(firstsegment && lastsegment);
+  HeatRHSData rhs_data = {
+      .sys = sys,
+      .rhs = MEM_mallocN(sizeof(*rhs_data.rhs) * me->totvert, __func__),
+  };
 
-    /* clear weights */
-    if (bbone && firstsegment) {
-      for (a = 0; a < me->totvert; a++) {
-        if (mask && !mask[a]) {
-          continue;
-        }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (me->totvert > 1000);
 
-        ED_vgroup_vert_remove(ob, dgrouplist[j], a);
-        if (vertsflipped && dgroupflip[j] && vertsflipped[a] >= 0) {
-          ED_vgroup_vert_remove(ob, dgroupflip[j], vertsflipped[a]);
-        }
-      }
-    }
+  for (int batch = 0; batch < bones_len; batch += HEAT_SOLVE_BATCH) {
+    rhs_data.bones = &bones[batch];
+    rhs_data.bones_len = min_ii(HEAT_SOLVE_BATCH, bones_len - batch);
 
-    /* fill right hand side */
+    /* fill right hand sides, the visibility ray-casts are done in parallel */
     laplacian_begin_solve(sys, -1);
 
+    BLI_task_parallel_range(0, me->totvert, &rhs_data, heat_fill_rhs_cb, &settings);
+
     for (a = 0; a < me->totvert; a++) {
-      if (heat_source_closest(sys, a, j)) {
-        laplacian_add_right_hand_side(sys, a, sys->heat.H[a] * sys->heat.p[a]);
+      for (int i = 0; i < rhs_data.bones_len; i++) {
+        if (rhs_data.rhs[a][i] != 0.0f) {
+          EIG_linear_solver_right_hand_side_add(sys->context, i, a, rhs_data.rhs[a][i]);
+        }
       }
     }
 
     /* solve */
-    if (laplacian_system_solve(sys)) {
+    if (!laplacian_system_solve(sys)) {
+      *err_str = N_("Bone Heat Weighting: failed to find solution for one or more bones");
+      break;
+    }
+
+    for (int i = 0; i < rhs_data.bones_len; i++) {
+      j = rhs_data.bones[i];
+
+      firstsegment = (j == 0 || dgrouplist[j - 1] != dgrouplist[j]);
+      lastsegment = (j == numsource - 1 || dgrouplist[j] != dgrouplist[j + 1]);
+      bbone = !(firstsegment && lastsegment);
+
+      /* clear weights */
+      if (bbone && firstsegment) {
+        for (a = 0; a < me->totvert; a++) {
+          if (mask && !mask[a]) {
+            continue;
+          }
+
+          ED_vgroup_vert_remove(ob, dgrouplist[j], a);
+          if (vertsflipped && dgroupflip[j] && vertsflipped[a] >= 0) {
+            ED_vgroup_vert_remove(ob, dgroupflip[j], vertsflipped[a]);
+          }
+        }
+      }
+
       /* load solution into vertex groups */
       for (a = 0; a < me->totvert; a++) {
         if (mask && !mask[a]) {
           continue;
         }
 
-        solution = laplacian_system_get_solution(sys, a);
+        solution = EIG_linear_solver_variable_get(sys->context, i, a);
 
         if (bbone) {
           if (solution > 0.0f) {
@@ -806,36 +872,35 @@ void heat_bone_weighting(Object *ob,
           }
         }
       }
-    }
-    else if (*err_str == NULL) {
-      *err_str = N_("Bone Heat Weighting: failed to find solution for one or more bones");
-      break;
-    }
 
-    /* remove too small vertex weights */
-    if (bbone && lastsegment) {
-      for (a = 0; a < me->totvert; a++) {
-        if (mask && !mask[a]) {
-          continue;
-        }
-
-        weight = ED_vgroup_vert_weight(ob, dgrouplist[j], a);
-        weight = heat_limit_weight(weight);
-        if (weight <= 0.0f) {
-          ED_vgroup_vert_remove(ob, dgrouplist[j], a);
-        }
+      /* remove too small vertex weights */
+      if (bbone && lastsegment) {
+        for (a = 0; a < me->totvert; a++) {
+          if (mask && !mask[a]) {
+            continue;
+          }
 
-        if (vertsflipped && dgroupflip[j] && vertsflipped[a] >= 0) {
-          weight = ED_vgroup_vert_weight(ob, dgroupflip[j], vertsflipped[a]);
+          weight = ED_vgroup_vert_weight(ob, dgrouplist[j], a);
           weight = heat_limit_weight(weight);
           if (weight <= 0.0f) {
-            ED_vgroup_vert_remove(ob, dgroupflip[j], vertsflipped[a]);
+            ED_vgroup_vert_remove(ob, dgrouplist[j], a);
+          }
+
+          if (vertsflipped && dgroupflip[j] && vertsflipped[a] >= 0) {
+            weight = ED_vgroup_vert_weight(ob, dgroupflip[j], vertsflipped[a]);
+            weight = heat_limit_weight(weight);
+            if (weight <= 0.0f) {
+              ED_vgroup_vert_remove(ob, dgroupflip[j], vertsflipped[a]);
+            }
           }
         }
       }
     }
   }
 
+  MEM_freeN(rhs_data.rhs);
+  MEM_freeN(bones);
+
   /* free */
   if (vertsflipped) {
     MEM_freeN(vertsflipped);
@@ -866,6 +931,9 @@ void heat_bone_weighting(Object *ob,
 
 #define MESHDEFORM_MIN_INFLUENCE 0.0005f
 
+/** number of cage vertices solved for at once, one right hand side of the solver each */
+#define MESHDEFORM_SOLVE_BATCH 4
+
 static const int MESHDEFORM_OFFSET[7][3] = {
     {0, 0, 0},
     {1, 0, 0},
@@ -909,6 +977,8 @@ typedef struct MeshDeformBind {
 
   /* grids */
   MemArena *memarena;
+  /* protects 'memarena' while boundary intersections are added from multiple threads */
+  SpinLock memarena_lock;
   MDefBoundIsect *(*boundisect)[6];
   int *semibound;
   int *tag;
@@ -999,42 +1069,55 @@ static void harmonic_ray_callback(void *userdata,
   }
 }
 
-static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb,
-                                                     const float co1[3],
-                                                     const float co2[3])
+/**
+ * Ray-cast from \a co1 to \a co2, only reading from \a mdb so it's safe to call from threads.
+ */
+static bool meshdeform_ray_tree_raycast(MeshDeformBind *mdb,
+                                        const float co1[3],
+                                        const float co2[3],
+                                        MeshDeformIsect *isect_mdef,
+                                        BVHTreeRayHit *hit)
 {
-  BVHTreeRayHit hit;
-  MeshDeformIsect isect_mdef;
   struct MeshRayCallbackData data = {
       mdb,
-      &isect_mdef,
+      isect_mdef,
   };
   float end[3], vec_normal[3];
 
   /* happens binding when a cage has no faces */
   if (UNLIKELY(mdb->bvhtree == NULL)) {
-    return NULL;
+    return false;
   }
 
   /* setup isec */
-  memset(&isect_mdef, 0, sizeof(isect_mdef));
-  isect_mdef.lambda = 1e10f;
+  memset(isect_mdef, 0, sizeof(*isect_mdef));
+  isect_mdef->lambda = 1e10f;
 
-  copy_v3_v3(isect_mdef.start, co1);
+  copy_v3_v3(isect_mdef->start, co1);
   copy_v3_v3(end, co2);
-  sub_v3_v3v3(isect_mdef.vec, end, isect_mdef.start);
-  isect_mdef.vec_length = normalize_v3_v3(vec_normal, isect_mdef.vec);
+  sub_v3_v3v3(isect_mdef->vec, end, isect_mdef->start);
+  isect_mdef->vec_length = normalize_v3_v3(vec_normal, isect_mdef->vec);
+
+  hit->index = -1;
+  hit->dist = BVH_RAYCAST_DIST_MAX;
+  return (BLI_bvhtree_ray_cast_ex(mdb->bvhtree,
+                                  isect_mdef->start,
+                                  vec_normal,
+                                  0.0,
+                                  hit,
+                                  harmonic_ray_callback,
+                                  &data,
+                                  BVH_RAYCAST_WATERTIGHT) != -1);
+}
 
-  hit.index = -1;
-  hit.dist = BVH_RAYCAST_DIST_MAX;
-  if (BLI_bvhtree_ray_cast_ex(mdb->bvhtree,
-                              isect_mdef.start,
-                              vec_normal,
-                              0.0,
-                              &hit,
-                              harmonic_ray_callback,
-                              &data,
-                              BVH_RAYCAST_WATERTIGHT) != -1) {
+static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb,
+                                                     const float co1[3],
+                                                     const float co2[3])
+{
+  BVHTreeRayHit hit;
+  MeshDeformIsect isect_mdef;
+
+  if (meshdeform_ray_tree_raycast(mdb, co1, co2, &isect_mdef, &hit)) {
     const MLoop *mloop = mdb->cagemesh_cache.mloop;
     const MLoopTri *lt = &mdb->cagemesh_cache.looptri[hit.index];
     const MPoly *mp = &mdb->cagemesh_cache.mpoly[lt->poly];
@@ -1046,7 +1129,9 @@ static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb,
     int i;
 
     /* create MDefBoundIsect, and extra for 'poly_weights[]' */
+    BLI_spin_lock(&mdb->memarena_lock);
     isect = BLI_memarena_alloc(mdb->memarena, sizeof(*isect) + (sizeof(float) * mp->totloop));
+    BLI_spin_unlock(&mdb->memarena_lock);
 
     /* compute intersection coordinate */
     madd_v3_v3v3fl(isect->co, co1, isect_mdef.vec, len);
@@ -1072,7 +1157,8 @@ static MDefBoundIsect *meshdeform_ray_tree_intersect(MeshDeformBind *mdb,
 
 static int meshdeform_inside_cage(MeshDeformBind *mdb, float *co)
 {
-  MDefBoundIsect *isect;
+  MeshDeformIsect isect_mdef;
+  BVHTreeRayHit hit;
   float outside[3], start[3], dir[3];
   int i;
 
@@ -1085,8 +1171,9 @@ static int meshdeform_inside_cage(MeshDeformBind *mdb, float *co)
     sub_v3_v3v3(dir, outside, start);
     normalize_v3(dir);
 
-    isect = meshdeform_ray_tree_intersect(mdb, start, outside);
-    if (isect && !isect->facing) {
+    /* only the facing of the hit is needed, no need to store the intersection */
+    if (meshdeform_ray_tree_raycast(mdb, start, outside, &isect_mdef, &hit) &&
+        !isect_mdef.isect) {
       return 1;
     }
   }
@@ -1372,7 +1459,7 @@ static void meshdeform_matrix_add_cell(
 }
 
 static void meshdeform_matrix_add_rhs(
-    MeshDeformBind *mdb, LinearSolver *context, int x, int y, int z, int cagevert)
+    MeshDeformBind *mdb, LinearSolver *context, int x, int y, int z, int rhs_index, int cagevert)
 {
   MDefBoundIsect *isect;
   float rhs, weight, totweight;
@@ -1395,7 +1482,7 @@ static void meshdeform_matrix_add_rhs(
     if (isect) {
       weight = (1.0f / isect->len) / totweight;
       rhs = weight * meshdeform_boundary_phi(mdb, isect, cagevert);
-      EIG_linear_solver_right_hand_side_add(context, 0, mdb->varidx[acenter], rhs);
+      EIG_linear_solver_right_hand_side_add(context, rhs_index, mdb->varidx[acenter], rhs);
     }
   }
 }
@@ -1453,10 +1540,97 @@ static void meshdeform_matrix_add_exterior_phi(
   }
 }
 
+typedef struct MeshDeformSolveData {
+  MeshDeformBind *mdb;
+  LinearSolver *context;
+  /* cage vertex of the first right hand side */
+  int cagevert_first;
+  int cagevert_len;
+  /* right hand side read back after solving, for cage vertex 'cagevert_first + rhs_index' */
+  int rhs_index;
+} MeshDeformSolveData;
+
+/* The grid passes are threaded over Z slices, each cell only writes to its own values. */
+
+static void meshdeform_matrix_add_rhs_cb(void *__restrict userdata,
+                                         const int z,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  MeshDeformBind *mdb = data->mdb;
+
+  for (int y = 0; y < mdb->size; y++) {
+    for (int x = 0; x < mdb->size; x++) {
+      for (int i = 0; i < data->cagevert_len; i++) {
+        meshdeform_matrix_add_rhs(mdb, data->context, x, y, z, i, data->cagevert_first + i);
+      }
+    }
+  }
+}
+
+static void meshdeform_matrix_add_semibound_phi_cb(void *__restrict userdata,
+                                                   const int z,
+                                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  MeshDeformBind *mdb = data->mdb;
+
+  for (int y = 0; y < mdb->size; y++) {
+    for (int x = 0; x < mdb->size; x++) {
+      meshdeform_matrix_add_semibound_phi(mdb, x, y, z, data->cagevert_first + data->rhs_index);
+    }
+  }
+}
+
+static void meshdeform_matrix_add_exterior_phi_cb(void *__restrict userdata,
+                                                  const int z,
+                                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  MeshDeformBind *mdb = data->mdb;
+
+  for (int y = 0; y < mdb->size; y++) {
+    for (int x = 0; x < mdb->size; x++) {
+      meshdeform_matrix_add_exterior_phi(mdb, x, y, z, data->cagevert_first + data->rhs_index);
+    }
+  }
+}
+
+static void meshdeform_matrix_phi_from_solution_cb(void *__restrict userdata,
+                                                   const int b,
+                                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  MeshDeformBind *mdb = data->mdb;
+
+  if (mdb->tag[b] != MESHDEFORM_TAG_EXTERIOR) {
+    mdb->phi[b] = EIG_linear_solver_variable_get(data->context, data->rhs_index, mdb->varidx[b]);
+  }
+  mdb->totalphi[b] += mdb->phi[b];
+}
+
+static void meshdeform_static_bind_weights_cb(void *__restrict userdata,
+                                              const int b,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformSolveData *data = userdata;
+  MeshDeformBind *mdb = data->mdb;
+  const int a = data->cagevert_first + data->rhs_index;
+  float vec[3], gridvec[3];
+
+  if (mdb->inside[b]) {
+    copy_v3_v3(vec, mdb->vertexcos[b]);
+    gridvec[0] = (vec[0] - mdb->min[0] - mdb->halfwidth[0]) / mdb->width[0];
+    gridvec[1] = (vec[1] - mdb->min[1] - mdb->halfwidth[1]) / mdb->width[1];
+    gridvec[2] = (vec[2] - mdb->min[2] - mdb->halfwidth[2]) / mdb->width[2];
+
+    mdb->weights[b * mdb->totcagevert + a] = meshdeform_interp_w(mdb, gridvec, vec, a);
+  }
+}
+
 static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind *mdb)
 {
   LinearSolver *context;
-  float vec[3], gridvec[3];
   int a, b, x, y, z, totvar;
   char message[256];
 
@@ -1473,8 +1647,8 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
 
   progress_bar(0, "Starting mesh deform solve");
 
-  /* setup linear solver */
-  context = EIG_linear_solver_new(totvar, totvar, 1);
+  /* setup linear solver, the factorization is shared by all right hand sides */
+  context = EIG_linear_solver_new(totvar, totvar, MESHDEFORM_SOLVE_BATCH);
 
   /* build matrix */
   for (z = 0; z < mdb->size; z++) {
@@ -1485,53 +1659,47 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
     }
   }
 
-  /* solve for each cage vert */
-  for (a = 0; a < mdb->totcagevert; a++) {
-    /* fill in right hand side and solve */
-    for (z = 0; z < mdb->size; z++) {
-      for (y = 0; y < mdb->size; y++) {
-        for (x = 0; x < mdb->size; x++) {
-          meshdeform_matrix_add_rhs(mdb, context, x, y, z, a);
-        }
-      }
-    }
+  MeshDeformSolveData data = {
+      .mdb = mdb,
+      .context = context,
+  };
 
-    if (EIG_linear_solver_solve(context)) {
-      for (z = 0; z < mdb->size; z++) {
-        for (y = 0; y < mdb->size; y++) {
-          for (x = 0; x < mdb->size; x++) {
-            meshdeform_matrix_add_semibound_phi(mdb, x, y, z, a);
-          }
-        }
-      }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (mdb->size3 > 10000);
 
-      for (z = 0; z < mdb->size; z++) {
-        for (y = 0; y < mdb->size; y++) {
-          for (x = 0; x < mdb->size; x++) {
-            meshdeform_matrix_add_exterior_phi(mdb, x, y, z, a);
-          }
-        }
-      }
+  TaskParallelSettings settings_vert;
+  BLI_parallel_range_settings_defaults(&settings_vert);
+  settings_vert.use_threading = (mdb->totvert > 10000);
 
-      for (b = 0; b < mdb->size3; b++) {
-        if (mdb->tag[b] != MESHDEFORM_TAG_EXTERIOR) {
-          mdb->phi[b] = EIG_linear_solver_variable_get(context, 0, mdb->varidx[b]);
-        }
-        mdb->totalphi[b] += mdb->phi[b];
-      }
+  /* solve for a batch of cage verts at a time */
+  for (data.cagevert_first = 0; data.cagevert_first < mdb->totcagevert;
+       data.cagevert_first += MESHDEFORM_SOLVE_BATCH) {
+    data.cagevert_len = min_ii(MESHDEFORM_SOLVE_BATCH, mdb->totcagevert - data.cagevert_first);
+
+    /* fill in right hand sides and solve */
+    BLI_task_parallel_range(0, mdb->size, &data, meshdeform_matrix_add_rhs_cb, &settings);
+
+    if (!EIG_linear_solver_solve(context)) {
+      BKE_modifier_set_error(&mmd->modifier, "Failed to find bind solution (increase precision?)");
+      error("Mesh Deform: failed to find bind solution.");
+      break;
+    }
+
+    for (data.rhs_index = 0; data.rhs_index < data.cagevert_len; data.rhs_index++) {
+      a = data.cagevert_first + data.rhs_index;
+
+      BLI_task_parallel_range(
+          0, mdb->size, &data, meshdeform_matrix_add_semibound_phi_cb, &settings);
+      BLI_task_parallel_range(
+          0, mdb->size, &data, meshdeform_matrix_add_exterior_phi_cb, &settings);
+      BLI_task_parallel_range(
+          0, mdb->size3, &data, meshdeform_matrix_phi_from_solution_cb, &settings);
 
       if (mdb->weights) {
         /* static bind : compute weights for each vertex */
-        for (b = 0; b < mdb->totvert; b++) {
-          if (mdb->inside[b]) {
-            copy_v3_v3(vec, mdb->vertexcos[b]);
-            gridvec[0] = (vec[0] - mdb->min[0] - mdb->halfwidth[0]) / mdb->width[0];
-            gridvec[1] = (vec[1] - mdb->min[1] - mdb->halfwidth[1]) / mdb->width[1];
-            gridvec[2] = (vec[2] - mdb->min[2] - mdb->halfwidth[2]) / mdb->width[2];
-
-            mdb->weights[b * mdb->totcagevert + a] = meshdeform_interp_w(mdb, gridvec, vec, a);
-          }
-        }
+        BLI_task_parallel_range(
+            0, mdb->totvert, &data, meshdeform_static_bind_weights_cb, &settings_vert);
       }
       else {
         MDefBindInfluence *inf;
@@ -1547,16 +1715,14 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
           }
         }
       }
-    }
-    else {
-      BKE_modifier_set_error(&mmd->modifier, "Failed to find bind solution (increase precision?)");
-      error("Mesh Deform: failed to find bind solution.");
-      break;
-    }
 
-    BLI_snprintf(
-        message, sizeof(message), "Mesh deform solve %d / %d       |||", a + 1, mdb->totcagevert);
-    progress_bar((float)(a + 1) / (float)(mdb->totcagevert), message);
+      BLI_snprintf(message,
+                   sizeof(message),
+                   "Mesh deform solve %d / %d       |||",
+                   a + 1,
+                   mdb->totcagevert);
+      progress_bar((float)(a + 1) / (float)(mdb->totcagevert), message);
+    }
   }
 
 #if 0
@@ -1580,13 +1746,38 @@ static void meshdeform_matrix_solve(MeshDeformModifierData *mmd, MeshDeformBind
   EIG_linear_solver_delete(context);
 }
 
+/* Each vertex does several ray-casts, so this is threaded for far fewer vertices than usual. */
+static void meshdeform_inside_cage_cb(void *__restrict userdata,
+                                      const int a,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformBind *mdb = userdata;
+  float vec[3];
+
+  copy_v3_v3(vec, mdb->vertexcos[a]);
+  mdb->inside[a] = meshdeform_inside_cage(mdb, vec);
+}
+
+static void meshdeform_add_intersections_cb(void *__restrict userdata,
+                                            const int z,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshDeformBind *mdb = userdata;
+
+  for (int y = 0; y < mdb->size; y++) {
+    for (int x = 0; x < mdb->size; x++) {
+      meshdeform_add_intersections(mdb, x, y, z);
+    }
+  }
+}
+
 static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBind *mdb)
 {
   MDefBindInfluence *inf;
   MDefInfluence *mdinf;
   MDefCell *cell;
-  float center[3], vec[3], maxwidth, totweight;
-  int a, b, x, y, z, totinside, offset;
+  float center[3], maxwidth, totweight;
+  int a, b, x, y, z, offset;
 
   /* compute bounding box of the cage mesh */
   INIT_MINMAX(mdb->min, mdb->max);
@@ -1615,6 +1806,7 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
 
   mdb->memarena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "harmonic coords arena");
   BLI_memarena_use_calloc(mdb->memarena);
+  BLI_spin_init(&mdb->memarena_lock);
 
   /* initialize data from 'cagedm' for reuse */
   {
@@ -1650,18 +1842,10 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
 
   progress_bar(0, "Setting up mesh deform system");
 
-  totinside = 0;
-  for (a = 0; a < mdb->totvert; a++) {
-    copy_v3_v3(vec, mdb->vertexcos[a]);
-    mdb->inside[a] = meshdeform_inside_cage(mdb, vec);
-    if (mdb->inside[a]) {
-      totinside++;
-    }
-  }
-
-  /* free temporary MDefBoundIsects */
-  BLI_memarena_free(mdb->memarena);
-  mdb->memarena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, "harmonic coords arena");
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (mdb->totvert > 1000);
+  BLI_task_parallel_range(0, mdb->totvert, mdb, meshdeform_inside_cage_cb, &settings);
 
   /* start with all cells untyped */
   for (a = 0; a < mdb->size3; a++) {
@@ -1669,13 +1853,9 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
   }
 
   /* detect intersections and tag boundary cells */
-  for (z = 0; z < mdb->size; z++) {
-    for (y = 0; y < mdb->size; y++) {
-      for (x = 0; x < mdb->size; x++) {
-        meshdeform_add_intersections(mdb, x, y, z);
-      }
-    }
-  }
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (mdb->size3 > 10000);
+  BLI_task_parallel_range(0, mdb->size, mdb, meshdeform_add_intersections_cb, &settings);
 
   /* compute exterior and interior tags */
   meshdeform_bind_floodfill(mdb);
@@ -1744,6 +1924,7 @@ static void harmonic_coordinates_bind(MeshDeformModifierData *mmd, MeshDeformBin
   MEM_freeN(mdb->boundisect);
   MEM_freeN(mdb->semibound);
   BLI_memarena_free(mdb->memarena);
+  BLI_spin_end(&mdb->memarena_lock);
   free_bvhtree_from_mesh(&mdb->bvhdata);
 }
 
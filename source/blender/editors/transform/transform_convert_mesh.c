@@ -972,11 +972,8 @@ struct TransCustomDataLayer {
   int data_len;
 };
 
-static void trans_mesh_customdata_free_cb(struct TransInfo *UNUSED(t),
-                                          struct TransDataContainer *UNUSED(tc),
-                                          struct TransCustomData *custom_data)
+static void trans_mesh_customdata_layer_free(struct TransCustomDataLayer *tcld)
 {
-  struct TransCustomDataLayer *tcld = custom_data->data;
   bmesh_edit_end(tcld->bm, BMO_OPTYPE_FLAG_UNTAN_MULTIRES);
 
   if (tcld->bm_origfaces) {
@@ -996,9 +993,50 @@ static void trans_mesh_customdata_free_cb(struct TransInfo *UNUSED(t),
   }
 
   MEM_freeN(tcld);
+}
+
+/**
+ * Mesh specific data stored in #TransCustomDataContainer.type,
+ * shared by custom-data correction and partial geometry updates.
+ */
+struct TransCustomDataMesh {
+  struct TransCustomDataLayer *cd_layer_correct;
+  struct {
+    struct BMPartialUpdate *cache;
+    /** The size of proportional editing used for `cache`. */
+    float prop_size;
+    /** Too many vertices are affected, a partial update would be slower than a full update. */
+    bool use_full_update;
+  } partial_update;
+};
+
+static void trans_mesh_customdata_free_cb(struct TransInfo *UNUSED(t),
+                                          struct TransDataContainer *UNUSED(tc),
+                                          struct TransCustomData *custom_data)
+{
+  struct TransCustomDataMesh *tcmd = custom_data->data;
+  if (tcmd->cd_layer_correct != NULL) {
+    trans_mesh_customdata_layer_free(tcmd->cd_layer_correct);
+  }
+  if (tcmd->partial_update.cache != NULL) {
+    BM_mesh_partial_destroy(tcmd->partial_update.cache);
+  }
+  MEM_freeN(tcmd);
   custom_data->data = NULL;
 }
 
+static struct TransCustomDataMesh *trans_mesh_customdata_ensure(TransDataContainer *tc)
+{
+  struct TransCustomDataMesh *tcmd = tc->custom.type.data;
+  BLI_assert(tc->custom.type.data == NULL ||
+             tc->custom.type.free_cb == trans_mesh_customdata_free_cb);
+  if (tc->custom.type.data == NULL) {
+    tc->custom.type.data = tcmd = MEM_callocN(sizeof(*tcmd), __func__);
+    tc->custom.type.free_cb = trans_mesh_customdata_free_cb;
+  }
+  return tcmd;
+}
+
 static void create_trans_vert_customdata_layer(BMVert *v,
                                                struct TransCustomDataLayer *tcld,
                                                struct TransCustomDataLayerVert *r_tcld_vert)
@@ -1053,14 +1091,10 @@ static void create_trans_vert_customdata_layer(BMVert *v,
 void trans_mesh_customdata_correction_init(TransInfo *t)
 {
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
-    if (tc->custom.type.data) {
-      if (tc->custom.type.free_cb == trans_mesh_customdata_free_cb) {
-        /* Custom data correction has initiated before. */
-        continue;
-      }
-      else {
-        BLI_assert(false);
-      }
+    struct TransCustomDataMesh *tcmd = trans_mesh_customdata_ensure(tc);
+    if (tcmd->cd_layer_correct != NULL) {
+      /* Custom data correction has initiated before. */
+      continue;
     }
     int i;
 
@@ -1115,8 +1149,7 @@ void trans_mesh_customdata_correction_init(TransInfo *t)
       }
 
       struct TransCustomDataLayer *tcld;
-      tc->custom.type.data = tcld = MEM_mallocN(sizeof(*tcld), __func__);
-      tc->custom.type.free_cb = trans_mesh_customdata_free_cb;
+      tcmd->cd_layer_correct = tcld = MEM_mallocN(sizeof(*tcld), __func__);
 
       tcld->bm = bm;
       tcld->origfaces = origfaces;
@@ -1295,7 +1328,8 @@ static void trans_mesh_customdata_correction_apply_vert(struct TransCustomDataLa
 
 void trans_mesh_customdata_correction_apply(struct TransDataContainer *tc, bool is_final)
 {
-  struct TransCustomDataLayer *tcld = tc->custom.type.data;
+  struct TransCustomDataMesh *tcmd = tc->custom.type.data;
+  struct TransCustomDataLayer *tcld = tcmd ? tcmd->cd_layer_correct : NULL;
   if (!tcld) {
     return;
   }
@@ -1312,6 +1346,113 @@ void trans_mesh_customdata_correction_apply(struct TransDataContainer *tc, bool
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Recalc Mesh Data (Partial Update)
+ *
+ * Only recalculate normals & tessellation of faces affected by the transformed vertices,
+ * this avoids updating the whole mesh when transforming a small part of a large mesh.
+ * \{ */
+
+static struct BMPartialUpdate *trans_mesh_partial_update_ensure(TransInfo *t,
+                                                                TransDataContainer *tc)
+{
+  struct TransCustomDataMesh *tcmd = trans_mesh_customdata_ensure(tc);
+  const bool is_prop_edit = (t->flag & T_PROP_EDIT) != 0;
+
+  if ((tcmd->partial_update.cache != NULL) || tcmd->partial_update.use_full_update) {
+    /* A larger proportional editing size may transform vertices not in the cache,
+     * a smaller size only restores vertices which are already in it. */
+    if (!is_prop_edit || (t->prop_size <= tcmd->partial_update.prop_size)) {
+      return tcmd->partial_update.cache;
+    }
+    if (tcmd->partial_update.use_full_update) {
+      return NULL;
+    }
+    BM_mesh_partial_destroy(tcmd->partial_update.cache);
+    tcmd->partial_update.cache = NULL;
+  }
+
+  BMEditMesh *em = BKE_editmesh_from_object(tc->obedit);
+  BMesh *bm = em->bm;
+
+  BM_mesh_elem_index_ensure(bm, BM_VERT);
+
+  BLI_bitmap *verts_mask = BLI_BITMAP_NEW(bm->totvert, __func__);
+  int verts_mask_count = 0;
+
+  TransData *td = tc->data;
+  for (int i = 0; i < tc->data_len; i++, td++) {
+    if (is_prop_edit && !(td->flag & TD_SELECTED) && (td->factor == 0.0f)) {
+      continue;
+    }
+    BMVert *v = td->extra;
+    const int v_index = BM_elem_index_get(v);
+    if (!BLI_BITMAP_TEST(verts_mask, v_index)) {
+      BLI_BITMAP_ENABLE(verts_mask, v_index);
+      verts_mask_count += 1;
+    }
+  }
+
+  TransDataMirror *td_mirror = tc->mirror.data;
+  for (int i = 0; i < tc->mirror.data_len; i++, td_mirror++) {
+    BMVert *v_mirr = td_mirror->extra;
+    const int v_mirr_index = BM_elem_index_get(v_mirr);
+    if (!BLI_BITMAP_TEST(verts_mask, v_mirr_index)) {
+      BLI_BITMAP_ENABLE(verts_mask, v_mirr_index);
+      verts_mask_count += 1;
+    }
+  }
+
+  tcmd->partial_update.prop_size = t->prop_size;
+
+  /* When most of the mesh is transformed, the full (non-partial) update is faster. */
+  if (verts_mask_count > bm->totvert / 2) {
+    tcmd->partial_update.use_full_update = true;
+  }
+  else {
+    tcmd->partial_update.cache = BM_mesh_partial_create_from_verts(
+        bm,
+        &(BMPartialUpdate_Params){
+            .do_tessellate = true,
+            .do_normals = true,
+        },
+        verts_mask,
+        verts_mask_count);
+  }
+
+  MEM_freeN(verts_mask);
+
+  return tcmd->partial_update.cache;
+}
+
+/**
+ * Update normals & tessellation of the edit-meshes being transformed.
+ */
+void trans_mesh_update_normals_and_looptris(TransInfo *t)
+{
+  /* Edge (crease) data doesn't store vertices in #TransData.extra. */
+  const bool use_partial = (t->options & CTX_EDGE) == 0;
+
+  FOREACH_TRANS_DATA_CONTAINER (t, tc) {
+    BMEditMesh *em = BKE_editmesh_from_object(tc->obedit);
+    struct BMPartialUpdate *bmpinfo = NULL;
+    if (use_partial && (em->looptris != NULL)) {
+      bmpinfo = trans_mesh_partial_update_ensure(t, tc);
+    }
+
+    if (bmpinfo != NULL) {
+      BM_mesh_normals_update_with_partial(em->bm, bmpinfo);
+      BKE_editmesh_looptri_calc_with_partial(em, bmpinfo);
+    }
+    else {
+      EDBM_mesh_normals_update(em);
+      BKE_editmesh_looptri_calc(em);
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Edge (for crease) Transform Creation
  *
@@ -855,10 +855,8 @@ static void recalcData_objects(TransInfo *t)
 
       FOREACH_TRANS_DATA_CONTAINER (t, tc) {
         DEG_id_tag_update(tc->obedit->data, 0); /* sets recalc flags */
-        BMEditMesh *em = BKE_editmesh_from_object(tc->obedit);
-        EDBM_mesh_normals_update(em);
-        BKE_editmesh_looptri_calc(em);
       }
+      trans_mesh_update_normals_and_looptris(t);
     }
     else if (t->obedit_type == OB_ARMATURE) { /* no recalc flag, does pose */
 
@@ -97,6 +97,7 @@ static IArchive open_archive(const std::string &filename,
 }
 
 ArchiveReader::ArchiveReader(struct Main *bmain, const char *filename)
+    : m_prefetch_pool(nullptr)
 {
   char abs_filename[FILE_MAX];
   BLI_strncpy(abs_filename, filename, FILE_MAX);
@@ -122,6 +123,15 @@ ArchiveReader::ArchiveReader(struct Main *bmain, const char *filename)
   }
 }
 
+ArchiveReader::~ArchiveReader()
+{
+  /* Tasks still read from the streams, which are closed with the archive. */
+  if (m_prefetch_pool != nullptr) {
+    BLI_task_pool_cancel(m_prefetch_pool);
+    BLI_task_pool_free(m_prefetch_pool);
+  }
+}
+
 bool ArchiveReader::is_hdf5() const
 {
   return m_is_hdf5;
@@ -136,3 +146,14 @@ Alembic::Abc::IObject ArchiveReader::getTop()
 {
   return m_archive.getTop();
 }
+
+void ArchiveReader::prefetch_task_push(TaskRunFunction run,
+                                       void *taskdata,
+                                       TaskFreeFunction freedata)
+{
+  std::lock_guard<std::mutex> lock(m_prefetch_pool_mutex);
+  if (m_prefetch_pool == nullptr) {
+    m_prefetch_pool = BLI_task_pool_create_background_serial(this, TASK_PRIORITY_LOW);
+  }
+  BLI_task_pool_push(m_prefetch_pool, run, taskdata, true, freedata);
+}
@@ -33,6 +33,9 @@
 #include <Alembic/AbcCoreOgawa/All.h>
 
 #include <fstream>
+#include <mutex>
+
+#include "BLI_task.h"
 
 struct Main;
 struct Scene;
@@ -48,8 +51,14 @@ class ArchiveReader {
   std::vector<std::istream *> m_streams;
   bool m_is_hdf5;
 
+  /* Background thread decoding samples ahead of playback, shared by all readers of the archive
+   * so the number of threads doesn't grow with the number of objects. Created on first use. */
+  TaskPool *m_prefetch_pool;
+  std::mutex m_prefetch_pool_mutex;
+
  public:
   ArchiveReader(struct Main *bmain, const char *filename);
+  ~ArchiveReader();
 
   bool valid() const;
 
@@ -62,6 +71,12 @@ class ArchiveReader {
   bool is_hdf5() const;
 
   Alembic::Abc::IObject getTop();
+
+  /**
+   * Queue a task on the prefetch thread, which can be called from multiple threads.
+   * Tasks are canceled when the archive is freed, \a freedata is called for every task.
+   */
+  void prefetch_task_push(TaskRunFunction run, void *taskdata, TaskFreeFunction freedata);
 };
 
 #endif /* __ABC_READER_ARCHIVE_H__ */
@@ -20,10 +20,14 @@
 
 #include "abc_reader_mesh.h"
 #include "abc_axis_conversion.h"
+#include "abc_reader_archive.h"
 #include "abc_reader_transform.h"
 #include "abc_util.h"
 
 #include <algorithm>
+#include <map>
+#include <mutex>
+#include <set>
 
 #include "MEM_guardedalloc.h"
 
@@ -33,6 +37,8 @@
 #include "DNA_object_types.h"
 
 #include "BLI_math_geom.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
 
 #include "BKE_main.h"
 #include "BKE_material.h"
@@ -182,6 +188,45 @@ void read_mverts(MVert *mverts, const P3fArraySamplePtr positions, const N3fArra
   }
 }
 
+/**
+ * Check whether the polygons and loops of the mesh already are the ones of the sample,
+ * this is the case when reading a mesh with constant topology onto the mesh it was imported as.
+ */
+static bool mesh_topology_matches(const CDStreamConfig &config, const AbcMeshData &mesh_data)
+{
+  const Mesh *mesh = config.mesh;
+  const Int32ArraySamplePtr &face_indices = mesh_data.face_indices;
+  const Int32ArraySamplePtr &face_counts = mesh_data.face_counts;
+
+  /* Edges are calculated from the loops, an existing mesh without them needs them built. */
+  if (mesh->totedge == 0 || mesh->totpoly != face_counts->size() ||
+      mesh->totloop != face_indices->size()) {
+    return false;
+  }
+
+  const MPoly *mpolys = config.mpoly;
+  const MLoop *mloops = config.mloop;
+  unsigned int loop_index = 0;
+
+  for (int i = 0; i < face_counts->size(); i++) {
+    const int face_size = (*face_counts)[i];
+    const MPoly &poly = mpolys[i];
+    if (poly.loopstart != loop_index || poly.totloop != face_size) {
+      return false;
+    }
+
+    /* NOTE: Alembic data is stored in the reverse order. */
+    unsigned int rev_loop_index = loop_index + (face_size - 1);
+    for (int f = 0; f < face_size; f++, loop_index++, rev_loop_index--) {
+      if (mloops[rev_loop_index].v != (*face_indices)[loop_index]) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
 {
   MPoly *mpolys = config.mpoly;
@@ -197,6 +242,13 @@ static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
 
   const bool do_uvs = (mloopuvs && uvs && uvs_indices) &&
                       (uvs_indices->size() == face_indices->size());
+  /* Comparing is much cheaper than rebuilding the edges, which dominates reading otherwise. */
+  const bool reuse_topology = mesh_topology_matches(config, mesh_data);
+
+  if (reuse_topology && !do_uvs) {
+    return;
+  }
+
   unsigned int loop_index = 0;
   unsigned int rev_loop_index = 0;
   unsigned int uv_index = 0;
@@ -216,8 +268,10 @@ static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
     rev_loop_index = loop_index + (face_size - 1);
 
     for (int f = 0; f < face_size; f++, loop_index++, rev_loop_index--) {
-      MLoop &loop = mloops[rev_loop_index];
-      loop.v = (*face_indices)[loop_index];
+      if (!reuse_topology) {
+        MLoop &loop = mloops[rev_loop_index];
+        loop.v = (*face_indices)[loop_index];
+      }
 
       if (do_uvs) {
         MLoopUV &loopuv = mloopuvs[rev_loop_index];
@@ -235,7 +289,9 @@ static void read_mpolys(CDStreamConfig &config, const AbcMeshData &mesh_data)
     }
   }
 
-  BKE_mesh_calc_edges(config.mesh, false, false);
+  if (!reuse_topology) {
+    BKE_mesh_calc_edges(config.mesh, false, false);
+  }
 }
 
 static void process_no_normals(CDStreamConfig &config)
@@ -298,14 +354,17 @@ static void process_vertex_normals(CDStreamConfig &config,
 
 static void process_normals(CDStreamConfig &config,
                             const IN3fGeomParam &normals,
-                            const ISampleSelector &selector)
+                            const ISampleSelector &selector,
+                            const AbcMeshSample &mesh_sample)
 {
   if (!normals.valid()) {
     process_no_normals(config);
     return;
   }
 
-  IN3fGeomParam::Sample normsamp = normals.getExpandedValue(selector);
+  const IN3fGeomParam::Sample normsamp = mesh_sample.has_normals ?
+                                             mesh_sample.normals :
+                                             normals.getExpandedValue(selector);
   Alembic::AbcGeom::GeometryScope scope = normals.getScope();
 
   switch (scope) {
@@ -391,26 +450,25 @@ static void get_weight_and_index(CDStreamConfig &config,
   config.ceil_index = i1;
 }
 
+/**
+ * \param ceil_positions: Positions of the sample at `config.ceil_index`,
+ * used when `config.weight` is not zero.
+ */
 static void read_mesh_sample(const std::string &iobject_full_name,
                              ImportSettings *settings,
                              const IPolyMeshSchema &schema,
                              const ISampleSelector &selector,
+                             const AbcMeshSample &mesh_sample,
+                             const P3fArraySamplePtr &ceil_positions,
                              CDStreamConfig &config)
 {
-  const IPolyMeshSchema::Sample sample = schema.getValue(selector);
+  const IPolyMeshSchema::Sample &sample = mesh_sample.sample;
 
   AbcMeshData abc_mesh_data;
   abc_mesh_data.face_counts = sample.getFaceCounts();
   abc_mesh_data.face_indices = sample.getFaceIndices();
   abc_mesh_data.positions = sample.getPositions();
-
-  get_weight_and_index(config, schema.getTimeSampling(), schema.getNumSamples());
-
-  if (config.weight != 0.0f) {
-    Alembic::AbcGeom::IPolyMeshSchema::Sample ceil_sample;
-    schema.get(ceil_sample, Alembic::Abc::ISampleSelector(config.ceil_index));
-    abc_mesh_data.ceil_positions = ceil_sample.getPositions();
-  }
+  abc_mesh_data.ceil_positions = ceil_positions;
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_UV) != 0) {
     read_uvs_params(config, abc_mesh_data, schema.getUVsParam(), selector);
@@ -422,7 +480,7 @@ static void read_mesh_sample(const std::string &iobject_full_name,
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_POLY) != 0) {
     read_mpolys(config, abc_mesh_data);
-    process_normals(config, schema.getNormalsParam(), selector);
+    process_normals(config, schema.getNormalsParam(), selector, mesh_sample);
   }
 
   if ((settings->read_flag & (MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR)) != 0) {
@@ -451,7 +509,7 @@ CDStreamConfig get_config(Mesh *mesh)
 /* ************************************************************************** */
 
 AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
-    : AbcObjectReader(object, settings)
+    : AbcObjectReader(object, settings), m_prefetch_archive(nullptr)
 {
   m_settings->read_flag |= MOD_MESHSEQ_READ_ALL;
 
@@ -461,6 +519,11 @@ AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
   get_min_max_time(m_iobject, m_schema, m_min_time, m_max_time);
 }
 
+AbcMeshReader::~AbcMeshReader()
+{
+  prefetch_detach();
+}
+
 bool AbcMeshReader::valid() const
 {
   return m_schema.valid();
@@ -513,11 +576,187 @@ bool AbcMeshReader::accepts_object_type(
   return true;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Sample Prefetching
+ *
+ * Reading a sample decodes its arrays from the archive, which dominates playback of animated
+ * meshes. Readers used by the Mesh Sequence Cache modifier read the samples following the
+ * current one on a background thread, so the next frame finds its sample already decoded.
+ * \{ */
+
+/* Number of samples decoded ahead of the one being read. */
+#define ABC_PREFETCH_SAMPLES 4
+
+/* State shared by a reader with its prefetch tasks. Tasks may still be queued on the archive
+ * when the reader is freed, they keep the state alive and return without reading then. */
+struct AbcMeshPrefetch {
+  IPolyMeshSchema schema;
+  std::mutex mutex;
+  /* Written with the mutex locked, tasks compare against it to skip stale samples. */
+  Alembic::AbcGeom::index_t last_index = -1;
+  bool is_detached = false;
+  std::map<Alembic::AbcGeom::index_t, AbcMeshSample> samples;
+  std::set<Alembic::AbcGeom::index_t> pending;
+};
+
+struct AbcMeshPrefetchTask {
+  std::shared_ptr<AbcMeshPrefetch> prefetch;
+  Alembic::AbcGeom::index_t index;
+};
+
+/* Runs on the prefetch thread, the archive supports reading from multiple threads. */
+static void mesh_prefetch_sample(AbcMeshPrefetch &prefetch, const Alembic::AbcGeom::index_t index)
+{
+  {
+    /* Skip samples queued before jumping to another frame. */
+    std::lock_guard<std::mutex> lock(prefetch.mutex);
+    if (prefetch.is_detached || index <= prefetch.last_index ||
+        index > prefetch.last_index + ABC_PREFETCH_SAMPLES) {
+      prefetch.pending.erase(index);
+      return;
+    }
+  }
+
+  AbcMeshSample mesh_sample;
+  bool is_valid = true;
+
+  try {
+    const ISampleSelector sample_sel(index);
+    prefetch.schema.get(mesh_sample.sample, sample_sel);
+
+    /* Normals with their own sampling are left to be read when used. */
+    const IN3fGeomParam normals = prefetch.schema.getNormalsParam();
+    if (normals.valid() && normals.getNumSamples() == prefetch.schema.getNumSamples()) {
+      normals.getExpanded(mesh_sample.normals, sample_sel);
+      mesh_sample.has_normals = true;
+    }
+  }
+  catch (Alembic::Util::Exception &) {
+    /* Reading the sample again when it's needed reports the error. */
+    is_valid = false;
+  }
+
+  std::lock_guard<std::mutex> lock(prefetch.mutex);
+  prefetch.pending.erase(index);
+  if (is_valid && !prefetch.is_detached) {
+    prefetch.samples[index] = mesh_sample;
+  }
+}
+
+static void mesh_prefetch_task(TaskPool *__restrict pool, void *taskdata)
+{
+  if (BLI_task_pool_canceled(pool)) {
+    return;
+  }
+  AbcMeshPrefetchTask *task = static_cast<AbcMeshPrefetchTask *>(taskdata);
+  mesh_prefetch_sample(*task->prefetch, task->index);
+}
+
+static void mesh_prefetch_task_free(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  delete static_cast<AbcMeshPrefetchTask *>(taskdata);
+}
+
+void AbcMeshReader::enable_prefetch(ArchiveReader *archive)
+{
+  m_prefetch_archive = archive;
+  m_prefetch = std::make_shared<AbcMeshPrefetch>();
+  m_prefetch->schema = m_schema;
+}
+
+/* Stop queued tasks from reading, and release the decoded samples. */
+void AbcMeshReader::prefetch_detach()
+{
+  if (m_prefetch == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_prefetch->mutex);
+    m_prefetch->is_detached = true;
+    m_prefetch->samples.clear();
+  }
+  m_prefetch.reset();
+}
+
+Alembic::AbcGeom::index_t AbcMeshReader::sample_index(const ISampleSelector &sample_sel) const
+{
+  return sample_sel.getIndex(m_schema.getTimeSampling(), m_schema.getNumSamples());
+}
+
+/* Read a sample, from the prefetched ones when available. May throw like reading the schema. */
+void AbcMeshReader::read_sample(const Alembic::AbcGeom::index_t index, AbcMeshSample &r_sample)
+{
+  if (m_prefetch != nullptr) {
+    std::lock_guard<std::mutex> lock(m_prefetch->mutex);
+    const auto it = m_prefetch->samples.find(index);
+    if (it != m_prefetch->samples.end()) {
+      r_sample = it->second;
+      return;
+    }
+  }
+
+  m_schema.get(r_sample.sample, ISampleSelector(index));
+}
+
+/* Make sure the samples following \a index are decoded or being decoded. */
+void AbcMeshReader::prefetch_schedule(const Alembic::AbcGeom::index_t index)
+{
+  const Alembic::AbcGeom::index_t samples_num = m_schema.getNumSamples();
+  if (m_prefetch == nullptr || samples_num <= 1) {
+    return;
+  }
+
+  const Alembic::AbcGeom::index_t index_last = std::min(index + ABC_PREFETCH_SAMPLES,
+                                                        samples_num - 1);
+
+  std::lock_guard<std::mutex> lock(m_prefetch->mutex);
+  if (index == m_prefetch->last_index) {
+    return;
+  }
+
+  /* The shared pool isn't canceled when jumping to another frame, instead the tasks queued for
+   * the old position return without reading. */
+  m_prefetch->last_index = index;
+
+  /* Keep the current sample, the ORCO evaluation and interpolation read it again. */
+  for (auto it = m_prefetch->samples.begin(); it != m_prefetch->samples.end();) {
+    if (it->first < index || it->first > index_last) {
+      it = m_prefetch->samples.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  for (Alembic::AbcGeom::index_t i = index + 1; i <= index_last; i++) {
+    if (m_prefetch->samples.count(i) || m_prefetch->pending.count(i)) {
+      continue;
+    }
+    m_prefetch->pending.insert(i);
+    AbcMeshPrefetchTask *task = new AbcMeshPrefetchTask{m_prefetch, i};
+    m_prefetch_archive->prefetch_task_push(mesh_prefetch_task, task, mesh_prefetch_task_free);
+  }
+}
+
+/** \} */
+
+static bool sample_topology_changed(const IPolyMeshSchema::Sample &sample,
+                                    const Mesh *existing_mesh)
+{
+  const P3fArraySamplePtr &positions = sample.getPositions();
+  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
+  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
+
+  return positions->size() != existing_mesh->totvert ||
+         face_counts->size() != existing_mesh->totpoly ||
+         face_indices->size() != existing_mesh->totloop;
+}
+
 bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector &sample_sel)
 {
-  IPolyMeshSchema::Sample sample;
+  AbcMeshSample mesh_sample;
   try {
-    sample = m_schema.getValue(sample_sel);
+    read_sample(sample_index(sample_sel), mesh_sample);
   }
   catch (Alembic::Util::Exception &ex) {
     printf("Alembic: error reading mesh sample for '%s/%s' at time %f: %s\n",
@@ -529,13 +768,7 @@ bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector
     return false;
   }
 
-  const P3fArraySamplePtr &positions = sample.getPositions();
-  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
-  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
-
-  return positions->size() != existing_mesh->totvert ||
-         face_counts->size() != existing_mesh->totpoly ||
-         face_indices->size() != existing_mesh->totloop;
+  return sample_topology_changed(mesh_sample.sample, existing_mesh);
 }
 
 Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
@@ -543,9 +776,10 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
                                int read_flag,
                                const char **err_str)
 {
-  IPolyMeshSchema::Sample sample;
+  const Alembic::AbcGeom::index_t index = sample_index(sample_sel);
+  AbcMeshSample mesh_sample;
   try {
-    sample = m_schema.getValue(sample_sel);
+    read_sample(index, mesh_sample);
   }
   catch (Alembic::Util::Exception &ex) {
     if (err_str != nullptr) {
@@ -559,6 +793,7 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
     return existing_mesh;
   }
 
+  const IPolyMeshSchema::Sample &sample = mesh_sample.sample;
   const P3fArraySamplePtr &positions = sample.getPositions();
   const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
   const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
@@ -584,7 +819,7 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   ImportSettings settings;
   settings.read_flag |= read_flag;
 
-  if (topology_changed(existing_mesh, sample_sel)) {
+  if (sample_topology_changed(sample, existing_mesh)) {
     new_mesh = BKE_mesh_new_nomain_from_template(
         existing_mesh, positions->size(), 0, 0, face_indices->size(), face_counts->size());
 
@@ -609,7 +844,29 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   CDStreamConfig config = get_config(new_mesh ? new_mesh : existing_mesh);
   config.time = sample_sel.getRequestedTime();
 
-  read_mesh_sample(m_iobject.getFullName(), &settings, m_schema, sample_sel, config);
+  get_weight_and_index(config, m_schema.getTimeSampling(), m_schema.getNumSamples());
+
+  P3fArraySamplePtr ceil_positions;
+  if (config.weight != 0.0f) {
+    AbcMeshSample ceil_sample;
+    try {
+      read_sample(config.ceil_index, ceil_sample);
+      ceil_positions = ceil_sample.sample.getPositions();
+    }
+    catch (Alembic::Util::Exception &) {
+      /* Reading failed, don't interpolate. */
+    }
+  }
+
+  read_mesh_sample(m_iobject.getFullName(),
+                   &settings,
+                   m_schema,
+                   sample_sel,
+                   mesh_sample,
+                   ceil_positions,
+                   config);
+
+  prefetch_schedule(index);
 
   if (new_mesh) {
     /* Here we assume that the number of materials doesn't change, i.e. that
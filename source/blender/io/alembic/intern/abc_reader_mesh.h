@@ -24,15 +24,31 @@
 #include "abc_customdata.h"
 #include "abc_reader_object.h"
 
+#include <memory>
+
+struct AbcMeshPrefetch;
 struct Mesh;
 
+/** A mesh sample which is read completely, so using it doesn't access the archive. */
+struct AbcMeshSample {
+  Alembic::AbcGeom::IPolyMeshSchema::Sample sample;
+  Alembic::AbcGeom::IN3fGeomParam::Sample normals;
+  bool has_normals = false;
+};
+
 class AbcMeshReader : public AbcObjectReader {
   Alembic::AbcGeom::IPolyMeshSchema m_schema;
 
   CDStreamConfig m_mesh_data;
 
+  /* Samples following the last one read are decoded on the prefetch thread of the archive
+   * during playback, NULL when not used. */
+  ArchiveReader *m_prefetch_archive;
+  std::shared_ptr<AbcMeshPrefetch> m_prefetch;
+
  public:
   AbcMeshReader(const Alembic::Abc::IObject &object, ImportSettings &settings);
+  ~AbcMeshReader();
 
   bool valid() const override;
   bool accepts_object_type(const Alembic::AbcCoreAbstract::ObjectHeader &alembic_header,
@@ -47,7 +63,14 @@ class AbcMeshReader : public AbcObjectReader {
   bool topology_changed(Mesh *existing_mesh,
                         const Alembic::Abc::ISampleSelector &sample_sel) override;
 
+  void enable_prefetch(ArchiveReader *archive) override;
+
  private:
+  Alembic::AbcGeom::index_t sample_index(const Alembic::Abc::ISampleSelector &sample_sel) const;
+  void read_sample(const Alembic::AbcGeom::index_t index, AbcMeshSample &r_sample);
+  void prefetch_schedule(const Alembic::AbcGeom::index_t index);
+  void prefetch_detach();
+
   void readFaceSetsSample(Main *bmain,
                           Mesh *mesh,
                           const Alembic::AbcGeom::ISampleSelector &sample_sel);
@@ -26,6 +26,7 @@
 
 #include "DNA_ID.h"
 
+class ArchiveReader;
 struct CacheFile;
 struct Main;
 struct Mesh;
@@ -146,6 +147,11 @@ class AbcObjectReader {
   virtual bool topology_changed(Mesh *existing_mesh,
                                 const Alembic::Abc::ISampleSelector &sample_sel);
 
+  /** Decode upcoming samples in the background, for readers which are used for playback. */
+  virtual void enable_prefetch(ArchiveReader * /*archive*/)
+  {
+  }
+
   /** Reads the object matrix and sets up an object transform if animated. */
   void setupObjectTransform(const float time);
 
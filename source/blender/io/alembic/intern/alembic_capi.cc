@@ -1065,5 +1065,10 @@ CacheReader *CacheReader_open_alembic_object(AbcArchiveHandle *handle,
   abc_reader->object(object);
   abc_reader->incref();
 
+  /* These readers are used for playback. HDF5 archives can't be read from multiple threads. */
+  if (!archive->is_hdf5()) {
+    abc_reader->enable_prefetch(archive);
+  }
+
   return reinterpret_cast<CacheReader *>(abc_reader);
 }
@@ -105,6 +105,14 @@ typedef struct Mesh_Runtime {
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
+  /** Flattened vertex group weights, see #BKE_mesh_runtime_deform_weights_ensure. */
+  struct MeshDeformWeights *deform_weights;
+
+  /** Cached adjacency maps, see #BKE_mesh_runtime_vert_poly_map_ensure. */
+  struct MeshTopologyMaps *topology_maps;
+  /** Protects #topology_maps, a `ThreadRWMutex`. */
+  void *topology_maps_lock;
+
   /** Set by modifier stack if only deformed from original. */
   char deformed_only;
   /**
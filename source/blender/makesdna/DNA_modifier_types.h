@@ -123,6 +123,11 @@ typedef struct ModifierData {
   /* Pointer to a ModifierData in the original domain. */
   struct ModifierData *orig_modifier_data;
   void *runtime;
+
+  /** Session-wise unique value, renewed when settings of the original modifier are changed,
+   * see #BKE_modifier_settings_tag_changed. */
+  unsigned int settings_update_id;
+  char _pad1[4];
 } ModifierData;
 
 typedef enum {
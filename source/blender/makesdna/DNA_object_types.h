@@ -119,6 +119,7 @@ typedef struct LodLevel {
 } LodLevel;
 
 struct CustomData_MeshMasks;
+struct ModifierStackCache;
 
 /* Not saved in file! */
 typedef struct Object_Runtime {
@@ -187,6 +188,18 @@ typedef struct Object_Runtime {
   /** Runtime evaluated curve-specific data, not stored in the file. */
   struct CurveCache *curve_cache;
 
+  /**
+   * Intermediate results of the modifier stack, used to resume evaluation after the last
+   * unchanged modifier when interactively tweaking modifiers.
+   */
+  struct ModifierStackCache *modifier_stack_cache;
+
+  /**
+   * Playback cache entry owning data_eval and mesh_deform_eval, when they are read from or stored
+   * in the cache. Released when the evaluated data is freed.
+   */
+  struct MeshPlaybackCacheEntry *mesh_playback_cache_entry;
+
   unsigned short local_collections_bits;
   short _pad2[3];
 } Object_Runtime;
@@ -732,7 +732,8 @@ typedef struct UserDef {
   short gp_manhattendist, gp_euclideandist, gp_eraser;
   /** #eGP_UserdefSettings. */
   short gp_settings;
-  char _pad13[4];
+  /** Memory limit of cached intermediate modifier results in megabytes, zero disables it. */
+  int modifier_cachelimit;
   struct SolidLight light_param[4];
   float light_ambient[3];
   char _pad3[4];
@@ -746,7 +747,8 @@ typedef struct UserDef {
   int prefetchframes;
   /** Control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use. */
   float pad_rot_angle;
-  char _pad12[4];
+  /** Memory limit of the evaluated geometry playback cache in megabytes, zero disables it. */
+  int geometry_cachelimit;
   /** Rotating view icon size. */
   short rvisize;
   /** Rotating view icon brightness. */
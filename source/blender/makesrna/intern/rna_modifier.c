@@ -759,6 +759,11 @@ static char *rna_Modifier_path(PointerRNA *ptr)
 
 static void rna_Modifier_update(Main *UNUSED(bmain), Scene *UNUSED(scene), PointerRNA *ptr)
 {
+  /* Nested structs have no modifier to tag, the geometry tag of the object invalidates the
+   * whole modifier stack cache then. */
+  if (RNA_struct_is_a(ptr->type, &RNA_Modifier)) {
+    BKE_modifier_settings_tag_changed(ptr->data);
+  }
   DEG_id_tag_update(ptr->owner_id, ID_RECALC_GEOMETRY);
   WM_main_add_notifier(NC_OBJECT | ND_MODIFIER, ptr->owner_id);
 }
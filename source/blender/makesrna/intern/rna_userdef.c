@@ -180,6 +180,7 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 #  include "BKE_global.h"
 #  include "BKE_idprop.h"
 #  include "BKE_main.h"
+#  include "BKE_mesh_playback_cache.h"
 #  include "BKE_mesh_runtime.h"
 #  include "BKE_paint.h"
 #  include "BKE_pbvh.h"
@@ -551,6 +552,14 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
   USERDEF_TAG_DIRTY;
 }
 
+static void rna_Userdef_geometry_cache_update(Main *UNUSED(bmain),
+                                              Scene *UNUSED(scene),
+                                              PointerRNA *UNUSED(ptr))
+{
+  BKE_mesh_playback_cache_limit_update();
+  USERDEF_TAG_DIRTY;
+}
+
 static void rna_Userdef_disk_cache_dir_update(Main *UNUSED(bmain),
                                               Scene *UNUSED(scene),
                                               PointerRNA *UNUSED(ptr))
@@ -5257,6 +5266,26 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "geometry_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "geometry_cachelimit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Geometry Cache Limit",
+                           "Memory limit for caching evaluated meshes of unchanged objects during "
+                           "animation playback (in megabytes), zero disables the cache");
+  RNA_def_property_update(prop, 0, "rna_Userdef_geometry_cache_update");
+
+  prop = RNA_def_property(srna, "modifier_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "modifier_cachelimit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Modifier Cache Limit",
+                           "Memory limit for intermediate modifier results of the active object, "
+                           "used to avoid re-evaluating unchanged modifiers while tweaking "
+                           "settings, and for each subdivided mesh of deforming objects "
+                           "(in megabytes), zero disables the caches");
+  RNA_def_property_update(prop, 0, "rna_userdef_update");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -28,6 +28,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_curve_types.h"
 #include "DNA_mesh_types.h"
@@ -147,42 +148,38 @@ static void svert_from_mvert(SortVertsElem *sv,
 }
 
 /**
- * Take as inputs two sets of verts, to be processed for detection of doubles and mapping.
- * Each set of verts is defined by its start within mverts array and its num_verts;
- * It builds a mapping for all vertices within source,
- * to vertices within target, or -1 if no double found.
- * The int doubles_map[num_verts_source] array must have been allocated by caller.
+ * Build an array of the given set of verts, sorted according to sum of vertex coordinates
+ * (sumco), to be tested for merging.
  */
-static void dm_mvert_map_doubles(int *doubles_map,
-                                 const MVert *mverts,
-                                 const int target_start,
-                                 const int target_num_verts,
-                                 const int source_start,
-                                 const int source_num_verts,
-                                 const float dist)
+static SortVertsElem *svert_sorted_create(const MVert *mverts,
+                                          const int start,
+                                          const int num_verts)
 {
-  const float dist3 = ((float)M_SQRT3 + 0.00005f) * dist; /* Just above sqrt(3) */
-  int i_source, i_target, i_target_low_bound, target_end, source_end;
-  SortVertsElem *sorted_verts_target, *sorted_verts_source;
-  SortVertsElem *sve_source, *sve_target, *sve_target_low_bound;
-  bool target_scan_completed;
-
-  target_end = target_start + target_num_verts;
-  source_end = source_start + source_num_verts;
+  SortVertsElem *sorted_verts = MEM_malloc_arrayN(num_verts, sizeof(SortVertsElem), __func__);
 
-  /* build array of MVerts to be tested for merging */
-  sorted_verts_target = MEM_malloc_arrayN(target_num_verts, sizeof(SortVertsElem), __func__);
-  sorted_verts_source = MEM_malloc_arrayN(source_num_verts, sizeof(SortVertsElem), __func__);
+  /* Copy vertices index and cos into SortVertsElem array */
+  svert_from_mvert(sorted_verts, mverts + start, start, start + num_verts);
 
-  /* Copy target vertices index and cos into SortVertsElem array */
-  svert_from_mvert(sorted_verts_target, mverts + target_start, target_start, target_end);
+  qsort(sorted_verts, num_verts, sizeof(SortVertsElem), svert_sum_cmp);
 
-  /* Copy source vertices index and cos into SortVertsElem array */
-  svert_from_mvert(sorted_verts_source, mverts + source_start, source_start, source_end);
+  return sorted_verts;
+}
 
-  /* sort arrays according to sum of vertex coordinates (sumco) */
-  qsort(sorted_verts_target, target_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
-  qsort(sorted_verts_source, source_num_verts, sizeof(SortVertsElem), svert_sum_cmp);
+/**
+ * Same as #dm_mvert_map_doubles, with both sets of verts already sorted by #svert_sorted_create.
+ */
+static void dm_mvert_map_doubles_sorted(int *doubles_map,
+                                        const MVert *mverts,
+                                        const SortVertsElem *sorted_verts_target,
+                                        const int target_num_verts,
+                                        const SortVertsElem *sorted_verts_source,
+                                        const int source_num_verts,
+                                        const float dist)
+{
+  const float dist3 = ((float)M_SQRT3 + 0.00005f) * dist; /* Just above sqrt(3) */
+  int i_source, i_target, i_target_low_bound;
+  const SortVertsElem *sve_source, *sve_target, *sve_target_low_bound;
+  bool target_scan_completed;
 
   sve_target_low_bound = sorted_verts_target;
   i_target_low_bound = 0;
@@ -262,6 +259,35 @@ static void dm_mvert_map_doubles(int *doubles_map,
     /* End of candidate scan: if none found then no doubles */
     doubles_map[sve_source->vertex_num] = best_target_vertex;
   }
+}
+
+/**
+ * Take as inputs two sets of verts, to be processed for detection of doubles and mapping.
+ * Each set of verts is defined by its start within mverts array and its num_verts;
+ * It builds a mapping for all vertices within source,
+ * to vertices within target, or -1 if no double found.
+ * The int doubles_map[num_verts_source] array must have been allocated by caller.
+ */
+static void dm_mvert_map_doubles(int *doubles_map,
+                                 const MVert *mverts,
+                                 const int target_start,
+                                 const int target_num_verts,
+                                 const int source_start,
+                                 const int source_num_verts,
+                                 const float dist)
+{
+  SortVertsElem *sorted_verts_target = svert_sorted_create(
+      mverts, target_start, target_num_verts);
+  SortVertsElem *sorted_verts_source = svert_sorted_create(
+      mverts, source_start, source_num_verts);
+
+  dm_mvert_map_doubles_sorted(doubles_map,
+                              mverts,
+                              sorted_verts_target,
+                              target_num_verts,
+                              sorted_verts_source,
+                              source_num_verts,
+                              dist);
 
   MEM_freeN(sorted_verts_source);
   MEM_freeN(sorted_verts_target);
@@ -349,16 +375,158 @@ static void mesh_merge_transform(Mesh *result,
   }
 }
 
+typedef struct ArrayChunkData {
+  const Mesh *mesh;
+  Mesh *result;
+  /* Cumulative offset of every copy. */
+  const float (*chunk_offsets)[4][4];
+  int chunk_nverts, chunk_nedges, chunk_nloops, chunk_npolys;
+  bool use_recalc_normals;
+  float uv_offset[2];
+} ArrayChunkData;
+
+/* Copy of the source mesh, each one writes to its own range of the result. */
+static void array_chunk_copy_cb(void *__restrict userdata,
+                                const int c,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArrayChunkData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  Mesh *result = data->result;
+  const float(*current_offset)[4] = data->chunk_offsets[c];
+  const int chunk_nverts = data->chunk_nverts;
+  const int chunk_nedges = data->chunk_nedges;
+  const int chunk_nloops = data->chunk_nloops;
+  const int chunk_npolys = data->chunk_npolys;
+  MVert *mv;
+  MEdge *me;
+  MLoop *ml;
+  MPoly *mp;
+  int i;
+
+  /* copy customdata to new geometry */
+  CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
+  CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
+  CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
+  CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
+
+  /* apply offset to all new verts */
+  mv = result->mvert + c * chunk_nverts;
+  for (i = 0; i < chunk_nverts; i++, mv++) {
+    mul_m4_v3(current_offset, mv->co);
+
+    /* We have to correct normals too, if we do not tag them as dirty! */
+    if (!data->use_recalc_normals) {
+      float no[3];
+      normal_short_to_float_v3(no, mv->no);
+      mul_mat3_m4_v3(current_offset, no);
+      normalize_v3(no);
+      normal_float_to_short_v3(mv->no, no);
+    }
+  }
+
+  /* adjust edge vertex indices */
+  me = result->medge + c * chunk_nedges;
+  for (i = 0; i < chunk_nedges; i++, me++) {
+    me->v1 += c * chunk_nverts;
+    me->v2 += c * chunk_nverts;
+  }
+
+  mp = result->mpoly + c * chunk_npolys;
+  for (i = 0; i < chunk_npolys; i++, mp++) {
+    mp->loopstart += c * chunk_nloops;
+  }
+
+  /* adjust loop vertex and edge indices */
+  ml = result->mloop + c * chunk_nloops;
+  for (i = 0; i < chunk_nloops; i++, ml++) {
+    ml->v += c * chunk_nverts;
+    ml->e += c * chunk_nedges;
+  }
+
+  /* handle UVs */
+  if (chunk_nloops > 0 && is_zero_v2(data->uv_offset) == false) {
+    const float uv_offset[2] = {
+        data->uv_offset[0] * (float)c,
+        data->uv_offset[1] * (float)c,
+    };
+    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
+    for (i = 0; i < totuv; i++) {
+      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
+      dmloopuv += c * chunk_nloops;
+      int l_index = chunk_nloops;
+      for (; l_index-- != 0; dmloopuv++) {
+        dmloopuv->uv[0] += uv_offset[0];
+        dmloopuv->uv[1] += uv_offset[1];
+      }
+    }
+  }
+}
+
+typedef struct ArrayChunkSortData {
+  const MVert *mverts;
+  SortVertsElem **sorted_chunks;
+  int chunk_nverts;
+} ArrayChunkSortData;
+
+static void array_chunk_sort_cb(void *__restrict userdata,
+                                const int c,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArrayChunkSortData *data = userdata;
+  data->sorted_chunks[c] = svert_sorted_create(
+      data->mverts, c * data->chunk_nverts, data->chunk_nverts);
+}
+
+/**
+ * Map doubles between every copy and the previous one, when the offset is scaling the copies.
+ * All pairs need a full search then, copies are sorted in parallel (in batches, to limit memory
+ * usage), while the mapping itself stays serial since it follows the mapping of previous copies.
+ */
+static void array_map_doubles_scaled(int *full_doubles_map,
+                                     const MVert *mverts,
+                                     const int count,
+                                     const int chunk_nverts,
+                                     const float merge_dist)
+{
+  const int batch_size = 64;
+  SortVertsElem **sorted_chunks = MEM_calloc_arrayN(count, sizeof(*sorted_chunks), __func__);
+  ArrayChunkSortData data = {
+      .mverts = mverts,
+      .sorted_chunks = sorted_chunks,
+      .chunk_nverts = chunk_nverts,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (chunk_nverts > 1000);
+
+  for (int batch_start = 0; batch_start < count; batch_start += batch_size) {
+    const int batch_end = min_ii(batch_start + batch_size, count);
+    BLI_task_parallel_range(batch_start, batch_end, &data, array_chunk_sort_cb, &settings);
+
+    for (int c = max_ii(batch_start, 1); c < batch_end; c++) {
+      dm_mvert_map_doubles_sorted(full_doubles_map,
+                                  mverts,
+                                  sorted_chunks[c - 1],
+                                  chunk_nverts,
+                                  sorted_chunks[c],
+                                  chunk_nverts,
+                                  merge_dist);
+      MEM_freeN(sorted_chunks[c - 1]);
+    }
+  }
+  MEM_freeN(sorted_chunks[count - 1]);
+  MEM_freeN(sorted_chunks);
+}
+
 static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                                    const ModifierEvalContext *ctx,
                                    Mesh *mesh)
 {
   const MVert *src_mvert;
-  MVert *mv, *mv_prev, *result_dm_verts;
+  MVert *result_dm_verts;
 
-  MEdge *me;
-  MLoop *ml;
-  MPoly *mp;
   int i, j, c, count;
   float length = amd->length;
   /* offset matrix */
@@ -563,56 +731,51 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
   first_chunk_start = 0;
   first_chunk_nverts = chunk_nverts;
 
-  unit_m4(current_offset);
+  /* Cumulative offset of every copy, computed up-front so the copies are independent. */
+  float(*chunk_offsets)[4][4] = MEM_malloc_arrayN(count, sizeof(*chunk_offsets), __func__);
+  unit_m4(chunk_offsets[0]);
   for (c = 1; c < count; c++) {
-    /* copy customdata to new geometry */
-    CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
-    CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
-    CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
-    CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
-
-    mv_prev = result_dm_verts;
-    mv = mv_prev + c * chunk_nverts;
-
-    /* recalculate cumulative offset here */
-    mul_m4_m4m4(current_offset, current_offset, offset);
-
-    /* apply offset to all new verts */
-    for (i = 0; i < chunk_nverts; i++, mv++, mv_prev++) {
-      mul_m4_v3(current_offset, mv->co);
-
-      /* We have to correct normals too, if we do not tag them as dirty! */
-      if (!use_recalc_normals) {
-        float no[3];
-        normal_short_to_float_v3(no, mv->no);
-        mul_mat3_m4_v3(current_offset, no);
-        normalize_v3(no);
-        normal_float_to_short_v3(mv->no, no);
-      }
-    }
-
-    /* adjust edge vertex indices */
-    me = result->medge + c * chunk_nedges;
-    for (i = 0; i < chunk_nedges; i++, me++) {
-      me->v1 += c * chunk_nverts;
-      me->v2 += c * chunk_nverts;
-    }
-
-    mp = result->mpoly + c * chunk_npolys;
-    for (i = 0; i < chunk_npolys; i++, mp++) {
-      mp->loopstart += c * chunk_nloops;
-    }
-
-    /* adjust loop vertex and edge indices */
-    ml = result->mloop + c * chunk_nloops;
-    for (i = 0; i < chunk_nloops; i++, ml++) {
-      ml->v += c * chunk_nverts;
-      ml->e += c * chunk_nedges;
+    mul_m4_m4m4(chunk_offsets[c], chunk_offsets[c - 1], offset);
+  }
+  copy_m4_m4(current_offset, chunk_offsets[count - 1]);
+
+  {
+    ArrayChunkData data = {
+        .mesh = mesh,
+        .result = result,
+        .chunk_offsets = (const float(*)[4][4])chunk_offsets,
+        .chunk_nverts = chunk_nverts,
+        .chunk_nedges = chunk_nedges,
+        .chunk_nloops = chunk_nloops,
+        .chunk_npolys = chunk_npolys,
+        .use_recalc_normals = use_recalc_normals,
+        .uv_offset = {amd->uv_offset[0], amd->uv_offset[1]},
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = ((size_t)count * (size_t)chunk_nverts > 10000);
+    BLI_task_parallel_range(1, count, &data, array_chunk_copy_cb, &settings);
+  }
+
+  MEM_freeN(chunk_offsets);
+
+  /* Handle merge between chunk n and n-1 */
+  if (use_merge && (count > 1)) {
+    if (offset_has_scale) {
+      array_map_doubles_scaled(
+          full_doubles_map, result_dm_verts, count, chunk_nverts, amd->merge_dist);
     }
+    else {
+      dm_mvert_map_doubles(full_doubles_map,
+                           result_dm_verts,
+                           0,
+                           chunk_nverts,
+                           chunk_nverts,
+                           chunk_nverts,
+                           amd->merge_dist);
 
-    /* Handle merge between chunk n and n-1 */
-    if (use_merge && (c >= 1)) {
-      if (!offset_has_scale && (c >= 2)) {
+      for (c = 2; c < count; c++) {
         /* Mapping chunk 3 to chunk 2 is a translation of mapping 2 to 1
          * ... that is except if scaling makes the distance grow */
         int k;
@@ -638,35 +801,6 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
           full_doubles_map[this_chunk_index] = target;
         }
       }
-      else {
-        dm_mvert_map_doubles(full_doubles_map,
-                             result_dm_verts,
-                             (c - 1) * chunk_nverts,
-                             chunk_nverts,
-                             c * chunk_nverts,
-                             chunk_nverts,
-                             amd->merge_dist);
-      }
-    }
-  }
-
-  /* handle UVs */
-  if (chunk_nloops > 0 && is_zero_v2(amd->uv_offset) == false) {
-    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
-    for (i = 0; i < totuv; i++) {
-      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
-      dmloopuv += chunk_nloops;
-      for (c = 1; c < count; c++) {
-        const float uv_offset[2] = {
-            amd->uv_offset[0] * (float)c,
-            amd->uv_offset[1] * (float)c,
-        };
-        int l_index = chunk_nloops;
-        for (; l_index-- != 0; dmloopuv++) {
-          dmloopuv->uv[0] += uv_offset[0];
-          dmloopuv->uv[1] += uv_offset[1];
-        }
-      }
     }
   }
 
@@ -26,6 +26,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -38,6 +39,7 @@
 #include "BKE_editmesh.h"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 
 #include "MOD_modifiertypes.h"
 #include "MOD_util.h"
@@ -53,8 +55,24 @@
 #  include "PIL_time_utildefines.h"
 #endif
 
-/* minor optimization, calculate this inline */
-#define USE_TANGENT_CALC_INLINE
+/* Vertex-centric adjacency of the mesh, so the smoothing and tangent-space passes can gather
+ * from neighbors instead of scattering into shared accumulators, which allows threading.
+ * Stored in #ModifierData.runtime and re-used as long as the topology doesn't change. */
+typedef struct CorrectiveSmoothTopology {
+  /* Vertices connected to every vertex by an edge, in edge order. */
+  MeshElemMap *vert_edge_map;
+  int *vert_edge_mem;
+  /* Loops using every vertex, in face order. */
+  MeshElemMap *vert_loop_map;
+  int *vert_loop_mem;
+  /* Previous and next vertex of every loop in its face. */
+  int (*loop_adjacent_verts)[2];
+
+  /* Topology the adjacency was built from. */
+  const MEdge *medge;
+  const MLoop *mloop;
+  int totvert, totedge, totloop, totpoly;
+} CorrectiveSmoothTopology;
 
 static void initData(ModifierData *md)
 {
@@ -97,10 +115,31 @@ static void freeBind(CorrectiveSmoothModifierData *csmd)
   csmd->bind_coords_num = 0;
 }
 
+static void topology_free_data(CorrectiveSmoothTopology *topology)
+{
+  MEM_SAFE_FREE(topology->vert_edge_map);
+  MEM_SAFE_FREE(topology->vert_edge_mem);
+  MEM_SAFE_FREE(topology->vert_loop_map);
+  MEM_SAFE_FREE(topology->vert_loop_mem);
+  MEM_SAFE_FREE(topology->loop_adjacent_verts);
+}
+
+static void freeRuntimeData(void *runtime_data_v)
+{
+  if (runtime_data_v == NULL) {
+    return;
+  }
+  CorrectiveSmoothTopology *topology = (CorrectiveSmoothTopology *)runtime_data_v;
+  topology_free_data(topology);
+  MEM_freeN(topology);
+}
+
 static void freeData(ModifierData *md)
 {
   CorrectiveSmoothModifierData *csmd = (CorrectiveSmoothModifierData *)md;
   freeBind(csmd);
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
@@ -169,14 +208,121 @@ static void mesh_get_boundaries(Mesh *mesh, float *smooth_weights)
   MEM_freeN(boundaries);
 }
 
+/* -------------------------------------------------------------------- */
+/* Topology Cache
+ */
+
+static void topology_build(CorrectiveSmoothTopology *topology, Mesh *mesh)
+{
+  const MPoly *mpoly = mesh->mpoly;
+  const MLoop *mloop = mesh->mloop;
+
+  topology_free_data(topology);
+
+  topology->medge = mesh->medge;
+  topology->mloop = mesh->mloop;
+  topology->totvert = mesh->totvert;
+  topology->totedge = mesh->totedge;
+  topology->totloop = mesh->totloop;
+  topology->totpoly = mesh->totpoly;
+
+  BKE_mesh_vert_edge_vert_map_create(&topology->vert_edge_map,
+                                     &topology->vert_edge_mem,
+                                     mesh->medge,
+                                     mesh->totvert,
+                                     mesh->totedge);
+  BKE_mesh_vert_loop_map_create(&topology->vert_loop_map,
+                                &topology->vert_loop_mem,
+                                mesh->mpoly,
+                                mesh->mloop,
+                                mesh->totvert,
+                                mesh->totpoly,
+                                mesh->totloop);
+
+  int(*loop_adjacent_verts)[2] = MEM_malloc_arrayN(
+      (size_t)mesh->totloop, sizeof(*loop_adjacent_verts), __func__);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mpoly[i];
+    const int loop_last = mp->loopstart + mp->totloop - 1;
+    for (int j = mp->loopstart; j <= loop_last; j++) {
+      loop_adjacent_verts[j][0] = (int)mloop[(j == mp->loopstart) ? loop_last : j - 1].v;
+      loop_adjacent_verts[j][1] = (int)mloop[(j == loop_last) ? mp->loopstart : j + 1].v;
+    }
+  }
+  topology->loop_adjacent_verts = loop_adjacent_verts;
+}
+
+static bool topology_is_valid(const CorrectiveSmoothTopology *topology, const Mesh *mesh)
+{
+  return (topology->vert_edge_map != NULL && topology->medge == mesh->medge &&
+          topology->mloop == mesh->mloop && topology->totvert == mesh->totvert &&
+          topology->totedge == mesh->totedge && topology->totloop == mesh->totloop &&
+          topology->totpoly == mesh->totpoly);
+}
+
+/**
+ * \param use_cache: Re-use the adjacency from the previous evaluation, only safe when the mesh
+ * is the original mesh data (no edit-mode or generated mesh), since then topology changes are
+ * reported by the dependency graph.
+ */
+static const CorrectiveSmoothTopology *topology_ensure(ModifierData *md,
+                                                       Object *ob,
+                                                       Mesh *mesh,
+                                                       const bool use_cache)
+{
+  CorrectiveSmoothTopology *topology = (CorrectiveSmoothTopology *)md->runtime;
+  if (topology == NULL) {
+    topology = MEM_callocN(sizeof(*topology), "corrective smooth topology");
+    md->runtime = topology;
+  }
+  else if (use_cache && topology_is_valid(topology, mesh) &&
+           (((ID *)ob->data)->recalc & ID_RECALC_ALL) == 0) {
+    return topology;
+  }
+  topology_build(topology, mesh);
+  return topology;
+}
+
 /* -------------------------------------------------------------------- */
 /* Simple Weighted Smoothing
  *
  * (average of surrounding verts)
  */
+
+typedef struct SmoothIterData {
+  const CorrectiveSmoothTopology *topology;
+  const float (*co_src)[3];
+  float (*co_dst)[3];
+  /* Simple smoothing. */
+  const float *vertex_edge_count_div;
+  /* Length weighted smoothing. */
+  const float *smooth_weights;
+  float lambda;
+} SmoothIterData;
+
+static void smooth_iter__simple_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SmoothIterData *data = userdata;
+  const MeshElemMap *vert_edges = &data->topology->vert_edge_map[i];
+  const float(*co_src)[3] = data->co_src;
+  float delta[3] = {0.0f, 0.0f, 0.0f};
+
+  /* Neighbors are in edge order, so the sum matches accumulating over all edges. */
+  for (int j = 0; j < vert_edges->count; j++) {
+    float edge_dir[3];
+    sub_v3_v3v3(edge_dir, co_src[vert_edges->indices[j]], co_src[i]);
+    add_v3_v3(delta, edge_dir);
+  }
+
+  madd_v3_v3v3fl(data->co_dst[i], co_src[i], delta, data->vertex_edge_count_div[i]);
+}
+
 static void smooth_iter__simple(CorrectiveSmoothModifierData *csmd,
-                                Mesh *mesh,
+                                const CorrectiveSmoothTopology *topology,
                                 float (*vertexCos)[3],
+                                float (*vertexCos_tmp)[3],
                                 uint numVerts,
                                 const float *smooth_weights,
                                 uint iterations)
@@ -184,186 +330,161 @@ static void smooth_iter__simple(CorrectiveSmoothModifierData *csmd,
   const float lambda = csmd->lambda;
   uint i;
 
-  const uint numEdges = (uint)mesh->totedge;
-  const MEdge *edges = mesh->medge;
-  float *vertex_edge_count_div;
-
-  struct SmoothingData_Simple {
-    float delta[3];
-  } *smooth_data = MEM_calloc_arrayN(numVerts, sizeof(*smooth_data), __func__);
-
-  vertex_edge_count_div = MEM_calloc_arrayN(numVerts, sizeof(float), __func__);
-
-  /* calculate as floats to avoid int->float conversion in #smooth_iter */
-  for (i = 0; i < numEdges; i++) {
-    vertex_edge_count_div[edges[i].v1] += 1.0f;
-    vertex_edge_count_div[edges[i].v2] += 1.0f;
-  }
+  float *vertex_edge_count_div = MEM_malloc_arrayN(numVerts, sizeof(float), __func__);
 
   /* a little confusing, but we can include 'lambda' and smoothing weight
    * here to avoid multiplying for every iteration */
   if (smooth_weights == NULL) {
     for (i = 0; i < numVerts; i++) {
-      vertex_edge_count_div[i] = lambda * (vertex_edge_count_div[i] ?
-                                               (1.0f / vertex_edge_count_div[i]) :
-                                               1.0f);
+      const float count = (float)topology->vert_edge_map[i].count;
+      vertex_edge_count_div[i] = lambda * (count ? (1.0f / count) : 1.0f);
     }
   }
   else {
     for (i = 0; i < numVerts; i++) {
-      vertex_edge_count_div[i] = smooth_weights[i] * lambda *
-                                 (vertex_edge_count_div[i] ? (1.0f / vertex_edge_count_div[i]) :
-                                                             1.0f);
+      const float count = (float)topology->vert_edge_map[i].count;
+      vertex_edge_count_div[i] = smooth_weights[i] * lambda * (count ? (1.0f / count) : 1.0f);
     }
   }
 
   /* -------------------------------------------------------------------- */
   /* Main Smoothing Loop */
 
-  while (iterations--) {
-    for (i = 0; i < numEdges; i++) {
-      struct SmoothingData_Simple *sd_v1;
-      struct SmoothingData_Simple *sd_v2;
-      float edge_dir[3];
-
-      sub_v3_v3v3(edge_dir, vertexCos[edges[i].v2], vertexCos[edges[i].v1]);
+  SmoothIterData data = {
+      .topology = topology,
+      .vertex_edge_count_div = vertex_edge_count_div,
+  };
 
-      sd_v1 = &smooth_data[edges[i].v1];
-      sd_v2 = &smooth_data[edges[i].v2];
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numVerts > 10000);
 
-      add_v3_v3(sd_v1->delta, edge_dir);
-      sub_v3_v3(sd_v2->delta, edge_dir);
-    }
+  /* Jacobi iterations, reading from one buffer and writing to the other. */
+  float(*co_src)[3] = vertexCos;
+  float(*co_dst)[3] = vertexCos_tmp;
+  while (iterations--) {
+    data.co_src = (const float(*)[3])co_src;
+    data.co_dst = co_dst;
+    BLI_task_parallel_range(0, (int)numVerts, &data, smooth_iter__simple_cb, &settings);
+    float(*co_swap)[3] = co_src;
+    co_src = co_dst;
+    co_dst = co_swap;
+  }
 
-    for (i = 0; i < numVerts; i++) {
-      struct SmoothingData_Simple *sd = &smooth_data[i];
-      madd_v3_v3fl(vertexCos[i], sd->delta, vertex_edge_count_div[i]);
-      /* zero for the next iteration (saves memset on entire array) */
-      memset(sd, 0, sizeof(*sd));
-    }
+  if (co_src != vertexCos) {
+    memcpy(vertexCos, co_src, sizeof(*vertexCos) * numVerts);
   }
 
   MEM_freeN(vertex_edge_count_div);
-  MEM_freeN(smooth_data);
 }
 
 /* -------------------------------------------------------------------- */
 /* Edge-Length Weighted Smoothing
  */
+
+static void smooth_iter__length_weight_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const float eps = FLT_EPSILON * 10.0f;
+  const SmoothIterData *data = userdata;
+  const MeshElemMap *vert_edges = &data->topology->vert_edge_map[i];
+  const float(*co_src)[3] = data->co_src;
+  float delta[3] = {0.0f, 0.0f, 0.0f};
+  float edge_length_sum = 0.0f;
+
+  for (int j = 0; j < vert_edges->count; j++) {
+    float edge_dir[3];
+    float edge_dist;
+
+    sub_v3_v3v3(edge_dir, co_src[vert_edges->indices[j]], co_src[i]);
+    edge_dist = len_v3(edge_dir);
+
+    /* weight by distance */
+    madd_v3_v3fl(delta, edge_dir, edge_dist);
+    edge_length_sum += edge_dist;
+  }
+
+  /* Divide by sum of all neighbor distances (weighted) and amount of neighbors,
+   * (mean average). */
+  const float div = edge_length_sum * (float)vert_edges->count;
+  if (div > eps) {
+    const float lambda_w = data->smooth_weights ? data->lambda * data->smooth_weights[i] :
+                                                  data->lambda;
+    /* first calculate the new location, then interpolate, in one step */
+    madd_v3_v3v3fl(data->co_dst[i], co_src[i], delta, lambda_w / div);
+  }
+  else {
+    copy_v3_v3(data->co_dst[i], co_src[i]);
+  }
+}
+
 static void smooth_iter__length_weight(CorrectiveSmoothModifierData *csmd,
-                                       Mesh *mesh,
+                                       const CorrectiveSmoothTopology *topology,
                                        float (*vertexCos)[3],
+                                       float (*vertexCos_tmp)[3],
                                        uint numVerts,
                                        const float *smooth_weights,
                                        uint iterations)
 {
-  const float eps = FLT_EPSILON * 10.0f;
-  const uint numEdges = (uint)mesh->totedge;
   /* note: the way this smoothing method works, its approx half as strong as the simple-smooth,
    * and 2.0 rarely spikes, double the value for consistent behavior. */
-  const float lambda = csmd->lambda * 2.0f;
-  const MEdge *edges = mesh->medge;
-  float *vertex_edge_count;
-  uint i;
-
-  struct SmoothingData_Weighted {
-    float delta[3];
-    float edge_length_sum;
-  } *smooth_data = MEM_calloc_arrayN(numVerts, sizeof(*smooth_data), __func__);
-
-  /* calculate as floats to avoid int->float conversion in #smooth_iter */
-  vertex_edge_count = MEM_calloc_arrayN(numVerts, sizeof(float), __func__);
-  for (i = 0; i < numEdges; i++) {
-    vertex_edge_count[edges[i].v1] += 1.0f;
-    vertex_edge_count[edges[i].v2] += 1.0f;
-  }
+  SmoothIterData data = {
+      .topology = topology,
+      .smooth_weights = smooth_weights,
+      .lambda = csmd->lambda * 2.0f,
+  };
 
   /* -------------------------------------------------------------------- */
   /* Main Smoothing Loop */
 
-  while (iterations--) {
-    for (i = 0; i < numEdges; i++) {
-      struct SmoothingData_Weighted *sd_v1;
-      struct SmoothingData_Weighted *sd_v2;
-      float edge_dir[3];
-      float edge_dist;
-
-      sub_v3_v3v3(edge_dir, vertexCos[edges[i].v2], vertexCos[edges[i].v1]);
-      edge_dist = len_v3(edge_dir);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numVerts > 10000);
 
-      /* weight by distance */
-      mul_v3_fl(edge_dir, edge_dist);
-
-      sd_v1 = &smooth_data[edges[i].v1];
-      sd_v2 = &smooth_data[edges[i].v2];
-
-      add_v3_v3(sd_v1->delta, edge_dir);
-      sub_v3_v3(sd_v2->delta, edge_dir);
-
-      sd_v1->edge_length_sum += edge_dist;
-      sd_v2->edge_length_sum += edge_dist;
-    }
-
-    if (smooth_weights == NULL) {
-      /* fast-path */
-      for (i = 0; i < numVerts; i++) {
-        struct SmoothingData_Weighted *sd = &smooth_data[i];
-        /* Divide by sum of all neighbor distances (weighted) and amount of neighbors,
-         * (mean average). */
-        const float div = sd->edge_length_sum * vertex_edge_count[i];
-        if (div > eps) {
-#if 0
-          /* first calculate the new location */
-          mul_v3_fl(sd->delta, 1.0f / div);
-          /* then interpolate */
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda);
-#else
-          /* do this in one step */
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda / div);
-#endif
-        }
-        /* zero for the next iteration (saves memset on entire array) */
-        memset(sd, 0, sizeof(*sd));
-      }
-    }
-    else {
-      for (i = 0; i < numVerts; i++) {
-        struct SmoothingData_Weighted *sd = &smooth_data[i];
-        const float div = sd->edge_length_sum * vertex_edge_count[i];
-        if (div > eps) {
-          const float lambda_w = lambda * smooth_weights[i];
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda_w / div);
-        }
-
-        memset(sd, 0, sizeof(*sd));
-      }
-    }
+  float(*co_src)[3] = vertexCos;
+  float(*co_dst)[3] = vertexCos_tmp;
+  while (iterations--) {
+    data.co_src = (const float(*)[3])co_src;
+    data.co_dst = co_dst;
+    BLI_task_parallel_range(0, (int)numVerts, &data, smooth_iter__length_weight_cb, &settings);
+    float(*co_swap)[3] = co_src;
+    co_src = co_dst;
+    co_dst = co_swap;
   }
 
-  MEM_freeN(vertex_edge_count);
-  MEM_freeN(smooth_data);
+  if (co_src != vertexCos) {
+    memcpy(vertexCos, co_src, sizeof(*vertexCos) * numVerts);
+  }
 }
 
 static void smooth_iter(CorrectiveSmoothModifierData *csmd,
-                        Mesh *mesh,
+                        const CorrectiveSmoothTopology *topology,
                         float (*vertexCos)[3],
                         uint numVerts,
                         const float *smooth_weights,
                         uint iterations)
 {
+  float(*vertexCos_tmp)[3] = MEM_malloc_arrayN(numVerts, sizeof(*vertexCos_tmp), __func__);
+
   switch (csmd->smooth_type) {
     case MOD_CORRECTIVESMOOTH_SMOOTH_LENGTH_WEIGHT:
-      smooth_iter__length_weight(csmd, mesh, vertexCos, numVerts, smooth_weights, iterations);
+      smooth_iter__length_weight(
+          csmd, topology, vertexCos, vertexCos_tmp, numVerts, smooth_weights, iterations);
       break;
 
     /* case MOD_CORRECTIVESMOOTH_SMOOTH_SIMPLE: */
     default:
-      smooth_iter__simple(csmd, mesh, vertexCos, numVerts, smooth_weights, iterations);
+      smooth_iter__simple(
+          csmd, topology, vertexCos, vertexCos_tmp, numVerts, smooth_weights, iterations);
       break;
   }
+
+  MEM_freeN(vertexCos_tmp);
 }
 
 static void smooth_verts(CorrectiveSmoothModifierData *csmd,
+                         const CorrectiveSmoothTopology *topology,
                          Mesh *mesh,
                          MDeformVert *dvert,
                          const int defgrp_index,
@@ -392,7 +513,7 @@ static void smooth_verts(CorrectiveSmoothModifierData *csmd,
     }
   }
 
-  smooth_iter(csmd, mesh, vertexCos, numVerts, smooth_weights, (uint)csmd->repeat);
+  smooth_iter(csmd, topology, vertexCos, numVerts, smooth_weights, (uint)csmd->repeat);
 
   if (smooth_weights) {
     MEM_freeN(smooth_weights);
@@ -453,54 +574,77 @@ static void calc_tangent_loop_accum(const float v_dir_prev[3],
   }
 }
 
-static void calc_tangent_spaces(Mesh *mesh, float (*vertexCos)[3], float (*r_tangent_spaces)[3][3])
+/**
+ * Calculate the tangent space of a single vertex from the loops using it,
+ * so vertices can be handled in parallel.
+ */
+static void calc_tangent_space(const CorrectiveSmoothTopology *topology,
+                               const float (*vertexCos)[3],
+                               const int v,
+                               float r_tspace[3][3])
 {
-  const uint mpoly_num = (uint)mesh->totpoly;
-#ifndef USE_TANGENT_CALC_INLINE
-  const uint mvert_num = (uint)dm->getNumVerts(dm);
-#endif
-  const MPoly *mpoly = mesh->mpoly;
-  const MLoop *mloop = mesh->mloop;
-  uint i;
+  const MeshElemMap *vert_loops = &topology->vert_loop_map[v];
 
-  for (i = 0; i < mpoly_num; i++) {
-    const MPoly *mp = &mpoly[i];
-    const MLoop *l_next = &mloop[mp->loopstart];
-    const MLoop *l_term = l_next + mp->totloop;
-    const MLoop *l_prev = l_term - 2;
-    const MLoop *l_curr = l_term - 1;
+  zero_m3(r_tspace);
+
+  for (int j = 0; j < vert_loops->count; j++) {
+    const int *adjacent_verts = topology->loop_adjacent_verts[vert_loops->indices[j]];
 
     /* loop directions */
     float v_dir_prev[3], v_dir_next[3];
 
-    /* needed entering the loop */
-    sub_v3_v3v3(v_dir_prev, vertexCos[l_prev->v], vertexCos[l_curr->v]);
+    sub_v3_v3v3(v_dir_prev, vertexCos[adjacent_verts[0]], vertexCos[v]);
     normalize_v3(v_dir_prev);
 
-    for (; l_next != l_term; l_prev = l_curr, l_curr = l_next, l_next++) {
-      float(*ts)[3] = r_tangent_spaces[l_curr->v];
+    sub_v3_v3v3(v_dir_next, vertexCos[v], vertexCos[adjacent_verts[1]]);
+    normalize_v3(v_dir_next);
 
-      /* re-use the previous value */
-#if 0
-      sub_v3_v3v3(v_dir_prev, vertexCos[l_prev->v], vertexCos[l_curr->v]);
-      normalize_v3(v_dir_prev);
-#endif
-      sub_v3_v3v3(v_dir_next, vertexCos[l_curr->v], vertexCos[l_next->v]);
-      normalize_v3(v_dir_next);
+    calc_tangent_loop_accum(v_dir_prev, v_dir_next, r_tspace);
+  }
 
-      calc_tangent_loop_accum(v_dir_prev, v_dir_next, ts);
+  calc_tangent_ortho(r_tspace);
+}
 
-      copy_v3_v3(v_dir_prev, v_dir_next);
-    }
-  }
+typedef struct TangentSpaceData {
+  const CorrectiveSmoothTopology *topology;
+  /* Smoothed coordinates, the tangent spaces are calculated from these. */
+  const float (*smooth_vertex_coords)[3];
+  /* Delta calculation. */
+  const float (*rest_coords)[3];
+  /* Delta application. */
+  float (*vertexCos)[3];
+  float scale;
+
+  float (*deltas)[3];
+} TangentSpaceData;
+
+static void calc_deltas_cb(void *__restrict userdata,
+                           const int i,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const TangentSpaceData *data = userdata;
+  float tspace[3][3], imat[3][3], delta[3];
+
+  calc_tangent_space(data->topology, data->smooth_vertex_coords, i, tspace);
 
-  /* do inline */
-#ifndef USE_TANGENT_CALC_INLINE
-  for (i = 0; i < mvert_num; i++) {
-    float(*ts)[3] = r_tangent_spaces[i];
-    calc_tangent_ortho(ts);
+  sub_v3_v3v3(delta, data->rest_coords[i], data->smooth_vertex_coords[i]);
+  if (UNLIKELY(!invert_m3_m3(imat, tspace))) {
+    transpose_m3_m3(imat, tspace);
   }
-#endif
+  mul_v3_m3v3(data->deltas[i], imat, delta);
+}
+
+static void apply_deltas_cb(void *__restrict userdata,
+                            const int i,
+                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const TangentSpaceData *data = userdata;
+  float tspace[3][3], delta[3];
+
+  calc_tangent_space(data->topology, data->smooth_vertex_coords, i, tspace);
+
+  mul_v3_m3v3(delta, tspace, data->deltas[i]);
+  madd_v3_v3v3fl(data->vertexCos[i], data->smooth_vertex_coords[i], delta, data->scale);
 }
 
 static void store_cache_settings(CorrectiveSmoothModifierData *csmd)
@@ -525,6 +669,7 @@ static bool cache_settings_equal(CorrectiveSmoothModifierData *csmd)
  * It's not run on every update (during animation for example).
  */
 static void calc_deltas(CorrectiveSmoothModifierData *csmd,
+                        const CorrectiveSmoothTopology *topology,
                         Mesh *mesh,
                         MDeformVert *dvert,
                         const int defgrp_index,
@@ -532,10 +677,6 @@ static void calc_deltas(CorrectiveSmoothModifierData *csmd,
                         uint numVerts)
 {
   float(*smooth_vertex_coords)[3] = MEM_dupallocN(rest_coords);
-  float(*tangent_spaces)[3][3];
-  uint i;
-
-  tangent_spaces = MEM_calloc_arrayN(numVerts, sizeof(float[3][3]), __func__);
 
   if (csmd->delta_cache.totverts != numVerts) {
     MEM_SAFE_FREE(csmd->delta_cache.deltas);
@@ -547,25 +688,20 @@ static void calc_deltas(CorrectiveSmoothModifierData *csmd,
     csmd->delta_cache.deltas = MEM_malloc_arrayN(numVerts, sizeof(float[3]), __func__);
   }
 
-  smooth_verts(csmd, mesh, dvert, defgrp_index, smooth_vertex_coords, numVerts);
-
-  calc_tangent_spaces(mesh, smooth_vertex_coords, tangent_spaces);
+  smooth_verts(csmd, topology, mesh, dvert, defgrp_index, smooth_vertex_coords, numVerts);
 
-  for (i = 0; i < numVerts; i++) {
-    float imat[3][3], delta[3];
+  TangentSpaceData data = {
+      .topology = topology,
+      .smooth_vertex_coords = (const float(*)[3])smooth_vertex_coords,
+      .rest_coords = rest_coords,
+      .deltas = csmd->delta_cache.deltas,
+  };
 
-#ifdef USE_TANGENT_CALC_INLINE
-    calc_tangent_ortho(tangent_spaces[i]);
-#endif
-
-    sub_v3_v3v3(delta, rest_coords[i], smooth_vertex_coords[i]);
-    if (UNLIKELY(!invert_m3_m3(imat, tangent_spaces[i]))) {
-      transpose_m3_m3(imat, tangent_spaces[i]);
-    }
-    mul_v3_m3v3(csmd->delta_cache.deltas[i], imat, delta);
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numVerts > 10000);
+  BLI_task_parallel_range(0, (int)numVerts, &data, calc_deltas_cb, &settings);
 
-  MEM_freeN(tangent_spaces);
   MEM_freeN(smooth_vertex_coords);
 }
 
@@ -575,7 +711,8 @@ static void correctivesmooth_modifier_do(ModifierData *md,
                                          Mesh *mesh,
                                          float (*vertexCos)[3],
                                          uint numVerts,
-                                         struct BMEditMesh *em)
+                                         struct BMEditMesh *em,
+                                         const bool use_topology_cache)
 {
   CorrectiveSmoothModifierData *csmd = (CorrectiveSmoothModifierData *)md;
 
@@ -591,6 +728,8 @@ static void correctivesmooth_modifier_do(ModifierData *md,
 
   MOD_get_vgroup(ob, mesh, csmd->defgrp_name, &dvert, &defgrp_index);
 
+  const CorrectiveSmoothTopology *topology = topology_ensure(md, ob, mesh, use_topology_cache);
+
   /* if rest bind_coords not are defined, set them (only run during bind) */
   if ((csmd->rest_source == MOD_CORRECTIVESMOOTH_RESTSOURCE_BIND) &&
       /* signal to recalculate, whoever sets MUST also free bind coords */
@@ -612,7 +751,7 @@ static void correctivesmooth_modifier_do(ModifierData *md,
   }
 
   if (UNLIKELY(use_only_smooth)) {
-    smooth_verts(csmd, mesh, dvert, defgrp_index, vertexCos, numVerts);
+    smooth_verts(csmd, topology, mesh, dvert, defgrp_index, vertexCos, numVerts);
     return;
   }
 
@@ -672,7 +811,7 @@ static void correctivesmooth_modifier_do(ModifierData *md,
     TIMEIT_START(corrective_smooth_deltas);
 #endif
 
-    calc_deltas(csmd, mesh, dvert, defgrp_index, rest_coords, numVerts);
+    calc_deltas(csmd, topology, mesh, dvert, defgrp_index, rest_coords, numVerts);
 
 #ifdef DEBUG_TIME
     TIMEIT_END(corrective_smooth_deltas);
@@ -692,30 +831,27 @@ static void correctivesmooth_modifier_do(ModifierData *md,
 #endif
 
   /* do the actual delta mush */
-  smooth_verts(csmd, mesh, dvert, defgrp_index, vertexCos, numVerts);
-
   {
-    uint i;
-
-    float(*tangent_spaces)[3][3];
-    const float scale = csmd->scale;
-    /* calloc, since values are accumulated */
-    tangent_spaces = MEM_calloc_arrayN(numVerts, sizeof(float[3][3]), __func__);
-
-    calc_tangent_spaces(mesh, vertexCos, tangent_spaces);
-
-    for (i = 0; i < numVerts; i++) {
-      float delta[3];
-
-#ifdef USE_TANGENT_CALC_INLINE
-      calc_tangent_ortho(tangent_spaces[i]);
-#endif
-
-      mul_v3_m3v3(delta, tangent_spaces[i], csmd->delta_cache.deltas[i]);
-      madd_v3_v3fl(vertexCos[i], delta, scale);
-    }
-
-    MEM_freeN(tangent_spaces);
+    /* Smooth a copy, the tangent spaces of neighboring vertices are read from it while the
+     * final coordinates are written. */
+    float(*smooth_vertex_coords)[3] = MEM_dupallocN(vertexCos);
+
+    smooth_verts(csmd, topology, mesh, dvert, defgrp_index, smooth_vertex_coords, numVerts);
+
+    TangentSpaceData data = {
+        .topology = topology,
+        .smooth_vertex_coords = (const float(*)[3])smooth_vertex_coords,
+        .vertexCos = vertexCos,
+        .scale = csmd->scale,
+        .deltas = csmd->delta_cache.deltas,
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (numVerts > 10000);
+    BLI_task_parallel_range(0, (int)numVerts, &data, apply_deltas_cb, &settings);
+
+    MEM_freeN(smooth_vertex_coords);
   }
 
 #ifdef DEBUG_TIME
@@ -738,8 +874,10 @@ static void deformVerts(ModifierData *md,
 {
   Mesh *mesh_src = MOD_deform_mesh_eval_get(ctx->object, NULL, mesh, NULL, numVerts, false, false);
 
+  /* Without an input mesh the topology is the one of the object data, which the dependency
+   * graph tags on changes, so the adjacency can be kept between evaluations. */
   correctivesmooth_modifier_do(
-      md, ctx->depsgraph, ctx->object, mesh_src, vertexCos, (uint)numVerts, NULL);
+      md, ctx->depsgraph, ctx->object, mesh_src, vertexCos, (uint)numVerts, NULL, mesh == NULL);
 
   if (!ELEM(mesh_src, NULL, mesh)) {
     BKE_id_free(NULL, mesh_src);
@@ -757,7 +895,7 @@ static void deformVertsEM(ModifierData *md,
       ctx->object, editData, mesh, NULL, numVerts, false, false);
 
   correctivesmooth_modifier_do(
-      md, ctx->depsgraph, ctx->object, mesh_src, vertexCos, (uint)numVerts, editData);
+      md, ctx->depsgraph, ctx->object, mesh_src, vertexCos, (uint)numVerts, editData, false);
 
   if (!ELEM(mesh_src, NULL, mesh)) {
     BKE_id_free(NULL, mesh_src);
@@ -792,5 +930,5 @@ ModifierTypeInfo modifierType_CorrectiveSmooth = {
     /* foreachObjectLink */ NULL,
     /* foreachIDLink */ NULL,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
 };
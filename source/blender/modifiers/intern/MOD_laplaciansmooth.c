@@ -65,6 +65,13 @@ struct BLaplacianSystem {
   /*Data*/
   float min_area;
   float vert_centroid[3];
+
+  /* Input the matrix was built from, to re-use its factorization in later evaluations. */
+  float (*cache_coords)[3]; /* Coordinates at the time the matrix was built */
+  float *cache_weights;     /* Vertex group weights, NULL when not using a group */
+  float cache_lambda;
+  float cache_lambda_border;
+  short cache_flag;
 };
 typedef struct BLaplacianSystem LaplacianSystem;
 
@@ -97,6 +104,8 @@ static void delete_laplacian_system(LaplacianSystem *sys)
   MEM_SAFE_FREE(sys->vlengths);
   MEM_SAFE_FREE(sys->vweights);
   MEM_SAFE_FREE(sys->zerola);
+  MEM_SAFE_FREE(sys->cache_coords);
+  MEM_SAFE_FREE(sys->cache_weights);
 
   if (sys->context) {
     EIG_linear_solver_delete(sys->context);
@@ -369,117 +378,214 @@ static void validate_solution(LaplacianSystem *sys, short flag, float lambda, fl
   }
 }
 
-static void laplaciansmoothModifier_do(
-    LaplacianSmoothModifierData *smd, Object *ob, Mesh *mesh, float (*vertexCos)[3], int numVerts)
+static float *laplacian_weights_alloc(LaplacianSmoothModifierData *smd,
+                                      MDeformVert *dvert,
+                                      int defgrp_index,
+                                      int numVerts)
 {
-  LaplacianSystem *sys;
-  MDeformVert *dvert = NULL;
-  MDeformVert *dv = NULL;
-  float w, wpaint;
-  int i, iter;
-  int defgrp_index;
   const bool invert_vgroup = (smd->flag & MOD_LAPLACIANSMOOTH_INVERT_VGROUP) != 0;
+  float *weights = MEM_malloc_arrayN(numVerts, sizeof(float), __func__);
+  MDeformVert *dv = dvert;
+  int i;
 
-  sys = init_laplacian_system(mesh->totedge, mesh->totpoly, mesh->totloop, numVerts);
-  if (!sys) {
-    return;
+  for (i = 0; i < numVerts; i++, dv++) {
+    weights[i] = invert_vgroup ? 1.0f - BKE_defvert_find_weight(dv, defgrp_index) :
+                                 BKE_defvert_find_weight(dv, defgrp_index);
   }
+  return weights;
+}
 
-  sys->mpoly = mesh->mpoly;
-  sys->mloop = mesh->mloop;
-  sys->medges = mesh->medge;
-  sys->vertexCos = vertexCos;
-  sys->min_area = 0.00001f;
-  MOD_get_vgroup(ob, mesh, smd->defgrp_name, &dvert, &defgrp_index);
+/* The matrix depends on the topology, the weights and the input coordinates. When all of them
+ * are unchanged (e.g. a static mesh smoothed before an armature) the factorization is kept and
+ * every evaluation only solves for the new right hand sides.
+ *
+ * \note Since the edge and face weights of the matrix are computed from the input coordinates,
+ * the cache can't be keyed on the topology only: it is only used when the input coordinates are
+ * exactly the same as when the matrix was built. Any deformation before this modifier (e.g. an
+ * armature or shape key) rebuilds the matrix on every evaluation. */
+static bool laplacian_system_is_valid(const LaplacianSystem *sys,
+                                      const LaplacianSmoothModifierData *smd,
+                                      const Mesh *mesh,
+                                      const float (*vertexCos)[3],
+                                      const float *weights,
+                                      int numVerts)
+{
+  if (sys->numVerts != numVerts || sys->numEdges != mesh->totedge ||
+      sys->numPolys != mesh->totpoly || sys->numLoops != mesh->totloop ||
+      sys->medges != mesh->medge || sys->mloop != mesh->mloop) {
+    return false;
+  }
+  if (sys->cache_lambda != smd->lambda || sys->cache_lambda_border != smd->lambda_border ||
+      ((sys->cache_flag ^ smd->flag) & MOD_LAPLACIANSMOOTH_NORMALIZED)) {
+    return false;
+  }
+  if ((sys->cache_weights == NULL) != (weights == NULL)) {
+    return false;
+  }
+  if (weights && memcmp(sys->cache_weights, weights, sizeof(float) * (size_t)numVerts) != 0) {
+    return false;
+  }
+  return memcmp(sys->cache_coords, vertexCos, sizeof(float[3]) * (size_t)numVerts) == 0;
+}
 
-  sys->vert_centroid[0] = 0.0f;
-  sys->vert_centroid[1] = 0.0f;
-  sys->vert_centroid[2] = 0.0f;
-  memset_laplacian_system(sys, 0);
+static void build_laplacian_system(LaplacianSystem *sys,
+                                   LaplacianSmoothModifierData *smd,
+                                   const float *weights)
+{
+  float w, wpaint;
+  int i;
 
-  sys->context = EIG_linear_least_squares_solver_new(numVerts, numVerts, 3);
+  sys->context = EIG_linear_least_squares_solver_new(sys->numVerts, sys->numVerts, 3);
 
   init_laplacian_matrix(sys);
 
-  for (iter = 0; iter < smd->repeat; iter++) {
-    for (i = 0; i < numVerts; i++) {
-      EIG_linear_solver_variable_set(sys->context, 0, i, vertexCos[i][0]);
-      EIG_linear_solver_variable_set(sys->context, 1, i, vertexCos[i][1]);
-      EIG_linear_solver_variable_set(sys->context, 2, i, vertexCos[i][2]);
-      if (iter == 0) {
-        add_v3_v3(sys->vert_centroid, vertexCos[i]);
-      }
-    }
-    if (iter == 0 && numVerts > 0) {
-      mul_v3_fl(sys->vert_centroid, 1.0f / (float)numVerts);
-    }
+  for (i = 0; i < sys->numVerts; i++) {
+    wpaint = weights ? weights[i] : 1.0f;
 
-    dv = dvert;
-    for (i = 0; i < numVerts; i++) {
-      EIG_linear_solver_right_hand_side_add(sys->context, 0, i, vertexCos[i][0]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 1, i, vertexCos[i][1]);
-      EIG_linear_solver_right_hand_side_add(sys->context, 2, i, vertexCos[i][2]);
-      if (iter == 0) {
-        if (dv) {
-          wpaint = invert_vgroup ? 1.0f - BKE_defvert_find_weight(dv, defgrp_index) :
-                                   BKE_defvert_find_weight(dv, defgrp_index);
-          dv++;
+    if (sys->zerola[i] == 0) {
+      if (smd->flag & MOD_LAPLACIANSMOOTH_NORMALIZED) {
+        w = sys->vweights[i];
+        sys->vweights[i] = (w == 0.0f) ? 0.0f : -fabsf(smd->lambda) * wpaint / w;
+        w = sys->vlengths[i];
+        sys->vlengths[i] = (w == 0.0f) ? 0.0f : -fabsf(smd->lambda_border) * wpaint * 2.0f / w;
+        if (sys->numNeEd[i] == sys->numNeFa[i]) {
+          EIG_linear_solver_matrix_add(sys->context, i, i, 1.0f + fabsf(smd->lambda) * wpaint);
         }
         else {
-          wpaint = 1.0f;
+          EIG_linear_solver_matrix_add(
+              sys->context, i, i, 1.0f + fabsf(smd->lambda_border) * wpaint * 2.0f);
         }
-
-        if (sys->zerola[i] == 0) {
-          if (smd->flag & MOD_LAPLACIANSMOOTH_NORMALIZED) {
-            w = sys->vweights[i];
-            sys->vweights[i] = (w == 0.0f) ? 0.0f : -fabsf(smd->lambda) * wpaint / w;
-            w = sys->vlengths[i];
-            sys->vlengths[i] = (w == 0.0f) ? 0.0f : -fabsf(smd->lambda_border) * wpaint * 2.0f / w;
-            if (sys->numNeEd[i] == sys->numNeFa[i]) {
-              EIG_linear_solver_matrix_add(sys->context, i, i, 1.0f + fabsf(smd->lambda) * wpaint);
-            }
-            else {
-              EIG_linear_solver_matrix_add(
-                  sys->context, i, i, 1.0f + fabsf(smd->lambda_border) * wpaint * 2.0f);
-            }
-          }
-          else {
-            w = sys->vweights[i] * sys->ring_areas[i];
-            sys->vweights[i] = (w == 0.0f) ? 0.0f : -fabsf(smd->lambda) * wpaint / (4.0f * w);
-            w = sys->vlengths[i];
-            sys->vlengths[i] = (w == 0.0f) ? 0.0f : -fabsf(smd->lambda_border) * wpaint * 2.0f / w;
-
-            if (sys->numNeEd[i] == sys->numNeFa[i]) {
-              EIG_linear_solver_matrix_add(sys->context,
-                                           i,
-                                           i,
-                                           1.0f + fabsf(smd->lambda) * wpaint /
-                                                      (4.0f * sys->ring_areas[i]));
-            }
-            else {
-              EIG_linear_solver_matrix_add(
-                  sys->context, i, i, 1.0f + fabsf(smd->lambda_border) * wpaint * 2.0f);
-            }
-          }
+      }
+      else {
+        w = sys->vweights[i] * sys->ring_areas[i];
+        sys->vweights[i] = (w == 0.0f) ? 0.0f : -fabsf(smd->lambda) * wpaint / (4.0f * w);
+        w = sys->vlengths[i];
+        sys->vlengths[i] = (w == 0.0f) ? 0.0f : -fabsf(smd->lambda_border) * wpaint * 2.0f / w;
+
+        if (sys->numNeEd[i] == sys->numNeFa[i]) {
+          EIG_linear_solver_matrix_add(sys->context,
+                                       i,
+                                       i,
+                                       1.0f + fabsf(smd->lambda) * wpaint /
+                                                  (4.0f * sys->ring_areas[i]));
         }
         else {
-          EIG_linear_solver_matrix_add(sys->context, i, i, 1.0f);
+          EIG_linear_solver_matrix_add(
+              sys->context, i, i, 1.0f + fabsf(smd->lambda_border) * wpaint * 2.0f);
         }
       }
     }
+    else {
+      EIG_linear_solver_matrix_add(sys->context, i, i, 1.0f);
+    }
+  }
+
+  fill_laplacian_matrix(sys);
+}
+
+static void laplaciansmoothModifier_do(LaplacianSmoothModifierData *smd,
+                                       Object *ob,
+                                       Mesh *mesh,
+                                       float (*vertexCos)[3],
+                                       int numVerts,
+                                       const bool use_cache)
+{
+  LaplacianSystem *sys = (LaplacianSystem *)smd->modifier.runtime;
+  MDeformVert *dvert = NULL;
+  float *weights = NULL;
+  int i, iter;
+  int defgrp_index;
+
+  MOD_get_vgroup(ob, mesh, smd->defgrp_name, &dvert, &defgrp_index);
+  if (dvert) {
+    weights = laplacian_weights_alloc(smd, dvert, defgrp_index, numVerts);
+  }
+
+  if (sys && !(use_cache && (((ID *)ob->data)->recalc & ID_RECALC_ALL) == 0 &&
+               laplacian_system_is_valid(
+                   sys, smd, mesh, (const float(*)[3])vertexCos, weights, numVerts))) {
+    delete_laplacian_system(sys);
+    sys = NULL;
+    smd->modifier.runtime = NULL;
+  }
+
+  if (sys == NULL) {
+    sys = init_laplacian_system(mesh->totedge, mesh->totpoly, mesh->totloop, numVerts);
+    if (!sys) {
+      MEM_SAFE_FREE(weights);
+      return;
+    }
+
+    sys->mpoly = mesh->mpoly;
+    sys->mloop = mesh->mloop;
+    sys->medges = mesh->medge;
+    sys->vertexCos = vertexCos;
+    sys->min_area = 0.00001f;
+    memset_laplacian_system(sys, 0);
+
+    build_laplacian_system(sys, smd, weights);
+
+    if (use_cache) {
+      /* The input coordinates may be a part of a larger or a non guarded allocation. */
+      sys->cache_coords = MEM_malloc_arrayN(numVerts, sizeof(float[3]), __func__);
+      memcpy(sys->cache_coords, vertexCos, sizeof(float[3]) * (size_t)numVerts);
+      sys->cache_weights = weights;
+      sys->cache_lambda = smd->lambda;
+      sys->cache_lambda_border = smd->lambda_border;
+      sys->cache_flag = smd->flag;
+      weights = NULL;
+    }
+  }
+  else {
+    sys->mpoly = mesh->mpoly;
+    sys->vertexCos = vertexCos;
+  }
+
+  MEM_SAFE_FREE(weights);
+
+  zero_v3(sys->vert_centroid);
+  for (i = 0; i < numVerts; i++) {
+    add_v3_v3(sys->vert_centroid, vertexCos[i]);
+  }
+  if (numVerts > 0) {
+    mul_v3_fl(sys->vert_centroid, 1.0f / (float)numVerts);
+  }
 
-    if (iter == 0) {
-      fill_laplacian_matrix(sys);
+  for (iter = 0; iter < smd->repeat; iter++) {
+    for (i = 0; i < numVerts; i++) {
+      EIG_linear_solver_variable_set(sys->context, 0, i, vertexCos[i][0]);
+      EIG_linear_solver_variable_set(sys->context, 1, i, vertexCos[i][1]);
+      EIG_linear_solver_variable_set(sys->context, 2, i, vertexCos[i][2]);
+      EIG_linear_solver_right_hand_side_add(sys->context, 0, i, vertexCos[i][0]);
+      EIG_linear_solver_right_hand_side_add(sys->context, 1, i, vertexCos[i][1]);
+      EIG_linear_solver_right_hand_side_add(sys->context, 2, i, vertexCos[i][2]);
     }
 
     if (EIG_linear_solver_solve(sys->context)) {
       validate_solution(sys, smd->flag, smd->lambda, smd->lambda_border);
     }
   }
-  EIG_linear_solver_delete(sys->context);
-  sys->context = NULL;
 
-  delete_laplacian_system(sys);
+  if (use_cache) {
+    smd->modifier.runtime = sys;
+  }
+  else {
+    delete_laplacian_system(sys);
+  }
+}
+
+static void free_runtime_data(void *runtime_data_v)
+{
+  if (runtime_data_v == NULL) {
+    return;
+  }
+  delete_laplacian_system((LaplacianSystem *)runtime_data_v);
+}
+
+static void free_data(ModifierData *md)
+{
+  free_runtime_data(md->runtime);
+  md->runtime = NULL;
 }
 
 static void init_data(ModifierData *md)
@@ -536,8 +642,14 @@ static void deformVerts(ModifierData *md,
 
   mesh_src = MOD_deform_mesh_eval_get(ctx->object, NULL, mesh, NULL, numVerts, false, false);
 
-  laplaciansmoothModifier_do(
-      (LaplacianSmoothModifierData *)md, ctx->object, mesh_src, vertexCos, numVerts);
+  /* Without an input mesh the topology is the one of the object data, which the dependency
+   * graph tags on changes, so the system can be kept between evaluations. */
+  laplaciansmoothModifier_do((LaplacianSmoothModifierData *)md,
+                             ctx->object,
+                             mesh_src,
+                             vertexCos,
+                             numVerts,
+                             mesh == NULL && ctx->object->type == OB_MESH);
 
   if (!ELEM(mesh_src, NULL, mesh)) {
     BKE_id_free(NULL, mesh_src);
@@ -560,7 +672,7 @@ static void deformVertsEM(ModifierData *md,
   mesh_src = MOD_deform_mesh_eval_get(ctx->object, editData, mesh, NULL, numVerts, false, false);
 
   laplaciansmoothModifier_do(
-      (LaplacianSmoothModifierData *)md, ctx->object, mesh_src, vertexCos, numVerts);
+      (LaplacianSmoothModifierData *)md, ctx->object, mesh_src, vertexCos, numVerts, false);
 
   if (!ELEM(mesh_src, NULL, mesh)) {
     BKE_id_free(NULL, mesh_src);
@@ -587,7 +699,7 @@ ModifierTypeInfo modifierType_LaplacianSmooth = {
 
     /* initData */ init_data,
     /* requiredDataMask */ required_data_mask,
-    /* freeData */ NULL,
+    /* freeData */ free_data,
     /* isDisabled */ is_disabled,
     /* updateDepsgraph */ NULL,
     /* dependsOnTime */ NULL,
@@ -595,5 +707,5 @@ ModifierTypeInfo modifierType_LaplacianSmooth = {
     /* foreachObjectLink */ NULL,
     /* foreachIDLink */ NULL,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ free_runtime_data,
 };
@@ -59,6 +59,17 @@ static void initData(ModifierData *md)
   mcmd->up_axis = 2;
 }
 
+static void freeRuntimeData(void *runtime_data)
+{
+  MOD_meshcache_file_map_free(runtime_data);
+}
+
+static void freeData(ModifierData *md)
+{
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
+}
+
 static bool dependsOnTime(ModifierData *md)
 {
   MeshCacheModifierData *mcmd = (MeshCacheModifierData *)md;
@@ -146,14 +157,30 @@ static void meshcache_do(MeshCacheModifierData *mcmd,
   BLI_strncpy(filepath, mcmd->filepath, sizeof(filepath));
   BLI_path_abs(filepath, ID_BLEND_PATH_FROM_GLOBAL((ID *)ob));
 
+  /* Keep the file mapped between evaluations, falls back to reading it when mapping fails. */
+  MeshCacheFileMap *fmap = MOD_meshcache_file_map_ensure(mcmd->modifier.runtime, filepath);
+  mcmd->modifier.runtime = fmap;
+
   switch (mcmd->type) {
     case MOD_MESHCACHE_TYPE_MDD:
-      ok = MOD_meshcache_read_mdd_times(
-          filepath, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
+      if (fmap) {
+        ok = MOD_meshcache_read_mdd_times_map(
+            fmap, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
+      }
+      else {
+        ok = MOD_meshcache_read_mdd_times(
+            filepath, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
+      }
       break;
     case MOD_MESHCACHE_TYPE_PC2:
-      ok = MOD_meshcache_read_pc2_times(
-          filepath, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
+      if (fmap) {
+        ok = MOD_meshcache_read_pc2_times_map(
+            fmap, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
+      }
+      else {
+        ok = MOD_meshcache_read_pc2_times(
+            filepath, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
+      }
       break;
     default:
       ok = false;
@@ -308,7 +335,7 @@ ModifierTypeInfo modifierType_MeshCache = {
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
-    /* freeData */ NULL,
+    /* freeData */ freeData,
     /* isDisabled */ isDisabled,
     /* updateDepsgraph */ NULL,
     /* dependsOnTime */ dependsOnTime,
@@ -316,5 +343,5 @@ ModifierTypeInfo modifierType_MeshCache = {
     /* foreachObjectLink */ NULL,
     /* foreachIDLink */ NULL,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
 };
@@ -42,16 +42,11 @@ typedef struct MDDHead {
   int verts_tot;
 } MDDHead; /* frames, verts */
 
-static bool meshcache_read_mdd_head(FILE *fp,
-                                    const int verts_tot,
-                                    MDDHead *mdd_head,
-                                    const char **err_str)
+/* Check (and convert to native byte order) a header read from the file. */
+static bool meshcache_mdd_head_validate(MDDHead *mdd_head,
+                                        const int verts_tot,
+                                        const char **err_str)
 {
-  if (!fread(mdd_head, sizeof(*mdd_head), 1, fp)) {
-    *err_str = "Missing header";
-    return false;
-  }
-
 #ifdef __LITTLE_ENDIAN__
   BLI_endian_switch_int32_array((int *)mdd_head, 2);
 #endif
@@ -65,11 +60,24 @@ static bool meshcache_read_mdd_head(FILE *fp,
     *err_str = "Invalid frame total";
     return false;
   }
-  /* intentionally dont seek back */
 
   return true;
 }
 
+static bool meshcache_read_mdd_head(FILE *fp,
+                                    const int verts_tot,
+                                    MDDHead *mdd_head,
+                                    const char **err_str)
+{
+  if (!fread(mdd_head, sizeof(*mdd_head), 1, fp)) {
+    *err_str = "Missing header";
+    return false;
+  }
+  /* intentionally dont seek back */
+
+  return meshcache_mdd_head_validate(mdd_head, verts_tot, err_str);
+}
+
 /**
  * Gets the index frange and factor
  */
@@ -166,27 +174,13 @@ bool MOD_meshcache_read_mdd_index(FILE *fp,
   }
 
   if (factor >= 1.0f) {
-#if 1
-    float *vco = *vertexCos;
-    uint i;
-    for (i = mdd_head.verts_tot; i != 0; i--, vco += 3) {
-      fread(vco, sizeof(float) * 3, 1, fp);
-
-#  ifdef __LITTLE_ENDIAN__
-      BLI_endian_switch_float(vco + 0);
-      BLI_endian_switch_float(vco + 1);
-      BLI_endian_switch_float(vco + 2);
-#  endif /* __LITTLE_ENDIAN__ */
-    }
-#else
-    /* no blending */
-    if (!fread(vertexCos, sizeof(float) * 3, mdd_head.verts_tot, f)) {
-      *err_str = errno ? strerror(errno) : "Failed to read frame";
+    /* no blending, read the whole frame at once */
+    if (fread(vertexCos, sizeof(float[3]), mdd_head.verts_tot, fp) != (size_t)mdd_head.verts_tot) {
+      *err_str = "Failed to read frame";
       return false;
     }
-#  ifdef __LITTLE_ENDIAN__
+#ifdef __LITTLE_ENDIAN__
     BLI_endian_switch_float_array(vertexCos[0], mdd_head.verts_tot * 3);
-#  endif
 #endif
   }
   else {
@@ -308,3 +302,181 @@ bool MOD_meshcache_read_mdd_times(const char *filepath,
   fclose(fp);
   return ok;
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Memory Mapped Reading
+ *
+ * MDD is big endian, so on most systems each frame is copied and converted.
+ * \{ */
+
+static bool meshcache_read_mdd_head_map(const MeshCacheFileMap *fmap,
+                                        const int verts_tot,
+                                        MDDHead *mdd_head,
+                                        const char **err_str)
+{
+  if (!MOD_meshcache_file_map_range_is_valid(fmap, 0, sizeof(*mdd_head))) {
+    *err_str = "Missing header";
+    return false;
+  }
+  memcpy(mdd_head, fmap->data, sizeof(*mdd_head));
+
+  if (meshcache_mdd_head_validate(mdd_head, verts_tot, err_str) == false) {
+    return false;
+  }
+
+  if (!MOD_meshcache_file_map_range_is_valid(
+          fmap, sizeof(*mdd_head), sizeof(float) * (size_t)mdd_head->frame_tot)) {
+    *err_str = "Header seek failed";
+    return false;
+  }
+
+  return true;
+}
+
+static float meshcache_read_mdd_frame_from_time_map(const MeshCacheFileMap *fmap,
+                                                    const MDDHead *mdd_head,
+                                                    const float time)
+{
+  const char *times = fmap->data + sizeof(*mdd_head);
+  int i;
+  float f_time, f_time_prev = FLT_MAX;
+  float frame;
+
+  for (i = 0; i < mdd_head->frame_tot; i++) {
+    memcpy(&f_time, times + sizeof(float) * (size_t)i, sizeof(float));
+#ifdef __LITTLE_ENDIAN__
+    BLI_endian_switch_float(&f_time);
+#endif
+    if (f_time >= time) {
+      break;
+    }
+    f_time_prev = f_time;
+  }
+
+  if (i == mdd_head->frame_tot) {
+    frame = (float)(mdd_head->frame_tot - 1);
+  }
+  if (UNLIKELY(f_time_prev == FLT_MAX)) {
+    frame = 0.0f;
+  }
+  else {
+    const float range = f_time - f_time_prev;
+
+    if (range <= FRAME_SNAP_EPS) {
+      frame = (float)i;
+    }
+    else {
+      frame = (float)(i - 1) + ((time - f_time_prev) / range);
+    }
+  }
+
+  return frame;
+}
+
+static size_t meshcache_mdd_frame_offset(const MDDHead *mdd_head, const int index)
+{
+  return sizeof(*mdd_head) + sizeof(float) * (size_t)mdd_head->frame_tot +
+         sizeof(float[3]) * (size_t)mdd_head->verts_tot * (size_t)index;
+}
+
+static bool meshcache_read_mdd_index_map(const MeshCacheFileMap *fmap,
+                                         const MDDHead *mdd_head,
+                                         float (*vertexCos)[3],
+                                         const int index,
+                                         const float factor,
+                                         const char **err_str)
+{
+  const size_t frame_size = sizeof(float[3]) * (size_t)mdd_head->verts_tot;
+  const size_t offset = meshcache_mdd_frame_offset(mdd_head, index);
+
+  if (!MOD_meshcache_file_map_range_is_valid(fmap, offset, frame_size)) {
+    *err_str = "Failed to seek frame";
+    return false;
+  }
+
+  const char *src = fmap->data + offset;
+
+  if (factor >= 1.0f) {
+    memcpy(vertexCos, src, frame_size);
+#ifdef __LITTLE_ENDIAN__
+    BLI_endian_switch_float_array(*vertexCos, mdd_head->verts_tot * 3);
+#endif
+  }
+  else {
+    const float ifactor = 1.0f - factor;
+    float *vco = *vertexCos;
+    uint i;
+    for (i = mdd_head->verts_tot; i != 0; i--, vco += 3, src += sizeof(float[3])) {
+      float tvec[3];
+      /* The mapped data isn't guaranteed to be aligned for floats. */
+      memcpy(tvec, src, sizeof(tvec));
+
+#ifdef __LITTLE_ENDIAN__
+      BLI_endian_switch_float(tvec + 0);
+      BLI_endian_switch_float(tvec + 1);
+      BLI_endian_switch_float(tvec + 2);
+#endif
+
+      vco[0] = (vco[0] * ifactor) + (tvec[0] * factor);
+      vco[1] = (vco[1] * ifactor) + (tvec[1] * factor);
+      vco[2] = (vco[2] * ifactor) + (tvec[2] * factor);
+    }
+  }
+
+  return true;
+}
+
+bool MOD_meshcache_read_mdd_times_map(const MeshCacheFileMap *fmap,
+                                      float (*vertexCos)[3],
+                                      const int verts_tot,
+                                      const char interp,
+                                      const float time,
+                                      const float UNUSED(fps),
+                                      const char time_mode,
+                                      const char **err_str)
+{
+  MDDHead mdd_head;
+  int index_range[2];
+  float frame, factor;
+
+  if (meshcache_read_mdd_head_map(fmap, verts_tot, &mdd_head, err_str) == false) {
+    return false;
+  }
+
+  switch (time_mode) {
+    case MOD_MESHCACHE_TIME_FRAME: {
+      frame = time;
+      break;
+    }
+    case MOD_MESHCACHE_TIME_SECONDS: {
+      /* we need to find the closest time */
+      frame = meshcache_read_mdd_frame_from_time_map(fmap, &mdd_head, time);
+      break;
+    }
+    case MOD_MESHCACHE_TIME_FACTOR:
+    default: {
+      frame = CLAMPIS(time, 0.0f, 1.0f) * (float)mdd_head.frame_tot;
+      break;
+    }
+  }
+
+  MOD_meshcache_calc_range(frame, interp, mdd_head.frame_tot, index_range, &factor);
+
+  if (!meshcache_read_mdd_index_map(fmap, &mdd_head, vertexCos, index_range[0], 1.0f, err_str)) {
+    return false;
+  }
+  if ((index_range[0] != index_range[1]) &&
+      !meshcache_read_mdd_index_map(
+          fmap, &mdd_head, vertexCos, index_range[1], factor, err_str)) {
+    return false;
+  }
+
+  /* Playback is usually forward, have the frame after this one ready for the next evaluation. */
+  MOD_meshcache_file_map_prefetch(fmap,
+                                  meshcache_mdd_frame_offset(&mdd_head, index_range[1] + 1),
+                                  sizeof(float[3]) * (size_t)mdd_head.verts_tot);
+
+  return true;
+}
+
+/** \} */
@@ -46,16 +46,11 @@ typedef struct PC2Head {
   int frame_tot;
 } PC2Head; /* frames, verts */
 
-static bool meshcache_read_pc2_head(FILE *fp,
-                                    const int verts_tot,
-                                    PC2Head *pc2_head,
-                                    const char **err_str)
+/* Check (and convert to native byte order) a header read from the file. */
+static bool meshcache_pc2_head_validate(PC2Head *pc2_head,
+                                        const int verts_tot,
+                                        const char **err_str)
 {
-  if (!fread(pc2_head, sizeof(*pc2_head), 1, fp)) {
-    *err_str = "Missing header";
-    return false;
-  }
-
   if (!STREQ(pc2_head->header, "POINTCACHE2")) {
     *err_str = "Invalid header";
     return false;
@@ -75,11 +70,24 @@ static bool meshcache_read_pc2_head(FILE *fp,
     *err_str = "Invalid frame total";
     return false;
   }
-  /* intentionally dont seek back */
 
   return true;
 }
 
+static bool meshcache_read_pc2_head(FILE *fp,
+                                    const int verts_tot,
+                                    PC2Head *pc2_head,
+                                    const char **err_str)
+{
+  if (!fread(pc2_head, sizeof(*pc2_head), 1, fp)) {
+    *err_str = "Missing header";
+    return false;
+  }
+  /* intentionally dont seek back */
+
+  return meshcache_pc2_head_validate(pc2_head, verts_tot, err_str);
+}
+
 /**
  * Gets the index frange and factor
  *
@@ -152,17 +160,14 @@ bool MOD_meshcache_read_pc2_index(FILE *fp,
   }
 
   if (factor >= 1.0f) {
-    float *vco = *vertexCos;
-    uint i;
-    for (i = pc2_head.verts_tot; i != 0; i--, vco += 3) {
-      fread(vco, sizeof(float) * 3, 1, fp);
-
-#ifdef __BIG_ENDIAN__
-      BLI_endian_switch_float(vco + 0);
-      BLI_endian_switch_float(vco + 1);
-      BLI_endian_switch_float(vco + 2);
-#endif /* __BIG_ENDIAN__ */
+    /* no blending, read the whole frame at once */
+    if (fread(vertexCos, sizeof(float[3]), pc2_head.verts_tot, fp) != (size_t)pc2_head.verts_tot) {
+      *err_str = "Failed to read frame";
+      return false;
     }
+#ifdef __BIG_ENDIAN__
+    BLI_endian_switch_float_array(vertexCos[0], pc2_head.verts_tot * 3);
+#endif
   }
   else {
     const float ifactor = 1.0f - factor;
@@ -283,3 +288,130 @@ bool MOD_meshcache_read_pc2_times(const char *filepath,
   fclose(fp);
   return ok;
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Memory Mapped Reading
+ *
+ * PC2 is little endian, so on most systems frames are read straight from the mapped file.
+ * \{ */
+
+static bool meshcache_read_pc2_head_map(const MeshCacheFileMap *fmap,
+                                        const int verts_tot,
+                                        PC2Head *pc2_head,
+                                        const char **err_str)
+{
+  if (!MOD_meshcache_file_map_range_is_valid(fmap, 0, sizeof(*pc2_head))) {
+    *err_str = "Missing header";
+    return false;
+  }
+  memcpy(pc2_head, fmap->data, sizeof(*pc2_head));
+
+  return meshcache_pc2_head_validate(pc2_head, verts_tot, err_str);
+}
+
+static bool meshcache_read_pc2_index_map(const MeshCacheFileMap *fmap,
+                                         const PC2Head *pc2_head,
+                                         float (*vertexCos)[3],
+                                         const int index,
+                                         const float factor,
+                                         const char **err_str)
+{
+  const size_t frame_size = sizeof(float[3]) * (size_t)pc2_head->verts_tot;
+  const size_t offset = sizeof(*pc2_head) + frame_size * (size_t)index;
+
+  if (!MOD_meshcache_file_map_range_is_valid(fmap, offset, frame_size)) {
+    *err_str = "Failed to seek frame";
+    return false;
+  }
+
+  const char *src = fmap->data + offset;
+
+  if (factor >= 1.0f) {
+    memcpy(vertexCos, src, frame_size);
+#ifdef __BIG_ENDIAN__
+    BLI_endian_switch_float_array(*vertexCos, pc2_head->verts_tot * 3);
+#endif
+  }
+  else {
+    const float ifactor = 1.0f - factor;
+    float *vco = *vertexCos;
+    uint i;
+    for (i = pc2_head->verts_tot; i != 0; i--, vco += 3, src += sizeof(float[3])) {
+      float tvec[3];
+      /* The mapped data isn't guaranteed to be aligned for floats. */
+      memcpy(tvec, src, sizeof(tvec));
+
+#ifdef __BIG_ENDIAN__
+      BLI_endian_switch_float(tvec + 0);
+      BLI_endian_switch_float(tvec + 1);
+      BLI_endian_switch_float(tvec + 2);
+#endif /* __BIG_ENDIAN__ */
+
+      vco[0] = (vco[0] * ifactor) + (tvec[0] * factor);
+      vco[1] = (vco[1] * ifactor) + (tvec[1] * factor);
+      vco[2] = (vco[2] * ifactor) + (tvec[2] * factor);
+    }
+  }
+
+  return true;
+}
+
+bool MOD_meshcache_read_pc2_times_map(const MeshCacheFileMap *fmap,
+                                      float (*vertexCos)[3],
+                                      const int verts_tot,
+                                      const char interp,
+                                      const float time,
+                                      const float fps,
+                                      const char time_mode,
+                                      const char **err_str)
+{
+  PC2Head pc2_head;
+  int index_range[2];
+  float frame, factor;
+
+  if (meshcache_read_pc2_head_map(fmap, verts_tot, &pc2_head, err_str) == false) {
+    return false;
+  }
+
+  switch (time_mode) {
+    case MOD_MESHCACHE_TIME_FRAME: {
+      frame = time;
+      break;
+    }
+    case MOD_MESHCACHE_TIME_SECONDS: {
+      frame = ((time / fps) - pc2_head.start) / pc2_head.sampling;
+      if (frame >= pc2_head.frame_tot) {
+        frame = (float)(pc2_head.frame_tot - 1);
+      }
+      else if (frame < 0.0f) {
+        frame = 0.0f;
+      }
+      break;
+    }
+    case MOD_MESHCACHE_TIME_FACTOR:
+    default: {
+      frame = CLAMPIS(time, 0.0f, 1.0f) * (float)pc2_head.frame_tot;
+      break;
+    }
+  }
+
+  MOD_meshcache_calc_range(frame, interp, pc2_head.frame_tot, index_range, &factor);
+
+  if (!meshcache_read_pc2_index_map(fmap, &pc2_head, vertexCos, index_range[0], 1.0f, err_str)) {
+    return false;
+  }
+  if ((index_range[0] != index_range[1]) &&
+      !meshcache_read_pc2_index_map(
+          fmap, &pc2_head, vertexCos, index_range[1], factor, err_str)) {
+    return false;
+  }
+
+  /* Playback is usually forward, have the frame after this one ready for the next evaluation. */
+  const size_t frame_size = sizeof(float[3]) * (size_t)pc2_head.verts_tot;
+  MOD_meshcache_file_map_prefetch(
+      fmap, sizeof(pc2_head) + frame_size * (size_t)(index_range[1] + 1), frame_size);
+
+  return true;
+}
+
+/** \} */
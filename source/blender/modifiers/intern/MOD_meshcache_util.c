@@ -18,9 +18,21 @@
  * \ingroup modifiers
  */
 
+#include <stdio.h>
+
+#ifndef WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_string.h"
+
+#include "MEM_guardedalloc.h"
 
 #include "DNA_modifier_types.h"
 
@@ -62,3 +74,159 @@ void MOD_meshcache_calc_range(const float frame,
     }
   }
 }
+
+/* -------------------------------------------------------------------- */
+/** \name File Mapping
+ * \{ */
+
+static void meshcache_file_map_release(MeshCacheFileMap *fmap)
+{
+#ifndef WIN32
+  if (fmap->data != NULL) {
+    munmap((void *)fmap->data, fmap->size);
+  }
+  if (fmap->file != -1) {
+    close(fmap->file);
+  }
+#endif
+  fmap->data = NULL;
+  fmap->size = 0;
+  fmap->file = -1;
+  MEM_SAFE_FREE(fmap->filepath);
+}
+
+#ifndef WIN32
+static int64_t meshcache_stat_mtime_nsec(const struct stat *st)
+{
+#  ifdef __APPLE__
+  return (int64_t)st->st_mtimespec.tv_nsec;
+#  else
+  return (int64_t)st->st_mtim.tv_nsec;
+#  endif
+}
+
+/** Check \a st still describes the file that was mapped, unchanged. */
+static bool meshcache_file_map_stat_matches(const MeshCacheFileMap *fmap, const struct stat *st)
+{
+  return (fmap->size == (size_t)st->st_size) && (fmap->inode == (uint64_t)st->st_ino) &&
+         (fmap->mtime_sec == (int64_t)st->st_mtime) &&
+         (fmap->mtime_nsec == meshcache_stat_mtime_nsec(st));
+}
+#endif
+
+/**
+ * Return a mapping of \a filepath, reusing \a fmap when it still maps the same unchanged file.
+ * Returns NULL when the file can't be mapped (or mapping isn't supported),
+ * callers then fall back to reading the file.
+ */
+MeshCacheFileMap *MOD_meshcache_file_map_ensure(MeshCacheFileMap *fmap, const char *filepath)
+{
+#ifdef WIN32
+  UNUSED_VARS(filepath);
+  MOD_meshcache_file_map_free(fmap);
+  return NULL;
+#else
+  struct stat st;
+  if (stat(filepath, &st) != 0 || st.st_size <= 0) {
+    MOD_meshcache_file_map_free(fmap);
+    return NULL;
+  }
+
+  if (fmap != NULL) {
+    if ((fmap->data != NULL) && STREQ(fmap->filepath, filepath) &&
+        meshcache_file_map_stat_matches(fmap, &st)) {
+      return fmap;
+    }
+    meshcache_file_map_release(fmap);
+  }
+  else {
+    fmap = MEM_callocN(sizeof(*fmap), __func__);
+    fmap->file = -1;
+  }
+
+  const int file = open(filepath, O_RDONLY);
+  if (file == -1) {
+    MOD_meshcache_file_map_free(fmap);
+    return NULL;
+  }
+  /* Stat the opened file, the path may have been replaced since the check above. */
+  if (fstat(file, &st) != 0 || st.st_size <= 0) {
+    close(file);
+    MOD_meshcache_file_map_free(fmap);
+    return NULL;
+  }
+  void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, file, 0);
+  if (data == MAP_FAILED) {
+    close(file);
+    MOD_meshcache_file_map_free(fmap);
+    return NULL;
+  }
+
+  fmap->filepath = BLI_strdup(filepath);
+  fmap->data = data;
+  fmap->size = (size_t)st.st_size;
+  fmap->file = file;
+  fmap->mtime_sec = (int64_t)st.st_mtime;
+  fmap->mtime_nsec = meshcache_stat_mtime_nsec(&st);
+  fmap->inode = (uint64_t)st.st_ino;
+  return fmap;
+#endif
+}
+
+void MOD_meshcache_file_map_free(MeshCacheFileMap *fmap)
+{
+  if (fmap == NULL) {
+    return;
+  }
+  meshcache_file_map_release(fmap);
+  MEM_freeN(fmap);
+}
+
+/**
+ * Check the range of the mapping can be read, this must be called before every read.
+ *
+ * Reading pages of a shared mapping past the end of a file that was truncated (while being
+ * written again by an exporter for example) raises `SIGBUS`, so the open file is checked to be
+ * unchanged instead of relying on the size at the time it was mapped.
+ * The file could still be truncated between this check and the read, this only narrows the window
+ * to the copy of a single frame.
+ */
+bool MOD_meshcache_file_map_range_is_valid(const MeshCacheFileMap *fmap,
+                                           const size_t offset,
+                                           const size_t size)
+{
+  if ((offset > fmap->size) || (size > fmap->size - offset)) {
+    return false;
+  }
+#ifndef WIN32
+  struct stat st;
+  if (fstat(fmap->file, &st) != 0 || !meshcache_file_map_stat_matches(fmap, &st)) {
+    return false;
+  }
+#endif
+  return true;
+}
+
+/**
+ * Hint that a range of the file is about to be read (the next frame during playback),
+ * the kernel reads it ahead in the background so the next evaluation doesn't wait on the disk.
+ */
+void MOD_meshcache_file_map_prefetch(const MeshCacheFileMap *fmap,
+                                     const size_t offset,
+                                     const size_t size)
+{
+#if !defined(WIN32) && defined(MADV_WILLNEED)
+  if (offset >= fmap->size) {
+    return;
+  }
+  /* The start address passed to #madvise must be page aligned. */
+  const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t offset_aligned = offset - (offset % page_size);
+  const size_t end = min_zz(offset + size, fmap->size);
+  madvise((void *)(fmap->data + offset_aligned), end - offset_aligned, MADV_WILLNEED);
+#else
+  UNUSED_VARS(fmap, offset, size);
+#endif
+}
+
+/** \} */
@@ -21,6 +21,33 @@
 #ifndef __MOD_MESHCACHE_UTIL_H__
 #define __MOD_MESHCACHE_UTIL_H__
 
+/* MOD_meshcache_util.c */
+
+/**
+ * A cache file mapped into memory, kept in the modifier's runtime data so playback reads frames
+ * directly from the page cache instead of opening and seeking the file on every evaluation.
+ */
+typedef struct MeshCacheFileMap {
+  char *filepath;
+  const char *data;
+  size_t size;
+  /* Kept open to check the mapped file wasn't truncated before each read. */
+  int file;
+  /* Used to detect the file being written again or replaced, in that case it's mapped again. */
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  uint64_t inode;
+} MeshCacheFileMap;
+
+MeshCacheFileMap *MOD_meshcache_file_map_ensure(MeshCacheFileMap *fmap, const char *filepath);
+void MOD_meshcache_file_map_free(MeshCacheFileMap *fmap);
+bool MOD_meshcache_file_map_range_is_valid(const MeshCacheFileMap *fmap,
+                                           const size_t offset,
+                                           const size_t size);
+void MOD_meshcache_file_map_prefetch(const MeshCacheFileMap *fmap,
+                                     const size_t offset,
+                                     const size_t size);
+
 /* MOD_meshcache_mdd.c */
 bool MOD_meshcache_read_mdd_index(FILE *fp,
                                   float (*vertexCos)[3],
@@ -42,6 +69,14 @@ bool MOD_meshcache_read_mdd_times(const char *filepath,
                                   const float fps,
                                   const char time_mode,
                                   const char **err_str);
+bool MOD_meshcache_read_mdd_times_map(const MeshCacheFileMap *fmap,
+                                      float (*vertexCos)[3],
+                                      const int verts_tot,
+                                      const char interp,
+                                      const float time,
+                                      const float fps,
+                                      const char time_mode,
+                                      const char **err_str);
 
 /* MOD_meshcache_pc2.c */
 bool MOD_meshcache_read_pc2_index(FILE *fp,
@@ -64,6 +99,14 @@ bool MOD_meshcache_read_pc2_times(const char *filepath,
                                   const float fps,
                                   const char time_mode,
                                   const char **err_str);
+bool MOD_meshcache_read_pc2_times_map(const MeshCacheFileMap *fmap,
+                                      float (*vertexCos)[3],
+                                      const int verts_tot,
+                                      const char interp,
+                                      const float time,
+                                      const float fps,
+                                      const char time_mode,
+                                      const char **err_str);
 
 /* MOD_meshcache_util.c */
 void MOD_meshcache_calc_range(const float frame,
@@ -30,6 +30,7 @@
 #include "DNA_mesh_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
 #include "BKE_scene.h"
 #include "BKE_subdiv.h"
@@ -48,6 +49,9 @@
 typedef struct SubsurfRuntimeData {
   /* Cached subdivision surface descriptor, with topology and settings. */
   struct Subdiv *subdiv;
+  /* Subdivided mesh and limit surface coordinates of its vertices, for fast re-evaluation of
+   * meshes which only change vertex coordinates. */
+  struct SubdivMeshCache *mesh_cache;
 } SubsurfRuntimeData;
 
 static void initData(ModifierData *md)
@@ -82,6 +86,9 @@ static void freeRuntimeData(void *runtime_data_v)
   if (runtime_data->subdiv != NULL) {
     BKE_subdiv_free(runtime_data->subdiv);
   }
+  if (runtime_data->mesh_cache != NULL) {
+    BKE_subdiv_mesh_cache_free(runtime_data->mesh_cache);
+  }
   MEM_freeN(runtime_data);
 }
 
@@ -163,7 +170,20 @@ static Mesh *subdiv_as_mesh(SubsurfModifierData *smd,
   if (mesh_settings.resolution < 3) {
     return result;
   }
-  result = BKE_subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+  /* Final render and applying the modifier are one-time evaluations, the cache would only cost
+   * memory there. */
+  if (ctx->flag & (MOD_APPLY_RENDER | MOD_APPLY_TO_BASE_MESH)) {
+    result = BKE_subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+  }
+  else {
+    /* Shares the memory limit of the modifier stack cache. */
+    SubsurfRuntimeData *runtime_data = (SubsurfRuntimeData *)smd->modifier.runtime;
+    const size_t cache_memory_limit = (U.modifier_cachelimit > 0) ?
+                                          (size_t)U.modifier_cachelimit * 1024 * 1024 :
+                                          0;
+    result = BKE_subdiv_to_mesh_cached(
+        subdiv, &mesh_settings, mesh, cache_memory_limit, &runtime_data->mesh_cache);
+  }
   return result;
 }
 
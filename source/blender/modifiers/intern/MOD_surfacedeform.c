@@ -75,6 +75,15 @@ typedef struct SDefBindCalcData {
   int success;
 } SDefBindCalcData;
 
+/**
+ * Data which is localized to each computed chunk
+ * (i.e. thread-safe, and with continuous subset of index range).
+ */
+typedef struct SDefBindCalcDataChunk {
+  /* Nearest looptri of the previous vertex bound in this chunk, -1 when there is none yet. */
+  int looptri_hint;
+} SDefBindCalcDataChunk;
+
 typedef struct SDefBindPoly {
   float (*coords)[3];
   float (*coords_v2)[2];
@@ -320,7 +329,9 @@ BLI_INLINE void sortPolyVertsTri(uint *indices,
   }
 }
 
-BLI_INLINE uint nearestVert(SDefBindCalcData *const data, const float point_co[3])
+BLI_INLINE uint nearestVert(SDefBindCalcData *const data,
+                            SDefBindCalcDataChunk *const data_chunk,
+                            const float point_co[3])
 {
   BVHTreeNearest nearest = {
       .dist_sq = FLT_MAX,
@@ -336,9 +347,29 @@ BLI_INLINE uint nearestVert(SDefBindCalcData *const data, const float point_co[3
 
   mul_v3_m4v3(t_point, data->imat, point_co);
 
+  /* Vertices bound one after the other in a chunk are usually close to each other, so the search
+   * is bounded by the distance to the looptri nearest to the previous vertex, pruning most of the
+   * tree. The bound is slightly larger than that distance so the looptri found is the same as
+   * when searching the whole tree, including ties. */
+  if (data_chunk->looptri_hint != -1) {
+    data->treeData->nearest_callback(
+        data->treeData, data_chunk->looptri_hint, t_point, &nearest);
+    nearest.dist_sq = nearest.dist_sq * 1.0001f + FLT_EPSILON;
+    nearest.index = -1;
+  }
+
   BLI_bvhtree_find_nearest(
       data->treeData->tree, t_point, &nearest, data->treeData->nearest_callback, data->treeData);
 
+  if (UNLIKELY(nearest.index == -1)) {
+    /* The hinted looptri is within the bound, this is only a guard against non-finite
+     * coordinates, search without bounds. */
+    nearest.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(
+        data->treeData->tree, t_point, &nearest, data->treeData->nearest_callback, data->treeData);
+  }
+  data_chunk->looptri_hint = nearest.index;
+
   poly = &data->mpoly[data->looptri[nearest.index].poly];
   loop = &data->mloop[poly->loopstart];
 
@@ -423,9 +454,10 @@ BLI_INLINE float computeAngularWeight(const float point_angle, const float edgem
 }
 
 BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
+                                                  SDefBindCalcDataChunk *const data_chunk,
                                                   const float point_co[3])
 {
-  const uint nearest = nearestVert(data, point_co);
+  const uint nearest = nearestVert(data, data_chunk, point_co);
   const SDefAdjacency *const vert_edges = data->vert_edges[nearest].first;
   const SDefEdgePolys *const edge_polys = data->edge_polys;
 
@@ -813,9 +845,10 @@ BLI_INLINE float computeNormalDisplacement(const float point_co[3],
 
 static void bindVert(void *__restrict userdata,
                      const int index,
-                     const TaskParallelTLS *__restrict UNUSED(tls))
+                     const TaskParallelTLS *__restrict tls)
 {
   SDefBindCalcData *const data = (SDefBindCalcData *)userdata;
+  SDefBindCalcDataChunk *const data_chunk = tls->userdata_chunk;
   float point_co[3];
   float point_co_proj[3];
 
@@ -831,7 +864,7 @@ static void bindVert(void *__restrict userdata,
   }
 
   copy_v3_v3(point_co, data->vertexCos[index]);
-  bwdata = computeBindWeights(data, point_co);
+  bwdata = computeBindWeights(data, data_chunk, point_co);
 
   if (bwdata == NULL) {
     sdvert->binds = NULL;
@@ -1095,9 +1128,19 @@ static bool surfacedeformBind(SurfaceDeformModifierData *smd_orig,
     mul_v3_m4v3(data.targetCos[i], smd_orig->mat, mvert[i].co);
   }
 
+  /* Binding a vertex involves a nearest lookup and walking the polygons around it,
+   * which is expensive enough to thread much smaller meshes than when deforming.
+   * Vertices are bound in chunks of consecutive indices, reusing the previous nearest lookup. */
+  SDefBindCalcDataChunk data_chunk = {
+      .looptri_hint = -1,
+  };
+
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
-  settings.use_threading = (numverts > 10000);
+  settings.use_threading = (numverts > 100);
+  settings.min_iter_per_thread = 16;
+  settings.userdata_chunk = &data_chunk;
+  settings.userdata_chunk_size = sizeof(data_chunk);
   BLI_task_parallel_range(0, numverts, &data, bindVert, &settings);
 
   MEM_freeN(data.targetCos);
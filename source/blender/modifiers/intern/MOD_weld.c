@@ -32,8 +32,10 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_alloca.h"
+#include "BLI_bitmap.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -49,6 +51,8 @@
 
 #include "MOD_modifiertypes.h"
 
+#include "atomic_ops.h"
+
 //#define USE_WELD_DEBUG
 //#define USE_WELD_NORMALS
 
@@ -368,73 +372,309 @@ static void weld_assert_poly_len(const WeldPoly *wp, const WeldLoop *wloop)
 /** \} */
 
 /* -------------------------------------------------------------------- */
-/** \name Weld Vert API
+/** \name Vertex Clusters
+ *
+ * Vertices closer than the merge distance form clusters which are merged into one vertex.
+ * Clusters are found with a union-find over the vertex indices: `vert_dest_map` starts with every
+ * vertex pointing to itself and unions always link the higher root to the lower one, so once
+ * done the root of a cluster is its lowest vertex index. Unions are atomic, pairs of vertices are
+ * processed in parallel.
  * \{ */
 
-static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
-                                          const BVHTreeOverlap *overlap,
-                                          const uint overlap_len,
-                                          uint *r_vert_dest_map,
-                                          WeldVert **r_wvert,
-                                          uint *r_wvert_len,
-                                          uint *r_vert_kill_len)
+static uint weld_vert_root_find(const uint *vert_dest_map, uint v)
 {
-  uint *v_dest_iter = &r_vert_dest_map[0];
-  for (uint i = mvert_len; i--; v_dest_iter++) {
-    *v_dest_iter = OUT_OF_CONTEXT;
+  uint v_parent;
+  while ((v_parent = vert_dest_map[v]) != v) {
+    v = v_parent;
   }
+  return v;
+}
 
-  uint vert_kill_len = 0;
-  const BVHTreeOverlap *overlap_iter = &overlap[0];
-  for (uint i = 0; i < overlap_len; i++, overlap_iter++) {
-    uint indexA = overlap_iter->indexA;
-    uint indexB = overlap_iter->indexB;
+static void weld_vert_union(uint *vert_dest_map, uint va, uint vb)
+{
+  while (true) {
+    va = weld_vert_root_find(vert_dest_map, va);
+    vb = weld_vert_root_find(vert_dest_map, vb);
+    if (va == vb) {
+      return;
+    }
+    if (va > vb) {
+      SWAP(uint, va, vb);
+    }
+    /* Fails when another thread linked `vb` meanwhile, then try again from the new roots. */
+    if (atomic_cas_uint32(&vert_dest_map[vb], vb, va) == vb) {
+      return;
+    }
+  }
+}
 
-    BLI_assert(indexA < indexB);
+struct WeldOverlapUnionData {
+  const BVHTreeOverlap *overlap;
+  uint *vert_dest_map;
+};
 
-    uint va_dst = r_vert_dest_map[indexA];
-    uint vb_dst = r_vert_dest_map[indexB];
-    if (va_dst == OUT_OF_CONTEXT) {
-      if (vb_dst == OUT_OF_CONTEXT) {
-        vb_dst = indexA;
-        r_vert_dest_map[indexB] = vb_dst;
-      }
-      r_vert_dest_map[indexA] = vb_dst;
-      vert_kill_len++;
+static void weld_vert_clusters_from_overlap_cb(void *__restrict userdata,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct WeldOverlapUnionData *data = userdata;
+  const BVHTreeOverlap *overlap = &data->overlap[i];
+  weld_vert_union(data->vert_dest_map, (uint)overlap->indexA, (uint)overlap->indexB);
+}
+
+static void weld_vert_clusters_from_overlap(const BVHTreeOverlap *overlap,
+                                            const uint overlap_len,
+                                            uint *vert_dest_map)
+{
+  struct WeldOverlapUnionData data = {
+      .overlap = overlap,
+      .vert_dest_map = vert_dest_map,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (overlap_len > 10000);
+  BLI_task_parallel_range(
+      0, (int)overlap_len, &data, weld_vert_clusters_from_overlap_cb, &settings);
+}
+
+/* Spatial hash, used when the number of interactions isn't limited. Then all pairs closer than
+ * the merge distance are needed, which cells with the size of the merge distance find without
+ * the traversal overhead of a BVH overlap. */
+
+typedef struct WeldGridVert {
+  uint64_t cell;
+  uint vert;
+} WeldGridVert;
+
+struct WeldGridData {
+  const MVert *mvert;
+  float merge_dist_sq;
+  float cell_size_inv;
+  float min[3];
+  int cell_len[3];
+  /* Vertices sorted by cell. */
+  const WeldGridVert *grid_verts;
+  uint grid_verts_len;
+  uint *vert_dest_map;
+};
+
+static uint64_t weld_grid_cell_key(const int cell_len[3], const int cell[3])
+{
+  return (uint64_t)cell[0] +
+         (uint64_t)cell_len[0] * ((uint64_t)cell[1] + (uint64_t)cell_len[1] * (uint64_t)cell[2]);
+}
+
+static void weld_grid_cell_get(const struct WeldGridData *data, const float co[3], int r_cell[3])
+{
+  for (int i = 0; i < 3; i++) {
+    r_cell[i] = (int)((co[i] - data->min[i]) * data->cell_size_inv);
+    CLAMP(r_cell[i], 0, data->cell_len[i] - 1);
+  }
+}
+
+static int weld_grid_vert_cmp(const void *a_v, const void *b_v)
+{
+  const WeldGridVert *a = a_v;
+  const WeldGridVert *b = b_v;
+  if (a->cell != b->cell) {
+    return (a->cell < b->cell) ? -1 : 1;
+  }
+  return (a->vert < b->vert) ? -1 : (a->vert > b->vert);
+}
+
+/* Index of the first vertex in the cell, or `grid_verts_len` if the cell is empty. */
+static uint weld_grid_cell_first(const struct WeldGridData *data, const uint64_t cell)
+{
+  uint lo = 0, hi = data->grid_verts_len;
+  while (lo < hi) {
+    const uint mid = lo + (hi - lo) / 2;
+    if (data->grid_verts[mid].cell < cell) {
+      lo = mid + 1;
     }
-    else if (vb_dst == OUT_OF_CONTEXT) {
-      r_vert_dest_map[indexB] = va_dst;
-      vert_kill_len++;
+    else {
+      hi = mid;
     }
-    else if (va_dst != vb_dst) {
-      uint v_new, v_old;
-      if (va_dst < vb_dst) {
-        v_new = va_dst;
-        v_old = vb_dst;
-      }
-      else {
-        v_new = vb_dst;
-        v_old = va_dst;
-      }
-      BLI_assert(r_vert_dest_map[v_old] == v_old);
-      BLI_assert(r_vert_dest_map[v_new] == v_new);
-      vert_kill_len++;
+  }
+  return (lo < data->grid_verts_len && data->grid_verts[lo].cell == cell) ? lo :
+                                                                             data->grid_verts_len;
+}
 
-      const BVHTreeOverlap *overlap_iter_b = &overlap[0];
-      for (uint j = i + 1; j--; overlap_iter_b++) {
-        indexA = overlap_iter_b->indexA;
-        indexB = overlap_iter_b->indexB;
-        va_dst = r_vert_dest_map[indexA];
-        vb_dst = r_vert_dest_map[indexB];
-        if (ELEM(v_old, vb_dst, va_dst)) {
-          r_vert_dest_map[indexA] = v_new;
-          r_vert_dest_map[indexB] = v_new;
+static void weld_vert_clusters_from_grid_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldGridData *data = userdata;
+  const uint v = data->grid_verts[i].vert;
+  const float *co = data->mvert[v].co;
+
+  int cell[3];
+  weld_grid_cell_get(data, co, cell);
+
+  int cell_iter[3];
+  for (int z = -1; z <= 1; z++) {
+    cell_iter[2] = cell[2] + z;
+    if (cell_iter[2] < 0 || cell_iter[2] >= data->cell_len[2]) {
+      continue;
+    }
+    for (int y = -1; y <= 1; y++) {
+      cell_iter[1] = cell[1] + y;
+      if (cell_iter[1] < 0 || cell_iter[1] >= data->cell_len[1]) {
+        continue;
+      }
+      for (int x = -1; x <= 1; x++) {
+        cell_iter[0] = cell[0] + x;
+        if (cell_iter[0] < 0 || cell_iter[0] >= data->cell_len[0]) {
+          continue;
+        }
+        const uint64_t key = weld_grid_cell_key(data->cell_len, cell_iter);
+        for (uint j = weld_grid_cell_first(data, key);
+             j < data->grid_verts_len && data->grid_verts[j].cell == key;
+             j++) {
+          /* Each pair is found from both of its vertices, only test it once. */
+          const uint v_other = data->grid_verts[j].vert;
+          if (v_other > v &&
+              len_squared_v3v3(co, data->mvert[v_other].co) <= data->merge_dist_sq) {
+            weld_vert_union(data->vert_dest_map, v, v_other);
+          }
         }
       }
-      BLI_assert(r_vert_dest_map[v_old] == v_new);
     }
   }
+}
+
+/**
+ * Cluster all vertices closer than \a merge_dist.
+ * \return false when the grid can't be used (zero merge distance or too many cells),
+ * then the BVH overlap is used instead.
+ */
+static bool weld_vert_clusters_from_grid(const MVert *mvert,
+                                         const uint mvert_len,
+                                         const BLI_bitmap *v_mask,
+                                         const float merge_dist,
+                                         uint *vert_dest_map)
+{
+  if (merge_dist <= 0.0f) {
+    return false;
+  }
+
+  float min[3], max[3];
+  INIT_MINMAX(min, max);
+  uint grid_verts_len = 0;
+  for (uint i = 0; i < mvert_len; i++) {
+    if (v_mask == NULL || BLI_BITMAP_TEST(v_mask, i)) {
+      minmax_v3v3_v3(min, max, mvert[i].co);
+      grid_verts_len++;
+    }
+  }
+  if (grid_verts_len < 2) {
+    /* Nothing to merge. */
+    return true;
+  }
+
+  /* Grow the cells by the precision of the coordinates, so rounding can't put vertices closer
+   * than the merge distance more than one cell apart. */
+  const float co_abs_max = max_ff(max_fff(fabsf(min[0]), fabsf(min[1]), fabsf(min[2])),
+                                  max_fff(fabsf(max[0]), fabsf(max[1]), fabsf(max[2])));
+
+  struct WeldGridData data;
+  data.mvert = mvert;
+  data.merge_dist_sq = square_f(merge_dist);
+  data.cell_size_inv = 1.0f / (merge_dist + 4.0f * FLT_EPSILON * co_abs_max);
+  copy_v3_v3(data.min, min);
+
+  /* Keys must fit into 64 bits and coordinates into integers. */
+  double cell_tot = 1.0;
+  for (int i = 0; i < 3; i++) {
+    const double cell_len = floor((double)(max[i] - min[i]) * data.cell_size_inv) + 1.0;
+    if (cell_len > (double)(INT_MAX / 2)) {
+      return false;
+    }
+    data.cell_len[i] = (int)cell_len;
+    cell_tot *= cell_len;
+  }
+  if (cell_tot > (double)(1ULL << 62)) {
+    return false;
+  }
+
+  WeldGridVert *grid_verts = MEM_mallocN(sizeof(*grid_verts) * grid_verts_len, __func__);
+  WeldGridVert *gv = grid_verts;
+  for (uint i = 0; i < mvert_len; i++) {
+    if (v_mask == NULL || BLI_BITMAP_TEST(v_mask, i)) {
+      int cell[3];
+      weld_grid_cell_get(&data, mvert[i].co, cell);
+      gv->cell = weld_grid_cell_key(data.cell_len, cell);
+      gv->vert = i;
+      gv++;
+    }
+  }
+  qsort(grid_verts, grid_verts_len, sizeof(*grid_verts), weld_grid_vert_cmp);
+
+  data.grid_verts = grid_verts;
+  data.grid_verts_len = grid_verts_len;
+  data.vert_dest_map = vert_dest_map;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (grid_verts_len > 10000);
+  BLI_task_parallel_range(
+      0, (int)grid_verts_len, &data, weld_vert_clusters_from_grid_cb, &settings);
+
+  MEM_freeN(grid_verts);
+  return true;
+}
+
+static void weld_vert_clusters_flatten_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  uint *vert_dest_map = userdata;
+  /* Other threads may still walk through this vertex, pointing it to the root keeps that valid. */
+  vert_dest_map[i] = weld_vert_root_find(vert_dest_map, (uint)i);
+}
 
+/**
+ * Point every vertex to the root of its cluster, vertices which are not merged with any other
+ * get #OUT_OF_CONTEXT.
+ * \return The number of vertices which are removed.
+ */
+static uint weld_vert_clusters_finalize(const uint mvert_len, uint *vert_dest_map)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (mvert_len > 10000);
+  BLI_task_parallel_range(
+      0, (int)mvert_len, vert_dest_map, weld_vert_clusters_flatten_cb, &settings);
+
+  BLI_bitmap *is_root_merged = BLI_BITMAP_NEW(mvert_len, __func__);
+  uint vert_kill_len = 0;
+  for (uint i = 0; i < mvert_len; i++) {
+    if (vert_dest_map[i] != i) {
+      BLI_BITMAP_ENABLE(is_root_merged, vert_dest_map[i]);
+      vert_kill_len++;
+    }
+  }
+  for (uint i = 0; i < mvert_len; i++) {
+    if (vert_dest_map[i] == i && !BLI_BITMAP_TEST(is_root_merged, i)) {
+      vert_dest_map[i] = OUT_OF_CONTEXT;
+    }
+  }
+  MEM_freeN(is_root_merged);
+
+  return vert_kill_len;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Weld Vert API
+ * \{ */
+
+static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
+                                          const uint *vert_dest_map,
+                                          WeldVert **r_wvert,
+                                          uint *r_wvert_len)
+{
   /* Vert Context. */
   uint wvert_len = 0;
 
@@ -442,7 +682,7 @@ static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
   wvert = MEM_mallocN(sizeof(*wvert) * mvert_len, __func__);
   wv = &wvert[0];
 
-  v_dest_iter = &r_vert_dest_map[0];
+  const uint *v_dest_iter = &vert_dest_map[0];
   for (uint i = 0; i < mvert_len; i++, v_dest_iter++) {
     if (*v_dest_iter != OUT_OF_CONTEXT) {
       wv->vert_dest = *v_dest_iter;
@@ -452,13 +692,8 @@ static void weld_vert_ctx_alloc_and_setup(const uint mvert_len,
     }
   }
 
-#ifdef USE_WELD_DEBUG
-  weld_assert_vert_dest_map_setup(overlap, overlap_len, r_vert_dest_map);
-#endif
-
   *r_wvert = MEM_reallocN(wvert, sizeof(*wvert) * wvert_len);
   *r_wvert_len = wvert_len;
-  *r_vert_kill_len = vert_kill_len;
 }
 
 static void weld_vert_groups_setup(const uint mvert_len,
@@ -1383,9 +1618,12 @@ static void weld_poly_loop_ctx_setup(const MLoop *mloop,
 /** \name Weld Mesh API
  * \{ */
 
+/**
+ * \param vert_dest_map: Result of #weld_vert_clusters_finalize, owned by the context afterwards.
+ */
 static void weld_mesh_context_create(const Mesh *mesh,
-                                     BVHTreeOverlap *overlap,
-                                     const uint overlap_len,
+                                     uint *vert_dest_map,
+                                     const uint vert_kill_len,
                                      WeldMesh *r_weld_mesh)
 {
   const MEdge *medge = mesh->medge;
@@ -1396,19 +1634,13 @@ static void weld_mesh_context_create(const Mesh *mesh,
   const uint mloop_len = mesh->totloop;
   const uint mpoly_len = mesh->totpoly;
 
-  uint *vert_dest_map = MEM_mallocN(sizeof(*vert_dest_map) * mvert_len, __func__);
   uint *edge_dest_map = MEM_mallocN(sizeof(*edge_dest_map) * medge_len, __func__);
   struct WeldGroup *v_links = MEM_callocN(sizeof(*v_links) * mvert_len, __func__);
 
   WeldVert *wvert;
   uint wvert_len;
-  weld_vert_ctx_alloc_and_setup(mvert_len,
-                                overlap,
-                                overlap_len,
-                                vert_dest_map,
-                                &wvert,
-                                &wvert_len,
-                                &r_weld_mesh->vert_kill_len);
+  weld_vert_ctx_alloc_and_setup(mvert_len, vert_dest_map, &wvert, &wvert_len);
+  r_weld_mesh->vert_kill_len = vert_kill_len;
 
   uint *edge_ctx_map;
   WeldEdge *wedge;
@@ -1638,6 +1870,253 @@ static bool bvhtree_weld_overlap_cb(void *userdata, int index_a, int index_b, in
   return false;
 }
 
+/* Elements are copied to the result in blocks. The destination index of each block is counted
+ * beforehand, so the blocks (and polygons) are copied in parallel. */
+#define WELD_BLOCK_SIZE 1024
+
+struct WeldResultData {
+  const Mesh *mesh;
+  Mesh *result;
+  const WeldMesh *weld_mesh;
+  uint *vert_final;
+  uint *edge_final;
+
+  /* Vertices or edges of the current pass. */
+  const uint *groups_map;
+  uint elem_len;
+  /* Destination index of the first element of each block. */
+  uint *block_dest;
+
+  /* Polygons, followed by the new polygons. #OUT_OF_CONTEXT in `poly_dest` for removed ones. */
+  uint *poly_dest;
+  uint *poly_loop_start;
+  uint *poly_loop_len;
+};
+
+static void weld_result_block_len_cb(void *__restrict userdata,
+                                     const int b,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct WeldResultData *data = userdata;
+  const uint start = (uint)b * WELD_BLOCK_SIZE;
+  const uint end = MIN2(start + WELD_BLOCK_SIZE, data->elem_len);
+  uint len = 0;
+  for (uint i = start; i < end; i++) {
+    if (data->groups_map[i] != ELEM_MERGED) {
+      len++;
+    }
+  }
+  data->block_dest[b] = len;
+}
+
+/* Count the elements of each block and turn the counts into destination offsets. */
+static uint weld_result_blocks_setup(struct WeldResultData *data,
+                                     const uint *groups_map,
+                                     const uint elem_len)
+{
+  const uint block_len = (elem_len + WELD_BLOCK_SIZE - 1) / WELD_BLOCK_SIZE;
+  data->groups_map = groups_map;
+  data->elem_len = elem_len;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, (int)block_len, data, weld_result_block_len_cb, &settings);
+
+  uint ofs = 0;
+  for (uint b = 0; b < block_len; b++) {
+    const uint len = data->block_dest[b];
+    data->block_dest[b] = ofs;
+    ofs += len;
+  }
+  return block_len;
+}
+
+static void weld_result_verts_cb(void *__restrict userdata,
+                                 const int b,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldResultData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  Mesh *result = data->result;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const uint start = (uint)b * WELD_BLOCK_SIZE;
+  const uint end = MIN2(start + WELD_BLOCK_SIZE, data->elem_len);
+
+  uint *index_iter = &data->vert_final[start];
+  int dest_index = (int)data->block_dest[b];
+  for (uint i = start; i < end; i++, index_iter++) {
+    int source_index = i;
+    int count = 0;
+    while (i < end && *index_iter == OUT_OF_CONTEXT) {
+      *index_iter = dest_index + count;
+      index_iter++;
+      count++;
+      i++;
+    }
+    if (count) {
+      CustomData_copy_data(&mesh->vdata, &result->vdata, source_index, dest_index, count);
+      dest_index += count;
+    }
+    if (i == end) {
+      break;
+    }
+    if (*index_iter != ELEM_MERGED) {
+      struct WeldGroup *wgroup = &weld_mesh->vert_groups[*index_iter];
+      customdata_weld(&mesh->vdata,
+                      &result->vdata,
+                      &weld_mesh->vert_groups_buffer[wgroup->ofs],
+                      wgroup->len,
+                      dest_index);
+      *index_iter = dest_index;
+      dest_index++;
+    }
+  }
+}
+
+static void weld_result_edges_cb(void *__restrict userdata,
+                                 const int b,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldResultData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  Mesh *result = data->result;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const uint *vert_final = data->vert_final;
+  const uint start = (uint)b * WELD_BLOCK_SIZE;
+  const uint end = MIN2(start + WELD_BLOCK_SIZE, data->elem_len);
+
+  uint *index_iter = &data->edge_final[start];
+  int dest_index = (int)data->block_dest[b];
+  for (uint i = start; i < end; i++, index_iter++) {
+    int source_index = i;
+    int count = 0;
+    while (i < end && *index_iter == OUT_OF_CONTEXT) {
+      *index_iter = dest_index + count;
+      index_iter++;
+      count++;
+      i++;
+    }
+    if (count) {
+      CustomData_copy_data(&mesh->edata, &result->edata, source_index, dest_index, count);
+      MEdge *me = &result->medge[dest_index];
+      dest_index += count;
+      for (; count--; me++) {
+        me->v1 = vert_final[me->v1];
+        me->v2 = vert_final[me->v2];
+      }
+    }
+    if (i == end) {
+      break;
+    }
+    if (*index_iter != ELEM_MERGED) {
+      struct WeldGroupEdge *wegrp = &weld_mesh->edge_groups[*index_iter];
+      customdata_weld(&mesh->edata,
+                      &result->edata,
+                      &weld_mesh->edge_groups_buffer[wegrp->group.ofs],
+                      wegrp->group.len,
+                      dest_index);
+      MEdge *me = &result->medge[dest_index];
+      me->v1 = vert_final[wegrp->v1];
+      me->v2 = vert_final[wegrp->v2];
+      me->flag |= ME_LOOSEEDGE;
+
+      *index_iter = dest_index;
+      dest_index++;
+    }
+  }
+}
+
+/* The context polygon of polygon \a i, NULL when it's not affected by welding. */
+static const WeldPoly *weld_result_wpoly_get(const struct WeldResultData *data, const uint i)
+{
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const uint mpoly_len = (uint)data->mesh->totpoly;
+  if (i >= mpoly_len) {
+    return &weld_mesh->wpoly_new[i - mpoly_len];
+  }
+  const uint poly_ctx = weld_mesh->poly_map[i];
+  return (poly_ctx != OUT_OF_CONTEXT) ? &weld_mesh->wpoly[poly_ctx] : NULL;
+}
+
+static void weld_result_poly_len_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  struct WeldResultData *data = userdata;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const WeldPoly *wp = weld_result_wpoly_get(data, (uint)i);
+  if (wp == NULL) {
+    data->poly_loop_len[i] = (uint)data->mesh->mpoly[i].totloop;
+    return;
+  }
+
+  WeldLoopOfPolyIter iter;
+  if (!weld_iter_loop_of_poly_begin(
+          &iter, wp, weld_mesh->wloop, data->mesh->mloop, weld_mesh->loop_map, NULL) ||
+      (wp->poly_dst != OUT_OF_CONTEXT)) {
+    data->poly_loop_len[i] = OUT_OF_CONTEXT;
+    return;
+  }
+  uint loop_len = 0;
+  while (weld_iter_loop_of_poly_next(&iter)) {
+    loop_len++;
+  }
+  data->poly_loop_len[i] = loop_len;
+}
+
+static void weld_result_polys_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct WeldResultData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  Mesh *result = data->result;
+  const WeldMesh *weld_mesh = data->weld_mesh;
+  const uint *vert_final = data->vert_final;
+  const uint *edge_final = data->edge_final;
+
+  const uint r_i = data->poly_dest[i];
+  if (r_i == OUT_OF_CONTEXT) {
+    return;
+  }
+
+  const int loop_start = (int)data->poly_loop_start[i];
+  int loop_cur = loop_start;
+  MLoop *r_ml = &result->mloop[loop_cur];
+
+  const WeldPoly *wp = weld_result_wpoly_get(data, (uint)i);
+  if (wp == NULL) {
+    const MPoly *mp = &mesh->mpoly[i];
+    uint mp_loop_len = mp->totloop;
+    CustomData_copy_data(&mesh->ldata, &result->ldata, mp->loopstart, loop_cur, mp_loop_len);
+    for (; mp_loop_len--; r_ml++) {
+      r_ml->v = vert_final[r_ml->v];
+      r_ml->e = edge_final[r_ml->e];
+    }
+  }
+  else {
+    uint *group_buffer = BLI_array_alloca(group_buffer, weld_mesh->max_poly_len);
+    WeldLoopOfPolyIter iter;
+    weld_iter_loop_of_poly_begin(
+        &iter, wp, weld_mesh->wloop, mesh->mloop, weld_mesh->loop_map, group_buffer);
+    while (weld_iter_loop_of_poly_next(&iter)) {
+      customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
+      r_ml->v = vert_final[iter.v];
+      r_ml->e = edge_final[iter.e];
+      r_ml++;
+      loop_cur++;
+    }
+  }
+
+  /* New polygons don't have source data. */
+  if (i < mesh->totpoly) {
+    CustomData_copy_data(&mesh->pdata, &result->pdata, i, r_i, 1);
+  }
+  MPoly *r_mp = &result->mpoly[r_i];
+  r_mp->loopstart = loop_start;
+  r_mp->totloop = data->poly_loop_len[i];
+}
+
 static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContext *ctx, Mesh *mesh)
 {
   Mesh *result = mesh;
@@ -1647,8 +2126,6 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
   int v_mask_act = 0;
 
   const MVert *mvert;
-  const MLoop *mloop;
-  const MPoly *mpoly, *mp;
   uint totvert, totedge, totloop, totpoly;
   uint i;
 
@@ -1674,231 +2151,150 @@ static Mesh *weldModifier_doWeld(WeldModifierData *wmd, const ModifierEvalContex
     }
   }
 
-  /* Get overlap map. */
-  /* TODO: For a better performanse use KD-Tree. */
-  struct BVHTreeFromMesh treedata;
-  BVHTree *bvhtree = bvhtree_from_mesh_verts_ex(
-      &treedata, mvert, totvert, false, v_mask, v_mask_act, wmd->merge_dist / 2, 2, 6, 0, NULL);
+  /* Find the clusters of vertices to merge, every vertex starts as its own cluster. */
+  uint *vert_dest_map = MEM_mallocN(sizeof(*vert_dest_map) * totvert, __func__);
+  for (i = 0; i < totvert; i++) {
+    vert_dest_map[i] = i;
+  }
+
+  if ((wmd->max_interactions == 0) &&
+      weld_vert_clusters_from_grid(mvert, totvert, v_mask, wmd->merge_dist, vert_dest_map)) {
+    /* Pass. */
+  }
+  else {
+    /* Get overlap map. */
+    struct BVHTreeFromMesh treedata;
+    BVHTree *bvhtree = bvhtree_from_mesh_verts_ex(
+        &treedata, mvert, totvert, false, v_mask, v_mask_act, wmd->merge_dist / 2, 2, 6, 0, NULL);
+
+    if (bvhtree) {
+      struct WeldOverlapData data;
+      data.mvert = mvert;
+      data.merge_dist_sq = square_f(wmd->merge_dist);
+
+      uint overlap_len;
+      BVHTreeOverlap *overlap = BLI_bvhtree_overlap_ex(
+          bvhtree,
+          bvhtree,
+          &overlap_len,
+          bvhtree_weld_overlap_cb,
+          &data,
+          wmd->max_interactions,
+          BVH_OVERLAP_RETURN_PAIRS | BVH_OVERLAP_USE_THREADING);
+
+      free_bvhtree_from_mesh(&treedata);
+
+      if (overlap) {
+        weld_vert_clusters_from_overlap(overlap, overlap_len, vert_dest_map);
+#ifdef USE_WELD_DEBUG
+        uint *vert_root_map = MEM_dupallocN(vert_dest_map);
+        weld_vert_clusters_finalize(totvert, vert_root_map);
+        weld_assert_vert_dest_map_setup(overlap, overlap_len, vert_root_map);
+        MEM_freeN(vert_root_map);
+#endif
+        MEM_freeN(overlap);
+      }
+    }
+  }
 
   if (v_mask) {
     MEM_freeN(v_mask);
   }
 
-  if (bvhtree == NULL) {
+  const uint vert_kill_len = weld_vert_clusters_finalize(totvert, vert_dest_map);
+
+  if (vert_kill_len == 0) {
+    MEM_freeN(vert_dest_map);
     return result;
   }
 
-  struct WeldOverlapData data;
-  data.mvert = mvert;
-  data.merge_dist_sq = square_f(wmd->merge_dist);
-
-  uint overlap_len;
-  BVHTreeOverlap *overlap = BLI_bvhtree_overlap_ex(bvhtree,
-                                                   bvhtree,
-                                                   &overlap_len,
-                                                   bvhtree_weld_overlap_cb,
-                                                   &data,
-                                                   wmd->max_interactions,
-                                                   BVH_OVERLAP_RETURN_PAIRS);
-
-  free_bvhtree_from_mesh(&treedata);
-
-  if (overlap_len) {
-    WeldMesh weld_mesh;
-    weld_mesh_context_create(mesh, overlap, overlap_len, &weld_mesh);
-
-    mloop = mesh->mloop;
-    mpoly = mesh->mpoly;
-
-    totedge = mesh->totedge;
-    totloop = mesh->totloop;
-    totpoly = mesh->totpoly;
-
-    const int result_nverts = totvert - weld_mesh.vert_kill_len;
-    const int result_nedges = totedge - weld_mesh.edge_kill_len;
-    const int result_nloops = totloop - weld_mesh.loop_kill_len;
-    const int result_npolys = totpoly - weld_mesh.poly_kill_len + weld_mesh.wpoly_new_len;
-
-    result = BKE_mesh_new_nomain_from_template(
-        mesh, result_nverts, result_nedges, 0, result_nloops, result_npolys);
-
-    /* Vertices */
-
-    uint *vert_final = weld_mesh.vert_groups_map;
-    uint *index_iter = &vert_final[0];
-    int dest_index = 0;
-    for (i = 0; i < totvert; i++, index_iter++) {
-      int source_index = i;
-      int count = 0;
-      while (i < totvert && *index_iter == OUT_OF_CONTEXT) {
-        *index_iter = dest_index + count;
-        index_iter++;
-        count++;
-        i++;
-      }
-      if (count) {
-        CustomData_copy_data(&mesh->vdata, &result->vdata, source_index, dest_index, count);
-        dest_index += count;
-      }
-      if (i == totvert) {
-        break;
-      }
-      if (*index_iter != ELEM_MERGED) {
-        struct WeldGroup *wgroup = &weld_mesh.vert_groups[*index_iter];
-        customdata_weld(&mesh->vdata,
-                        &result->vdata,
-                        &weld_mesh.vert_groups_buffer[wgroup->ofs],
-                        wgroup->len,
-                        dest_index);
-        *index_iter = dest_index;
-        dest_index++;
-      }
-    }
+  WeldMesh weld_mesh;
+  weld_mesh_context_create(mesh, vert_dest_map, vert_kill_len, &weld_mesh);
 
-    BLI_assert(dest_index == result_nverts);
+  totedge = mesh->totedge;
+  totloop = mesh->totloop;
+  totpoly = mesh->totpoly;
 
-    /* Edges */
+  const int result_nverts = totvert - weld_mesh.vert_kill_len;
+  const int result_nedges = totedge - weld_mesh.edge_kill_len;
+  const int result_nloops = totloop - weld_mesh.loop_kill_len;
+  const int result_npolys = totpoly - weld_mesh.poly_kill_len + weld_mesh.wpoly_new_len;
 
-    uint *edge_final = weld_mesh.edge_groups_map;
-    index_iter = &edge_final[0];
-    dest_index = 0;
-    for (i = 0; i < totedge; i++, index_iter++) {
-      int source_index = i;
-      int count = 0;
-      while (i < totedge && *index_iter == OUT_OF_CONTEXT) {
-        *index_iter = dest_index + count;
-        index_iter++;
-        count++;
-        i++;
-      }
-      if (count) {
-        CustomData_copy_data(&mesh->edata, &result->edata, source_index, dest_index, count);
-        MEdge *me = &result->medge[dest_index];
-        dest_index += count;
-        for (; count--; me++) {
-          me->v1 = vert_final[me->v1];
-          me->v2 = vert_final[me->v2];
-        }
-      }
-      if (i == totedge) {
-        break;
-      }
-      if (*index_iter != ELEM_MERGED) {
-        struct WeldGroupEdge *wegrp = &weld_mesh.edge_groups[*index_iter];
-        customdata_weld(&mesh->edata,
-                        &result->edata,
-                        &weld_mesh.edge_groups_buffer[wegrp->group.ofs],
-                        wegrp->group.len,
-                        dest_index);
-        MEdge *me = &result->medge[dest_index];
-        me->v1 = vert_final[wegrp->v1];
-        me->v2 = vert_final[wegrp->v2];
-        me->flag |= ME_LOOSEEDGE;
-
-        *index_iter = dest_index;
-        dest_index++;
-      }
-    }
+  result = BKE_mesh_new_nomain_from_template(
+      mesh, result_nverts, result_nedges, 0, result_nloops, result_npolys);
 
-    BLI_assert(dest_index == result_nedges);
-
-    /* Polys/Loops */
-
-    mp = &mpoly[0];
-    MPoly *r_mp = &result->mpoly[0];
-    MLoop *r_ml = &result->mloop[0];
-    uint r_i = 0;
-    int loop_cur = 0;
-    uint *group_buffer = BLI_array_alloca(group_buffer, weld_mesh.max_poly_len);
-    for (i = 0; i < totpoly; i++, mp++) {
-      int loop_start = loop_cur;
-      uint poly_ctx = weld_mesh.poly_map[i];
-      if (poly_ctx == OUT_OF_CONTEXT) {
-        uint mp_loop_len = mp->totloop;
-        CustomData_copy_data(&mesh->ldata, &result->ldata, mp->loopstart, loop_cur, mp_loop_len);
-        loop_cur += mp_loop_len;
-        for (; mp_loop_len--; r_ml++) {
-          r_ml->v = vert_final[r_ml->v];
-          r_ml->e = edge_final[r_ml->e];
-        }
-      }
-      else {
-        WeldPoly *wp = &weld_mesh.wpoly[poly_ctx];
-        WeldLoopOfPolyIter iter;
-        if (!weld_iter_loop_of_poly_begin(
-                &iter, wp, weld_mesh.wloop, mloop, weld_mesh.loop_map, group_buffer)) {
-          continue;
-        }
-        else {
-          if (wp->poly_dst != OUT_OF_CONTEXT) {
-            continue;
-          }
-          while (weld_iter_loop_of_poly_next(&iter)) {
-            customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
-            uint v = vert_final[iter.v];
-            uint e = edge_final[iter.e];
-            r_ml->v = v;
-            r_ml->e = e;
-            r_ml++;
-            loop_cur++;
-            if (iter.type) {
-              result->medge[e].flag &= ~ME_LOOSEEDGE;
-            }
-            BLI_assert((result->medge[e].flag & ME_LOOSEEDGE) == 0);
-          }
-        }
-      }
+  struct WeldResultData data = {
+      .mesh = mesh,
+      .result = result,
+      .weld_mesh = &weld_mesh,
+      .vert_final = weld_mesh.vert_groups_map,
+      .edge_final = weld_mesh.edge_groups_map,
+  };
+  const uint block_len_max = (MAX2(totvert, totedge) + WELD_BLOCK_SIZE - 1) / WELD_BLOCK_SIZE;
+  data.block_dest = MEM_mallocN(sizeof(*data.block_dest) * block_len_max, __func__);
 
-      CustomData_copy_data(&mesh->pdata, &result->pdata, i, r_i, 1);
-      r_mp->loopstart = loop_start;
-      r_mp->totloop = loop_cur - loop_start;
-      r_mp++;
-      r_i++;
-    }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
 
-    WeldPoly *wp = &weld_mesh.wpoly_new[0];
-    for (i = 0; i < weld_mesh.wpoly_new_len; i++, wp++) {
-      int loop_start = loop_cur;
-      WeldLoopOfPolyIter iter;
-      if (!weld_iter_loop_of_poly_begin(
-              &iter, wp, weld_mesh.wloop, mloop, weld_mesh.loop_map, group_buffer)) {
-        continue;
-      }
-      else {
-        if (wp->poly_dst != OUT_OF_CONTEXT) {
-          continue;
-        }
-        while (weld_iter_loop_of_poly_next(&iter)) {
-          customdata_weld(&mesh->ldata, &result->ldata, group_buffer, iter.group_len, loop_cur);
-          uint v = vert_final[iter.v];
-          uint e = edge_final[iter.e];
-          r_ml->v = v;
-          r_ml->e = e;
-          r_ml++;
-          loop_cur++;
-          if (iter.type) {
-            result->medge[e].flag &= ~ME_LOOSEEDGE;
-          }
-          BLI_assert((result->medge[e].flag & ME_LOOSEEDGE) == 0);
-        }
-      }
-      r_mp->loopstart = loop_start;
-      r_mp->totloop = loop_cur - loop_start;
-      r_mp++;
-      r_i++;
+  /* Vertices */
+
+  uint block_len = weld_result_blocks_setup(&data, weld_mesh.vert_groups_map, totvert);
+  BLI_task_parallel_range(0, (int)block_len, &data, weld_result_verts_cb, &settings);
+
+  /* Edges */
+
+  block_len = weld_result_blocks_setup(&data, weld_mesh.edge_groups_map, totedge);
+  BLI_task_parallel_range(0, (int)block_len, &data, weld_result_edges_cb, &settings);
+
+  MEM_freeN(data.block_dest);
+
+  /* Polys/Loops */
+
+  const uint poly_len = totpoly + weld_mesh.wpoly_new_len;
+  data.poly_dest = MEM_mallocN(sizeof(*data.poly_dest) * poly_len, __func__);
+  data.poly_loop_start = MEM_mallocN(sizeof(*data.poly_loop_start) * poly_len, __func__);
+  data.poly_loop_len = MEM_mallocN(sizeof(*data.poly_loop_len) * poly_len, __func__);
+
+  settings.use_threading = (poly_len > 1000);
+  BLI_task_parallel_range(0, (int)poly_len, &data, weld_result_poly_len_cb, &settings);
+
+  uint r_i = 0;
+  uint loop_cur = 0;
+  for (i = 0; i < poly_len; i++) {
+    if (data.poly_loop_len[i] == OUT_OF_CONTEXT) {
+      data.poly_dest[i] = OUT_OF_CONTEXT;
+      continue;
     }
+    data.poly_dest[i] = r_i++;
+    data.poly_loop_start[i] = loop_cur;
+    loop_cur += data.poly_loop_len[i];
+  }
+
+  BLI_assert((int)r_i == result_npolys);
+  BLI_assert((int)loop_cur == result_nloops);
 
-    BLI_assert((int)r_i == result_npolys);
-    BLI_assert(loop_cur == result_nloops);
+  BLI_task_parallel_range(0, (int)poly_len, &data, weld_result_polys_cb, &settings);
 
-    /* is this needed? */
-    /* recalculate normals */
-    result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  MEM_freeN(data.poly_dest);
+  MEM_freeN(data.poly_loop_start);
+  MEM_freeN(data.poly_loop_len);
 
-    weld_mesh_context_free(&weld_mesh);
+  /* Merged edges are marked loose until a face is found using them. */
+  const MLoop *r_ml = result->mloop;
+  for (i = 0; i < (uint)result_nloops; i++, r_ml++) {
+    result->medge[r_ml->e].flag &= ~ME_LOOSEEDGE;
   }
 
-  MEM_freeN(overlap);
+  /* is this needed? */
+  /* recalculate normals */
+  result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+
+  weld_mesh_context_free(&weld_mesh);
+
+#ifdef USE_WELD_DEBUG
+  BLI_assert(BKE_mesh_is_valid(result));
+#endif
+
   return result;
 }
 
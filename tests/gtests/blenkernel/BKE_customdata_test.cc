@@ -0,0 +1,158 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#define SOURCE_LEN 64
+#define DEST_LEN 256
+
+/* Layers with a dedicated batch loop, and normals which use their interpolation callback. */
+static void customdata_interp_layers_add(CustomData *data,
+                                         const int totelem,
+                                         const bool use_normal)
+{
+  CustomData_reset(data);
+  const int types[] = {CD_MLOOPUV, CD_MLOOPUV, CD_MLOOPCOL, CD_SHAPEKEY, CD_BWEIGHT, CD_CREASE};
+  for (int i = 0; i < ARRAY_SIZE(types); i++) {
+    CustomData_add_layer(data, types[i], CD_CALLOC, nullptr, totelem);
+  }
+  if (use_normal) {
+    CustomData_add_layer(data, CD_NORMAL, CD_CALLOC, nullptr, totelem);
+  }
+}
+
+static void customdata_interp_source_fill(CustomData *data, RNG *rng)
+{
+  for (int layer_index = 0; layer_index < data->totlayer; layer_index++) {
+    CustomDataLayer *layer = &data->layers[layer_index];
+    for (int i = 0; i < SOURCE_LEN; i++) {
+      switch (layer->type) {
+        case CD_MLOOPUV: {
+          MLoopUV *uv = &((MLoopUV *)layer->data)[i];
+          uv->uv[0] = BLI_rng_get_float(rng);
+          uv->uv[1] = BLI_rng_get_float(rng);
+          uv->flag = 1 << BLI_rng_get_int(rng) % 4;
+          break;
+        }
+        case CD_MLOOPCOL: {
+          MLoopCol *col = &((MLoopCol *)layer->data)[i];
+          col->r = (unsigned char)BLI_rng_get_int(rng);
+          col->g = (unsigned char)BLI_rng_get_int(rng);
+          col->b = (unsigned char)BLI_rng_get_int(rng);
+          col->a = (unsigned char)BLI_rng_get_int(rng);
+          break;
+        }
+        case CD_SHAPEKEY:
+        case CD_NORMAL: {
+          float *co = ((float(*)[3])layer->data)[i];
+          BLI_rng_get_float_unit_v3(rng, co);
+          break;
+        }
+        default:
+          ((float *)layer->data)[i] = BLI_rng_get_float(rng);
+          break;
+      }
+    }
+  }
+}
+
+/* Compare #CustomData_interp_batch with calling #CustomData_interp for each element. Elements
+ * have no sources, a few, or more than #CustomData_interp keeps on the stack. */
+static void customdata_interp_batch_test(const bool use_weights)
+{
+  RNG *rng = BLI_rng_new(0);
+  CustomData source, dest_batch, dest_single;
+  customdata_interp_layers_add(&source, SOURCE_LEN, use_weights);
+  customdata_interp_layers_add(&dest_batch, DEST_LEN, use_weights);
+  customdata_interp_layers_add(&dest_single, DEST_LEN, use_weights);
+  customdata_interp_source_fill(&source, rng);
+
+  int src_offsets[DEST_LEN + 1];
+  src_offsets[0] = 0;
+  for (int i = 0; i < DEST_LEN; i++) {
+    const int count = (i == DEST_LEN / 2) ? 150 : BLI_rng_get_int(rng) % 7;
+    src_offsets[i + 1] = src_offsets[i] + count;
+  }
+  const int src_len = src_offsets[DEST_LEN];
+  int *src_indices = (int *)MEM_malloc_arrayN(src_len, sizeof(int), __func__);
+  float *weights = (float *)MEM_malloc_arrayN(src_len, sizeof(float), __func__);
+  for (int j = 0; j < src_len; j++) {
+    src_indices[j] = BLI_rng_get_int(rng) % SOURCE_LEN;
+    /* Some weights are negative, those don't pass on UV flags. */
+    weights[j] = BLI_rng_get_float(rng) * 1.2f - 0.2f;
+  }
+
+  const float *weights_test = use_weights ? weights : nullptr;
+  CustomData_interp_batch(
+      &source, &dest_batch, src_indices, weights_test, src_offsets, DEST_LEN - 1, 1);
+  for (int i = 0; i < DEST_LEN - 1; i++) {
+    const int src_start = src_offsets[i];
+    CustomData_interp(&source,
+                      &dest_single,
+                      &src_indices[src_start],
+                      use_weights ? &weights[src_start] : nullptr,
+                      nullptr,
+                      src_offsets[i + 1] - src_start,
+                      i + 1);
+  }
+
+  ASSERT_EQ(dest_batch.totlayer, dest_single.totlayer);
+  for (int layer_index = 0; layer_index < dest_batch.totlayer; layer_index++) {
+    const CustomDataLayer *layer_batch = &dest_batch.layers[layer_index];
+    const CustomDataLayer *layer_single = &dest_single.layers[layer_index];
+    const size_t size = (size_t)CustomData_sizeof(layer_batch->type);
+    for (int i = 0; i < DEST_LEN; i++) {
+      EXPECT_EQ(memcmp(POINTER_OFFSET(layer_batch->data, size * i),
+                       POINTER_OFFSET(layer_single->data, size * i),
+                       size),
+                0)
+          << "layer type " << layer_batch->type << ", element " << i;
+    }
+  }
+
+  MEM_freeN(src_indices);
+  MEM_freeN(weights);
+  CustomData_free(&source, SOURCE_LEN);
+  CustomData_free(&dest_batch, DEST_LEN);
+  CustomData_free(&dest_single, DEST_LEN);
+  BLI_rng_free(rng);
+}
+
+TEST(customdata, InterpBatch)
+{
+  customdata_interp_batch_test(true);
+}
+
+/* Normals need weights, they are only tested above. */
+TEST(customdata, InterpBatchNoWeights)
+{
+  customdata_interp_batch_test(false);
+}
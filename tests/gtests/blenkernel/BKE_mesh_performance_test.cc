@@ -0,0 +1,223 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+#include "testing/testing_performance.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_rotation.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "mesh_test_util.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 10
+
+static void mesh_calc_edges_validate_test(const int resolution)
+{
+  BLI_threadapi_init();
+  BKE_idtype_init();
+
+  Mesh *mesh = grid_mesh_create(resolution);
+  printf("Mesh: %d vertices, %d polygons\n", mesh->totvert, mesh->totpoly);
+
+  benchmark_foreach_num_threads([&](const int num_threads) {
+    double calc_edges_time = 0.0, validate_time = 0.0;
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      double start_time = PIL_check_seconds_timer();
+      BKE_mesh_calc_edges(mesh, false, false);
+      calc_edges_time += PIL_check_seconds_timer() - start_time;
+
+      bool changed;
+      start_time = PIL_check_seconds_timer();
+      const bool is_valid = BKE_mesh_validate_arrays(mesh,
+                                                     mesh->mvert,
+                                                     mesh->totvert,
+                                                     mesh->medge,
+                                                     mesh->totedge,
+                                                     mesh->mface,
+                                                     mesh->totface,
+                                                     mesh->mloop,
+                                                     mesh->totloop,
+                                                     mesh->mpoly,
+                                                     mesh->totpoly,
+                                                     mesh->dvert,
+                                                     false,
+                                                     false,
+                                                     &changed);
+      validate_time += PIL_check_seconds_timer() - start_time;
+      EXPECT_TRUE(is_valid);
+      EXPECT_FALSE(changed);
+    }
+    /* Every vertex has an edge to its right and its top neighbor, except on the borders. */
+    EXPECT_EQ(mesh->totedge, 2 * resolution * (resolution - 1));
+
+    benchmark_time_print(num_threads, "calc edges", calc_edges_time, NUM_RUN_AVERAGED);
+    benchmark_time_print(num_threads, "validate", validate_time, NUM_RUN_AVERAGED);
+  });
+
+  BKE_id_free(NULL, mesh);
+  BLI_threadapi_exit();
+}
+
+/* Auto smooth split normals of a grid with sharp folds, without custom normals. */
+static void mesh_calc_normals_split_test(const int resolution)
+{
+  BLI_threadapi_init();
+  BKE_idtype_init();
+
+  Mesh *mesh = grid_mesh_create(resolution);
+  for (int i = 0; i < mesh->totvert; i++) {
+    MVert *mv = &mesh->mvert[i];
+    mv->co[2] = fabsf((float)((int)mv->co[0] % 8) - 4.0f);
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].flag |= ME_SMOOTH;
+  }
+  mesh->flag |= ME_AUTOSMOOTH;
+  mesh->smoothresh = DEG2RADF(30.0f);
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+  printf("Mesh: %d vertices, %d polygons\n", mesh->totvert, mesh->totpoly);
+
+  benchmark_run_num_threads("split normals", NUM_RUN_AVERAGED, [&]() {
+    const double start_time = PIL_check_seconds_timer();
+    BKE_mesh_calc_normals_split(mesh);
+    return PIL_check_seconds_timer() - start_time;
+  });
+
+  /* All faces slope by 45 degrees and every fold is sharp, so each corner keeps the normal of its
+   * face. */
+  const float(*lnors)[3] = (const float(*)[3])CustomData_get_layer(&mesh->ldata, CD_NORMAL);
+  ASSERT_NE(lnors, nullptr);
+  int num_lnors_wrong = 0;
+  for (int i = 0; i < mesh->totloop; i++) {
+    if (fabsf(lnors[i][2] - (float)M_SQRT1_2) > 1e-5f || fabsf(lnors[i][1]) > 1e-5f) {
+      num_lnors_wrong++;
+    }
+  }
+  EXPECT_EQ(num_lnors_wrong, 0);
+
+  BKE_id_free(NULL, mesh);
+  BLI_threadapi_exit();
+}
+
+/* Corners of a level 1 subdivision, each face corner of the grid gives the 4 corners of a sub
+ * face, interpolated from all corners of the face like the legacy CCG subdivision does. Compare
+ * one #CustomData_interp call per corner with one #CustomData_interp_batch call per face. */
+static void mesh_customdata_interp_test(const int resolution)
+{
+  Mesh *mesh = grid_mesh_create(resolution);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOPUV, CD_CALLOC, NULL, mesh->totloop);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOPCOL, CD_CALLOC, NULL, mesh->totloop);
+  const int subdiv_totloop = mesh->totloop * 4;
+  CustomData subdiv_ldata;
+  CustomData_copy(&mesh->ldata, &subdiv_ldata, CD_MASK_MESH.lmask, CD_CALLOC, subdiv_totloop);
+  printf("Mesh: %d polygons, %d interpolated corners\n", mesh->totpoly, subdiv_totloop);
+
+  /* Weights of the 16 sub face corners of a quad: corner, edge midpoints and center. */
+  int src_indices[16 * 4], src_offsets[16 + 1];
+  float weights[16 * 4];
+  for (int corner = 0; corner < 4; corner++) {
+    const float corner_weights[4][4] = {{1.0f, 0.0f, 0.0f, 0.0f},
+                                        {0.5f, 0.5f, 0.0f, 0.0f},
+                                        {0.25f, 0.25f, 0.25f, 0.25f},
+                                        {0.5f, 0.0f, 0.0f, 0.5f}};
+    for (int sub = 0; sub < 4; sub++) {
+      const int i = corner * 4 + sub;
+      src_offsets[i] = i * 4;
+      for (int j = 0; j < 4; j++) {
+        src_indices[i * 4 + j] = (corner + j) % 4;
+        weights[i * 4 + j] = corner_weights[sub][j];
+      }
+    }
+  }
+  src_offsets[16] = 16 * 4;
+
+  double single_time = 0.0, batch_time = 0.0;
+  for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+    int face_indices[16 * 4];
+    double start_time = PIL_check_seconds_timer();
+    for (int i = 0; i < mesh->totpoly; i++) {
+      const int loopstart = mesh->mpoly[i].loopstart;
+      for (int j = 0; j < 16 * 4; j++) {
+        face_indices[j] = loopstart + src_indices[j];
+      }
+      for (int j = 0; j < 16; j++) {
+        CustomData_interp(&mesh->ldata,
+                          &subdiv_ldata,
+                          &face_indices[j * 4],
+                          &weights[j * 4],
+                          NULL,
+                          4,
+                          i * 16 + j);
+      }
+    }
+    single_time += PIL_check_seconds_timer() - start_time;
+
+    start_time = PIL_check_seconds_timer();
+    for (int i = 0; i < mesh->totpoly; i++) {
+      const int loopstart = mesh->mpoly[i].loopstart;
+      for (int j = 0; j < 16 * 4; j++) {
+        face_indices[j] = loopstart + src_indices[j];
+      }
+      CustomData_interp_batch(
+          &mesh->ldata, &subdiv_ldata, face_indices, weights, src_offsets, 16, i * 16);
+    }
+    batch_time += PIL_check_seconds_timer() - start_time;
+  }
+  benchmark_time_print(1, "interp per corner", single_time, NUM_RUN_AVERAGED);
+  benchmark_time_print(1, "interp batch per face", batch_time, NUM_RUN_AVERAGED);
+
+  CustomData_free(&subdiv_ldata, subdiv_totloop);
+  BKE_id_free(NULL, mesh);
+}
+
+TEST(mesh, CalcEdgesValidate1M)
+{
+  mesh_calc_edges_validate_test(1001);
+}
+
+TEST(mesh, CalcEdgesValidate4M)
+{
+  mesh_calc_edges_validate_test(2001);
+}
+
+TEST(mesh, CalcNormalsSplitAutoSmooth1M)
+{
+  mesh_calc_normals_split_test(1001);
+}
+
+TEST(mesh, CustomDataInterpCorners1M)
+{
+  BKE_idtype_init();
+  mesh_customdata_interp_test(501);
+}
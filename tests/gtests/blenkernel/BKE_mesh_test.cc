@@ -0,0 +1,325 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_edgehash.h"
+#include "BLI_math_base.h"
+#include "BLI_math_rotation.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "mesh_test_util.h"
+
+/* Expected result of BKE_mesh_calc_edges(): edges in the order they are inserted in an EdgeHash,
+ * iterating over polys' corners. */
+static void calc_edges_expected(const Mesh *mesh, EdgeHash *eh)
+{
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mesh->mpoly[i];
+    const MLoop *ml = &mesh->mloop[mp->loopstart];
+    unsigned int v_prev = ml[mp->totloop - 1].v;
+    for (int j = 0; j < mp->totloop; j++) {
+      if (v_prev != ml[j].v) {
+        void **val_p;
+        if (!BLI_edgehash_ensure_p(eh, v_prev, ml[j].v, &val_p)) {
+          *val_p = POINTER_FROM_UINT(BLI_edgehash_len(eh) - 1);
+        }
+      }
+      v_prev = ml[j].v;
+    }
+  }
+}
+
+static void calc_edges_test(Mesh *mesh)
+{
+  EdgeHash *eh = BLI_edgehash_new(__func__);
+  calc_edges_expected(mesh, eh);
+
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  ASSERT_EQ(mesh->totedge, (int)BLI_edgehash_len(eh));
+  EdgeHashIterator *ehi;
+  int i;
+  for (ehi = BLI_edgehashIterator_new(eh), i = 0; !BLI_edgehashIterator_isDone(ehi);
+       BLI_edgehashIterator_step(ehi), i++) {
+    unsigned int v1, v2;
+    BLI_edgehashIterator_getKey(ehi, &v1, &v2);
+    EXPECT_EQ(mesh->medge[i].v1, v1);
+    EXPECT_EQ(mesh->medge[i].v2, v2);
+    EXPECT_EQ(mesh->medge[i].flag, ME_EDGEDRAW | ME_EDGERENDER);
+  }
+  BLI_edgehashIterator_free(ehi);
+
+  for (i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mesh->mpoly[i];
+    for (int j = 0; j < mp->totloop; j++) {
+      const MLoop *ml = &mesh->mloop[mp->loopstart + j];
+      const MLoop *ml_next = &mesh->mloop[mp->loopstart + (j + 1) % mp->totloop];
+      if (ml->v == ml_next->v) {
+        EXPECT_EQ(ml->e, 0u);
+      }
+      else {
+        EXPECT_EQ(ml->e, POINTER_AS_UINT(BLI_edgehash_lookup(eh, ml->v, ml_next->v)));
+      }
+    }
+  }
+
+  BLI_edgehash_free(eh, NULL);
+}
+
+static bool validate_arrays(Mesh *mesh, const bool do_fixes, bool *r_changed)
+{
+  return BKE_mesh_validate_arrays(mesh,
+                                  mesh->mvert,
+                                  mesh->totvert,
+                                  mesh->medge,
+                                  mesh->totedge,
+                                  mesh->mface,
+                                  mesh->totface,
+                                  mesh->mloop,
+                                  mesh->totloop,
+                                  mesh->mpoly,
+                                  mesh->totpoly,
+                                  mesh->dvert,
+                                  false,
+                                  do_fixes,
+                                  r_changed);
+}
+
+/* Grid with some height, sharp edges and flat polys, so that it has smooth fans of all kinds. */
+static Mesh *normals_grid_mesh_create(const int resolution)
+{
+  Mesh *mesh = grid_mesh_create(resolution);
+  BKE_mesh_calc_edges(mesh, false, false);
+  for (int i = 0; i < mesh->totvert; i++) {
+    float *co = mesh->mvert[i].co;
+    co[2] = sinf(co[0] * 0.7f) * cosf(co[1] * 1.3f);
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    if (i % 13 != 0) {
+      mesh->mpoly[i].flag |= ME_SMOOTH;
+    }
+  }
+  for (int i = 0; i < mesh->totedge; i += 11) {
+    mesh->medge[i].flag |= ME_SHARP;
+  }
+  return mesh;
+}
+
+static void normals_loop_split(Mesh *mesh,
+                               const float (*polynors)[3],
+                               const float split_angle,
+                               MLoopNorSpaceArray *r_lnors_spacearr,
+                               float (*r_loopnors)[3])
+{
+  BKE_mesh_normals_loop_split(mesh->mvert,
+                              mesh->totvert,
+                              mesh->medge,
+                              mesh->totedge,
+                              mesh->mloop,
+                              r_loopnors,
+                              mesh->totloop,
+                              mesh->mpoly,
+                              polynors,
+                              mesh->totpoly,
+                              true,
+                              split_angle,
+                              r_lnors_spacearr,
+                              NULL,
+                              NULL);
+}
+
+/* Split normals are computed by a parallel generator when no lnor spaces are requested, compare
+ * them with the serial generator used for lnor spaces. */
+static void normals_loop_split_test(Mesh *mesh, const float split_angle)
+{
+  float(*polynors)[3] = (float(*)[3])MEM_malloc_arrayN(
+      (size_t)mesh->totpoly, sizeof(*polynors), __func__);
+  BKE_mesh_calc_normals_poly(mesh->mvert,
+                             NULL,
+                             mesh->totvert,
+                             mesh->mloop,
+                             mesh->mpoly,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             polynors,
+                             false);
+
+  float(*loopnors_parallel)[3] = (float(*)[3])MEM_malloc_arrayN(
+      (size_t)mesh->totloop, sizeof(*loopnors_parallel), __func__);
+  float(*loopnors_serial)[3] = (float(*)[3])MEM_malloc_arrayN(
+      (size_t)mesh->totloop, sizeof(*loopnors_serial), __func__);
+
+  normals_loop_split(mesh, polynors, split_angle, NULL, loopnors_parallel);
+  MLoopNorSpaceArray lnors_spacearr = {NULL};
+  normals_loop_split(mesh, polynors, split_angle, &lnors_spacearr, loopnors_serial);
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+
+  for (int i = 0; i < mesh->totloop; i++) {
+    EXPECT_EQ(loopnors_parallel[i][0], loopnors_serial[i][0]);
+    EXPECT_EQ(loopnors_parallel[i][1], loopnors_serial[i][1]);
+    EXPECT_EQ(loopnors_parallel[i][2], loopnors_serial[i][2]);
+  }
+
+  MEM_freeN(polynors);
+  MEM_freeN(loopnors_parallel);
+  MEM_freeN(loopnors_serial);
+}
+
+class MeshTest : public testing::Test {
+ protected:
+  virtual void SetUp()
+  {
+    BLI_threadapi_init();
+    BKE_idtype_init();
+  }
+
+  virtual void TearDown()
+  {
+    BLI_threadapi_exit();
+  }
+};
+
+TEST_F(MeshTest, CalcEdgesGrid)
+{
+  /* Large enough to run in parallel. */
+  Mesh *mesh = grid_mesh_create(100);
+  calc_edges_test(mesh);
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(MeshTest, CalcEdgesDegenerate)
+{
+  Mesh *mesh = grid_mesh_create(10);
+  /* Poly using the same vertex twice in a row, this corner has no edge. */
+  MLoop *ml = &mesh->mloop[mesh->mpoly[3].loopstart];
+  ml[1].v = ml[0].v;
+  calc_edges_test(mesh);
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(MeshTest, ValidateValid)
+{
+  Mesh *mesh = grid_mesh_create(100);
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  bool changed = true;
+  EXPECT_TRUE(validate_arrays(mesh, true, &changed));
+  EXPECT_FALSE(changed);
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(MeshTest, ValidateDuplicateEdge)
+{
+  Mesh *mesh = grid_mesh_create(10);
+  BKE_mesh_calc_edges(mesh, false, false);
+  const int totedge = mesh->totedge;
+  mesh->medge[1] = mesh->medge[0];
+
+  bool changed = false;
+  EXPECT_FALSE(validate_arrays(mesh, false, &changed));
+  EXPECT_FALSE(changed);
+
+  EXPECT_FALSE(validate_arrays(mesh, true, &changed));
+  EXPECT_TRUE(changed);
+  /* The duplicate was removed, and the missing edge recreated. */
+  EXPECT_EQ(mesh->totedge, totedge);
+  EXPECT_TRUE(validate_arrays(mesh, false, &changed));
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(MeshTest, ValidateDuplicatePoly)
+{
+  Mesh *mesh = grid_mesh_create(10);
+  BKE_mesh_calc_edges(mesh, false, false);
+  /* Same vertices as poly 0, starting from another corner. */
+  MLoop *ml_src = &mesh->mloop[mesh->mpoly[0].loopstart];
+  MLoop *ml_dst = &mesh->mloop[mesh->mpoly[1].loopstart];
+  for (int j = 0; j < 4; j++) {
+    ml_dst[j] = ml_src[(j + 1) % 4];
+  }
+
+  bool changed = false;
+  EXPECT_FALSE(validate_arrays(mesh, false, &changed));
+
+  EXPECT_FALSE(validate_arrays(mesh, true, &changed));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(mesh->totpoly, 9 * 9 - 1);
+  EXPECT_TRUE(validate_arrays(mesh, false, &changed));
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(MeshTest, ValidateSharedLoops)
+{
+  Mesh *mesh = grid_mesh_create(10);
+  BKE_mesh_calc_edges(mesh, false, false);
+  /* Poly 1 uses the loops of poly 0, its own loops are unused. */
+  mesh->mpoly[1].loopstart = mesh->mpoly[0].loopstart;
+
+  bool changed = false;
+  EXPECT_FALSE(validate_arrays(mesh, false, &changed));
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(MeshTest, ValidateInvalidCoordinate)
+{
+  Mesh *mesh = grid_mesh_create(10);
+  BKE_mesh_calc_edges(mesh, false, false);
+  mesh->mvert[5].co[2] = NAN;
+
+  bool changed = false;
+  EXPECT_FALSE(validate_arrays(mesh, true, &changed));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(mesh->mvert[5].co[2], 0.0f);
+  BKE_id_free(NULL, mesh);
+}
+
+TEST_F(MeshTest, NormalsLoopSplitGrid)
+{
+  /* Large enough to run in parallel. */
+  Mesh *mesh = normals_grid_mesh_create(100);
+  normals_loop_split_test(mesh, DEG2RADF(30.0f));
+  normals_loop_split_test(mesh, (float)M_PI);
+  BKE_id_free(NULL, mesh);
+}
+
+/* Corners using the edges of other corners of their poly make the parallel generator walk a
+ * fan cycle which doesn't contain its first loop, it falls back to the serial generator. */
+TEST_F(MeshTest, NormalsLoopSplitDegenerate)
+{
+  Mesh *mesh = normals_grid_mesh_create(8);
+  MLoop *ml = &mesh->mloop[mesh->mpoly[41].loopstart];
+  const unsigned int e = ml[1].e;
+  ml[1].e = ml[2].e;
+  ml[2].e = ml[3].e;
+  ml[3].e = e;
+  normals_loop_split_test(mesh, (float)M_PI);
+  normals_loop_split_test(mesh, DEG2RADF(30.0f));
+  BKE_id_free(NULL, mesh);
+}
@@ -0,0 +1,71 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#ifndef __MESH_TEST_UTIL_H__
+#define __MESH_TEST_UTIL_H__
+
+/* Meshes shared by the mesh tests and benchmarks. */
+
+#include <climits>
+#include <cstdint>
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_mesh.h"
+
+/* Grid of quads in the XY plane without edges, with one unit between vertices. Vertex indices are
+ * scattered and polys are reversed, like scanned or imported meshes, so that edges are not
+ * created in any trivial order. */
+inline Mesh *grid_mesh_create(const int resolution)
+{
+  const int num_polys = (resolution - 1) * (resolution - 1);
+  const int num_verts = resolution * resolution;
+  Mesh *mesh = BKE_mesh_new_nomain(num_verts, 0, 0, num_polys * 4, num_polys);
+
+  /* 7919 is prime and does not divide the number of vertices, so this is a permutation. */
+  auto vert_index = [&](const int x, const int y) {
+    return (unsigned int)(((int64_t)(y * resolution + x) * 7919) % num_verts);
+  };
+
+  for (int y = 0; y < resolution; y++) {
+    for (int x = 0; x < resolution; x++) {
+      MVert *mv = &mesh->mvert[vert_index(x, y)];
+      mv->co[0] = (float)x;
+      mv->co[1] = (float)y;
+      mv->no[2] = SHRT_MAX;
+    }
+  }
+  for (int y = 0; y < resolution - 1; y++) {
+    for (int x = 0; x < resolution - 1; x++) {
+      const int poly_index = num_polys - 1 - (y * (resolution - 1) + x);
+      MPoly *mp = &mesh->mpoly[poly_index];
+      MLoop *ml = &mesh->mloop[poly_index * 4];
+      mp->loopstart = poly_index * 4;
+      mp->totloop = 4;
+      ml[0].v = vert_index(x, y);
+      ml[1].v = vert_index(x + 1, y);
+      ml[2].v = vert_index(x + 1, y + 1);
+      ml[3].v = vert_index(x, y + 1);
+    }
+  }
+  return mesh;
+}
+
+#endif /* __MESH_TEST_UTIL_H__ */
@@ -102,6 +102,8 @@ TEST_PARSE_FAIL(BadArgCount2, "sqrt(1,2)")
 TEST_PARSE_FAIL(BadArgCount3, "pi()")
 TEST_PARSE_FAIL(BadArgCount4, "max()")
 TEST_PARSE_FAIL(BadArgCount5, "min()")
+TEST_PARSE_FAIL(BadArgCount6, "clamp(1,2)")
+TEST_PARSE_FAIL(BadArgCount7, "lerp(1,2)")
 
 TEST_PARSE_FAIL(Truncated1, "(1+2")
 TEST_PARSE_FAIL(Truncated2, "1 if 2")
@@ -113,6 +115,9 @@ TEST_PARSE_FAIL(Truncated7, "1 and")
 TEST_PARSE_FAIL(Truncated8, "1 or")
 TEST_PARSE_FAIL(Truncated9, "sqrt(1")
 TEST_PARSE_FAIL(Truncated10, "fmod(1,")
+TEST_PARSE_FAIL(Truncated11, "2 **")
+TEST_PARSE_FAIL(Truncated12, "2 //")
+TEST_PARSE_FAIL(Truncated13, "2 %")
 
 /* Constant expression with working constant folding */
 #define TEST_CONST(name, str, value) \
@@ -147,6 +152,8 @@ TEST_CONST(Half, ".5", 0.5)
 TEST_CONST(Pi, "pi", M_PI)
 TEST_CONST(True, "True", TRUE_VAL)
 TEST_CONST(False, "False", FALSE_VAL)
+TEST_CONST(Tau, "tau", 2.0 * M_PI)
+TEST_CONST(E, "e", M_E)
 
 TEST_CONST(Sqrt, "sqrt(4)", 2.0)
 TEST_EVAL(Sqrt, "sqrt(x)", 4.0, 2.0)
@@ -157,6 +164,27 @@ TEST_EVAL(FMod, "fmod(x, 2)", 3.5, 1.5)
 TEST_CONST(Pow, "pow(4, 0.5)", 2.0)
 TEST_EVAL(Pow, "pow(4, x)", 0.5, 2.0)
 
+TEST_CONST(Hypot, "hypot(3, 4)", 5.0)
+TEST_EVAL(Hypot, "hypot(x, 4)", 3.0, 5.0)
+
+TEST_CONST(Log2, "log2(8)", 3.0)
+TEST_CONST(Log10, "log10(1000)", 3.0)
+TEST_CONST(CopySign, "copysign(2, -0.5)", -2.0)
+
+TEST_CONST(Clamp1, "clamp(-0.5)", 0.0)
+TEST_CONST(Clamp2, "clamp(1.5)", 1.0)
+TEST_EVAL(Clamp1, "clamp(x)", 0.5, 0.5)
+TEST_CONST(Clamp3, "clamp(3, 1, 2)", 2.0)
+TEST_EVAL(Clamp3, "clamp(x, 1, 2)", 0.5, 1.0)
+
+TEST_CONST(Lerp, "lerp(2, 4, 0.25)", 2.5)
+TEST_EVAL(Lerp, "lerp(2, 4, x)", 1.0, 4.0)
+
+TEST_CONST(SmoothStep1, "smoothstep(1, 3, 0)", 0.0)
+TEST_CONST(SmoothStep2, "smoothstep(1, 3, 2)", 0.5)
+TEST_CONST(SmoothStep3, "smoothstep(1, 3, 4)", 1.0)
+TEST_EVAL(SmoothStep1, "smoothstep(0, 1, x)", 0.25, 0.15625)
+
 TEST_RESULT(Min1, "min(3,1,2)", 1.0)
 TEST_RESULT(Max1, "max(3,1,2)", 3.0)
 TEST_RESULT(Min2, "min(1,2,3)", 1.0)
@@ -181,10 +209,29 @@ TEST_EVAL(BinaryMul, "x*3", 2, 6.0)
 TEST_CONST(BinaryDiv, "3/2", 1.5)
 TEST_EVAL(BinaryDiv, "3/x", 2, 1.5)
 
+TEST_CONST(BinaryFloorDiv1, "7//2", 3.0)
+TEST_CONST(BinaryFloorDiv2, "-7//2", -4.0)
+TEST_CONST(BinaryFloorDiv3, "7.5//-2", -4.0)
+TEST_EVAL(BinaryFloorDiv, "x//2", -7, -4.0)
+
+TEST_CONST(BinaryMod1, "7%3", 1.0)
+TEST_CONST(BinaryMod2, "-7%3", 2.0)
+TEST_CONST(BinaryMod3, "7%-3", -2.0)
+TEST_CONST(BinaryMod4, "5.5%2", 1.5)
+TEST_EVAL(BinaryMod, "x%3", -7, 2.0)
+
+TEST_CONST(BinaryPow1, "2**3", 8.0)
+TEST_CONST(BinaryPow2, "2**-1", 0.5)
+TEST_CONST(BinaryPow3, "-2**2", -4.0)
+TEST_CONST(BinaryPow4, "2**3**2", 512.0)
+TEST_CONST(BinaryPow5, "(-2)**2", 4.0)
+TEST_EVAL(BinaryPow, "x**2", 3, 9.0)
+
 TEST_CONST(Arith1, "1 + -2 * 3", -5.0)
 TEST_CONST(Arith2, "(1 + -2) * 3", -3.0)
 TEST_CONST(Arith3, "-1 + 2 * 3", 5.0)
 TEST_CONST(Arith4, "3 * (-2 + 1)", -3.0)
+TEST_CONST(Arith5, "1 + 2 * 3 ** 2 % 4", 3.0)
 
 TEST_EVAL(Arith1, "1 + -x * 3", 2, -5.0)
 
@@ -313,6 +360,7 @@ TEST_ERROR(SqrtDomain3, "sqrt(x)", 0.0, EXPR_PYLIKE_SUCCESS)
 TEST_ERROR(PowDomain1, "pow(-1, 0.5)", 0.0, EXPR_PYLIKE_MATH_ERROR)
 TEST_ERROR(PowDomain2, "pow(-1, x)", 0.5, EXPR_PYLIKE_MATH_ERROR)
 TEST_ERROR(PowDomain3, "pow(-1, x)", 2.0, EXPR_PYLIKE_SUCCESS)
+TEST_ERROR(PowDomain4, "x ** 0.5", -1.0, EXPR_PYLIKE_MATH_ERROR)
 
 TEST_ERROR(Mixed1, "sqrt(x) + 1 / max(0, x)", -1.0, EXPR_PYLIKE_MATH_ERROR)
 TEST_ERROR(Mixed2, "sqrt(x) + 1 / max(0, x)", 0.0, EXPR_PYLIKE_DIV_BY_ZERO)
@@ -0,0 +1,140 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "testing/testing_performance.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_kdtree.h"
+#include "BLI_math_base.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+}
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+/* Large enough for the parallel duplicate search. */
+#define GRID_RES 24
+#define CLUSTER_NUM 3
+/* More than the candidates stored per search by the parallel duplicate search. */
+#define CLUSTER_LEN 40
+
+#define GRID_POINTS_NUM (GRID_RES * GRID_RES * GRID_RES)
+#define POINTS_NUM (GRID_POINTS_NUM + CLUSTER_NUM * CLUSTER_LEN)
+#define DUPLICATES_RANGE 1.05f
+
+/* A jittered grid with a spacing close to the range, so most points have a few neighbors in
+ * range, followed by clusters where all points are in range of each other. */
+static KDTree_3d *kdtree_duplicates_tree_create()
+{
+  RNG *rng = BLI_rng_new(0);
+  KDTree_3d *tree = BLI_kdtree_3d_new(POINTS_NUM);
+  int index = 0;
+  for (int z = 0; z < GRID_RES; z++) {
+    for (int y = 0; y < GRID_RES; y++) {
+      for (int x = 0; x < GRID_RES; x++) {
+        float co[3] = {(float)x, (float)y, (float)z};
+        for (int j = 0; j < 3; j++) {
+          co[j] += (BLI_rng_get_float(rng) - 0.5f) * 0.2f;
+        }
+        BLI_kdtree_3d_insert(tree, index++, co);
+      }
+    }
+  }
+  for (int i = 0; i < CLUSTER_NUM; i++) {
+    for (int k = 0; k < CLUSTER_LEN; k++) {
+      float co[3] = {(float)(GRID_RES + 10 * (i + 1)), 0.0f, 0.0f};
+      for (int j = 0; j < 3; j++) {
+        co[j] += BLI_rng_get_float(rng) * 0.01f;
+      }
+      BLI_kdtree_3d_insert(tree, index++, co);
+    }
+  }
+  BLI_kdtree_3d_balance(tree);
+  BLI_rng_free(rng);
+  return tree;
+}
+
+/* Some grid points are kept or already merged by the caller. */
+static void kdtree_duplicates_init(int *duplicates)
+{
+  for (int i = 0; i < POINTS_NUM; i++) {
+    duplicates[i] = -1;
+  }
+  for (int i = 0; i < GRID_POINTS_NUM; i++) {
+    if (i % 97 == 0) {
+      duplicates[i] = i;
+    }
+    else if (i % 89 == 0) {
+      duplicates[i] = 0;
+    }
+  }
+}
+
+/* Balance the tree and find duplicates with the given number of threads. */
+static int kdtree_duplicates_calc(const int num_threads,
+                                  const bool use_index_order,
+                                  int *duplicates)
+{
+  benchmark_task_scheduler_threads_set(num_threads);
+  KDTree_3d *tree = kdtree_duplicates_tree_create();
+  kdtree_duplicates_init(duplicates);
+  const int found = BLI_kdtree_3d_calc_duplicates_fast(
+      tree, DUPLICATES_RANGE, use_index_order, duplicates);
+  BLI_kdtree_3d_free(tree);
+  benchmark_task_scheduler_threads_set(0);
+  return found;
+}
+
+/* Compare the parallel balance and duplicate search with the serial ones, which are used for one
+ * thread. Without the index order, the result depends on the layout of the balanced tree. */
+static void kdtree_duplicates_test(const bool use_index_order)
+{
+  int *duplicates_serial = (int *)MEM_malloc_arrayN(POINTS_NUM, sizeof(int), __func__);
+  int *duplicates_parallel = (int *)MEM_malloc_arrayN(POINTS_NUM, sizeof(int), __func__);
+  const int found_serial = kdtree_duplicates_calc(1, use_index_order, duplicates_serial);
+  const int found_parallel = kdtree_duplicates_calc(4, use_index_order, duplicates_parallel);
+
+  EXPECT_EQ(found_serial, found_parallel);
+  for (int i = 0; i < POINTS_NUM; i++) {
+    EXPECT_EQ(duplicates_serial[i], duplicates_parallel[i]);
+  }
+
+  /* Each cluster is merged into a single point. */
+  int *targets_len = (int *)MEM_calloc_arrayN(POINTS_NUM, sizeof(int), __func__);
+  for (int i = 0; i < POINTS_NUM; i++) {
+    const int target = duplicates_serial[i];
+    if (!ELEM(target, -1, i)) {
+      targets_len[target] += 1;
+    }
+  }
+  for (int i = 0; i < CLUSTER_NUM; i++) {
+    int targets_len_max = 0;
+    for (int k = 0; k < CLUSTER_LEN; k++) {
+      targets_len_max = max_ii(targets_len_max,
+                               targets_len[GRID_POINTS_NUM + i * CLUSTER_LEN + k]);
+    }
+    EXPECT_EQ(targets_len_max, CLUSTER_LEN - 1);
+  }
+  /* The grid has merges too. */
+  EXPECT_GT(found_serial, CLUSTER_NUM * (CLUSTER_LEN - 1) + POINTS_NUM / 20);
+
+  MEM_freeN(targets_len);
+  MEM_freeN(duplicates_serial);
+  MEM_freeN(duplicates_parallel);
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+TEST(kdtree, CalcDuplicatesFast)
+{
+  kdtree_duplicates_test(false);
+}
+
+TEST(kdtree, CalcDuplicatesFastIndexOrder)
+{
+  kdtree_duplicates_test(true);
+}
@@ -1,8 +1,26 @@
 #include "testing/testing.h"
+#include "testing/testing_performance.h"
 
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
 #include "bmesh.h"
+#include "bmesh_test_util.h"
+
+#include "blenkernel/mesh_test_util.h"
 
 TEST(bmesh_core, BMVertCreate)
 {
@@ -38,3 +56,369 @@ TEST(bmesh_core, BMVertCreate)
   EXPECT_EQ(BM_mesh_elem_count(bm, BM_VERT), 3);
   BM_mesh_free(bm);
 }
+
+TEST(bmesh_core, BMPartialUpdate)
+{
+  BMesh *bm;
+  const int grid_len = 5;
+  BMVert *verts[grid_len * grid_len], *verts_ngon[6];
+
+  BMeshCreateParams bm_params;
+  bm_params.use_toolflags = false;
+  bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+
+  /* A bumpy grid of quads, and a separate hexagon to test ngon tessellation. */
+  for (int y = 0; y < grid_len; y++) {
+    for (int x = 0; x < grid_len; x++) {
+      const float co[3] = {(float)x, (float)y, (float)((x * 7 + y * 3) % 5) * 0.1f};
+      verts[y * grid_len + x] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+    }
+  }
+  for (int y = 0; y < grid_len - 1; y++) {
+    for (int x = 0; x < grid_len - 1; x++) {
+      BMVert *quad[4] = {
+          verts[y * grid_len + x],
+          verts[y * grid_len + x + 1],
+          verts[(y + 1) * grid_len + x + 1],
+          verts[(y + 1) * grid_len + x],
+      };
+      BM_face_create_verts(bm, quad, 4, NULL, BM_CREATE_NOP, true);
+    }
+  }
+  for (int i = 0; i < 6; i++) {
+    const float angle = (float)i * (float)(M_PI / 3.0);
+    const float co[3] = {cosf(angle) + 10.0f, sinf(angle), 0.0f};
+    verts_ngon[i] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+  }
+  BM_face_create_verts(bm, verts_ngon, 6, NULL, BM_CREATE_NOP, true);
+
+  const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
+  BMLoop *(*looptris)[3] = (BMLoop * (*)[3]) MEM_mallocN(sizeof(*looptris) * looptris_tot,
+                                                          __func__);
+  BMLoop *(*looptris_full)[3] = (BMLoop * (*)[3]) MEM_mallocN(sizeof(*looptris) * looptris_tot,
+                                                               __func__);
+  int tottri;
+  BM_mesh_normals_update(bm);
+  BM_mesh_calc_tessellation(bm, looptris, &tottri);
+  EXPECT_EQ(tottri, looptris_tot);
+
+  /* Move a few vertices, then update only the affected elements. */
+  BMVert *verts_move[2] = {verts[2 * grid_len + 2], verts_ngon[0]};
+  BM_mesh_elem_index_ensure(bm, BM_VERT);
+  BLI_bitmap *verts_mask = BLI_BITMAP_NEW(bm->totvert, __func__);
+  for (int i = 0; i < 2; i++) {
+    verts_move[i]->co[2] += 0.75f;
+    BLI_BITMAP_ENABLE(verts_mask, BM_elem_index_get(verts_move[i]));
+  }
+
+  BMPartialUpdate_Params params;
+  params.do_normals = true;
+  params.do_tessellate = true;
+  BMPartialUpdate *bmpinfo = BM_mesh_partial_create_from_verts(bm, &params, verts_mask, 2);
+  /* Four quads around the grid vertex and the hexagon. */
+  EXPECT_EQ(bmpinfo->faces_len, 5);
+  /* The 3x3 vertices around the grid vertex and all vertices of the hexagon. */
+  EXPECT_EQ(bmpinfo->verts_len, 9 + 6);
+
+  BM_mesh_normals_update_with_partial(bm, bmpinfo);
+  BM_mesh_calc_tessellation_with_partial(bm, looptris, bmpinfo);
+  BM_mesh_partial_destroy(bmpinfo);
+  MEM_freeN(verts_mask);
+
+  /* Store the partially updated normals, then compare with a full update. */
+  float(*vnos)[3] = (float(*)[3])MEM_mallocN(sizeof(*vnos) * bm->totvert, __func__);
+  float(*fnos)[3] = (float(*)[3])MEM_mallocN(sizeof(*fnos) * bm->totface, __func__);
+  BMIter iter;
+  BMVert *v;
+  BMFace *f;
+  int i;
+  BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+    copy_v3_v3(vnos[i], v->no);
+  }
+  BM_ITER_MESH_INDEX (f, &iter, bm, BM_FACES_OF_MESH, i) {
+    copy_v3_v3(fnos[i], f->no);
+  }
+
+  BM_mesh_normals_update(bm);
+  BM_mesh_calc_tessellation(bm, looptris_full, &tottri);
+
+  BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+    EXPECT_V3_NEAR(vnos[i], v->no, 1e-6f);
+  }
+  BM_ITER_MESH_INDEX (f, &iter, bm, BM_FACES_OF_MESH, i) {
+    EXPECT_V3_NEAR(fnos[i], f->no, 1e-6f);
+  }
+  for (i = 0; i < tottri; i++) {
+    EXPECT_EQ(looptris[i][0], looptris_full[i][0]);
+    EXPECT_EQ(looptris[i][1], looptris_full[i][1]);
+    EXPECT_EQ(looptris[i][2], looptris_full[i][2]);
+  }
+
+  MEM_freeN(vnos);
+  MEM_freeN(fnos);
+  MEM_freeN(looptris);
+  MEM_freeN(looptris_full);
+  BM_mesh_free(bm);
+}
+
+TEST(bmesh_core, WeldVertsFaceCorners)
+{
+  BMesh *bm;
+  BMVert *verts_hex[6], *verts_quad[2];
+
+  BMeshCreateParams bm_params;
+  bm_params.use_toolflags = true;
+  bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+
+  /* A hexagon and a quad sharing an edge with it. */
+  for (int i = 0; i < 6; i++) {
+    const float angle = (float)i * (float)(M_PI / 3.0);
+    const float co[3] = {cosf(angle), sinf(angle), 0.0f};
+    verts_hex[i] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+  }
+  for (int i = 0; i < 2; i++) {
+    float co[3];
+    mul_v3_v3fl(co, verts_hex[2 - i]->co, 2.0f);
+    verts_quad[i] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+  }
+  BM_face_create_verts(bm, verts_hex, 6, NULL, BM_CREATE_NOP, true);
+  BMVert *quad[4] = {verts_hex[2], verts_hex[1], verts_quad[1], verts_quad[0]};
+  BM_face_create_verts(bm, quad, 4, NULL, BM_CREATE_NOP, true);
+  EXPECT_EQ(bm->totvert, 8);
+  EXPECT_EQ(bm->totedge, 9);
+  EXPECT_EQ(bm->totface, 2);
+
+  /* Weld a hexagon corner to the opposite corner, which splits the hexagon into two triangles,
+   * and a quad corner to the next corner, which collapses an edge of the quad. */
+  BMOperator op;
+  BMO_op_init(bm, &op, BMO_FLAG_DEFAULTS, "weld_verts");
+  BMOpSlot *slot_targetmap = BMO_slot_get(op.slots_in, "targetmap");
+  BMO_slot_map_elem_insert(&op, slot_targetmap, verts_hex[0], verts_hex[3]);
+  BMO_slot_map_elem_insert(&op, slot_targetmap, verts_quad[1], verts_quad[0]);
+  BMO_op_exec(bm, &op);
+  BMO_op_finish(bm, &op);
+
+  EXPECT_EQ(bm->totvert, 6);
+  EXPECT_EQ(bm->totedge, 8);
+  EXPECT_EQ(bm->totface, 3);
+  BMVert *tri_a[3] = {verts_hex[3], verts_hex[1], verts_hex[2]};
+  BMVert *tri_b[3] = {verts_hex[3], verts_hex[4], verts_hex[5]};
+  BMVert *tri_c[3] = {verts_hex[2], verts_hex[1], verts_quad[0]};
+  EXPECT_NE(BM_face_exists(tri_a, 3), nullptr);
+  EXPECT_NE(BM_face_exists(tri_b, 3), nullptr);
+  EXPECT_NE(BM_face_exists(tri_c, 3), nullptr);
+  EXPECT_NE(BM_edge_exists(verts_hex[1], verts_hex[3]), nullptr);
+  EXPECT_NE(BM_edge_exists(verts_hex[3], verts_hex[5]), nullptr);
+  EXPECT_NE(BM_edge_exists(verts_hex[1], verts_quad[0]), nullptr);
+
+  /* Loops use the edge to the next loop. */
+  BMIter iter;
+  BMFace *f;
+  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+    BMLoop *l_iter, *l_first;
+    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+    do {
+      EXPECT_TRUE(BM_vert_in_edge(l_iter->e, l_iter->v));
+      EXPECT_TRUE(BM_vert_in_edge(l_iter->e, l_iter->next->v));
+    } while ((l_iter = l_iter->next) != l_first);
+  }
+  BM_mesh_free(bm);
+}
+
+static float bevel_wave_height(const float x, const float y)
+{
+  return 0.05f * sinf(x * 8.0f) * cosf(y * 8.0f);
+}
+
+/* Bevel all edges of a grid with more vertices than the bevel calculates in parallel. */
+static BMesh *bevel_grid_create(const int num_threads)
+{
+  const int resolution = 24;
+  benchmark_task_scheduler_threads_set(num_threads);
+  BMeshCreateParams bm_params = {0};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+  bm_grid_create(bm, resolution, bevel_wave_height, 0);
+  BM_mesh_normals_update(bm);
+  BM_mesh_elem_hflag_enable_all(bm, BM_VERT | BM_EDGE, BM_ELEM_TAG, false);
+  bm_mesh_bevel_edges(bm, 0.2f / (resolution - 1), 3);
+  benchmark_task_scheduler_threads_set(0);
+  return bm;
+}
+
+/* The threaded calculation of vertex boundaries and meshes gives the same result as the serial
+ * one, including the order in which elements are created. */
+TEST(bmesh_core, BevelThreaded)
+{
+  BLI_threadapi_init();
+  BMesh *bm_serial = bevel_grid_create(1);
+  BMesh *bm_parallel = bevel_grid_create(4);
+
+  EXPECT_GT(bm_serial->totface, 23 * 23 * 2);
+  EXPECT_EQ(bm_serial->totvert, bm_parallel->totvert);
+  EXPECT_EQ(bm_serial->totedge, bm_parallel->totedge);
+  EXPECT_EQ(bm_serial->totface, bm_parallel->totface);
+  EXPECT_EQ(bm_serial->totloop, bm_parallel->totloop);
+  if (bm_serial->totvert == bm_parallel->totvert) {
+    BMIter iter_serial, iter_parallel;
+    BMVert *v_serial = (BMVert *)BM_iter_new(&iter_serial, bm_serial, BM_VERTS_OF_MESH, NULL);
+    BMVert *v_parallel = (BMVert *)BM_iter_new(
+        &iter_parallel, bm_parallel, BM_VERTS_OF_MESH, NULL);
+    for (; v_serial; v_serial = (BMVert *)BM_iter_step(&iter_serial),
+                     v_parallel = (BMVert *)BM_iter_step(&iter_parallel)) {
+      EXPECT_EQ(v_serial->co[0], v_parallel->co[0]);
+      EXPECT_EQ(v_serial->co[1], v_parallel->co[1]);
+      EXPECT_EQ(v_serial->co[2], v_parallel->co[2]);
+    }
+  }
+
+  BM_mesh_free(bm_serial);
+  BM_mesh_free(bm_parallel);
+  BLI_threadapi_exit();
+}
+
+/* A grid with polys in reverse loop order, and data in all element types. Deform weights are
+ * copied by their type's callback, other layers with a plain copy. */
+static Mesh *convert_mesh_create()
+{
+  Mesh *mesh = grid_mesh_create(48);
+  BKE_mesh_calc_edges(mesh, false, false);
+  /* Store the loops of the polys in the opposite order, so loops are not consecutive between
+   * polys and the custom-data of loops is copied in many runs. */
+  MLoop *mloop_orig = (MLoop *)MEM_dupallocN(mesh->mloop);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    MPoly *mp = &mesh->mpoly[i];
+    const int loopstart = mesh->totloop - mp->loopstart - mp->totloop;
+    memcpy(&mesh->mloop[loopstart], &mloop_orig[mp->loopstart], sizeof(MLoop) * mp->totloop);
+    mp->loopstart = loopstart;
+  }
+  MEM_freeN(mloop_orig);
+  mesh->cd_flag |= ME_CDFLAG_VERT_BWEIGHT | ME_CDFLAG_EDGE_CREASE;
+
+  MDeformVert *dvert = (MDeformVert *)CustomData_add_layer(
+      &mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, mesh->totvert);
+  float *vert_float = (float *)CustomData_add_layer(
+      &mesh->vdata, CD_PROP_FLT, CD_CALLOC, nullptr, mesh->totvert);
+  for (int i = 0; i < mesh->totvert; i++) {
+    mesh->mvert[i].bweight = (char)(i % 251);
+    BKE_defvert_add_index_notest(&dvert[i], i % 3, (float)i / mesh->totvert);
+    vert_float[i] = (float)i * 0.5f;
+  }
+  for (int i = 0; i < mesh->totedge; i++) {
+    mesh->medge[i].crease = (char)(i % 253);
+  }
+  MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer(
+      &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop);
+  MLoopCol *mloopcol = (MLoopCol *)CustomData_add_layer(
+      &mesh->ldata, CD_MLOOPCOL, CD_CALLOC, nullptr, mesh->totloop);
+  for (int i = 0; i < mesh->totloop; i++) {
+    mloopuv[i].uv[0] = (float)i;
+    mloopuv[i].uv[1] = (float)-i;
+    mloopcol[i].r = (unsigned char)i;
+    mloopcol[i].a = (unsigned char)(i / 256);
+  }
+  int *poly_int = (int *)CustomData_add_layer(
+      &mesh->pdata, CD_PROP_INT, CD_CALLOC, nullptr, mesh->totpoly);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    poly_int[i] = i * 3;
+  }
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  return mesh;
+}
+
+/* Check the BMesh of a round trip against the mesh it was created from, element by element. */
+static void convert_bmesh_check(const Mesh *mesh, BMesh *bm)
+{
+  const int cd_dvert_offset = CustomData_get_offset(&bm->vdata, CD_MDEFORMVERT);
+  const int cd_vert_float_offset = CustomData_get_offset(&bm->vdata, CD_PROP_FLT);
+  const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
+  const int cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE);
+  const int cd_loop_uv_offset = CustomData_get_offset(&bm->ldata, CD_MLOOPUV);
+  const int cd_loop_col_offset = CustomData_get_offset(&bm->ldata, CD_MLOOPCOL);
+  const int cd_poly_int_offset = CustomData_get_offset(&bm->pdata, CD_PROP_INT);
+  ASSERT_NE(cd_dvert_offset, -1);
+  ASSERT_NE(cd_vert_float_offset, -1);
+  ASSERT_NE(cd_vert_bweight_offset, -1);
+  ASSERT_NE(cd_edge_crease_offset, -1);
+  ASSERT_NE(cd_loop_uv_offset, -1);
+  ASSERT_NE(cd_loop_col_offset, -1);
+  ASSERT_NE(cd_poly_int_offset, -1);
+
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+  ASSERT_EQ(bm->totvert, mesh->totvert);
+  ASSERT_EQ(bm->totedge, mesh->totedge);
+  ASSERT_EQ(bm->totface, mesh->totpoly);
+
+  const MDeformVert *dvert = (const MDeformVert *)CustomData_get_layer(&mesh->vdata,
+                                                                       CD_MDEFORMVERT);
+  const float *vert_float = (const float *)CustomData_get_layer(&mesh->vdata, CD_PROP_FLT);
+  for (int i = 0; i < mesh->totvert; i++) {
+    BMVert *v = BM_vert_at_index(bm, i);
+    const MDeformVert *dv = (const MDeformVert *)BM_ELEM_CD_GET_VOID_P(v, cd_dvert_offset);
+    EXPECT_EQ(dv->totweight, 1);
+    EXPECT_NE(dv->dw, dvert[i].dw);
+    EXPECT_EQ(BKE_defvert_find_weight(dv, i % 3), dvert[i].dw->weight);
+    EXPECT_EQ(BM_ELEM_CD_GET_FLOAT(v, cd_vert_float_offset), vert_float[i]);
+    EXPECT_EQ(BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset), mesh->mvert[i].bweight);
+  }
+  for (int i = 0; i < mesh->totedge; i++) {
+    BMEdge *e = BM_edge_at_index(bm, i);
+    EXPECT_EQ(BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset), mesh->medge[i].crease);
+  }
+  const int *poly_int = (const int *)CustomData_get_layer(&mesh->pdata, CD_PROP_INT);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    BMFace *f = BM_face_at_index(bm, i);
+    EXPECT_EQ(BM_ELEM_CD_GET_INT(f, cd_poly_int_offset), poly_int[i]);
+    int j = mesh->mpoly[i].loopstart;
+    BMLoop *l_iter, *l_first;
+    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+    do {
+      const MLoopUV *luv = (const MLoopUV *)BM_ELEM_CD_GET_VOID_P(l_iter, cd_loop_uv_offset);
+      const MLoopCol *lcol = (const MLoopCol *)BM_ELEM_CD_GET_VOID_P(l_iter, cd_loop_col_offset);
+      EXPECT_EQ(luv->uv[0], mesh->mloopuv[j].uv[0]);
+      EXPECT_EQ(luv->uv[1], mesh->mloopuv[j].uv[1]);
+      EXPECT_EQ(memcmp(lcol, &mesh->mloopcol[j], sizeof(*lcol)), 0);
+      j++;
+    } while ((l_iter = l_iter->next) != l_first);
+  }
+}
+
+/* Convert to a BMesh and back with the given number of threads. Custom-data is copied a chunk
+ * of elements at a time, while creating the elements without threads and afterwards with. */
+static void convert_round_trip_test(const int num_threads)
+{
+  BLI_threadapi_init();
+  BKE_idtype_init();
+  benchmark_task_scheduler_threads_set(num_threads);
+  Mesh *mesh = convert_mesh_create();
+
+  BMeshCreateParams bm_create_params = {0};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_create_params);
+  BMeshFromMeshParams from_me_params = {0};
+  BM_mesh_bm_from_me(bm, mesh, &from_me_params);
+  convert_bmesh_check(mesh, bm);
+
+  /* Loops of the result are in the order of the polys. */
+  Mesh *mesh_result = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+  BMeshToMeshParams to_me_params = {0};
+  BM_mesh_bm_to_me(NULL, bm, mesh_result, &to_me_params);
+  BM_mesh_free(bm);
+  bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_create_params);
+  BM_mesh_bm_from_me(bm, mesh_result, &from_me_params);
+  convert_bmesh_check(mesh, bm);
+
+  BM_mesh_free(bm);
+  BKE_id_free(NULL, mesh_result);
+  BKE_id_free(NULL, mesh);
+  benchmark_task_scheduler_threads_set(0);
+  BLI_threadapi_exit();
+}
+
+TEST(bmesh_core, ConvertRoundTrip)
+{
+  convert_round_trip_test(1);
+}
+
+TEST(bmesh_core, ConvertRoundTripThreaded)
+{
+  convert_round_trip_test(4);
+}
@@ -0,0 +1,408 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+#include "testing/testing_performance.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "bmesh.h"
+#include "bmesh_tools.h"
+#include "bmesh_test_util.h"
+extern "C" {
+#include "tools/bmesh_intersect.h"
+}
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 5
+
+/* -------------------------------------------------------------------- */
+/* Intersect. */
+
+static float intersect_height_a(const float x, const float UNUSED(y))
+{
+  return 0.02f * sinf(x * 40.0f);
+}
+
+static float intersect_height_b(const float UNUSED(x), const float y)
+{
+  return 0.02f * cosf(y * 40.0f);
+}
+
+static int bm_face_isect_pair(BMFace *f, void *UNUSED(user_data))
+{
+  return BM_elem_flag_test(f, BM_ELEM_TAG) ? 1 : 0;
+}
+
+/* Two wavy grids crossing each other along many curves, intersected the way the Boolean
+ * modifier does it, only the second grid is tagged as the cutter. */
+static double mesh_intersect_run(const int resolution, const bool check_result)
+{
+  BMeshCreateParams bm_params = {0};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+  bm_grid_create(bm, resolution, intersect_height_a, 0);
+  bm_grid_create(bm, resolution, intersect_height_b, BM_ELEM_TAG);
+  BM_mesh_normals_update(bm);
+
+  const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
+  BMLoop *(*looptris)[3] = (BMLoop * (*)[3])
+      MEM_malloc_arrayN(looptris_tot, sizeof(*looptris), __func__);
+  int tottri;
+  BM_mesh_calc_tessellation(bm, looptris, &tottri);
+
+  const int totface_orig = bm->totface;
+  if (check_result) {
+    printf("Intersect: %d triangles in, ", tottri);
+  }
+
+  const double start_time = PIL_check_seconds_timer();
+  BM_mesh_intersect(bm,
+                    looptris,
+                    tottri,
+                    bm_face_isect_pair,
+                    NULL,
+                    false,
+                    false,
+                    true,
+                    true,
+                    false,
+                    false,
+                    BMESH_ISECT_BOOLEAN_NONE,
+                    1e-6f);
+  const double time = PIL_check_seconds_timer() - start_time;
+
+  if (check_result) {
+    printf("%d vertices, %d faces out\n", bm->totvert, bm->totface);
+    /* The grids cross along many curves, which cut faces of both grids. */
+    EXPECT_GT(bm->totface, totface_orig);
+  }
+
+  MEM_freeN(looptris);
+  BM_mesh_free(bm);
+  return time;
+}
+
+static void mesh_intersect_test(const int resolution)
+{
+  BLI_threadapi_init();
+
+  mesh_intersect_run(resolution, true);
+  benchmark_run_num_threads("intersect", NUM_RUN_AVERAGED, [&]() {
+    return mesh_intersect_run(resolution, false);
+  });
+
+  BLI_threadapi_exit();
+}
+
+TEST(bmesh_performance, Intersect256)
+{
+  mesh_intersect_test(256);
+}
+
+/* -------------------------------------------------------------------- */
+/* Bevel. */
+
+static float bevel_height(const float x, const float y)
+{
+  return 0.05f * sinf(x * 8.0f) * cosf(y * 8.0f);
+}
+
+/* Bevel all edges of a grid, every vertex is beveled and gets a vertex mesh with four sides.
+ * The sum of the squared coordinates is printed to compare the result between versions. */
+static double mesh_bevel_run(const int resolution, const int segments, const bool check_result)
+{
+  BMeshCreateParams bm_params = {0};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+  bm_grid_create(bm, resolution, bevel_height, 0);
+  BM_mesh_normals_update(bm);
+  BM_mesh_elem_hflag_enable_all(bm, BM_VERT | BM_EDGE, BM_ELEM_TAG, false);
+
+  const int totface_orig = bm->totface;
+  if (check_result) {
+    printf("Bevel %d segments: %d vertices, %d edges in, ", segments, bm->totvert, bm->totedge);
+  }
+
+  const double start_time = PIL_check_seconds_timer();
+  bm_mesh_bevel_edges(bm, 0.2f / (resolution - 1), segments);
+  const double time = PIL_check_seconds_timer() - start_time;
+
+  if (check_result) {
+    double co_sq_sum[3] = {0.0, 0.0, 0.0};
+    BMIter iter;
+    BMVert *v;
+    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+      for (int i = 0; i < 3; i++) {
+        co_sq_sum[i] += (double)v->co[i] * v->co[i];
+      }
+    }
+    printf("%d vertices, %d faces out, squared coordinate sum (%.9g, %.9g, %.9g)\n",
+           bm->totvert,
+           bm->totface,
+           co_sq_sum[0],
+           co_sq_sum[1],
+           co_sq_sum[2]);
+    /* Every edge gets a face and every vertex a vertex mesh. */
+    EXPECT_GT(bm->totface, totface_orig * 2);
+  }
+
+  BM_mesh_free(bm);
+  return time;
+}
+
+static void mesh_bevel_test(const int resolution, const int segments)
+{
+  BLI_threadapi_init();
+
+  mesh_bevel_run(resolution, segments, true);
+  benchmark_run_num_threads("bevel", NUM_RUN_AVERAGED, [&]() {
+    return mesh_bevel_run(resolution, segments, false);
+  });
+
+  BLI_threadapi_exit();
+}
+
+TEST(bmesh_performance, Bevel128Segments2)
+{
+  mesh_bevel_test(128, 2);
+}
+
+TEST(bmesh_performance, Bevel64Segments8)
+{
+  mesh_bevel_test(64, 8);
+}
+
+/* -------------------------------------------------------------------- */
+/* Decimate. */
+
+static float decimate_height(const float x, const float y)
+{
+  return 0.1f * sinf(x * 6.0f) * cosf(y * 4.0f);
+}
+
+/* Collapse a smooth height field to a tenth of its faces, like the Decimate modifier does.
+ * The distance of the remaining vertices to the height field measures the quality. */
+static double mesh_decimate_run(const int resolution, const bool check_result)
+{
+  BMeshCreateParams bm_params = {0};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+  bm_grid_create(bm, resolution, decimate_height, 0);
+  BM_mesh_normals_update(bm);
+
+  const int tottri_orig = poly_to_tri_count(bm->totface, bm->totloop);
+  if (check_result) {
+    printf("Decimate: %d vertices, %d faces in, ", bm->totvert, bm->totface);
+  }
+
+  const double start_time = PIL_check_seconds_timer();
+  BM_mesh_decimate_collapse(bm, 0.1f, NULL, 1.0f, false, -1, 0.0f);
+  const double time = PIL_check_seconds_timer() - start_time;
+
+  if (check_result) {
+    double error_sum = 0.0, error_max = 0.0;
+    BMIter iter;
+    BMVert *v;
+    BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+      const double error = fabs(v->co[2] - decimate_height(v->co[0], v->co[1]));
+      error_sum += error;
+      error_max = max_dd(error_max, error);
+    }
+    printf("%d vertices, %d faces out, height error %g average, %g max\n",
+           bm->totvert,
+           bm->totface,
+           error_sum / bm->totvert,
+           error_max);
+    /* The factor is a ratio of triangles, some of them are joined back into quads. */
+    EXPECT_LE(bm->totface, tottri_orig / 10);
+    EXPECT_GT(bm->totface, tottri_orig / 20);
+    /* The surface is smooth, so the collapse keeps the vertices close to it. */
+    EXPECT_LT(error_max, 1e-3);
+  }
+
+  BM_mesh_free(bm);
+  return time;
+}
+
+static void mesh_decimate_test(const int resolution)
+{
+  BLI_threadapi_init();
+
+  mesh_decimate_run(resolution, true);
+  benchmark_run_num_threads("decimate", NUM_RUN_AVERAGED, [&]() {
+    return mesh_decimate_run(resolution, false);
+  });
+
+  BLI_threadapi_exit();
+}
+
+TEST(bmesh_performance, Decimate512)
+{
+  mesh_decimate_test(512);
+}
+
+/* -------------------------------------------------------------------- */
+/* Remove doubles. */
+
+static float remove_doubles_height(const float x, const float y)
+{
+  return 0.1f * sinf(x * 5.0f) * cosf(y * 3.0f);
+}
+
+static float remove_doubles_height_offset(const float x, const float y)
+{
+  return remove_doubles_height(x, y) + 1e-5f;
+}
+
+/* Merge a grid with a copy of itself, moved by less than the merge distance, like "Merge by
+ * Distance" does. Every vertex of the copy is welded, its faces become duplicates. */
+static double mesh_remove_doubles_run(const int resolution, const bool check_result)
+{
+  BMeshCreateParams bm_params = {0};
+  bm_params.use_toolflags = true;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+  bm_grid_create(bm, resolution, remove_doubles_height, 0);
+  bm_grid_create(bm, resolution, remove_doubles_height_offset, 0);
+
+  if (check_result) {
+    printf("Remove doubles: %d vertices, %d faces in, ", bm->totvert, bm->totface);
+  }
+
+  const double start_time = PIL_check_seconds_timer();
+  BMO_op_callf(bm, BMO_FLAG_DEFAULTS, "remove_doubles verts=%av dist=%f", 1e-4f);
+  const double time = PIL_check_seconds_timer() - start_time;
+
+  if (check_result) {
+    printf("%d vertices, %d faces out\n", bm->totvert, bm->totface);
+    EXPECT_EQ(bm->totvert, resolution * resolution);
+    EXPECT_EQ(bm->totface, (resolution - 1) * (resolution - 1));
+  }
+
+  BM_mesh_free(bm);
+  return time;
+}
+
+static void mesh_remove_doubles_test(const int resolution)
+{
+  BLI_threadapi_init();
+
+  mesh_remove_doubles_run(resolution, true);
+  benchmark_run_num_threads("remove doubles", NUM_RUN_AVERAGED, [&]() {
+    return mesh_remove_doubles_run(resolution, false);
+  });
+
+  BLI_threadapi_exit();
+}
+
+TEST(bmesh_performance, RemoveDoubles512)
+{
+  mesh_remove_doubles_test(512);
+}
+
+/* -------------------------------------------------------------------- */
+/* Mesh <-> BMesh conversion. */
+
+static float convert_height(const float x, const float y)
+{
+  return 0.1f * sinf(x * 10.0f) * cosf(y * 10.0f);
+}
+
+/* Enter and leave edit-mode on a dense grid with UV and color layers, the conversions use the
+ * same parameters as edit-mode does. Adds the time spent in both directions. */
+static void mesh_convert_run(Mesh *mesh,
+                             const bool check_result,
+                             double *r_from_me_time,
+                             double *r_to_me_time)
+{
+  const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(mesh);
+  BMeshCreateParams bm_create_params = {0};
+  bm_create_params.use_toolflags = true;
+  BMesh *bm = BM_mesh_create(&allocsize, &bm_create_params);
+
+  BMeshFromMeshParams from_me_params = {0};
+  from_me_params.calc_face_normal = true;
+  from_me_params.use_shapekey = true;
+  double start_time = PIL_check_seconds_timer();
+  BM_mesh_bm_from_me(bm, mesh, &from_me_params);
+  *r_from_me_time += PIL_check_seconds_timer() - start_time;
+
+  Mesh *mesh_result = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+  BMeshToMeshParams to_me_params = {0};
+  start_time = PIL_check_seconds_timer();
+  BM_mesh_bm_to_me(NULL, bm, mesh_result, &to_me_params);
+  *r_to_me_time += PIL_check_seconds_timer() - start_time;
+
+  if (check_result) {
+    /* The round trip keeps the order of all elements and their data. */
+    EXPECT_EQ(BKE_mesh_cmp(mesh, mesh_result, FLT_EPSILON), nullptr);
+  }
+
+  BKE_id_free(NULL, mesh_result);
+  BM_mesh_free(bm);
+}
+
+static void mesh_convert_test(const int resolution)
+{
+  BLI_threadapi_init();
+  BKE_idtype_init();
+
+  BMeshCreateParams bm_create_params = {0};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_create_params);
+  bm_grid_create(bm, resolution, convert_height, 0);
+  BM_data_layer_add(bm, &bm->ldata, CD_MLOOPUV);
+  BM_data_layer_add(bm, &bm->ldata, CD_MLOOPCOL);
+  Mesh *mesh = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+  BMeshToMeshParams to_me_params = {0};
+  BM_mesh_bm_to_me(NULL, bm, mesh, &to_me_params);
+  BM_mesh_free(bm);
+
+  printf("Convert: %d vertices, %d faces, %d loops\n",
+         mesh->totvert,
+         mesh->totpoly,
+         mesh->totloop);
+
+  double from_me_time, to_me_time;
+  mesh_convert_run(mesh, true, &from_me_time, &to_me_time);
+  benchmark_foreach_num_threads([&](const int num_threads) {
+    from_me_time = to_me_time = 0.0;
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      mesh_convert_run(mesh, false, &from_me_time, &to_me_time);
+    }
+    benchmark_time_print(num_threads, "from mesh", from_me_time, NUM_RUN_AVERAGED);
+    benchmark_time_print(num_threads, "to mesh", to_me_time, NUM_RUN_AVERAGED);
+  });
+
+  BKE_id_free(NULL, mesh);
+  BLI_threadapi_exit();
+}
+
+TEST(bmesh_performance, Convert1M)
+{
+  mesh_convert_test(1024);
+}
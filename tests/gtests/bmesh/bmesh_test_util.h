@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#ifndef __BMESH_TEST_UTIL_H__
+#define __BMESH_TEST_UTIL_H__
+
+/* Meshes and operations shared by the BMesh tests and benchmarks. */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+
+#include "bmesh.h"
+#include "bmesh_tools.h"
+
+/* Grid of quads spanning [-1, 1] in X and Y, with the height given by the callback. */
+inline void bm_grid_create(BMesh *bm,
+                           const int resolution,
+                           float (*height_fn)(const float x, const float y),
+                           const char hflag)
+{
+  BMVert **verts = (BMVert **)MEM_malloc_arrayN(
+      resolution * resolution, sizeof(BMVert *), __func__);
+  for (int y = 0; y < resolution; y++) {
+    for (int x = 0; x < resolution; x++) {
+      float co[3];
+      co[0] = (float)x / (resolution - 1) * 2.0f - 1.0f;
+      co[1] = (float)y / (resolution - 1) * 2.0f - 1.0f;
+      co[2] = height_fn(co[0], co[1]);
+      verts[y * resolution + x] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+    }
+  }
+  for (int y = 0; y < resolution - 1; y++) {
+    for (int x = 0; x < resolution - 1; x++) {
+      BMVert *quad[4] = {verts[y * resolution + x],
+                         verts[y * resolution + x + 1],
+                         verts[(y + 1) * resolution + x + 1],
+                         verts[(y + 1) * resolution + x]};
+      BMFace *f = BM_face_create_verts(bm, quad, 4, NULL, BM_CREATE_NOP, true);
+      BM_elem_flag_set(f, hflag, true);
+    }
+  }
+  MEM_freeN(verts);
+}
+
+/* Bevel the tagged edges with the default settings of the bevel operator. */
+inline void bm_mesh_bevel_edges(BMesh *bm, const float offset, const int segments)
+{
+  BM_mesh_bevel(bm,
+                offset,
+                BEVEL_AMT_OFFSET,
+                segments,
+                0.5f,
+                false,
+                false,
+                true,
+                NULL,
+                -1,
+                -1,
+                true,
+                false,
+                false,
+                false,
+                BEVEL_FACE_STRENGTH_NONE,
+                BEVEL_MITER_SHARP,
+                BEVEL_MITER_SHARP,
+                0.1f,
+                (float)M_PI / 6.0f,
+                false,
+                NULL,
+                BEVEL_VMESH_ADJ);
+}
+
+#endif /* __BMESH_TEST_UTIL_H__ */
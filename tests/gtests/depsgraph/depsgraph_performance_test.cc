@@ -0,0 +1,466 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Dependency graph throughput benchmark.
+ *
+ * Scenes are built in memory, so no test assets are needed. Every scene is timed for relations
+ * building, frame change evaluation and the latency of tagging a single object for update, with
+ * a varying number of threads. Per component type times come from the evaluation statistics of
+ * the dependency graph. */
+
+#include "blenloader/blendfile_loading_base_test.h"
+#include "testing/testing_performance.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_collection_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_armature.h"
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_fcurve.h"
+#include "BKE_fcurve_driver.h"
+#include "BKE_global.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+#include "DEG_depsgraph_query.h"
+
+#include "PIL_time.h"
+}
+
+#define NUM_FRAMES 50
+#define NUM_RELATION_UPDATES 5
+#define NUM_TAG_UPDATES 50
+
+class DepsgraphPerformanceTest : public BlendfileLoadingBaseTest {
+ protected:
+  struct Main *bmain = nullptr;
+  struct Scene *scene = nullptr;
+  struct ViewLayer *view_layer = nullptr;
+  /* All objects of the benchmark are put in here, it is linked to the scene once built, to avoid
+   * synchronizing the view layer for every added object. */
+  struct Collection *collection = nullptr;
+  /* Object which is tagged for update when measuring tagging latency. */
+  struct Object *ob_tag = nullptr;
+
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = BKE_view_layer_default_view(scene);
+    collection = BKE_collection_add(bmain, nullptr, "Benchmark");
+  }
+
+  virtual void TearDown()
+  {
+    depsgraph_free();
+    BKE_main_free(bmain);
+    bmain = nullptr;
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* -------------------------------------------------------------------- */
+  /* Scene construction. */
+
+  Object *object_add(const int type, const char *name, ID *data)
+  {
+    Object *ob = BKE_object_add_only_object(bmain, type, name);
+    if (data != nullptr) {
+      ob->data = data;
+      id_us_plus(data);
+    }
+    BKE_collection_object_add(bmain, collection, ob);
+    return ob;
+  }
+
+  Mesh *grid_mesh_add(const char *name, const int resolution)
+  {
+    Mesh *mesh = BKE_mesh_add(bmain, name);
+    const int num_polys = (resolution - 1) * (resolution - 1);
+    mesh->totvert = resolution * resolution;
+    mesh->totpoly = num_polys;
+    mesh->totloop = num_polys * 4;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+    CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+    CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    for (int y = 0; y < resolution; y++) {
+      for (int x = 0; x < resolution; x++) {
+        MVert *mvert = &mesh->mvert[y * resolution + x];
+        mvert->co[0] = (float)x / (resolution - 1) * 2.0f - 1.0f;
+        mvert->co[1] = (float)y / (resolution - 1) * 2.0f - 1.0f;
+      }
+    }
+    for (int y = 0; y < resolution - 1; y++) {
+      for (int x = 0; x < resolution - 1; x++) {
+        const int poly_index = y * (resolution - 1) + x;
+        const int v = y * resolution + x;
+        MPoly *mpoly = &mesh->mpoly[poly_index];
+        MLoop *mloop = &mesh->mloop[poly_index * 4];
+        mpoly->loopstart = poly_index * 4;
+        mpoly->totloop = 4;
+        mloop[0].v = v;
+        mloop[1].v = v + 1;
+        mloop[2].v = v + resolution + 1;
+        mloop[3].v = v + resolution;
+      }
+    }
+    BKE_mesh_calc_edges(mesh, false, false);
+    BKE_mesh_calc_normals(mesh);
+    return mesh;
+  }
+
+  /* Animate a property with a generator F-Modifier, which gives value = offset + speed * frame
+   * without having to create keyframes. */
+  void fcurve_generator_add(
+      ID *id, const char *rna_path, const int array_index, const float offset, const float speed)
+  {
+    AnimData *adt = BKE_animdata_add_id(id);
+    if (adt->action == nullptr) {
+      adt->action = BKE_action_add(bmain, "Action");
+    }
+    FCurve *fcu = (FCurve *)MEM_callocN(sizeof(FCurve), __func__);
+    fcu->flag = (FCURVE_VISIBLE | FCURVE_SELECTED);
+    fcu->rna_path = BLI_strdup(rna_path);
+    fcu->array_index = array_index;
+    FModifier *fcm = add_fmodifier(&fcu->modifiers, FMODIFIER_TYPE_GENERATOR, fcu);
+    FMod_Generator *generator = (FMod_Generator *)fcm->data;
+    generator->coefficients[0] = offset;
+    generator->coefficients[1] = speed;
+    BLI_addtail(&adt->action->curves, fcu);
+  }
+
+  /* Driver which reads a transform channel of another object. */
+  void driver_add(ID *id,
+                  const char *rna_path,
+                  const int array_index,
+                  const char *expression,
+                  Object *ob_target)
+  {
+    AnimData *adt = BKE_animdata_add_id(id);
+    FCurve *fcu = (FCurve *)MEM_callocN(sizeof(FCurve), __func__);
+    fcu->flag = (FCURVE_VISIBLE | FCURVE_SELECTED);
+    fcu->rna_path = BLI_strdup(rna_path);
+    fcu->array_index = array_index;
+    fcu->driver = (ChannelDriver *)MEM_callocN(sizeof(ChannelDriver), __func__);
+    ChannelDriver *driver = fcu->driver;
+    driver->type = DRIVER_TYPE_PYTHON;
+    STRNCPY(driver->expression, expression);
+    DriverVar *dvar = driver_add_new_variable(driver);
+    driver_change_variable_type(dvar, DVAR_TYPE_TRANSFORM_CHAN);
+    dvar->targets[0].id = &ob_target->id;
+    dvar->targets[0].transChan = DTAR_TRANSCHAN_LOCZ;
+    BLI_addtail(&adt->drivers, fcu);
+  }
+
+  /* Chain of bones, every bone rotated by its own F-Curve. */
+  Object *armature_chain_add(const char *name, const int num_bones)
+  {
+    bArmature *arm = BKE_armature_add(bmain, name);
+    Bone *bone_parent = nullptr;
+    for (int i = 0; i < num_bones; i++) {
+      Bone *bone = (Bone *)MEM_callocN(sizeof(Bone), __func__);
+      BLI_snprintf(bone->name, sizeof(bone->name), "Bone.%04d", i);
+      bone->parent = bone_parent;
+      copy_v3_fl3(bone->tail, 0.0f, 1.0f, 0.0f);
+      unit_m3(bone->bone_mat);
+      bone->length = 1.0f;
+      bone->dist = 0.25f;
+      bone->weight = 1.0f;
+      bone->xwidth = bone->zwidth = 0.1f;
+      bone->rad_head = bone->rad_tail = 0.1f;
+      bone->segments = 1;
+      bone->layer = 1;
+      BLI_addtail((bone_parent != nullptr) ? &bone_parent->childbase : &arm->bonebase, bone);
+      bone_parent = bone;
+    }
+    BKE_armature_where_is(arm);
+
+    Object *ob = object_add(OB_ARMATURE, name, &arm->id);
+    id_us_min(&arm->id);
+    BKE_pose_rebuild(bmain, ob, arm, true);
+    LISTBASE_FOREACH (bPoseChannel *, pchan, &ob->pose->chanbase) {
+      pchan->rotmode = ROT_MODE_XYZ;
+      char rna_path[128];
+      BLI_snprintf(
+          rna_path, sizeof(rna_path), "pose.bones[\"%s\"].rotation_euler", pchan->name);
+      fcurve_generator_add(&ob->id, rna_path, 0, 0.0f, 0.01f);
+    }
+    return ob;
+  }
+
+  /* Deep armature rigs deforming dense meshes. */
+  void scene_build_rigs(const int num_rigs, const int num_bones)
+  {
+    for (int i = 0; i < num_rigs; i++) {
+      char name[MAX_ID_NAME - 2];
+      BLI_snprintf(name, sizeof(name), "Rig.%04d", i);
+      Object *ob_arm = armature_chain_add(name, num_bones);
+      BLI_snprintf(name, sizeof(name), "Body.%04d", i);
+      Mesh *mesh = grid_mesh_add(name, 64);
+      Object *ob_mesh = object_add(OB_MESH, name, &mesh->id);
+      id_us_min(&mesh->id);
+      ob_mesh->parent = ob_arm;
+      ArmatureModifierData *amd = (ArmatureModifierData *)BKE_modifier_new(
+          eModifierType_Armature);
+      amd->object = ob_arm;
+      amd->deformflag = ARM_DEF_ENVELOPE;
+      BLI_addtail(&ob_mesh->modifiers, amd);
+      ob_tag = ob_arm;
+    }
+  }
+
+  /* Thousands of animated objects, all instancing the same mesh. */
+  void scene_build_crowd(const int num_objects)
+  {
+    Mesh *mesh = grid_mesh_add("Crowd", 8);
+    for (int i = 0; i < num_objects; i++) {
+      char name[MAX_ID_NAME - 2];
+      BLI_snprintf(name, sizeof(name), "Crowd.%05d", i);
+      Object *ob = object_add(OB_MESH, name, &mesh->id);
+      ob->loc[0] = (float)(i % 100);
+      ob->loc[1] = (float)(i / 100);
+      fcurve_generator_add(&ob->id, "location", 2, (float)i, 0.1f);
+      ob_tag = ob;
+    }
+    id_us_min(&mesh->id);
+  }
+
+  /* Chains of empties, where every empty is driven by the previous one. */
+  void scene_build_drivers(const int num_chains, const int chain_length)
+  {
+    for (int i = 0; i < num_chains; i++) {
+      Object *ob_prev = nullptr;
+      for (int j = 0; j < chain_length; j++) {
+        char name[MAX_ID_NAME - 2];
+        BLI_snprintf(name, sizeof(name), "Driven.%03d.%03d", i, j);
+        Object *ob = object_add(OB_EMPTY, name, nullptr);
+        if (ob_prev == nullptr) {
+          fcurve_generator_add(&ob->id, "location", 2, 0.0f, 0.1f);
+          ob_tag = ob;
+        }
+        else {
+          driver_add(&ob->id, "location", 2, "var * 0.5 + sin(frame * 0.1)", ob_prev);
+          driver_add(&ob->id,
+                     "rotation_euler",
+                     0,
+                     "clamp(var ** 2 % tau, 0.1, pi) if var > 0 else lerp(0, -var, 0.5)",
+                     ob_prev);
+        }
+        ob_prev = ob;
+      }
+    }
+  }
+
+  /* Objects with long stacks of deform modifiers, first of which is time dependent. */
+  void scene_build_modifiers(const int num_objects, const int num_modifiers)
+  {
+    for (int i = 0; i < num_objects; i++) {
+      char name[MAX_ID_NAME - 2];
+      BLI_snprintf(name, sizeof(name), "Stack.%03d", i);
+      Mesh *mesh = grid_mesh_add(name, 32);
+      Object *ob = object_add(OB_MESH, name, &mesh->id);
+      id_us_min(&mesh->id);
+      ModifierData *md = BKE_modifier_new(eModifierType_Wave);
+      BLI_addtail(&ob->modifiers, md);
+      const int modifier_types[] = {
+          eModifierType_Smooth, eModifierType_Cast, eModifierType_SimpleDeform};
+      for (int j = 0; j < num_modifiers; j++) {
+        md = BKE_modifier_new(modifier_types[j % ARRAY_SIZE(modifier_types)]);
+        BLI_addtail(&ob->modifiers, md);
+        BKE_modifier_unique_name(&ob->modifiers, md);
+      }
+      ob_tag = ob;
+    }
+  }
+
+  /* -------------------------------------------------------------------- */
+  /* Timing. */
+
+  static void print_component_time(void * /*user_data*/,
+                                   const char *component_name,
+                                   const double time)
+  {
+    printf("\t\t%-24s %fs\n", component_name, time);
+  }
+
+  /* Report how many drivers are evaluated without Python, since those are the only ones which
+   * are evaluated in parallel. */
+  void drivers_count_print()
+  {
+    int num_simple = 0, num_python = 0;
+    LISTBASE_FOREACH (Object *, ob, &bmain->objects) {
+      AnimData *adt = BKE_animdata_from_id(&ob->id);
+      if (adt == nullptr) {
+        continue;
+      }
+      LISTBASE_FOREACH (FCurve *, fcu, &adt->drivers) {
+        if (BKE_driver_has_simple_expression(fcu->driver)) {
+          num_simple++;
+        }
+        else {
+          num_python++;
+        }
+      }
+    }
+    if (num_simple + num_python != 0) {
+      printf("\tDrivers: %d simple expressions, %d Python fallbacks\n", num_simple, num_python);
+    }
+  }
+
+  void benchmark_run(const char *id)
+  {
+    printf("\n========== STARTING %s (%d threads) ==========\n",
+           id,
+           BLI_task_scheduler_num_threads());
+
+    BKE_collection_child_add(bmain, scene->master_collection, collection);
+
+    double start_time = PIL_check_seconds_timer();
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+    const double build_time = PIL_check_seconds_timer() - start_time;
+
+    size_t num_outer, num_operations, num_relations;
+    DEG_stats_simple(depsgraph, &num_outer, &num_operations, &num_relations);
+    printf("\tGraph: %zu outer nodes, %zu operations, %zu relations\n",
+           num_outer,
+           num_operations,
+           num_relations);
+    drivers_count_print();
+
+    start_time = PIL_check_seconds_timer();
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+    const double initial_eval_time = PIL_check_seconds_timer() - start_time;
+
+    /* Rebuild the relations of the evaluated graph, so the copied data-blocks are re-used. */
+    double relations_time = 0.0;
+    for (int i = 0; i < NUM_RELATION_UPDATES; i++) {
+      DEG_graph_tag_relations_update(depsgraph);
+      start_time = PIL_check_seconds_timer();
+      DEG_graph_relations_update(depsgraph, bmain, scene, view_layer);
+      relations_time += PIL_check_seconds_timer() - start_time;
+    }
+
+    double frame_time = 0.0, frame_time_max = 0.0;
+    for (int frame = 1; frame <= NUM_FRAMES; frame++) {
+      start_time = PIL_check_seconds_timer();
+      DEG_evaluate_on_framechange(bmain, depsgraph, (float)frame);
+      const double time = PIL_check_seconds_timer() - start_time;
+      frame_time += time;
+      frame_time_max = max_dd(frame_time_max, time);
+    }
+
+    double tag_time = 0.0, refresh_time = 0.0;
+    for (int i = 0; i < NUM_TAG_UPDATES; i++) {
+      start_time = PIL_check_seconds_timer();
+      DEG_graph_id_tag_update(bmain, depsgraph, &ob_tag->id, ID_RECALC_TRANSFORM);
+      tag_time += PIL_check_seconds_timer() - start_time;
+      start_time = PIL_check_seconds_timer();
+      DEG_evaluate_on_refresh(bmain, depsgraph);
+      refresh_time += PIL_check_seconds_timer() - start_time;
+    }
+    /* Nothing may be left tagged, or the timings above skipped part of the work. */
+    EXPECT_TRUE(DEG_is_fully_evaluated(depsgraph));
+
+    printf("\tBuild:             %fs\n", build_time);
+    printf("\tRelations update:  %fs on average over %d runs\n",
+           relations_time / NUM_RELATION_UPDATES,
+           NUM_RELATION_UPDATES);
+    printf("\tInitial evaluation: %fs\n", initial_eval_time);
+    printf("\tFrame change:      %fs on average over %d frames, %fs worst\n",
+           frame_time / NUM_FRAMES,
+           NUM_FRAMES,
+           frame_time_max);
+    printf("\tTag:               %fs on average over %d runs\n",
+           tag_time / NUM_TAG_UPDATES,
+           NUM_TAG_UPDATES);
+    printf("\tFlush and refresh: %fs on average over %d runs\n",
+           refresh_time / NUM_TAG_UPDATES,
+           NUM_TAG_UPDATES);
+
+    /* Per component breakdown of one more frame. Timing is only enabled here, since gathering
+     * the statistics has its own overhead. */
+    const int debug_flags = G.debug;
+    G.debug |= G_DEBUG_DEPSGRAPH_TIME;
+    DEG_evaluate_on_framechange(bmain, depsgraph, (float)(NUM_FRAMES + 1));
+    G.debug = debug_flags;
+    printf("\tComponents:\n");
+    DEG_stats_component_times(depsgraph, print_component_time, nullptr);
+
+    printf("========== ENDED %s ==========\n\n", id);
+
+    depsgraph_free();
+    BKE_collection_child_remove(bmain, scene->master_collection, collection);
+  }
+
+  void benchmark_run_all_threads(const char *id)
+  {
+    benchmark_foreach_num_threads([&](const int /*num_threads*/) { benchmark_run(id); });
+  }
+};
+
+TEST_F(DepsgraphPerformanceTest, ArmatureRigs)
+{
+  scene_build_rigs(10, 200);
+  benchmark_run_all_threads("ArmatureRigs");
+}
+
+TEST_F(DepsgraphPerformanceTest, Crowd)
+{
+  scene_build_crowd(5000);
+  benchmark_run_all_threads("Crowd");
+}
+
+TEST_F(DepsgraphPerformanceTest, Drivers)
+{
+  scene_build_drivers(50, 40);
+  benchmark_run_all_threads("Drivers");
+}
+
+TEST_F(DepsgraphPerformanceTest, ModifierStacks)
+{
+  scene_build_modifiers(50, 30);
+  benchmark_run_all_threads("ModifierStacks");
+}
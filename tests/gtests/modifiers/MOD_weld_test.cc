@@ -0,0 +1,264 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "blenloader/blendfile_loading_base_test.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "CLG_log.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+}
+
+typedef std::array<float, 3> Co;
+
+class WeldTest : public BlendfileLoadingBaseTest {
+ protected:
+  struct Main *bmain = nullptr;
+  struct Object *ob = nullptr;
+  WeldModifierData *wmd = nullptr;
+
+  /* Mesh validation reports through the logger. */
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BlendfileLoadingBaseTest::SetUpTestCase();
+  }
+
+  static void TearDownTestCase()
+  {
+    CLG_exit();
+    BlendfileLoadingBaseTest::TearDownTestCase();
+  }
+
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    bmain = BKE_main_new();
+    ob = BKE_object_add_only_object(bmain, OB_MESH, "Weld");
+    wmd = (WeldModifierData *)BKE_modifier_new(eModifierType_Weld);
+    BLI_addtail(&ob->modifiers, wmd);
+    /* Merge all vertices within the distance, not only the closest pairs. */
+    wmd->max_interactions = 0;
+  }
+
+  virtual void TearDown()
+  {
+    BKE_main_free(bmain);
+    bmain = nullptr;
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* Copies of a grid of quads, with the lower left corner of every copy at the given offset. */
+  static Mesh *grid_copies_create(const int resolution, const std::vector<Co> &offsets)
+  {
+    const int num_copies = (int)offsets.size();
+    const int num_verts = resolution * resolution;
+    const int num_polys = (resolution - 1) * (resolution - 1);
+    Mesh *mesh = BKE_mesh_new_nomain(
+        num_verts * num_copies, 0, 0, num_polys * 4 * num_copies, num_polys * num_copies);
+    for (int i = 0; i < num_copies; i++) {
+      for (int y = 0; y < resolution; y++) {
+        for (int x = 0; x < resolution; x++) {
+          const float co[3] = {(float)x, (float)y, 0.0f};
+          add_v3_v3v3(mesh->mvert[i * num_verts + y * resolution + x].co, co, offsets[i].data());
+        }
+      }
+      for (int y = 0; y < resolution - 1; y++) {
+        for (int x = 0; x < resolution - 1; x++) {
+          const int poly_index = i * num_polys + y * (resolution - 1) + x;
+          const unsigned int v = (unsigned int)(i * num_verts + y * resolution + x);
+          MPoly *mp = &mesh->mpoly[poly_index];
+          MLoop *ml = &mesh->mloop[poly_index * 4];
+          mp->loopstart = poly_index * 4;
+          mp->totloop = 4;
+          ml[0].v = v;
+          ml[1].v = v + 1;
+          ml[2].v = v + resolution + 1;
+          ml[3].v = v + resolution;
+        }
+      }
+    }
+    BKE_mesh_calc_edges(mesh, false, false);
+    BKE_mesh_calc_normals(mesh);
+    return mesh;
+  }
+
+  Mesh *weld(Mesh *mesh)
+  {
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(eModifierType_Weld);
+    const ModifierEvalContext ctx = {nullptr, ob, (ModifierApplyFlag)0};
+    Mesh *result = mti->modifyMesh(&wmd->modifier, &ctx, mesh);
+    /* Normals of merged vertices are tagged dirty, like the modifier stack does, compute them
+     * before validating. */
+    BKE_mesh_ensure_normals(result);
+    EXPECT_FALSE(BKE_mesh_validate(result, true, true));
+    return result;
+  }
+
+  static std::vector<Co> vert_coords_sorted(const Mesh *mesh)
+  {
+    std::vector<Co> coords(mesh->totvert);
+    for (int i = 0; i < mesh->totvert; i++) {
+      copy_v3_v3(coords[i].data(), mesh->mvert[i].co);
+    }
+    std::sort(coords.begin(), coords.end());
+    return coords;
+  }
+
+  /* Reference clustering, every vertex is merged with all vertices within the merge distance, so
+   * vertices end up at the average of their cluster. */
+  std::vector<Co> vert_coords_welded_expected(const Mesh *mesh)
+  {
+    std::vector<int> cluster(mesh->totvert);
+    for (int i = 0; i < mesh->totvert; i++) {
+      cluster[i] = i;
+    }
+    auto cluster_find = [&](int i) {
+      while (cluster[i] != i) {
+        i = cluster[i];
+      }
+      return i;
+    };
+    const float merge_dist_sq = wmd->merge_dist * wmd->merge_dist;
+    for (int i = 0; i < mesh->totvert; i++) {
+      for (int j = i + 1; j < mesh->totvert; j++) {
+        if (len_squared_v3v3(mesh->mvert[i].co, mesh->mvert[j].co) <= merge_dist_sq) {
+          const int cluster_i = cluster_find(i), cluster_j = cluster_find(j);
+          cluster[std::max(cluster_i, cluster_j)] = std::min(cluster_i, cluster_j);
+        }
+      }
+    }
+
+    std::vector<Co> sums(mesh->totvert, Co{0.0f, 0.0f, 0.0f});
+    std::vector<int> counts(mesh->totvert, 0);
+    for (int i = 0; i < mesh->totvert; i++) {
+      const int root = cluster_find(i);
+      add_v3_v3(sums[root].data(), mesh->mvert[i].co);
+      counts[root]++;
+    }
+    std::vector<Co> coords;
+    for (int i = 0; i < mesh->totvert; i++) {
+      if (counts[i] != 0) {
+        mul_v3_fl(sums[i].data(), 1.0f / counts[i]);
+        coords.push_back(sums[i]);
+      }
+    }
+    std::sort(coords.begin(), coords.end());
+    return coords;
+  }
+
+  static void vert_coords_expect_near(const std::vector<Co> &expected,
+                                      const std::vector<Co> &actual)
+  {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_V3_NEAR(expected[i], actual[i], 1e-5f);
+    }
+  }
+};
+
+/* Touching copies, like the output of an array modifier without merging. Every vertex has one
+ * vertex to merge with at most, so limiting the interactions gives the same result. */
+TEST_F(WeldTest, TouchingGrids)
+{
+  Mesh *mesh = grid_copies_create(8, {{0, 0, 0}, {7, 0, 0}, {14, 0, 0}, {21, 0, 0}});
+  const std::vector<Co> coords_expected = vert_coords_welded_expected(mesh);
+
+  for (const unsigned int max_interactions : {0, 1}) {
+    wmd->max_interactions = max_interactions;
+    Mesh *result = weld(mesh);
+    EXPECT_EQ(result->totvert, 4 * 64 - 3 * 8);
+    EXPECT_EQ(result->totedge, 28 * 8 + 29 * 7);
+    EXPECT_EQ(result->totpoly, 4 * 49);
+    EXPECT_EQ(result->totloop, 4 * 49 * 4);
+    vert_coords_expect_near(coords_expected, vert_coords_sorted(result));
+    BKE_id_free(nullptr, result);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+/* Stacked duplicates, all copies collapse into one grid, without duplicate edges and faces. */
+TEST_F(WeldTest, DuplicateGrids)
+{
+  Mesh *mesh = grid_copies_create(
+      8, {{0, 0, 0}, {1e-4f, 0, 0}, {2e-4f, 0, 0}, {3e-4f, 0, 0}, {4e-4f, 0, 0}});
+  const std::vector<Co> coords_expected = vert_coords_welded_expected(mesh);
+
+  Mesh *result = weld(mesh);
+  EXPECT_EQ(result->totvert, 64);
+  EXPECT_EQ(result->totedge, 2 * 7 * 8);
+  EXPECT_EQ(result->totpoly, 49);
+  EXPECT_EQ(result->totloop, 49 * 4);
+  vert_coords_expect_near(coords_expected, vert_coords_sorted(result));
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+/* Loose vertices scattered around random centers, clusters get different sizes and vertices of
+ * the same center are not always merged. Compared with the clustering of all pairs. */
+TEST_F(WeldTest, RandomClusters)
+{
+  const int num_centers = 500, num_verts_per_center = 5;
+  Mesh *mesh = BKE_mesh_new_nomain(num_centers * num_verts_per_center, 0, 0, 0, 0);
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < num_centers; i++) {
+    const float center[3] = {
+        BLI_rng_get_float(rng), BLI_rng_get_float(rng), BLI_rng_get_float(rng)};
+    for (int j = 0; j < num_verts_per_center; j++) {
+      float offset[3];
+      BLI_rng_get_float_unit_v3(rng, offset);
+      madd_v3_v3v3fl(mesh->mvert[i * num_verts_per_center + j].co,
+                     center,
+                     offset,
+                     BLI_rng_get_float(rng) * 0.02f);
+      mesh->mvert[i * num_verts_per_center + j].no[2] = SHRT_MAX;
+    }
+  }
+  BLI_rng_free(rng);
+  wmd->merge_dist = 0.01f;
+  const std::vector<Co> coords_expected = vert_coords_welded_expected(mesh);
+  EXPECT_LT(coords_expected.size(), (size_t)mesh->totvert);
+
+  Mesh *result = weld(mesh);
+  vert_coords_expect_near(coords_expected, vert_coords_sorted(result));
+
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
@@ -0,0 +1,220 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "blenloader/blendfile_loading_base_test.h"
+
+#include "CLG_log.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_playback_cache.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+}
+
+/* Array of a quad followed by a wave, so the object is evaluated again on every frame. */
+class MeshPlaybackCacheTest : public BlendfileLoadingBaseTest {
+ protected:
+  struct Main *bmain = nullptr;
+  struct Scene *scene = nullptr;
+  struct Depsgraph *depsgraph = nullptr;
+  struct Object *ob = nullptr;
+  ArrayModifierData *amd = nullptr;
+  int geometry_cachelimit_prev = 0;
+
+  /* Modifier errors report through the logger. */
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BlendfileLoadingBaseTest::SetUpTestCase();
+  }
+
+  static void TearDownTestCase()
+  {
+    CLG_exit();
+    BlendfileLoadingBaseTest::TearDownTestCase();
+  }
+
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    geometry_cachelimit_prev = U.geometry_cachelimit;
+    U.geometry_cachelimit = 64;
+
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+    ob = BKE_object_add(bmain, scene, view_layer, OB_MESH, "Quad");
+    quad_mesh_fill((Mesh *)ob->data);
+
+    amd = (ArrayModifierData *)BKE_modifier_new(eModifierType_Array);
+    amd->count = 2;
+    BLI_addtail(&ob->modifiers, amd);
+    BLI_addtail(&ob->modifiers, BKE_modifier_new(eModifierType_Wave));
+
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+    DEG_make_active(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  virtual void TearDown()
+  {
+    DEG_graph_free(depsgraph);
+    BKE_main_free(bmain);
+    BKE_mesh_playback_cache_clear();
+    U.geometry_cachelimit = geometry_cachelimit_prev;
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  static void quad_mesh_fill(Mesh *mesh)
+  {
+    mesh->totvert = 4;
+    mesh->totloop = 4;
+    mesh->totpoly = 1;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+    CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+    CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    const float co[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+    for (int i = 0; i < 4; i++) {
+      mesh->mvert[i].co[0] = co[i][0];
+      mesh->mvert[i].co[1] = co[i][1];
+      mesh->mloop[i].v = (unsigned int)i;
+    }
+    mesh->mpoly[0].totloop = 4;
+    BKE_mesh_calc_edges(mesh, false, false);
+    BKE_mesh_calc_normals(mesh);
+  }
+
+  /* Like #BKE_scene_graph_update_for_newframe, without the sound update. */
+  void frame_set(const int frame)
+  {
+    BKE_scene_frame_set(scene, frame);
+    DEG_evaluate_on_framechange(bmain, depsgraph, BKE_scene_frame_get(scene));
+    DEG_ids_clear_recalc(bmain, depsgraph);
+  }
+
+  /* Change a scene setting which modifiers read, like the RNA update does. */
+  void simplify_set(const bool use_simplify)
+  {
+    SET_FLAG_FROM_TEST(scene->r.mode, use_simplify, R_SIMPLIFY);
+    DEG_graph_id_tag_update(bmain, depsgraph, &scene->id, ID_RECALC_COPY_ON_WRITE);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  Object *object_eval()
+  {
+    return DEG_get_evaluated_object(depsgraph, ob);
+  }
+
+  Mesh *mesh_eval()
+  {
+    return BKE_object_get_evaluated_mesh(object_eval());
+  }
+};
+
+/* Going back to a frame uses the stored mesh itself, without copying it. */
+TEST_F(MeshPlaybackCacheTest, SharedOnHit)
+{
+  frame_set(1);
+  Mesh *mesh_frame_1 = mesh_eval();
+  EXPECT_EQ(mesh_frame_1->totvert, 8);
+  EXPECT_FALSE(object_eval()->runtime.is_data_eval_owned);
+  EXPECT_GT(BKE_mesh_playback_cache_memory_in_use(), 0);
+
+  frame_set(2);
+  EXPECT_NE(mesh_eval(), mesh_frame_1);
+
+  frame_set(1);
+  EXPECT_EQ(mesh_eval(), mesh_frame_1);
+}
+
+/* Results for other simplify settings are stored next to each other. */
+TEST_F(MeshPlaybackCacheTest, SimplifyChange)
+{
+  frame_set(1);
+  Mesh *mesh_frame_1 = mesh_eval();
+
+  simplify_set(true);
+  frame_set(2);
+  frame_set(1);
+  Mesh *mesh_frame_1_simplify = mesh_eval();
+  EXPECT_NE(mesh_frame_1_simplify, mesh_frame_1);
+
+  simplify_set(false);
+  frame_set(2);
+  frame_set(1);
+  EXPECT_EQ(mesh_eval(), mesh_frame_1);
+}
+
+/* A cache hit reports the errors of the evaluation which created the meshes. */
+TEST_F(MeshPlaybackCacheTest, ErrorsOnHit)
+{
+  amd->count = 1000000000;
+  DEG_graph_id_tag_update(bmain, depsgraph, &ob->id, ID_RECALC_GEOMETRY);
+  frame_set(1);
+  Mesh *mesh_frame_1 = mesh_eval();
+  ModifierData *md_eval = (ModifierData *)object_eval()->modifiers.first;
+  EXPECT_NE(md_eval->error, nullptr);
+
+  /* Errors of the other frame must not be what is reported. */
+  frame_set(2);
+  BKE_modifiers_clear_errors(object_eval());
+  frame_set(1);
+  EXPECT_EQ(mesh_eval(), mesh_frame_1);
+  md_eval = (ModifierData *)object_eval()->modifiers.first;
+  EXPECT_NE(md_eval->error, nullptr);
+}
+
+/* Entries removed from the cache stay valid for the objects still using them. */
+TEST_F(MeshPlaybackCacheTest, InvalidateWhileUsed)
+{
+  frame_set(1);
+  Mesh *mesh_frame_1 = mesh_eval();
+
+  BKE_mesh_playback_cache_invalidate_object(ob);
+  EXPECT_EQ(BKE_mesh_playback_cache_memory_in_use(), 0);
+  EXPECT_EQ(mesh_eval(), mesh_frame_1);
+  EXPECT_EQ(mesh_eval()->totvert, 8);
+
+  frame_set(2);
+  frame_set(1);
+  EXPECT_NE(mesh_eval(), mesh_frame_1);
+  EXPECT_EQ(mesh_eval()->totvert, 8);
+}
@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "blenloader/blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+}
+
+/* Array of a quad, followed by a deform modifier whose settings are tweaked. */
+class ModifierStackCacheTest : public BlendfileLoadingBaseTest {
+ protected:
+  struct Main *bmain = nullptr;
+  struct Scene *scene = nullptr;
+  struct Depsgraph *depsgraph = nullptr;
+  struct Object *ob = nullptr;
+  ArrayModifierData *amd = nullptr;
+  DisplaceModifierData *dmd = nullptr;
+  int modifier_cachelimit_prev = 0;
+
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    modifier_cachelimit_prev = U.modifier_cachelimit;
+    U.modifier_cachelimit = 64;
+
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+    /* Added objects are active, the cache is only used for the active object. */
+    ob = BKE_object_add(bmain, scene, view_layer, OB_MESH, "Quad");
+    quad_mesh_fill((Mesh *)ob->data);
+
+    amd = (ArrayModifierData *)BKE_modifier_new(eModifierType_Array);
+    amd->count = 2;
+    BLI_addtail(&ob->modifiers, amd);
+    dmd = (DisplaceModifierData *)BKE_modifier_new(eModifierType_Displace);
+    BLI_addtail(&ob->modifiers, dmd);
+
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+    DEG_make_active(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  virtual void TearDown()
+  {
+    DEG_graph_free(depsgraph);
+    BKE_main_free(bmain);
+    U.modifier_cachelimit = modifier_cachelimit_prev;
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  static void quad_mesh_fill(Mesh *mesh)
+  {
+    mesh->totvert = 4;
+    mesh->totloop = 4;
+    mesh->totpoly = 1;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+    CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+    CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    const float co[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+    for (int i = 0; i < 4; i++) {
+      mesh->mvert[i].co[0] = co[i][0];
+      mesh->mvert[i].co[1] = co[i][1];
+      mesh->mloop[i].v = (unsigned int)i;
+    }
+    mesh->mpoly[0].totloop = 4;
+    BKE_mesh_calc_edges(mesh, false, false);
+    BKE_mesh_calc_normals(mesh);
+  }
+
+  /* Tag the object like RNA updates do, and evaluate again. */
+  void evaluate_after_update(ModifierData *md_changed)
+  {
+    if (md_changed != nullptr) {
+      BKE_modifier_settings_tag_changed(md_changed);
+    }
+    DEG_graph_id_tag_update(bmain, depsgraph, &ob->id, ID_RECALC_GEOMETRY);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  Object *object_eval()
+  {
+    return DEG_get_evaluated_object(depsgraph, ob);
+  }
+
+  Mesh *mesh_eval()
+  {
+    return BKE_object_get_evaluated_mesh(object_eval());
+  }
+
+  /* Change the result stored after the array, to tell whether it is used. */
+  void cached_array_offset(const float offset)
+  {
+    ModifierStackCache *cache = object_eval()->runtime.modifier_stack_cache;
+    ASSERT_NE(cache, nullptr);
+    ASSERT_EQ(cache->entries_num, 2);
+    Mesh *mesh = cache->entries[0].mesh;
+    ASSERT_NE(mesh, nullptr);
+    for (int i = 0; i < mesh->totvert; i++) {
+      mesh->mvert[i].co[2] += offset;
+    }
+  }
+
+  /* Height of the first vertex, all vertices are displaced by the same amount. */
+  float mesh_eval_height()
+  {
+    return mesh_eval()->mvert[0].co[2];
+  }
+};
+
+/* Tweaking the modifier after the array resumes from the stored array. */
+TEST_F(ModifierStackCacheTest, ResumeAfterSettingsChange)
+{
+  EXPECT_EQ(mesh_eval()->totvert, 8);
+  const float height = mesh_eval_height();
+
+  /* The first evaluation for the same frame stores results. */
+  evaluate_after_update(&dmd->modifier);
+  EXPECT_EQ(mesh_eval()->totvert, 8);
+  cached_array_offset(10.0f);
+
+  evaluate_after_update(&dmd->modifier);
+  EXPECT_EQ(mesh_eval()->totvert, 8);
+  EXPECT_FLOAT_EQ(mesh_eval_height(), height + 10.0f);
+
+  /* Changing the array itself starts over. */
+  amd->count = 3;
+  evaluate_after_update(&amd->modifier);
+  EXPECT_EQ(mesh_eval()->totvert, 12);
+  EXPECT_FLOAT_EQ(mesh_eval_height(), height);
+}
+
+/* Simplify is a scene setting, which modifiers read without it being part of their settings.
+ * Tweak a modifier in the same update, so the update tag of the object is explained. */
+TEST_F(ModifierStackCacheTest, SimplifyChange)
+{
+  evaluate_after_update(&dmd->modifier);
+  const float height = mesh_eval_height();
+  cached_array_offset(10.0f);
+
+  scene->r.mode |= R_SIMPLIFY;
+  scene->r.simplify_subsurf = 0;
+  DEG_graph_id_tag_update(bmain, depsgraph, &scene->id, ID_RECALC_COPY_ON_WRITE);
+  evaluate_after_update(&dmd->modifier);
+  EXPECT_FLOAT_EQ(mesh_eval_height(), height);
+
+  /* Results are stored again for the new settings. */
+  evaluate_after_update(&dmd->modifier);
+  cached_array_offset(10.0f);
+  scene->r.simplify_subsurf = 1;
+  DEG_graph_id_tag_update(bmain, depsgraph, &scene->id, ID_RECALC_COPY_ON_WRITE);
+  evaluate_after_update(&dmd->modifier);
+  EXPECT_FLOAT_EQ(mesh_eval_height(), height);
+}
+
+/* Operators changing modifier data directly only tag the object for a geometry update. */
+TEST_F(ModifierStackCacheTest, GeometryTagWithoutSettingsChange)
+{
+  evaluate_after_update(&dmd->modifier);
+  const float height = mesh_eval_height();
+  cached_array_offset(10.0f);
+
+  amd->count = 3;
+  evaluate_after_update(nullptr);
+  EXPECT_EQ(mesh_eval()->totvert, 12);
+  EXPECT_FLOAT_EQ(mesh_eval_height(), height);
+}
@@ -0,0 +1,252 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+/* Modifier evaluation benchmark.
+ *
+ * Every modifier is evaluated on its own, outside of the dependency graph, on a mesh built in
+ * memory, with a varying number of threads. */
+
+#include "blenloader/blendfile_loading_base_test.h"
+#include "testing/testing_performance.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+
+#include "PIL_time.h"
+}
+
+#define NUM_RUN_AVERAGED 10
+
+class ModifiersPerformanceTest : public BlendfileLoadingBaseTest {
+ protected:
+  struct Main *bmain = nullptr;
+  struct Scene *scene = nullptr;
+  struct Object *ob = nullptr;
+
+  virtual void SetUp()
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    depsgraph = DEG_graph_new(
+        bmain, scene, BKE_view_layer_default_view(scene), DAG_EVAL_VIEWPORT);
+  }
+
+  virtual void TearDown()
+  {
+    depsgraph_free();
+    BKE_main_free(bmain);
+    bmain = nullptr;
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* Grid of quads in the XY plane, displaced by a wave along Z which is zero on the borders at
+   * X = -1 and X = 1, so array copies touch. The mesh is the data of the object the modifiers are
+   * evaluated for, so it is also the rest shape of Corrective Smooth. */
+  Mesh *grid_object_add(const int resolution)
+  {
+    Mesh *mesh = BKE_mesh_add(bmain, "Grid");
+    const int num_polys = (resolution - 1) * (resolution - 1);
+    mesh->totvert = resolution * resolution;
+    mesh->totpoly = num_polys;
+    mesh->totloop = num_polys * 4;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+    CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+    CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    for (int y = 0; y < resolution; y++) {
+      for (int x = 0; x < resolution; x++) {
+        MVert *mvert = &mesh->mvert[y * resolution + x];
+        mvert->co[0] = (float)x / (resolution - 1) * 2.0f - 1.0f;
+        mvert->co[1] = (float)y / (resolution - 1) * 2.0f - 1.0f;
+        mvert->co[2] = 0.1f * sinf(mvert->co[0] * (float)M_PI * 4.0f) *
+                       cosf(mvert->co[1] * 10.0f);
+      }
+    }
+    for (int y = 0; y < resolution - 1; y++) {
+      for (int x = 0; x < resolution - 1; x++) {
+        const int poly_index = y * (resolution - 1) + x;
+        const int v = y * resolution + x;
+        MPoly *mpoly = &mesh->mpoly[poly_index];
+        MLoop *mloop = &mesh->mloop[poly_index * 4];
+        mpoly->loopstart = poly_index * 4;
+        mpoly->totloop = 4;
+        mloop[0].v = v;
+        mloop[1].v = v + 1;
+        mloop[2].v = v + resolution + 1;
+        mloop[3].v = v + resolution;
+      }
+    }
+    BKE_mesh_calc_edges(mesh, false, false);
+    BKE_mesh_calc_normals(mesh);
+
+    ob = BKE_object_add_only_object(bmain, OB_MESH, "Grid");
+    ob->data = mesh;
+    return mesh;
+  }
+
+  ModifierData *modifier_add(const int type)
+  {
+    ModifierData *md = BKE_modifier_new(type);
+    BLI_addtail(&ob->modifiers, md);
+    return md;
+  }
+
+  /* Evaluate the modifier on a copy of the input mesh, return the evaluation time. Deform
+   * modifiers get the coordinates of the input mesh moved along Z, so the deformation differs
+   * from the rest shape, and no mesh like the leading deform modifiers of a stack, so the input
+   * mesh has to be the object data. */
+  double modifier_eval(ModifierData *md, Mesh *mesh_input, Mesh **r_mesh_result)
+  {
+    const ModifierTypeInfo *mti = BKE_modifier_get_info((ModifierType)md->type);
+    const ModifierEvalContext ctx = {depsgraph, ob, (ModifierApplyFlag)0};
+    Mesh *mesh = BKE_mesh_copy_for_eval(mesh_input, false);
+
+    double time;
+    if (mti->type == eModifierTypeType_OnlyDeform) {
+      int num_verts;
+      float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, &num_verts);
+      for (int i = 0; i < num_verts; i++) {
+        vert_coords[i][2] += 0.1f * sinf(vert_coords[i][0] * 5.0f);
+      }
+      const double start_time = PIL_check_seconds_timer();
+      mti->deformVerts(md, &ctx, nullptr, vert_coords, num_verts);
+      time = PIL_check_seconds_timer() - start_time;
+      BKE_mesh_vert_coords_apply(mesh, vert_coords);
+      MEM_freeN(vert_coords);
+    }
+    else {
+      const double start_time = PIL_check_seconds_timer();
+      Mesh *mesh_result = mti->modifyMesh(md, &ctx, mesh);
+      time = PIL_check_seconds_timer() - start_time;
+      if (mesh_result != mesh) {
+        BKE_id_free(nullptr, mesh);
+        mesh = mesh_result;
+      }
+    }
+
+    if (r_mesh_result != nullptr) {
+      *r_mesh_result = mesh;
+    }
+    else {
+      BKE_id_free(nullptr, mesh);
+    }
+    return time;
+  }
+
+  /* Print the size of the result and check the expected number of vertices and polygons. */
+  void modifier_benchmark_run(const char *id,
+                              ModifierData *md,
+                              Mesh *mesh_input,
+                              const int totvert_expected,
+                              const int totpoly_expected)
+  {
+    Mesh *mesh_result;
+    modifier_eval(md, mesh_input, &mesh_result);
+    printf("%s: %d vertices, %d polygons in, %d vertices, %d polygons out\n",
+           id,
+           mesh_input->totvert,
+           mesh_input->totpoly,
+           mesh_result->totvert,
+           mesh_result->totpoly);
+    EXPECT_EQ(mesh_result->totvert, totvert_expected);
+    EXPECT_EQ(mesh_result->totpoly, totpoly_expected);
+    BKE_id_free(nullptr, mesh_result);
+
+    benchmark_run_num_threads(
+        id, NUM_RUN_AVERAGED, [&]() { return modifier_eval(md, mesh_input, nullptr); });
+  }
+};
+
+TEST_F(ModifiersPerformanceTest, CorrectiveSmooth)
+{
+  Mesh *mesh = grid_object_add(448);
+  CorrectiveSmoothModifierData *csmd = (CorrectiveSmoothModifierData *)modifier_add(
+      eModifierType_CorrectiveSmooth);
+  csmd->repeat = 10;
+  modifier_benchmark_run(
+      "CorrectiveSmooth", &csmd->modifier, mesh, mesh->totvert, mesh->totpoly);
+}
+
+TEST_F(ModifiersPerformanceTest, ArrayMerge)
+{
+  Mesh *mesh = grid_object_add(32);
+  ArrayModifierData *amd = (ArrayModifierData *)modifier_add(eModifierType_Array);
+  amd->count = 1000;
+  amd->flags |= MOD_ARR_MERGE;
+  /* Copies share their border column of vertices. */
+  modifier_benchmark_run("ArrayMerge",
+                         &amd->modifier,
+                         mesh,
+                         32 * (31 * 1000 + 1),
+                         mesh->totpoly * 1000);
+}
+
+/* Touching copies of an array without merging, joined by the weld modifier. */
+TEST_F(ModifiersPerformanceTest, Weld)
+{
+  Mesh *mesh = grid_object_add(64);
+  ArrayModifierData *amd = (ArrayModifierData *)modifier_add(eModifierType_Array);
+  amd->count = 64;
+  Mesh *mesh_array;
+  modifier_eval(&amd->modifier, mesh, &mesh_array);
+
+  ModifierData *md = modifier_add(eModifierType_Weld);
+  modifier_benchmark_run(
+      "Weld", md, mesh_array, 64 * (63 * 64 + 1), mesh_array->totpoly);
+  BKE_id_free(nullptr, mesh_array);
+}
+
+/* Every vertex duplicated many times within the merge distance, like in scans or repeatedly
+ * joined geometry, so all vertices are in large clusters. */
+TEST_F(ModifiersPerformanceTest, WeldClusters)
+{
+  Mesh *mesh = grid_object_add(128);
+  ArrayModifierData *amd = (ArrayModifierData *)modifier_add(eModifierType_Array);
+  amd->count = 16;
+  amd->offset_type = MOD_ARR_OFF_CONST;
+  amd->offset[0] = 1e-4f;
+  Mesh *mesh_array;
+  modifier_eval(&amd->modifier, mesh, &mesh_array);
+
+  ModifierData *md = modifier_add(eModifierType_Weld);
+  /* All copies collapse into a single grid. */
+  modifier_benchmark_run("WeldClusters", md, mesh_array, mesh->totvert, mesh->totpoly);
+  BKE_id_free(nullptr, mesh_array);
+}
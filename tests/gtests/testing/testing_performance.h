@@ -0,0 +1,82 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#ifndef __BLENDER_TESTING_PERFORMANCE_H__
+#define __BLENDER_TESTING_PERFORMANCE_H__
+
+/* Helpers for the benchmarks registered with BLENDER_TEST_PERFORMANCE, which time the same work
+ * with an increasing number of threads. */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+/* Restart the task scheduler with the given number of threads, zero uses all system threads. */
+inline void benchmark_task_scheduler_threads_set(const int num_threads)
+{
+  BLI_task_scheduler_exit();
+  BLI_system_num_threads_override_set(num_threads);
+  BLI_task_scheduler_init();
+}
+
+/* Call `fn(num_threads)` for 1, 2, 4 ... threads, up to the number of system threads, with the
+ * task scheduler restarted for each thread count. All threads are used again afterwards. */
+template<typename Fn> void benchmark_foreach_num_threads(const Fn &fn)
+{
+  const int num_threads_max = BLI_system_thread_count();
+  for (int num_threads = 1;; num_threads = std::min(num_threads * 2, num_threads_max)) {
+    benchmark_task_scheduler_threads_set(num_threads);
+    fn(num_threads);
+    if (num_threads == num_threads_max) {
+      break;
+    }
+  }
+  benchmark_task_scheduler_threads_set(0);
+}
+
+/* Print the average time of a benchmark for one thread count. */
+inline void benchmark_time_print(const int num_threads,
+                                 const char *name,
+                                 const double time_total,
+                                 const int num_runs)
+{
+  printf("\t%d threads: %s %fs (average over %d runs)\n",
+         num_threads,
+         name,
+         time_total / num_runs,
+         num_runs);
+}
+
+/* Time `run_fn()` for every thread count, averaged over `num_runs` calls. The function returns
+ * the time of the part that is measured, so it can exclude setup and cleanup. */
+template<typename Fn>
+void benchmark_run_num_threads(const char *name, const int num_runs, const Fn &run_fn)
+{
+  benchmark_foreach_num_threads([&](const int num_threads) {
+    double time_total = 0.0;
+    for (int i = 0; i < num_runs; i++) {
+      time_total += run_fn();
+    }
+    benchmark_time_print(num_threads, name, time_total, num_runs);
+  });
+}
+
+#endif /* __BLENDER_TESTING_PERFORMANCE_H__ */